@@ -26,6 +26,7 @@
 #include "util/util_args.h"
 #include "util/util_foreach.h"
 #include "util/util_function.h"
+#include "util/util_guarded_allocator.h"
 #include "util/util_logging.h"
 #include "util/util_path.h"
 #include "util/util_progress.h"
@@ -52,6 +53,11 @@ struct Options {
 	bool quiet;
 	bool show_help, interactive, pause;
 	string output_path;
+	/* Benchmark mode, renders all given files and reports statistics. */
+	bool benchmark;
+	string benchmark_output;
+	vector<string> filepaths;
+	double scene_load_time;
 } options;
 
 static void session_print(const string& str)
@@ -131,7 +137,15 @@ static void scene_init()
 	options.scene = new Scene(options.scene_params, options.session->device);
 
 	/* Read XML */
-	xml_read_file(options.scene, options.filepath.c_str());
+	{
+		scoped_timer timer(&options.scene_load_time);
+		xml_read_file(options.scene, options.filepath.c_str());
+	}
+
+	/* Fixed seed so benchmark runs are reproducible. */
+	if(options.benchmark) {
+		options.scene->integrator->seed = 0;
+	}
 
 	/* Camera width/height override? */
 	if(!(options.width == 0 || options.height == 0)) {
@@ -344,12 +358,161 @@ static void keyboard(unsigned char key)
 
 static int files_parse(int argc, const char *argv[])
 {
-	if(argc > 0)
+	for(int i = 0; i < argc; i++)
+		options.filepaths.push_back(argv[i]);
+
+	if(argc > 0 && options.filepath == "")
 		options.filepath = argv[0];
 
 	return 0;
 }
 
+/* Benchmark */
+
+static string json_escape(const string& str)
+{
+	string result;
+	foreach(char c, str) {
+		if(c == '"' || c == '\\') {
+			result += '\\';
+			result += c;
+		}
+		else if((unsigned char)c < 0x20) {
+			result += string_printf("\\u%04x", (unsigned char)c);
+		}
+		else {
+			result += c;
+		}
+	}
+	return result;
+}
+
+/* Render the file in options.filepath and append its statistics to json. */
+static void benchmark_render(string& json)
+{
+	double total_time;
+
+	/* Host peak is process wide, only measure this file. */
+	util_guarded_reset_mem_peak();
+
+	{
+		scoped_timer timer(&total_time);
+		session_init();
+		options.session->wait();
+	}
+
+	Session *session = options.session;
+	Progress& progress = session->progress;
+	const SceneUpdateTimes& update = options.scene->update_times;
+	const Camera *camera = options.scene->camera;
+
+	double progress_time, render_time;
+	double path_trace_time, denoise_time;
+	progress.get_time(progress_time, render_time);
+	progress.get_tile_time(path_trace_time, denoise_time);
+
+	uint64_t pixel_samples = progress.get_pixel_samples();
+	double paths_per_second = (render_time > 0.0)? pixel_samples / render_time: 0.0;
+
+	if(json != "")
+		json += ",\n";
+
+	json += string_printf(
+		"    {\n"
+		"      \"file\": \"%s\",\n"
+		"      \"width\": %d,\n"
+		"      \"height\": %d,\n"
+		"      \"samples\": %d,\n"
+		"      \"error\": \"%s\",\n"
+		"      \"time\": {\n"
+		"        \"total\": %f,\n"
+		"        \"scene_load\": %f,\n"
+		"        \"scene_update\": %f,\n"
+		"        \"shaders\": %f,\n"
+		"        \"objects\": %f,\n"
+		"        \"meshes\": %f,\n"
+		"        \"bvh\": %f,\n"
+		"        \"images\": %f,\n"
+		"        \"lights\": %f,\n"
+		"        \"render\": %f,\n"
+		"        \"path_trace_tiles\": %f,\n"
+		"        \"denoise_tiles\": %f\n"
+		"      },\n"
+		"      \"pixel_samples\": %llu,\n"
+		"      \"paths_per_second\": %f,\n"
+		"      \"memory\": {\n"
+		"        \"device_peak\": %llu,\n"
+		"        \"host_peak\": %llu\n"
+		"      }\n"
+		"    }",
+		json_escape(options.filepath).c_str(),
+		camera->width,
+		camera->height,
+		options.session_params.samples,
+		json_escape(progress.get_error_message()).c_str(),
+		total_time,
+		options.scene_load_time,
+		update.total,
+		update.shaders,
+		update.objects,
+		update.meshes,
+		update.bvh,
+		update.images,
+		update.lights,
+		render_time,
+		path_trace_time,
+		denoise_time,
+		(unsigned long long)pixel_samples,
+		paths_per_second,
+		(unsigned long long)session->stats.mem_peak,
+		(unsigned long long)util_guarded_get_mem_peak());
+
+	session_exit();
+}
+
+/* Render all given files one after the other with the same settings, and
+ * write the timings of every phase and peak memory usage as JSON, so runs
+ * can be compared against each other to find performance regressions. */
+static bool benchmark_run()
+{
+	const int width = options.width, height = options.height;
+	string scenes_json;
+
+	foreach(const string& filepath, options.filepaths) {
+		options.filepath = filepath;
+		options.width = width;
+		options.height = height;
+
+		benchmark_render(scenes_json);
+	}
+
+	string json = string_printf(
+		"{\n"
+		"  \"version\": \"%s\",\n"
+		"  \"device\": \"%s\",\n"
+		"  \"threads\": %d,\n"
+		"  \"scenes\": [\n"
+		"%s\n"
+		"  ]\n"
+		"}\n",
+		CYCLES_VERSION_STRING,
+		json_escape(options.session_params.device.description).c_str(),
+		options.session_params.threads,
+		scenes_json.c_str());
+
+	if(options.benchmark_output == "") {
+		printf("%s", json.c_str());
+		return true;
+	}
+
+	if(!path_write_text(options.benchmark_output, json)) {
+		fprintf(stderr, "Failed to write benchmark results to %s\n", options.benchmark_output.c_str());
+		return false;
+	}
+
+	return true;
+}
+
 static void options_parse(int argc, const char **argv)
 {
 	options.width = 0;
@@ -357,6 +520,9 @@ static void options_parse(int argc, const char **argv)
 	options.filepath = "";
 	options.session = NULL;
 	options.quiet = false;
+	options.benchmark = false;
+	options.benchmark_output = "";
+	options.scene_load_time = 0.0;
 
 	/* device names */
 	string device_names = "";
@@ -385,7 +551,7 @@ static void options_parse(int argc, const char **argv)
 	bool help = false, debug = false, version = false;
 	int verbosity = 1;
 
-	ap.options ("Usage: cycles [options] file.xml",
+	ap.options ("Usage: cycles [options] file.xml [file.xml ...]",
 		"%*", files_parse, "",
 		"--device %s", &devicename, ("Devices to use: " + device_names).c_str(),
 #ifdef WITH_OSL
@@ -401,6 +567,8 @@ static void options_parse(int argc, const char **argv)
 		"--tile-width %d", &options.session_params.tile_size.x, "Tile width in pixels",
 		"--tile-height %d", &options.session_params.tile_size.y, "Tile height in pixels",
 		"--list-devices", &list, "List information about all available devices",
+		"--benchmark", &options.benchmark, "Render all files in background with a fixed seed and report timings and memory usage as JSON",
+		"--benchmark-output %s", &options.benchmark_output, "File path to write benchmark results to, instead of standard output",
 #ifdef WITH_CYCLES_LOGGING
 		"--debug", &debug, "Enable debug logging",
 		"--verbose %d", &verbosity, "Set verbosity of the logger",
@@ -451,6 +619,11 @@ static void options_parse(int argc, const char **argv)
 	options.session_params.background = true;
 #endif
 
+	if(options.benchmark) {
+		options.session_params.background = true;
+		options.quiet = true;
+	}
+
 	/* Use progressive rendering */
 	options.session_params.progressive = true;
 
@@ -505,6 +678,10 @@ int main(int argc, const char **argv)
 	path_init();
 	options_parse(argc, argv);
 
+	if(options.benchmark) {
+		return benchmark_run()? 0: 1;
+	}
+
 #ifdef WITH_CYCLES_STANDALONE_GUI
 	if(options.session_params.background) {
 #endif
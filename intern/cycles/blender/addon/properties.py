@@ -50,6 +50,7 @@ enum_displacement_methods = (
 enum_bvh_layouts = (
     ('BVH2', "BVH2", "", 1),
     ('BVH4', "BVH4", "", 2),
+    ('BVH8', "BVH8", "", 4),
     )
 
 enum_bvh_types = (
@@ -296,6 +297,35 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
                 default=0.01,
                 )
 
+        cls.use_light_tree = BoolProperty(
+                name="Light Tree",
+                description="Pick lights based on their distance and orientation to the shading point, "
+                            "reducing noise in scenes with many lights. Not used when sampling all lights",
+                default=False,
+                )
+
+        cls.use_adaptive_sampling = BoolProperty(
+                name="Adaptive Sampling",
+                description="Automatically stop sampling pixels which have converged, "
+                            "only supported for final renders on the CPU",
+                default=False,
+                )
+        cls.adaptive_threshold = FloatProperty(
+                name="Adaptive Threshold",
+                description="Noise level at which a pixel is considered converged, "
+                            "zero for automatic setting based on number of AA samples",
+                min=0.0, max=1.0,
+                default=0.0,
+                precision=4,
+                )
+        cls.adaptive_min_samples = IntProperty(
+                name="Adaptive Min Samples",
+                description="Minimum number of AA samples taken before a pixel can be considered converged, "
+                            "zero for automatic setting based on number of AA samples",
+                min=0, max=4096,
+                default=0,
+                )
+
         cls.caustics_reflective = BoolProperty(
                 name="Reflective Caustics",
                 description="Use reflective caustics, resulting in a brighter image (more noise but added realism)",
@@ -545,6 +575,24 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
                 default=0,
                 min=0, max=16,
                 )
+        cls.use_texture_cache = BoolProperty(
+                name="Use Texture Cache",
+                description="Read image textures on demand from a tiled, mip-mapped cache of limited size "
+                            "instead of loading them fully (CPU only)",
+                default=False,
+                )
+        cls.texture_cache_size = IntProperty(
+                name="Cache Size",
+                description="Maximum memory used by the texture cache in megabytes",
+                default=1024,
+                min=64, max=65536,
+                )
+        cls.texture_auto_convert = BoolProperty(
+                name="Auto Convert",
+                description="Convert image textures which are not tiled and mip-mapped to .tx files "
+                            "next to the original once, to speed up reading from the cache",
+                default=False,
+                )
         cls.tile_order = EnumProperty(
                 name="Tile Order",
                 description="Tile order for rendering",
@@ -679,7 +727,7 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         cls.debug_bvh_layout = EnumProperty(
                 name="BVH Layout",
                 items=enum_bvh_layouts,
-                default='BVH4',
+                default='BVH8',
                 )
         cls.debug_use_cpu_split_kernel = BoolProperty(name="Split Kernel", default=False)
 
@@ -172,6 +172,7 @@ class CYCLES_RENDER_PT_sampling(CyclesButtonsPanel, Panel):
         sub.prop(cscene, "sample_clamp_direct")
         sub.prop(cscene, "sample_clamp_indirect")
         sub.prop(cscene, "light_sampling_threshold")
+        sub.prop(cscene, "use_light_tree")
 
         if cscene.progressive == 'PATH' or use_branched_path(context) is False:
             col = split.column()
@@ -205,6 +206,13 @@ class CYCLES_RENDER_PT_sampling(CyclesButtonsPanel, Panel):
 
         layout.row().prop(cscene, "sampling_pattern", text="Pattern")
 
+        row = layout.row()
+        row.prop(cscene, "use_adaptive_sampling")
+        sub = row.row(align=True)
+        sub.active = cscene.use_adaptive_sampling
+        sub.prop(cscene, "adaptive_threshold", text="Threshold")
+        sub.prop(cscene, "adaptive_min_samples", text="Min Samples")
+
         for rl in scene.render.layers:
             if rl.samples > 0:
                 layout.separator()
@@ -436,6 +444,15 @@ class CYCLES_RENDER_PT_performance(CyclesButtonsPanel, Panel):
         row.active = not cscene.debug_use_spatial_splits
         row.prop(cscene, "debug_bvh_time_steps")
 
+        col.separator()
+
+        col.label(text="Image Textures:")
+        col.prop(cscene, "use_texture_cache")
+        sub = col.column(align=True)
+        sub.active = cscene.use_texture_cache and use_cpu(context) and not cscene.shading_system
+        sub.prop(cscene, "texture_cache_size")
+        sub.prop(cscene, "texture_auto_convert")
+
         col = layout.column()
         col.label(text="Viewport Resolution:")
         split = col.split()
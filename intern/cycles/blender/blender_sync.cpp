@@ -284,6 +284,11 @@ void BlenderSync::sync_integrator()
 	integrator->sample_all_lights_direct = get_boolean(cscene, "sample_all_lights_direct");
 	integrator->sample_all_lights_indirect = get_boolean(cscene, "sample_all_lights_indirect");
 	integrator->light_sampling_threshold = get_float(cscene, "light_sampling_threshold");
+	integrator->use_light_tree = get_boolean(cscene, "use_light_tree");
+
+	integrator->use_adaptive_sampling = get_boolean(cscene, "use_adaptive_sampling");
+	integrator->adaptive_threshold = get_float(cscene, "adaptive_threshold");
+	integrator->adaptive_min_samples = get_int(cscene, "adaptive_min_samples");
 
 	int diffuse_samples = get_int(cscene, "diffuse_samples");
 	int glossy_samples = get_int(cscene, "glossy_samples");
@@ -324,6 +329,15 @@ void BlenderSync::sync_integrator()
 		integrator->ao_bounces = 0;
 	}
 
+	/* Whether the light tree is built depends on these. */
+	if(integrator->use_light_tree != previntegrator.use_light_tree ||
+	   integrator->method != previntegrator.method ||
+	   integrator->sample_all_lights_direct != previntegrator.sample_all_lights_direct ||
+	   integrator->sample_all_lights_indirect != previntegrator.sample_all_lights_indirect)
+	{
+		scene->light_manager->tag_update(scene);
+	}
+
 	if(integrator->modified(previntegrator))
 		integrator->tag_update(scene);
 }
@@ -616,6 +630,12 @@ array<Pass> BlenderSync::sync_render_passes(BL::RenderLayer& b_rlay,
 		Pass::add(PASS_VOLUME_INDIRECT, passes);
 	}
 
+	/* Internal passes for adaptive sampling, not exposed to Blender. */
+	if(scene->integrator->use_adaptive_sampling) {
+		Pass::add(PASS_ADAPTIVE_AUX_BUFFER, passes);
+		Pass::add(PASS_SAMPLE_COUNT, passes);
+	}
+
 	return passes;
 }
 
@@ -662,6 +682,10 @@ SceneParams BlenderSync::get_scene_params(BL::Scene& b_scene,
 		params.texture_limit = 0;
 	}
 
+	params.use_texture_cache = RNA_boolean_get(&cscene, "use_texture_cache");
+	params.texture_cache_size = RNA_int_get(&cscene, "texture_cache_size");
+	params.texture_auto_convert = RNA_boolean_get(&cscene, "texture_auto_convert");
+
 	params.bvh_layout = DebugFlags().cpu.bvh_layout;
 
 	return params;
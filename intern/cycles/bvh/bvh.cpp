@@ -22,6 +22,7 @@
 
 #include "bvh/bvh2.h"
 #include "bvh/bvh4.h"
+#include "bvh/bvh8.h"
 #include "bvh/bvh_build.h"
 #include "bvh/bvh_node.h"
 
@@ -38,6 +39,7 @@ const char *bvh_layout_name(BVHLayout layout)
 	switch(layout) {
 		case BVH_LAYOUT_BVH2: return "BVH2";
 		case BVH_LAYOUT_BVH4: return "BVH4";
+		case BVH_LAYOUT_BVH8: return "BVH8";
 		case BVH_LAYOUT_NONE: return "NONE";
 		case BVH_LAYOUT_ALL:  return "ALL";
 	}
@@ -81,7 +83,12 @@ int BVHStackEntry::encodeIdx() const
 /* BVH */
 
 BVH::BVH(const BVHParams& params_, const vector<Object*>& objects_)
-: params(params_), objects(objects_)
+: params(params_),
+  objects(objects_),
+  build_cost(0.0f),
+  refit_cost(0.0f),
+  refit_leaf_area(0.0f),
+  refit_bounds(BoundBox::empty)
 {
 }
 
@@ -92,6 +99,8 @@ BVH *BVH::create(const BVHParams& params, const vector<Object*>& objects)
 			return new BVH2(params, objects);
 		case BVH_LAYOUT_BVH4:
 			return new BVH4(params, objects);
+		case BVH_LAYOUT_BVH8:
+			return new BVH8(params, objects);
 		case BVH_LAYOUT_NONE:
 		case BVH_LAYOUT_ALL:
 			break;
@@ -130,6 +139,10 @@ void BVH::build(Progress& progress)
 		return;
 	}
 
+	/* measure quality to compare against after refitting */
+	build_cost = leaf_cost(root);
+	refit_cost = build_cost;
+
 	/* pack nodes */
 	progress.set_substatus("Packing BVH nodes");
 	pack_nodes(root);
@@ -140,15 +153,25 @@ void BVH::build(Progress& progress)
 
 /* Refitting */
 
-void BVH::refit(Progress& progress)
+bool BVH::refit(Progress& progress)
 {
 	progress.set_substatus("Packing BVH primitives");
 	pack_primitives();
 
-	if(progress.get_cancel()) return;
+	if(progress.get_cancel()) return true;
 
 	progress.set_substatus("Refitting BVH nodes");
+	refit_leaf_area = 0.0f;
+	refit_bounds = BoundBox::empty;
 	refit_nodes();
+
+	/* Deformation can stretch leaf bounds far beyond what a rebuild would
+	 * give, detect it from the expected number of primitive intersections. */
+	refit_cost = leaf_cost(NULL);
+
+	VLOG(2) << "BVH refit cost " << refit_cost << ", build cost " << build_cost << ".";
+
+	return refit_cost <= build_cost * params.max_refit_cost_ratio;
 }
 
 void BVH::refit_primitives(int start, int end, BoundBox& bbox, uint& visibility)
@@ -216,6 +239,41 @@ void BVH::refit_primitives(int start, int end, BoundBox& bbox, uint& visibility)
 		}
 		visibility |= ob->visibility_for_tracing();
 	}
+
+	refit_leaf_area += bbox.safe_area() * (end - start);
+	refit_bounds.grow(bbox);
+}
+
+float BVH::leaf_cost(const BVHNode *root)
+{
+	/* Bounds of the leaves of a newly built tree are measured the same way
+	 * as while refitting, spatial splits clip them in the build nodes. */
+	if(root) {
+		refit_leaf_area = 0.0f;
+		refit_bounds = BoundBox::empty;
+
+		vector<const BVHNode*> stack;
+		stack.push_back(root);
+		while(!stack.empty()) {
+			const BVHNode *node = stack.back();
+			stack.pop_back();
+
+			if(node->is_leaf()) {
+				const LeafNode *leaf = (const LeafNode*)node;
+				BoundBox bbox = BoundBox::empty;
+				uint visibility = 0;
+				refit_primitives(leaf->lo, leaf->hi, bbox, visibility);
+			}
+			else {
+				for(int i = 0; i < node->num_children(); i++) {
+					stack.push_back(node->get_child(i));
+				}
+			}
+		}
+	}
+
+	const float root_area = refit_bounds.safe_area();
+	return (root_area > 0.0f)? refit_leaf_area / root_area: 0.0f;
 }
 
 /* Triangles */
@@ -291,8 +349,8 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
 	 * BVH's are stored in global arrays. This function merges them into the
 	 * top level BVH, adjusting indexes and offsets where appropriate.
 	 */
-	/* TODO(sergey): This code needs adjustment for wider BVH than 4. */
 	const bool use_qbvh = (params.bvh_layout == BVH_LAYOUT_BVH4);
+	const bool use_obvh = (params.bvh_layout == BVH_LAYOUT_BVH8);
 
 	/* Adjust primitive index to point to the triangle in the global array, for
 	 * meshes with transform applied and already in the top level BVH.
@@ -469,14 +527,26 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
 			for(size_t i = 0, j = 0; i < bvh_nodes_size; j++) {
 				size_t nsize, nsize_bbox;
 				if(bvh_nodes[i].x & PATH_RAY_NODE_UNALIGNED) {
-					nsize = use_qbvh
-					            ? BVH_UNALIGNED_QNODE_SIZE
-					            : BVH_UNALIGNED_NODE_SIZE;
-					nsize_bbox = (use_qbvh)? 13: 0;
+					if(use_obvh) {
+						nsize = BVH_UNALIGNED_ONODE_SIZE;
+						nsize_bbox = BVH_UNALIGNED_ONODE_SIZE-2;
+					}
+					else {
+						nsize = use_qbvh
+						            ? BVH_UNALIGNED_QNODE_SIZE
+						            : BVH_UNALIGNED_NODE_SIZE;
+						nsize_bbox = (use_qbvh)? 13: 0;
+					}
 				}
 				else {
-					nsize = (use_qbvh)? BVH_QNODE_SIZE: BVH_NODE_SIZE;
-					nsize_bbox = (use_qbvh)? 7: 0;
+					if(use_obvh) {
+						nsize = BVH_ONODE_SIZE;
+						nsize_bbox = BVH_ONODE_SIZE-2;
+					}
+					else {
+						nsize = (use_qbvh)? BVH_QNODE_SIZE: BVH_NODE_SIZE;
+						nsize_bbox = (use_qbvh)? 7: 0;
+					}
 				}
 
 				memcpy(pack_nodes + pack_nodes_offset,
@@ -489,19 +559,33 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
 				data.z += (data.z < 0)? -noffset_leaf: noffset;
 				data.w += (data.w < 0)? -noffset_leaf: noffset;
 
-				if(use_qbvh) {
+				if(use_qbvh || use_obvh) {
 					data.x += (data.x < 0)? -noffset_leaf: noffset;
 					data.y += (data.y < 0)? -noffset_leaf: noffset;
 				}
 
 				pack_nodes[pack_nodes_offset + nsize_bbox] = data;
 
+				/* Octo nodes keep the second half of child indices in the
+				 * next element.
+				 */
+				size_t nsize_children = 1;
+				if(use_obvh) {
+					int4 data1 = bvh_nodes[i + nsize_bbox + 1];
+					data1.x += (data1.x < 0)? -noffset_leaf: noffset;
+					data1.y += (data1.y < 0)? -noffset_leaf: noffset;
+					data1.z += (data1.z < 0)? -noffset_leaf: noffset;
+					data1.w += (data1.w < 0)? -noffset_leaf: noffset;
+					pack_nodes[pack_nodes_offset + nsize_bbox + 1] = data1;
+					nsize_children = 2;
+				}
+
 				/* Usually this copies nothing, but we better
 				 * be prepared for possible node size extension.
 				 */
-				memcpy(&pack_nodes[pack_nodes_offset + nsize_bbox+1],
-				       &bvh_nodes[i + nsize_bbox+1],
-				       sizeof(int4) * (nsize - (nsize_bbox+1)));
+				memcpy(&pack_nodes[pack_nodes_offset + nsize_bbox + nsize_children],
+				       &bvh_nodes[i + nsize_bbox + nsize_children],
+				       sizeof(int4) * (nsize - (nsize_bbox + nsize_children)));
 
 				pack_nodes_offset += nsize;
 				i += nsize;
@@ -82,17 +82,31 @@ public:
 	BVHParams params;
 	vector<Object*> objects;
 
+	/* Primitive term of the SAH cost, relative to the root bounds, after the
+	 * last build and after the last refit. */
+	float build_cost;
+	float refit_cost;
+
 	static BVH *create(const BVHParams& params, const vector<Object*>& objects);
 	virtual ~BVH() {}
 
 	void build(Progress& progress);
-	void refit(Progress& progress);
+	/* Returns false if the tree quality degraded too much and it should be
+	 * rebuilt instead. */
+	bool refit(Progress& progress);
 
 protected:
 	BVH(const BVHParams& params, const vector<Object*>& objects);
 
+	/* Accumulated during refit. */
+	float refit_leaf_area;
+	BoundBox refit_bounds;
+
 	/* Refit range of primitives. */
 	void refit_primitives(int start, int end, BoundBox& bbox, uint& visibility);
+	/* Primitive SAH cost of the leaves accumulated by refit_primitives(),
+	 * or measured for the leaves of the given build nodes. */
+	float leaf_cost(const BVHNode *root);
 
 	/* triangles and strands */
 	void pack_primitives();
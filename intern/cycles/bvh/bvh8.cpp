@@ -0,0 +1,478 @@
+/*
+ * Adapted from code copyright 2009-2010 NVIDIA Corporation
+ * Modifications Copyright 2011, Blender Foundation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bvh/bvh8.h"
+
+#include "render/mesh.h"
+#include "render/object.h"
+
+#include "bvh/bvh_node.h"
+#include "bvh/bvh_unaligned.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Collect up to eight children of the given inner node, by expanding inner
+ * nodes of the binary tree. The child with the largest surface area is
+ * expanded first, so the resulting node has well balanced children.
+ */
+static int obvh_collect_children(const BVHNode *node, const BVHNode *children[8])
+{
+	assert(!node->is_leaf());
+	int num_children = 0;
+	children[num_children++] = node->get_child(0);
+	children[num_children++] = node->get_child(1);
+	while(num_children < 8) {
+		int best_child = -1;
+		float best_area = -FLT_MAX;
+		for(int i = 0; i < num_children; ++i) {
+			if(children[i]->is_leaf()) {
+				continue;
+			}
+			const float area = children[i]->bounds.safe_area();
+			if(area > best_area) {
+				best_child = i;
+				best_area = area;
+			}
+		}
+		if(best_child == -1) {
+			/* All children are leaves, nothing to expand. */
+			break;
+		}
+		const BVHNode *expand = children[best_child];
+		children[best_child] = expand->get_child(0);
+		children[num_children++] = expand->get_child(1);
+	}
+	return num_children;
+}
+
+static bool obvh_children_is_unaligned(const BVHNode *const *children,
+                                       const int num_children)
+{
+	for(int i = 0; i < num_children; ++i) {
+		if(children[i]->is_unaligned) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Count nodes of the collapsed tree, needed to allocate packed arrays. */
+static void obvh_count_nodes(const BVHNode *node,
+                             bool use_unaligned_nodes,
+                             size_t *num_inner_nodes,
+                             size_t *num_unaligned_inner_nodes,
+                             size_t *num_leaf_nodes)
+{
+	if(node->is_leaf()) {
+		(*num_leaf_nodes)++;
+		return;
+	}
+	const BVHNode *children[8];
+	const int num_children = obvh_collect_children(node, children);
+	(*num_inner_nodes)++;
+	if(use_unaligned_nodes &&
+	   obvh_children_is_unaligned(children, num_children))
+	{
+		(*num_unaligned_inner_nodes)++;
+	}
+	for(int i = 0; i < num_children; ++i) {
+		obvh_count_nodes(children[i],
+		                 use_unaligned_nodes,
+		                 num_inner_nodes,
+		                 num_unaligned_inner_nodes,
+		                 num_leaf_nodes);
+	}
+}
+
+BVH8::BVH8(const BVHParams& params_, const vector<Object*>& objects_)
+: BVH(params_, objects_)
+{
+	params.bvh_layout = BVH_LAYOUT_BVH8;
+}
+
+void BVH8::pack_leaf(const BVHStackEntry& e, const LeafNode *leaf)
+{
+	float4 data[BVH_ONODE_LEAF_SIZE];
+	memset(data, 0, sizeof(data));
+	if(leaf->num_triangles() == 1 && pack.prim_index[leaf->lo] == -1) {
+		/* object */
+		data[0].x = __int_as_float(~(leaf->lo));
+		data[0].y = __int_as_float(0);
+	}
+	else {
+		/* triangle */
+		data[0].x = __int_as_float(leaf->lo);
+		data[0].y = __int_as_float(leaf->hi);
+	}
+	data[0].z = __uint_as_float(leaf->visibility);
+	if(leaf->num_triangles() != 0) {
+		data[0].w = __uint_as_float(pack.prim_type[leaf->lo]);
+	}
+
+	memcpy(&pack.leaf_nodes[e.idx], data, sizeof(float4)*BVH_ONODE_LEAF_SIZE);
+}
+
+void BVH8::pack_inner(const BVHStackEntry& e,
+                      const BVHStackEntry *en,
+                      int num)
+{
+	bool has_unaligned = false;
+	/* Check whether we have to create unaligned node or all nodes are aligned
+	 * and we can cut some corner here.
+	 */
+	if(params.use_unaligned_nodes) {
+		for(int i = 0; i < num; i++) {
+			if(en[i].node->is_unaligned) {
+				has_unaligned = true;
+				break;
+			}
+		}
+	}
+	if(has_unaligned) {
+		/* Create unaligned node with orientation transform for each of the
+		 * children.
+		 */
+		pack_unaligned_inner(e, en, num);
+	}
+	else {
+		/* There's no unaligned children, pack into AABB node. */
+		pack_aligned_inner(e, en, num);
+	}
+}
+
+void BVH8::pack_aligned_inner(const BVHStackEntry& e,
+                              const BVHStackEntry *en,
+                              int num)
+{
+	BoundBox bounds[8];
+	int child[8];
+	for(int i = 0; i < num; ++i) {
+		bounds[i] = en[i].node->bounds;
+		child[i] = en[i].encodeIdx();
+	}
+	pack_aligned_node(e.idx,
+	                  bounds,
+	                  child,
+	                  e.node->visibility,
+	                  e.node->time_from,
+	                  e.node->time_to,
+	                  num);
+}
+
+void BVH8::pack_aligned_node(int idx,
+                             const BoundBox *bounds,
+                             const int *child,
+                             const uint visibility,
+                             const float time_from,
+                             const float time_to,
+                             const int num)
+{
+	float4 data[BVH_ONODE_SIZE];
+	memset(data, 0, sizeof(data));
+
+	data[0].x = __uint_as_float(visibility & ~PATH_RAY_NODE_UNALIGNED);
+	data[0].y = time_from;
+	data[0].z = time_to;
+
+	/* Every component takes two float4, child i lives in lane i%4 of the
+	 * (i/4)-th one.
+	 */
+	for(int i = 0; i < num; i++) {
+		float3 bb_min = bounds[i].min;
+		float3 bb_max = bounds[i].max;
+		const int j = i >> 2, k = i & 3;
+
+		data[2 + j][k] = bb_min.x;
+		data[4 + j][k] = bb_max.x;
+		data[6 + j][k] = bb_min.y;
+		data[8 + j][k] = bb_max.y;
+		data[10 + j][k] = bb_min.z;
+		data[12 + j][k] = bb_max.z;
+
+		data[14 + j][k] = __int_as_float(child[i]);
+	}
+
+	for(int i = num; i < 8; i++) {
+		/* We store BB which would never be recorded as intersection
+		 * so kernel might safely assume there are always 8 child nodes.
+		 */
+		const int j = i >> 2, k = i & 3;
+
+		data[2 + j][k] = FLT_MAX;
+		data[4 + j][k] = -FLT_MAX;
+
+		data[6 + j][k] = FLT_MAX;
+		data[8 + j][k] = -FLT_MAX;
+
+		data[10 + j][k] = FLT_MAX;
+		data[12 + j][k] = -FLT_MAX;
+
+		data[14 + j][k] = __int_as_float(0);
+	}
+
+	memcpy(&pack.nodes[idx], data, sizeof(float4)*BVH_ONODE_SIZE);
+}
+
+void BVH8::pack_unaligned_inner(const BVHStackEntry& e,
+                                const BVHStackEntry *en,
+                                int num)
+{
+	Transform aligned_space[8];
+	BoundBox bounds[8];
+	int child[8];
+	for(int i = 0; i < num; ++i) {
+		aligned_space[i] = en[i].node->get_aligned_space();
+		bounds[i] = en[i].node->bounds;
+		child[i] = en[i].encodeIdx();
+	}
+	pack_unaligned_node(e.idx,
+	                    aligned_space,
+	                    bounds,
+	                    child,
+	                    e.node->visibility,
+	                    e.node->time_from,
+	                    e.node->time_to,
+	                    num);
+}
+
+void BVH8::pack_unaligned_node(int idx,
+                               const Transform *aligned_space,
+                               const BoundBox *bounds,
+                               const int *child,
+                               const uint visibility,
+                               const float time_from,
+                               const float time_to,
+                               const int num)
+{
+	float4 data[BVH_UNALIGNED_ONODE_SIZE];
+	memset(data, 0, sizeof(data));
+
+	data[0].x = __uint_as_float(visibility | PATH_RAY_NODE_UNALIGNED);
+	data[0].y = time_from;
+	data[0].z = time_to;
+
+	for(int i = 0; i < num; i++) {
+		Transform space = BVHUnaligned::compute_node_transform(
+		        bounds[i],
+		        aligned_space[i]);
+		const int j = i >> 2, k = i & 3;
+
+		data[2 + j][k] = space.x.x;
+		data[4 + j][k] = space.x.y;
+		data[6 + j][k] = space.x.z;
+
+		data[8 + j][k] = space.y.x;
+		data[10 + j][k] = space.y.y;
+		data[12 + j][k] = space.y.z;
+
+		data[14 + j][k] = space.z.x;
+		data[16 + j][k] = space.z.y;
+		data[18 + j][k] = space.z.z;
+
+		data[20 + j][k] = space.x.w;
+		data[22 + j][k] = space.y.w;
+		data[24 + j][k] = space.z.w;
+
+		data[26 + j][k] = __int_as_float(child[i]);
+	}
+
+	for(int i = num; i < 8; i++) {
+		/* We store BB which would never be recorded as intersection
+		 * so kernel might safely assume there are always 8 child nodes.
+		 */
+		const int j = i >> 2, k = i & 3;
+
+		for(int c = 2; c < 26; c += 2) {
+			data[c + j][k] = NAN;
+		}
+
+		data[26 + j][k] = __int_as_float(0);
+	}
+
+	memcpy(&pack.nodes[idx], data, sizeof(float4)*BVH_UNALIGNED_ONODE_SIZE);
+}
+
+/* Octo SIMD Nodes */
+
+void BVH8::pack_nodes(const BVHNode *root)
+{
+	/* Calculate size of the arrays required. */
+	size_t num_inner_nodes = 0,
+	       num_unaligned_nodes = 0,
+	       num_leaf_nodes = 0;
+	obvh_count_nodes(root,
+	                 params.use_unaligned_nodes,
+	                 &num_inner_nodes,
+	                 &num_unaligned_nodes,
+	                 &num_leaf_nodes);
+	const size_t node_size =
+	        (num_unaligned_nodes * BVH_UNALIGNED_ONODE_SIZE) +
+	        (num_inner_nodes - num_unaligned_nodes) * BVH_ONODE_SIZE;
+	/* Resize arrays. */
+	pack.nodes.clear();
+	pack.leaf_nodes.clear();
+	/* For top level BVH, first merge existing BVH's so we know the offsets. */
+	if(params.top_level) {
+		pack_instances(node_size, num_leaf_nodes*BVH_ONODE_LEAF_SIZE);
+	}
+	else {
+		pack.nodes.resize(node_size);
+		pack.leaf_nodes.resize(num_leaf_nodes*BVH_ONODE_LEAF_SIZE);
+	}
+
+	int nextNodeIdx = 0, nextLeafNodeIdx = 0;
+
+	/* Size of the packed inner node, depends on whether any of the collapsed
+	 * children is unaligned.
+	 */
+	const BVHNode *children[8];
+	int num_children;
+
+	vector<BVHStackEntry> stack;
+	stack.reserve(BVHParams::MAX_DEPTH*4);
+	if(root->is_leaf()) {
+		stack.push_back(BVHStackEntry(root, nextLeafNodeIdx++));
+	}
+	else {
+		num_children = obvh_collect_children(root, children);
+		stack.push_back(BVHStackEntry(root, nextNodeIdx));
+		nextNodeIdx += (params.use_unaligned_nodes &&
+		                obvh_children_is_unaligned(children, num_children))
+		                       ? BVH_UNALIGNED_ONODE_SIZE
+		                       : BVH_ONODE_SIZE;
+	}
+
+	while(stack.size()) {
+		BVHStackEntry e = stack.back();
+		stack.pop_back();
+
+		if(e.node->is_leaf()) {
+			/* leaf node */
+			const LeafNode *leaf = reinterpret_cast<const LeafNode*>(e.node);
+			pack_leaf(e, leaf);
+		}
+		else {
+			/* Inner node. */
+			const BVHNode *nodes[8];
+			const int numnodes = obvh_collect_children(e.node, nodes);
+			/* Push entries on the stack. */
+			for(int i = 0; i < numnodes; ++i) {
+				int idx;
+				if(nodes[i]->is_leaf()) {
+					idx = nextLeafNodeIdx++;
+				}
+				else {
+					idx = nextNodeIdx;
+					num_children = obvh_collect_children(nodes[i], children);
+					nextNodeIdx += (params.use_unaligned_nodes &&
+					                obvh_children_is_unaligned(children, num_children))
+					                       ? BVH_UNALIGNED_ONODE_SIZE
+					                       : BVH_ONODE_SIZE;
+				}
+				stack.push_back(BVHStackEntry(nodes[i], idx));
+			}
+			/* Set node. */
+			pack_inner(e, &stack[stack.size()-numnodes], numnodes);
+		}
+	}
+	assert(node_size == nextNodeIdx);
+	/* Root index to start traversal at, to handle case of single leaf node. */
+	pack.root_index = (root->is_leaf())? -1: 0;
+}
+
+void BVH8::refit_nodes()
+{
+	assert(!params.top_level);
+
+	BoundBox bbox = BoundBox::empty;
+	uint visibility = 0;
+	refit_node(0, (pack.root_index == -1)? true: false, bbox, visibility);
+}
+
+void BVH8::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility)
+{
+	if(leaf) {
+		/* Refit leaf node. */
+		int4 *data = &pack.leaf_nodes[idx];
+		int4 c = data[0];
+
+		BVH::refit_primitives(c.x, c.y, bbox, visibility);
+
+		/* TODO(sergey): This is actually a copy of pack_leaf(),
+		 * but this chunk of code only knows actual data and has
+		 * no idea about BVHNode.
+		 */
+		float4 leaf_data[BVH_ONODE_LEAF_SIZE];
+		leaf_data[0].x = __int_as_float(c.x);
+		leaf_data[0].y = __int_as_float(c.y);
+		leaf_data[0].z = __uint_as_float(visibility);
+		leaf_data[0].w = __uint_as_float(c.w);
+		memcpy(&pack.leaf_nodes[idx], leaf_data, sizeof(float4)*BVH_ONODE_LEAF_SIZE);
+	}
+	else {
+		int4 *data = &pack.nodes[idx];
+		bool is_unaligned = (data[0].x & PATH_RAY_NODE_UNALIGNED) != 0;
+		int child[8];
+		const int4 *c = is_unaligned? &data[26]: &data[14];
+		for(int i = 0; i < 8; ++i) {
+			child[i] = c[i >> 2][i & 3];
+		}
+		/* Refit inner node, set bbox from children. */
+		BoundBox child_bbox[8] = {BoundBox::empty, BoundBox::empty,
+		                          BoundBox::empty, BoundBox::empty,
+		                          BoundBox::empty, BoundBox::empty,
+		                          BoundBox::empty, BoundBox::empty};
+		uint child_visibility[8] = {0};
+		int num_nodes = 0;
+
+		for(int i = 0; i < 8; ++i) {
+			if(child[i] != 0) {
+				refit_node((child[i] < 0)? -child[i]-1: child[i], (child[i] < 0),
+				           child_bbox[i], child_visibility[i]);
+				++num_nodes;
+				bbox.grow(child_bbox[i]);
+				visibility |= child_visibility[i];
+			}
+		}
+
+		if(is_unaligned) {
+			Transform aligned_space[8] = {transform_identity(), transform_identity(),
+			                              transform_identity(), transform_identity(),
+			                              transform_identity(), transform_identity(),
+			                              transform_identity(), transform_identity()};
+			pack_unaligned_node(idx,
+			                    aligned_space,
+			                    child_bbox,
+			                    child,
+			                    visibility,
+			                    0.0f,
+			                    1.0f,
+			                    8);
+		}
+		else {
+			pack_aligned_node(idx,
+			                  child_bbox,
+			                  child,
+			                  visibility,
+			                  0.0f,
+			                  1.0f,
+			                  8);
+		}
+	}
+}
+
+CCL_NAMESPACE_END
@@ -90,6 +90,10 @@ public:
 	/* Same as above, but for triangle primitives. */
 	int num_motion_triangle_steps;
 
+	/* Refitted trees are rebuilt once their primitive SAH cost grows past
+	 * this factor of the cost right after building. */
+	float max_refit_cost_ratio;
+
 	/* fixed parameters */
 	enum {
 		MAX_DEPTH = 64,
@@ -123,6 +127,8 @@ public:
 
 		num_motion_curve_steps = 0;
 		num_motion_triangle_steps = 0;
+
+		max_refit_cost_ratio = 1.5f;
 	}
 
 	/* SAH costs */
@@ -58,6 +58,7 @@ public:
 	bool advanced_shading;          /* Supports full shading system. */
 	bool has_half_images;           /* Support half-float textures. */
 	bool has_volume_decoupled;      /* Decoupled volume shading. */
+	bool has_sparse_images;         /* Support sparse 3D textures. */
 	BVHLayoutMask bvh_layout_mask;  /* Bitmask of supported BVH layouts. */
 	bool has_osl;                   /* Support Open Shading Language. */
 	bool use_split_kernel;          /* Use split or mega kernel. */
@@ -74,6 +75,7 @@ public:
 		advanced_shading = true;
 		has_half_images = false;
 		has_volume_decoupled = false;
+		has_sparse_images = false;
 		bvh_layout_mask = BVH_LAYOUT_NONE;
 		has_osl = false;
 		use_split_kernel = false;
@@ -180,6 +182,23 @@ public:
 		         use_shader_raytrace == requested_features.use_shader_raytrace);
 	}
 
+	/* Whether the specialized CPU kernels without the optional features
+	 * can be used, see __KERNEL_BASIC_FEATURES__ in kernel_types.h. */
+	bool use_basic_features() const
+	{
+		return !(use_hair ||
+		         use_object_motion ||
+		         use_camera_motion ||
+		         use_baking ||
+		         use_volume ||
+		         use_subsurface ||
+		         use_integrator_branched ||
+		         use_patch_evaluation ||
+		         use_shadow_tricks ||
+		         use_denoising ||
+		         use_shader_raytrace);
+	}
+
 	/* Convert the requested features structure to a build options,
 	 * which could then be passed to compilers.
 	 */
@@ -294,6 +313,9 @@ public:
 	/* open shading language, only for CPU device */
 	virtual void *osl_memory() { return NULL; }
 
+	/* texture cache for image files, only for CPU device */
+	virtual void *texture_cache_memory() { return NULL; }
+
 	/* load/compile kernels, must be called before adding tasks */ 
 	virtual bool load_kernels(
 	        const DeviceRequestedFeatures& /*requested_features*/)
@@ -34,6 +34,7 @@
 #include "kernel/kernel_types.h"
 #include "kernel/split/kernel_split_data.h"
 #include "kernel/kernel_globals.h"
+#include "kernel/kernel_adaptive_sampling.h"
 
 #include "kernel/filter/filter.h"
 
@@ -170,11 +171,17 @@ public:
 	OSLGlobals osl_globals;
 #endif
 
+	TextureCacheGlobals texture_cache_globals;
+
 	bool use_split_kernel;
 
+	/* Use the path tracing kernel specialized for basic features. */
+	bool use_basic_kernel;
+
 	DeviceRequestedFeatures requested_features;
 
 	KernelFunctions<void(*)(KernelGlobals *, float *, int, int, int, int, int)>             path_trace_kernel;
+	KernelFunctions<void(*)(KernelGlobals *, float *, int, int, int, int, int)>             path_trace_basic_kernel;
 	KernelFunctions<void(*)(KernelGlobals *, uchar4 *, float *, float, int, int, int, int)> convert_to_half_float_kernel;
 	KernelFunctions<void(*)(KernelGlobals *, uchar4 *, float *, float, int, int, int, int)> convert_to_byte_kernel;
 	KernelFunctions<void(*)(KernelGlobals *, uint4 *, float4 *, int, int, int, int, int)>   shader_kernel;
@@ -212,6 +219,12 @@ public:
 	  texture_info(this, "__texture_info", MEM_TEXTURE),
 #define REGISTER_KERNEL(name) name ## _kernel(KERNEL_FUNCTIONS(name))
 	  REGISTER_KERNEL(path_trace),
+	  path_trace_basic_kernel(KERNEL_NAME_EVAL(cpu, path_trace),
+	                          KERNEL_NAME_EVAL(cpu_sse2, path_trace),
+	                          KERNEL_NAME_EVAL(cpu_sse3, path_trace),
+	                          KERNEL_NAME_EVAL(cpu_sse41_basic, path_trace),
+	                          KERNEL_NAME_EVAL(cpu_avx_basic, path_trace),
+	                          KERNEL_NAME_EVAL(cpu_avx2_basic, path_trace)),
 	  REGISTER_KERNEL(convert_to_half_float),
 	  REGISTER_KERNEL(convert_to_byte),
 	  REGISTER_KERNEL(shader),
@@ -237,11 +250,16 @@ public:
 #ifdef WITH_OSL
 		kernel_globals.osl = &osl_globals;
 #endif
+		texture_cache_globals.lookup = NULL;
+		texture_cache_globals.data = NULL;
+		kernel_globals.texture_cache = &texture_cache_globals;
+
 		use_split_kernel = DebugFlags().cpu.split_kernel;
 		if(use_split_kernel) {
 			VLOG(1) << "Will be using split kernel.";
 		}
 		need_texture_info = false;
+		use_basic_kernel = false;
 
 #define REGISTER_SPLIT_KERNEL(name) split_kernels[#name] = KernelFunctions<void(*)(KernelGlobals*, KernelData*)>(KERNEL_FUNCTIONS(name))
 		REGISTER_SPLIT_KERNEL(path_init);
@@ -439,6 +457,11 @@ public:
 #endif
 	}
 
+	void *texture_cache_memory()
+	{
+		return &texture_cache_globals;
+	}
+
 	void thread_run(DeviceTask *task)
 	{
 		if(task->type == DeviceTask::RENDER) {
@@ -692,6 +715,14 @@ public:
 		int start_sample = tile.start_sample;
 		int end_sample = tile.start_sample + tile.num_samples;
 
+		/* OSL shading relies on the full kernel data layout. */
+		bool use_basic = use_basic_kernel;
+#ifdef WITH_OSL
+		use_basic = use_basic && !osl_globals.use;
+#endif
+		void (*path_trace_func)(KernelGlobals *, float *, int, int, int, int, int) =
+		        (use_basic)? path_trace_basic_kernel(): path_trace_kernel();
+
 		for(int sample = start_sample; sample < end_sample; sample++) {
 			if(task.get_cancel() || task_pool.canceled()) {
 				if(task.need_finish_queue == false)
@@ -700,14 +731,75 @@ public:
 
 			for(int y = tile.y; y < tile.y + tile.h; y++) {
 				for(int x = tile.x; x < tile.x + tile.w; x++) {
-					path_trace_kernel()(kg, render_buffer,
-					                    sample, x, y, tile.offset, tile.stride);
+					path_trace_func(kg, render_buffer,
+					                sample, x, y, tile.offset, tile.stride);
 				}
 			}
 
 			tile.sample = sample + 1;
 
 			task.update_progress(&tile, tile.w*tile.h);
+
+			if(kernel_adaptive_need_check(kg, sample) && adaptive_sampling_filter(kg, tile, sample)) {
+				/* All pixels converged, report the skipped samples as done so
+				 * the threads move on to the remaining tiles. */
+				tile.sample = end_sample;
+				task.update_progress(&tile, tile.w*tile.h*(end_sample - sample - 1));
+				break;
+			}
+		}
+
+		adaptive_sampling_post_adjust(kg, tile);
+	}
+
+	/* Flag converged pixels and dilate the unconverged regions, returns true
+	 * when no pixel of the tile needs more samples. */
+	bool adaptive_sampling_filter(KernelGlobals *kg, RenderTile &tile, int sample)
+	{
+		WorkTile wtile;
+		wtile.x = tile.x;
+		wtile.y = tile.y;
+		wtile.w = tile.w;
+		wtile.h = tile.h;
+		wtile.offset = tile.offset;
+		wtile.stride = tile.stride;
+		wtile.buffer = (float*)tile.buffer;
+
+		const int pass_stride = kg->__data.film.pass_stride;
+		for(int y = tile.y; y < tile.y + tile.h; y++) {
+			for(int x = tile.x; x < tile.x + tile.w; x++) {
+				int index = tile.offset + x + y*tile.stride;
+				kernel_adaptive_stopping(kg, wtile.buffer + index*pass_stride, sample);
+			}
+		}
+
+		bool any = false;
+		for(int y = tile.y; y < tile.y + tile.h; y++) {
+			any |= kernel_adaptive_filter_x(kg, &wtile, y);
+		}
+		for(int x = tile.x; x < tile.x + tile.w; x++) {
+			any |= kernel_adaptive_filter_y(kg, &wtile, x);
+		}
+
+		return !any;
+	}
+
+	/* Scale pixels that stopped early to the number of samples of the tile. */
+	void adaptive_sampling_post_adjust(KernelGlobals *kg, RenderTile &tile)
+	{
+		if(!kg->__data.integrator.use_adaptive_sampling ||
+		   kg->__data.film.pass_adaptive_aux_buffer == 0)
+		{
+			return;
+		}
+
+		float *render_buffer = (float*)tile.buffer;
+		const int pass_stride = kg->__data.film.pass_stride;
+		for(int y = tile.y; y < tile.y + tile.h; y++) {
+			for(int x = tile.x; x < tile.x + tile.w; x++) {
+				int index = tile.offset + x + y*tile.stride;
+				kernel_adaptive_post_adjust(kg, render_buffer + index*pass_stride, tile.sample);
+			}
 		}
 	}
 
@@ -921,12 +1013,23 @@ protected:
 	virtual bool load_kernels(const DeviceRequestedFeatures& requested_features_) {
 		requested_features = requested_features_;
 
+		use_basic_kernel = requested_features.use_basic_features();
+		VLOG(1) << "Will be using " << (use_basic_kernel? "basic": "full")
+		        << " features path tracing kernel.";
+
 		return true;
 	}
 };
 
 /* split kernel */
 
+/* Memory budget for the path state of a single thread, and bounds of the
+ * number of paths traced at once. */
+#define CPU_SPLIT_STATE_MEMORY ((uint64_t)32 * 1024 * 1024)
+#define CPU_SPLIT_MIN_PATHS 256
+#define CPU_SPLIT_MAX_PATHS 16384
+#define CPU_SPLIT_PATHS_WIDTH 64
+
 class CPUSplitKernelFunction : public SplitKernelFunction {
 public:
 	CPUDevice* device;
@@ -1022,8 +1125,19 @@ int2 CPUSplitKernel::split_kernel_local_size()
 	return make_int2(1, 1);
 }
 
-int2 CPUSplitKernel::split_kernel_global_size(device_memory& /*kg*/, device_memory& /*data*/, DeviceTask * /*task*/) {
-	return make_int2(1, 1);
+int2 CPUSplitKernel::split_kernel_global_size(device_memory& kernel_globals, device_memory& /*data*/, DeviceTask * /*task*/) {
+	/* Trace a large batch of paths at once, so rays can be sorted for more
+	 * coherent BVH traversal and shading. The batch size is limited by the
+	 * memory used for the path state of each thread. */
+	KernelGlobals *kg = (KernelGlobals*)kernel_globals.device_pointer;
+	uint64_t path_state_size = split_data_buffer_size(kg, 1);
+
+	int num_paths = CPU_SPLIT_MAX_PATHS;
+	if(path_state_size * CPU_SPLIT_MAX_PATHS > CPU_SPLIT_STATE_MEMORY) {
+		num_paths = max((int)(CPU_SPLIT_STATE_MEMORY / path_state_size), CPU_SPLIT_MIN_PATHS);
+	}
+
+	return make_int2(CPU_SPLIT_PATHS_WIDTH, num_paths / CPU_SPLIT_PATHS_WIDTH);
 }
 
 uint64_t CPUSplitKernel::state_buffer_size(device_memory& kernel_globals, device_memory& /*data*/, size_t num_threads) {
@@ -1050,9 +1164,18 @@ void device_cpu_info(vector<DeviceInfo>& devices)
 	if (system_cpu_support_sse2()) {
 		info.bvh_layout_mask |= BVH_LAYOUT_BVH4;
 	}
+#ifdef WITH_CYCLES_OPTIMIZED_KERNEL_AVX2
+	/* Octo BVH is only traversed by the AVX2 kernel, so must match the kernel
+	 * selection done in KernelFunctions.
+	 */
+	if (DebugFlags().cpu.has_avx2() && system_cpu_support_avx2()) {
+		info.bvh_layout_mask |= BVH_LAYOUT_BVH8;
+	}
+#endif
 	info.has_volume_decoupled = true;
 	info.has_osl = true;
 	info.has_half_images = true;
+	info.has_sparse_images = true;
 
 	devices.insert(devices.begin(), info);
 }
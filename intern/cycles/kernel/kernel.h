@@ -61,6 +61,16 @@ void kernel_tex_copy(KernelGlobals *kg,
 #define KERNEL_ARCH cpu_avx2
 #include "kernel/kernels/cpu/kernel_cpu.h"
 
+/* Kernels with basic features only, see __KERNEL_BASIC_FEATURES__. */
+#define KERNEL_ARCH cpu_sse41_basic
+#include "kernel/kernels/cpu/kernel_cpu.h"
+
+#define KERNEL_ARCH cpu_avx_basic
+#include "kernel/kernels/cpu/kernel_cpu.h"
+
+#define KERNEL_ARCH cpu_avx2_basic
+#include "kernel/kernels/cpu/kernel_cpu.h"
+
 CCL_NAMESPACE_END
 
 #endif /* __KERNEL_H__ */
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2011-2017 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KERNEL_ADAPTIVE_SAMPLING_H__
+#define __KERNEL_ADAPTIVE_SAMPLING_H__
+
+CCL_NAMESPACE_BEGIN
+
+/* Adaptive sampling
+ *
+ * The auxiliary buffer pass accumulates every second sample with twice the
+ * weight, so it holds a second estimate of the combined pass made from half
+ * the samples. The difference between both is used as per-pixel error, and
+ * once it drops below the threshold the pixel is flagged as converged in the
+ * w component of the auxiliary pass and skipped by the path tracing kernels.
+ * Since the remaining pixels received fewer samples than the tile, all
+ * accumulated passes are scaled up afterwards. */
+
+ccl_device_inline bool kernel_adaptive_pixel_converged(KernelGlobals *kg,
+                                                       ccl_global float *buffer)
+{
+	if(!kernel_data.integrator.use_adaptive_sampling ||
+	   kernel_data.film.pass_adaptive_aux_buffer == 0)
+	{
+		return false;
+	}
+	return buffer[kernel_data.film.pass_adaptive_aux_buffer + 3] != 0.0f;
+}
+
+/* Whether pixels should be checked for convergence after the given sample. */
+ccl_device_inline bool kernel_adaptive_need_check(KernelGlobals *kg, int sample)
+{
+	if(!kernel_data.integrator.use_adaptive_sampling ||
+	   kernel_data.film.pass_adaptive_aux_buffer == 0)
+	{
+		return false;
+	}
+	const int num_samples = sample + 1;
+	return num_samples >= kernel_data.integrator.adaptive_min_samples &&
+	       (num_samples % kernel_data.integrator.adaptive_step) == 0;
+}
+
+/* Flag the pixel as converged when the error between the full and the half
+ * sample estimate is small enough. The error metric follows "A hierarchical
+ * automatic stopping condition for Monte Carlo global illumination",
+ * scaled so it can be compared against the accumulated sums directly. */
+ccl_device void kernel_adaptive_stopping(KernelGlobals *kg,
+                                         ccl_global float *buffer,
+                                         int sample)
+{
+	ccl_global float *I = buffer + kernel_data.film.pass_combined;
+	ccl_global float *A = buffer + kernel_data.film.pass_adaptive_aux_buffer;
+
+	const float num_samples = (float)(sample + 1);
+	const float error = (fabsf(I[0] - A[0]) + fabsf(I[1] - A[1]) + fabsf(I[2] - A[2])) /
+	                    (num_samples * 0.0001f + sqrtf(max(I[0] + I[1] + I[2], 0.0f)));
+
+	if(error < kernel_data.integrator.adaptive_threshold * num_samples) {
+		A[3] = 1.0f;
+	}
+}
+
+/* Clear the converged flag of the neighbors of unconverged pixels, so noisy
+ * regions keep sampling with a one pixel margin. Returns true if any pixel
+ * in the row or column still needs samples. */
+ccl_device bool kernel_adaptive_filter_x(KernelGlobals *kg, ccl_global const WorkTile *tile, int y)
+{
+	const int pass_stride = kernel_data.film.pass_stride;
+	const int aux_offset = kernel_data.film.pass_adaptive_aux_buffer + 3;
+	bool any = false;
+	bool prev = false;
+
+	for(int x = (int)tile->x; x < (int)(tile->x + tile->w); x++) {
+		int index = tile->offset + x + y*tile->stride;
+		ccl_global float *flag = tile->buffer + index*pass_stride + aux_offset;
+
+		if(*flag == 0.0f) {
+			any = true;
+			if(x > (int)tile->x && !prev) {
+				*(flag - pass_stride) = 0.0f;
+			}
+			prev = true;
+		}
+		else {
+			if(prev) {
+				*flag = 0.0f;
+			}
+			prev = false;
+		}
+	}
+
+	return any;
+}
+
+ccl_device bool kernel_adaptive_filter_y(KernelGlobals *kg, ccl_global const WorkTile *tile, int x)
+{
+	const int pass_stride = kernel_data.film.pass_stride;
+	const int aux_offset = kernel_data.film.pass_adaptive_aux_buffer + 3;
+	bool any = false;
+	bool prev = false;
+
+	for(int y = (int)tile->y; y < (int)(tile->y + tile->h); y++) {
+		int index = tile->offset + x + y*tile->stride;
+		ccl_global float *flag = tile->buffer + index*pass_stride + aux_offset;
+
+		if(*flag == 0.0f) {
+			any = true;
+			if(y > (int)tile->y && !prev) {
+				*(flag - tile->stride*pass_stride) = 0.0f;
+			}
+			prev = true;
+		}
+		else {
+			if(prev) {
+				*flag = 0.0f;
+			}
+			prev = false;
+		}
+	}
+
+	return any;
+}
+
+/* Scale all accumulated passes of a pixel that stopped early, as if it had
+ * received num_samples samples. Values that are only written for the first
+ * sample and the adaptive sampling state itself are left untouched. */
+ccl_device void kernel_adaptive_post_adjust(KernelGlobals *kg,
+                                            ccl_global float *buffer,
+                                            int num_samples)
+{
+	if(kernel_data.film.pass_sample_count == 0) {
+		return;
+	}
+
+	ccl_global float *sample_count = buffer + kernel_data.film.pass_sample_count;
+	if(*sample_count == 0.0f || *sample_count == (float)num_samples) {
+		return;
+	}
+
+	const int flag = kernel_data.film.pass_flag;
+	const float depth = (flag & PASSMASK(DEPTH))? buffer[kernel_data.film.pass_depth]: 0.0f;
+	const float object_id = (flag & PASSMASK(OBJECT_ID))? buffer[kernel_data.film.pass_object_id]: 0.0f;
+	const float material_id = (flag & PASSMASK(MATERIAL_ID))? buffer[kernel_data.film.pass_material_id]: 0.0f;
+	const float converged = buffer[kernel_data.film.pass_adaptive_aux_buffer + 3];
+
+	const float scale = (float)num_samples / *sample_count;
+	for(int i = 0; i < kernel_data.film.pass_stride; i++) {
+		buffer[i] *= scale;
+	}
+
+	if(flag & PASSMASK(DEPTH)) {
+		buffer[kernel_data.film.pass_depth] = depth;
+	}
+	if(flag & PASSMASK(OBJECT_ID)) {
+		buffer[kernel_data.film.pass_object_id] = object_id;
+	}
+	if(flag & PASSMASK(MATERIAL_ID)) {
+		buffer[kernel_data.film.pass_material_id] = material_id;
+	}
+	buffer[kernel_data.film.pass_adaptive_aux_buffer + 3] = converged;
+	*sample_count = (float)num_samples;
+}
+
+CCL_NAMESPACE_END
+
+#endif  /* __KERNEL_ADAPTIVE_SAMPLING_H__ */
@@ -59,6 +59,9 @@ typedef struct KernelGlobals {
 	OSLThreadData *osl_tdata;
 #  endif
 
+	/* Image textures which are not loaded into memory. */
+	TextureCacheGlobals *texture_cache;
+
 	/* **** Run-time data ****  */
 
 	/* Heap-allocated storage for transparent shadows intersections. */
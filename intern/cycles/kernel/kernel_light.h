@@ -456,6 +456,195 @@ ccl_device float background_light_pdf(KernelGlobals *kg, float3 P, float3 direct
 }
 #endif
 
+/* Light Tree
+ *
+ * Emitters with a position are organized in a tree of spatial and
+ * orientation bounds, which is traversed from the root picking a child
+ * with probability proportional to its estimated contribution to the
+ * shading point. Distant and background lights are not part of the tree,
+ * they are picked with the same probability as in the light distribution.
+ *
+ * See Alejandro Conty Estevez and Christopher Kulla,
+ * "Importance Sampling of Many Lights with Adaptive Tree Splitting". */
+
+ccl_device float light_tree_node_importance(KernelGlobals *kg, float3 P, int node)
+{
+	const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, node);
+
+	const float3 bbox_min = make_float3(knode->bbox_min[0], knode->bbox_min[1], knode->bbox_min[2]);
+	const float3 bbox_max = make_float3(knode->bbox_max[0], knode->bbox_max[1], knode->bbox_max[2]);
+	const float3 centroid = 0.5f*(bbox_min + bbox_max);
+	const float radius = 0.5f*len(bbox_max - bbox_min);
+
+	float distance;
+	const float3 D = safe_normalize_len(P - centroid, &distance);
+
+	/* Clamp the distance to the node size, so points close to or inside
+	 * the bounds do not give a single child all the importance. */
+	const float distance_squared = max(distance*distance, max(radius*radius, 1e-8f));
+
+	if(distance <= radius) {
+		return knode->energy / distance_squared;
+	}
+
+	/* Smallest angle between the orientation bounds and the direction to
+	 * the shading point, taking the angle subtended by the bounds into
+	 * account. */
+	const float3 axis = make_float3(knode->axis[0], knode->axis[1], knode->axis[2]);
+	const float theta = fast_acosf(clamp(dot(axis, D), -1.0f, 1.0f));
+	const float theta_u = fast_asinf(radius/distance);
+	const float theta_prime = max(theta - knode->theta_o - theta_u, 0.0f);
+
+	if(theta_prime >= knode->theta_e) {
+		return 0.0f;
+	}
+
+	return knode->energy * fast_cosf(theta_prime) / distance_squared;
+}
+
+/* Pick a light tree leaf, returns its node index or -1 if no emitter can
+ * contribute to P. The random number is rescaled for reuse in the light. */
+ccl_device int light_tree_sample_leaf(KernelGlobals *kg, float3 P, float *randu, float *pmf)
+{
+	const float pdf_local = kernel_data.integrator.light_tree_pdf_local;
+	float r = *randu;
+
+	if(r >= pdf_local) {
+		/* Distant or background light. */
+		const int num_infinite = kernel_data.integrator.light_tree_num_infinite;
+		r = (r - pdf_local)/(1.0f - pdf_local) * num_infinite;
+		const int i = clamp((int)r, 0, num_infinite - 1);
+
+		*randu = r - i;
+		*pmf = kernel_data.integrator.pdf_lights;
+		return kernel_data.integrator.light_tree_num_nodes + i;
+	}
+
+	r /= pdf_local;
+	float node_pmf = pdf_local;
+	int node = 0;
+
+	while(kernel_tex_fetch(__light_tree_nodes, node).distribution_index < 0) {
+		const int left = node + 1;
+		const int right = kernel_tex_fetch(__light_tree_nodes, node).right_child;
+		const float importance_left = light_tree_node_importance(kg, P, left);
+		const float importance_right = light_tree_node_importance(kg, P, right);
+		const float importance_total = importance_left + importance_right;
+
+		if(importance_total == 0.0f) {
+			return -1;
+		}
+
+		const float probability_left = importance_left / importance_total;
+		if(r < probability_left) {
+			node = left;
+			r = r / probability_left;
+			node_pmf *= probability_left;
+		}
+		else {
+			node = right;
+			r = (r - probability_left) / (1.0f - probability_left);
+			node_pmf *= importance_right / importance_total;
+		}
+	}
+
+	*randu = min(r, 1.0f);
+	*pmf = node_pmf;
+	return node;
+}
+
+/* Probability of light_tree_sample_leaf() picking the given leaf. */
+ccl_device float light_tree_leaf_pmf(KernelGlobals *kg, float3 P, int leaf)
+{
+	if(leaf < 0) {
+		return 0.0f;
+	}
+	if(leaf >= kernel_data.integrator.light_tree_num_nodes) {
+		return kernel_data.integrator.pdf_lights;
+	}
+
+	float pmf = kernel_data.integrator.light_tree_pdf_local;
+	int node = leaf;
+
+	while(node != 0) {
+		const int parent = kernel_tex_fetch(__light_tree_nodes, node).parent;
+		const int left = parent + 1;
+		const int right = kernel_tex_fetch(__light_tree_nodes, parent).right_child;
+		const float importance_left = light_tree_node_importance(kg, P, left);
+		const float importance_right = light_tree_node_importance(kg, P, right);
+		const float importance_total = importance_left + importance_right;
+
+		if(importance_total == 0.0f) {
+			return 0.0f;
+		}
+
+		pmf *= ((node == left)? importance_left: importance_right) / importance_total;
+		node = parent;
+	}
+
+	return pmf;
+}
+
+/* Find the light distribution index of a mesh light triangle. Triangles
+ * come first in the distribution, sorted by object and primitive. */
+ccl_device int light_distribution_find_triangle(KernelGlobals *kg, int object, int prim)
+{
+	int first = 0;
+	int len = kernel_data.integrator.num_distribution - kernel_data.integrator.num_all_lights;
+
+	while(len > 0) {
+		int half_len = len >> 1;
+		int middle = first + half_len;
+		const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(__light_distribution, middle);
+		int middle_object = kdistribution->mesh_light.object_id;
+
+		if(middle_object < object || (middle_object == object && kdistribution->prim < prim)) {
+			first = middle + 1;
+			len = len - half_len - 1;
+		}
+		else {
+			len = half_len;
+		}
+	}
+
+	if(first < kernel_data.integrator.num_distribution - kernel_data.integrator.num_all_lights) {
+		const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(__light_distribution, first);
+		if(kdistribution->mesh_light.object_id == object && kdistribution->prim == prim) {
+			return first;
+		}
+	}
+
+	return -1;
+}
+
+/* Probability of picking a lamp from point P. */
+ccl_device float lamp_light_select_pdf(KernelGlobals *kg, int lamp, float3 P)
+{
+	if(kernel_data.integrator.use_light_tree) {
+		const int index = kernel_data.integrator.num_distribution - kernel_data.integrator.num_all_lights + lamp;
+		return light_tree_leaf_pmf(kg, P, kernel_tex_fetch(__light_tree_leaf, index));
+	}
+	return kernel_data.integrator.pdf_lights;
+}
+
+/* Probability of picking a mesh light triangle from point P, divided by
+ * the triangle area. */
+ccl_device float triangle_light_select_pdf(KernelGlobals *kg, int object, int prim, float3 P)
+{
+	if(kernel_data.integrator.use_light_tree) {
+		const int index = light_distribution_find_triangle(kg, object, prim);
+		if(index < 0) {
+			return 0.0f;
+		}
+		const int leaf = kernel_tex_fetch(__light_tree_leaf, index);
+		if(leaf < 0) {
+			return 0.0f;
+		}
+		return light_tree_leaf_pmf(kg, P, leaf) / kernel_tex_fetch(__light_tree_nodes, leaf).energy;
+	}
+	return kernel_data.integrator.pdf_triangles;
+}
+
 /* Regular Light */
 
 ccl_device float3 disk_light_sample(float3 v, float randu, float randv)
@@ -768,7 +957,7 @@ ccl_device bool lamp_light_eval(KernelGlobals *kg, int lamp, float3 P, float3 D,
 		return false;
 	}
 
-	ls->pdf *= kernel_data.integrator.pdf_lights;
+	ls->pdf *= lamp_light_select_pdf(kg, lamp, P);
 
 	return true;
 }
@@ -806,9 +995,13 @@ ccl_device_inline bool triangle_world_space_vertices(KernelGlobals *kg, int obje
 	return has_motion;
 }
 
-ccl_device_inline float triangle_light_pdf_area(KernelGlobals *kg, const float3 Ng, const float3 I, float t)
+ccl_device_inline float triangle_light_pdf_area(KernelGlobals *kg,
+                                                float pdf_triangles,
+                                                const float3 Ng,
+                                                const float3 I,
+                                                float t)
 {
-	float pdf = kernel_data.integrator.pdf_triangles;
+	float pdf = pdf_triangles;
 	float cos_pi = fabsf(dot(Ng, I));
 
 	if(cos_pi == 0.0f)
@@ -833,10 +1026,12 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
 	const float3 N = cross(e0, e1);
 	const float distance_to_plane = fabsf(dot(N, sd->I * t))/dot(N, N);
 
+	/* sd contains the point on the light source
+	 * calculate Px, the point that we're shading */
+	const float3 Px = sd->P + sd->I * t;
+	const float pdf_triangles = triangle_light_select_pdf(kg, sd->object, sd->prim, Px);
+
 	if(longest_edge_squared > distance_to_plane*distance_to_plane) {
-		/* sd contains the point on the light source
-		 * calculate Px, the point that we're shading */
-		const float3 Px = sd->P + sd->I * t;
 		const float3 v0_p = V[0] - Px;
 		const float3 v1_p = V[1] - Px;
 		const float3 v2_p = V[2] - Px;
@@ -864,12 +1059,12 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
 			else {
 				area = 0.5f * len(N);
 			}
-			const float pdf = area * kernel_data.integrator.pdf_triangles;
+			const float pdf = area * pdf_triangles;
 			return pdf / solid_angle;
 		}
 	}
 	else {
-		float pdf = triangle_light_pdf_area(kg, sd->Ng, sd->I, t);
+		float pdf = triangle_light_pdf_area(kg, pdf_triangles, sd->Ng, sd->I, t);
 		if(has_motion) {
 			const float	area = 0.5f * len(N);
 			if(UNLIKELY(area == 0.0f)) {
@@ -887,7 +1082,7 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
 }
 
 ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg, int prim, int object,
-	float randu, float randv, float time, LightSample *ls, const float3 P)
+	float randu, float randv, float time, LightSample *ls, const float3 P, float pdf_triangles)
 {
 	/* A naive heuristic to decide between costly solid angle sampling
 	 * and simple area sampling, comparing the distance to the triangle plane
@@ -1005,7 +1200,7 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg, int prim, i
 				triangle_world_space_vertices(kg, object, prim, -1.0f, V);
 				area = triangle_area(V[0], V[1], V[2]);
 			}
-			const float pdf = area * kernel_data.integrator.pdf_triangles;
+			const float pdf = area * pdf_triangles;
 			ls->pdf = pdf / solid_angle;
 		}
 	}
@@ -1019,7 +1214,7 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg, int prim, i
 		ls->P = u * V[0] + v * V[1] + t * V[2];
 		/* compute incoming direction, distance and pdf */
 		ls->D = normalize_len(ls->P - P, &ls->t);
-		ls->pdf = triangle_light_pdf_area(kg, ls->Ng, -ls->D, ls->t);
+		ls->pdf = triangle_light_pdf_area(kg, pdf_triangles, ls->Ng, -ls->D, ls->t);
 		if(has_motion && area != 0.0f) {
 			/* scale the PDF.
 			 * area = the area the sample was taken from
@@ -1087,7 +1282,25 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
                                       LightSample *ls)
 {
 	/* sample index */
-	int index = light_distribution_sample(kg, &randu);
+	int index;
+	float pdf_triangles = kernel_data.integrator.pdf_triangles;
+	float pdf_lamp = kernel_data.integrator.pdf_lights;
+
+	if(kernel_data.integrator.use_light_tree) {
+		float pmf;
+		int leaf = light_tree_sample_leaf(kg, P, &randu, &pmf);
+		if(leaf < 0) {
+			return false;
+		}
+
+		const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, leaf);
+		index = knode->distribution_index;
+		pdf_triangles = pmf / knode->energy;
+		pdf_lamp = pmf;
+	}
+	else {
+		index = light_distribution_sample(kg, &randu);
+	}
 
 	/* fetch light data */
 	const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(__light_distribution, index);
@@ -1097,7 +1310,7 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
 		int object = kdistribution->mesh_light.object_id;
 		int shader_flag = kdistribution->mesh_light.shader_flag;
 
-		triangle_light_sample(kg, prim, object, randu, randv, time, ls, P);
+		triangle_light_sample(kg, prim, object, randu, randv, time, ls, P, pdf_triangles);
 		ls->shader |= shader_flag;
 		return (ls->pdf > 0.0f);
 	}
@@ -1108,7 +1321,16 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
 			return false;
 		}
 
-		return lamp_light_sample(kg, lamp, randu, randv, P, ls);
+		if(!lamp_light_sample(kg, lamp, randu, randv, P, ls)) {
+			return false;
+		}
+
+		/* lamp_light_sample assumes the light distribution was used. */
+		if(pdf_lamp != kernel_data.integrator.pdf_lights) {
+			ls->pdf *= pdf_lamp / kernel_data.integrator.pdf_lights;
+		}
+
+		return (ls->pdf > 0.0f);
 	}
 }
 
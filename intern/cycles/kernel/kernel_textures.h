@@ -61,6 +61,8 @@ KERNEL_TEX(uchar4, __attributes_uchar4)
 
 /* lights */
 KERNEL_TEX(KernelLightDistribution, __light_distribution)
+KERNEL_TEX(KernelLightTreeNode, __light_tree_nodes)
+KERNEL_TEX(int, __light_tree_leaf)
 KERNEL_TEX(KernelLight, __lights)
 KERNEL_TEX(float2, __light_background_marginal_cdf)
 KERNEL_TEX(float2, __light_background_conditional_cdf)
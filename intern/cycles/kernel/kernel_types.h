@@ -82,6 +82,9 @@ CCL_NAMESPACE_BEGIN
 #  ifdef __KERNEL_SSE2__
 #    define __QBVH__
 #  endif
+#  ifdef __KERNEL_AVX2__
+#    define __OBVH__
+#  endif
 #  define __KERNEL_SHADING__
 #  define __KERNEL_ADV_SHADING__
 #  define __BRANCHED_PATH__
@@ -200,6 +203,22 @@ CCL_NAMESPACE_BEGIN
 #  define __BAKING__
 #endif
 
+/* CPU kernels specialized for scenes that only use basic features, must
+ * match DeviceRequestedFeatures::use_basic_features(). */
+#ifdef __KERNEL_BASIC_FEATURES__
+#  define __NO_CAMERA_MOTION__
+#  define __NO_OBJECT_MOTION__
+#  define __NO_HAIR__
+#  define __NO_VOLUME__
+#  define __NO_SUBSURFACE__
+#  define __NO_BAKING__
+#  define __NO_BRANCHED_PATH__
+#  define __NO_PATCH_EVAL__
+#  define __NO_SHADOW_TRICKS__
+#  define __NO_DENOISING__
+#  define __NO_SHADER_RAYTRACE__
+#endif
+
 /* Scene-based selective features compilation. */
 #ifdef __NO_CAMERA_MOTION__
 #  undef __CAMERA_MOTION__
@@ -415,6 +434,8 @@ typedef enum PassType {
 	PASS_RAY_BOUNCES,
 #endif
 	PASS_RENDER_TIME,
+	PASS_ADAPTIVE_AUX_BUFFER,
+	PASS_SAMPLE_COUNT,
 	PASS_CATEGORY_MAIN_END = 31,
 
 	PASS_MIST = 32,
@@ -1272,7 +1293,9 @@ typedef struct KernelFilm {
 	int pass_denoising_clean;
 	int denoising_flags;
 
-	int pad1, pad2, pad3;
+	int pass_adaptive_aux_buffer;
+	int pass_sample_count;
+	int pad1;
 
 #ifdef __KERNEL_DEBUG__
 	int pass_bvh_traversed_nodes;
@@ -1314,6 +1337,12 @@ typedef struct KernelIntegrator {
 	int num_portals;
 	int portal_offset;
 
+	/* light tree */
+	int use_light_tree;
+	int light_tree_num_nodes;
+	int light_tree_num_infinite;
+	float light_tree_pdf_local;
+
 	/* bounces */
 	int max_bounce;
 
@@ -1368,6 +1397,12 @@ typedef struct KernelIntegrator {
 	int start_sample;
 
 	int max_closures;
+
+	/* adaptive sampling */
+	int use_adaptive_sampling;
+	int adaptive_min_samples;
+	int adaptive_step;
+	float adaptive_threshold;
 } KernelIntegrator;
 static_assert_align(KernelIntegrator, 16);
 
@@ -1376,8 +1411,9 @@ typedef enum KernelBVHLayout {
 
 	BVH_LAYOUT_BVH2 = (1 << 0),
 	BVH_LAYOUT_BVH4 = (1 << 1),
+	BVH_LAYOUT_BVH8 = (1 << 2),
 
-	BVH_LAYOUT_DEFAULT = BVH_LAYOUT_BVH4,
+	BVH_LAYOUT_DEFAULT = BVH_LAYOUT_BVH8,
 	BVH_LAYOUT_ALL = (unsigned int)(-1),
 } KernelBVHLayout;
 
@@ -1515,6 +1551,27 @@ typedef struct KernelLightDistribution {
 } KernelLightDistribution;
 static_assert_align(KernelLightDistribution, 16);
 
+typedef struct KernelLightTreeNode {
+	/* Spatial bounds and summed emitter weight of the subtree. */
+	float bbox_min[3];
+	float energy;
+	float bbox_max[3];
+
+	/* Orientation bounds, the emitter normals lie within theta_o of the
+	 * axis and each emitter spreads light over theta_e around its normal. */
+	float theta_o;
+	float axis[3];
+	float theta_e;
+
+	/* Inner nodes have their first child right after them and store the
+	 * second one, leaves store an index into the light distribution. */
+	int right_child;
+	int distribution_index;
+	int parent;
+	int pad;
+} KernelLightTreeNode;
+static_assert_align(KernelLightTreeNode, 16);
+
 typedef struct KernelParticle {
 	int index;
 	float age;
@@ -19,7 +19,8 @@
 
 CCL_NAMESPACE_BEGIN
 
-template<typename T> struct TextureInterpolator  {
+/* Sparse textures only differ in how voxels are read for 3D interpolation. */
+template<typename T, bool sparse = false> struct TextureInterpolator  {
 #define SET_CUBIC_SPLINE_WEIGHTS(u, t) \
 	{ \
 		u[0] = (((-1.0f/6.0f)* t + 0.5f) * t - 0.5f) * t + (1.0f/6.0f); \
@@ -73,6 +74,25 @@ template<typename T> struct TextureInterpolator  {
 		return read(data[y * width + x]);
 	}
 
+	static ccl_always_inline float4 read_voxel(const TextureInfo& info,
+	                                           int x, int y, int z)
+	{
+		const T *data = (const T*)info.data;
+		if(sparse) {
+			const int tiles_x = (info.width + TEX_SPARSE_TILE_MASK) >> TEX_SPARSE_TILE_SHIFT;
+			const int tiles_y = (info.height + TEX_SPARSE_TILE_MASK) >> TEX_SPARSE_TILE_SHIFT;
+			const int tile = (x >> TEX_SPARSE_TILE_SHIFT) +
+			                 tiles_x * ((y >> TEX_SPARSE_TILE_SHIFT) +
+			                            tiles_y * (z >> TEX_SPARSE_TILE_SHIFT));
+			const int *tile_offsets = (const int*)info.data;
+			const T *tile_data = data + (size_t)tile_offsets[tile] * TEX_SPARSE_TILE_VOXELS;
+			return read(tile_data[(x & TEX_SPARSE_TILE_MASK) +
+			                      ((y & TEX_SPARSE_TILE_MASK) << TEX_SPARSE_TILE_SHIFT) +
+			                      ((z & TEX_SPARSE_TILE_MASK) << (2 * TEX_SPARSE_TILE_SHIFT))]);
+		}
+		return read(data[x + y*info.width + z*info.width*info.height]);
+	}
+
 	static ccl_always_inline int wrap_periodic(int x, int width)
 	{
 		x %= width;
@@ -279,8 +299,7 @@ template<typename T> struct TextureInterpolator  {
 				return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
 		}
 
-		const T *data = (const T*)info.data;
-		return read(data[ix + iy*width + iz*width*height]);
+		return read_voxel(info, ix, iy, iz);
 	}
 
 	static ccl_always_inline float4 interp_3d_linear(const TextureInfo& info,
@@ -327,18 +346,17 @@ template<typename T> struct TextureInterpolator  {
 				return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
 		}
 
-		const T *data = (const T*)info.data;
 		float4 r;
 
-		r  = (1.0f - tz)*(1.0f - ty)*(1.0f - tx)*read(data[ix + iy*width + iz*width*height]);
-		r += (1.0f - tz)*(1.0f - ty)*tx*read(data[nix + iy*width + iz*width*height]);
-		r += (1.0f - tz)*ty*(1.0f - tx)*read(data[ix + niy*width + iz*width*height]);
-		r += (1.0f - tz)*ty*tx*read(data[nix + niy*width + iz*width*height]);
+		r  = (1.0f - tz)*(1.0f - ty)*(1.0f - tx)*read_voxel(info, ix, iy, iz);
+		r += (1.0f - tz)*(1.0f - ty)*tx*read_voxel(info, nix, iy, iz);
+		r += (1.0f - tz)*ty*(1.0f - tx)*read_voxel(info, ix, niy, iz);
+		r += (1.0f - tz)*ty*tx*read_voxel(info, nix, niy, iz);
 
-		r += tz*(1.0f - ty)*(1.0f - tx)*read(data[ix + iy*width + niz*width*height]);
-		r += tz*(1.0f - ty)*tx*read(data[nix + iy*width + niz*width*height]);
-		r += tz*ty*(1.0f - tx)*read(data[ix + niy*width + niz*width*height]);
-		r += tz*ty*tx*read(data[nix + niy*width + niz*width*height]);
+		r += tz*(1.0f - ty)*(1.0f - tx)*read_voxel(info, ix, iy, niz);
+		r += tz*(1.0f - ty)*tx*read_voxel(info, nix, iy, niz);
+		r += tz*ty*(1.0f - tx)*read_voxel(info, ix, niy, niz);
+		r += tz*ty*tx*read_voxel(info, nix, niy, niz);
 
 		return r;
 	}
@@ -415,20 +433,14 @@ template<typename T> struct TextureInterpolator  {
 		}
 
 		const int xc[4] = {pix, ix, nix, nnix};
-		const int yc[4] = {width * piy,
-		                   width * iy,
-		                   width * niy,
-		                   width * nniy};
-		const int zc[4] = {width * height * piz,
-		                   width * height * iz,
-		                   width * height * niz,
-		                   width * height * nniz};
+		const int yc[4] = {piy, iy, niy, nniy};
+		const int zc[4] = {piz, iz, niz, nniz};
 		float u[4], v[4], w[4];
 
 		/* Some helper macro to keep code reasonable size,
 		 * let compiler to inline all the matrix multiplications.
 		 */
-#define DATA(x, y, z) (read(data[xc[x] + yc[y] + zc[z]]))
+#define DATA(x, y, z) (read_voxel(info, xc[x], yc[y], zc[z]))
 #define COL_TERM(col, row) \
 		(v[col] * (u[0] * DATA(0, col, row) + \
 		           u[1] * DATA(1, col, row) + \
@@ -445,7 +457,6 @@ template<typename T> struct TextureInterpolator  {
 		SET_CUBIC_SPLINE_WEIGHTS(w, tz);
 
 		/* Actual interpolation. */
-		const T *data = (const T*)info.data;
 		return ROW_TERM(0) + ROW_TERM(1) + ROW_TERM(2) + ROW_TERM(3);
 
 #undef COL_TERM
@@ -487,12 +498,37 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
 			return TextureInterpolator<half4>::interp(info, x, y);
 		case IMAGE_DATA_TYPE_BYTE4:
 			return TextureInterpolator<uchar4>::interp(info, x, y);
+		case IMAGE_DATA_TYPE_FLOAT4_SPARSE:
+		case IMAGE_DATA_TYPE_FLOAT_SPARSE:
+			/* Only used for volumes. */
+			return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
 		case IMAGE_DATA_TYPE_FLOAT4:
 		default:
 			return TextureInterpolator<float4>::interp(info, x, y);
 	}
 }
 
+/* Lookup filtered over the footprint given by the texture coordinate
+ * differentials, used to pick the mip level of cached textures. */
+ccl_device float4 kernel_tex_image_interp_filtered(KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy)
+{
+	if(kg->texture_cache != NULL && kg->texture_cache->lookup != NULL) {
+		float4 r;
+		/* Cached images are stored top to bottom. */
+		if(kg->texture_cache->lookup(kg->texture_cache->data,
+		                             id,
+		                             x, 1.0f - y,
+		                             dx.x, -dx.y,
+		                             dy.x, -dy.y,
+		                             &r))
+		{
+			return r;
+		}
+	}
+
+	return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg, int id, float x, float y, float z, InterpolationType interp)
 {
 	const TextureInfo& info = kernel_tex_fetch(__texture_info, id);
@@ -508,6 +544,10 @@ ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg, int id, float x,
 			return TextureInterpolator<half4>::interp_3d(info, x, y, z, interp);
 		case IMAGE_DATA_TYPE_BYTE4:
 			return TextureInterpolator<uchar4>::interp_3d(info, x, y, z, interp);
+		case IMAGE_DATA_TYPE_FLOAT4_SPARSE:
+			return TextureInterpolator<float4, true>::interp_3d(info, x, y, z, interp);
+		case IMAGE_DATA_TYPE_FLOAT_SPARSE:
+			return TextureInterpolator<float, true>::interp_3d(info, x, y, z, interp);
 		case IMAGE_DATA_TYPE_FLOAT4:
 		default:
 			return TextureInterpolator<float4>::interp_3d(info, x, y, z, interp);
@@ -16,6 +16,44 @@
 
 CCL_NAMESPACE_BEGIN
 
+#ifdef __KERNEL_CPU__
+/* Stable counting sort of the active ray queue by ray direction octant, so
+ * consecutive intersections traverse the BVH in the same order and touch the
+ * same nodes. The shader sorted queue is not in use until shader setup and
+ * serves as scratch memory. */
+ccl_device void kernel_scene_intersect_sort_queue(KernelGlobals *kg)
+{
+	const int queue_size = kernel_split_params.queue_size;
+	const int num_rays = kernel_split_params.queue_index[QUEUE_ACTIVE_AND_REGENERATED_RAYS];
+	ccl_global int *queue = kernel_split_state.queue_data + QUEUE_ACTIVE_AND_REGENERATED_RAYS*queue_size;
+	ccl_global int *sorted = kernel_split_state.queue_data + QUEUE_SHADER_SORTED_RAYS*queue_size;
+
+	/* Eight octants, and empty slots last. */
+	int offset[10] = {0};
+
+	for(int i = 0; i < num_rays; i++) {
+		int ray_index = queue[i];
+		uint bucket = (ray_index == QUEUE_EMPTY_SLOT)? 8: kernel_split_ray_octant(&kernel_split_state.ray[ray_index]);
+		offset[bucket + 1]++;
+	}
+
+	for(int i = 1; i < 10; i++) {
+		offset[i] += offset[i - 1];
+	}
+
+	for(int i = 0; i < num_rays; i++) {
+		int ray_index = queue[i];
+		uint bucket = (ray_index == QUEUE_EMPTY_SLOT)? 8: kernel_split_ray_octant(&kernel_split_state.ray[ray_index]);
+		sorted[offset[bucket]++] = ray_index;
+	}
+
+	for(int i = 0; i < num_rays; i++) {
+		queue[i] = sorted[i];
+		sorted[i] = QUEUE_EMPTY_SLOT;
+	}
+}
+#endif  /* __KERNEL_CPU__ */
+
 /* This kernel takes care of scene_intersect function.
  *
  * This kernel changes the ray_state of RAY_REGENERATED rays to RAY_ACTIVE.
@@ -31,6 +69,14 @@ ccl_device void kernel_scene_intersect(KernelGlobals *kg)
 
 	int ray_index = ccl_global_id(1) * ccl_global_size(0) + ccl_global_id(0);
 	if(local_use_queues_flag) {
+#ifdef __KERNEL_CPU__
+		/* Work items are executed in order on the CPU, so the first one can
+		 * sort the queue for all others. */
+		if(ray_index == 0) {
+			kernel_scene_intersect_sort_queue(kg);
+		}
+#endif
+
 		ray_index = get_ray_index(kg, ray_index,
 		                          QUEUE_ACTIVE_AND_REGENERATED_RAYS,
 		                          kernel_split_state.queue_data,
@@ -16,6 +16,35 @@
 
 CCL_NAMESPACE_BEGIN
 
+#ifdef __KERNEL_CPU__
+/* Stable radix sort of the local indices by value. There is only a single
+ * work item per block on the CPU, which sorts the entire block. */
+ccl_device void kernel_shader_sort_block_cpu(ccl_local_param ShaderSortLocals *locals)
+{
+	ccl_local uint *value = &locals->local_value[0];
+	ccl_local ushort *index = &locals->local_index[0];
+	ccl_local ushort *scratch = &locals->local_index_scratch[0];
+
+	for(uint shift = 0; shift < 32; shift += 8) {
+		uint offset[257] = {0};
+
+		for(uint i = 0; i < SHADER_SORT_BLOCK_SIZE; i++) {
+			offset[((value[index[i]] >> shift) & 0xff) + 1]++;
+		}
+		for(uint i = 1; i < 257; i++) {
+			offset[i] += offset[i - 1];
+		}
+		for(uint i = 0; i < SHADER_SORT_BLOCK_SIZE; i++) {
+			scratch[offset[(value[index[i]] >> shift) & 0xff]++] = index[i];
+		}
+
+		/* Even number of passes, so the result ends up in local_index. */
+		ccl_local ushort *tmp = index;
+		index = scratch;
+		scratch = tmp;
+	}
+}
+#endif  /* __KERNEL_CPU__ */
 
 ccl_device void kernel_shader_sort(KernelGlobals *kg,
                                    ccl_local_param ShaderSortLocals *locals)
@@ -48,6 +77,11 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg,
 			bool valid = (ray_index != QUEUE_EMPTY_SLOT) && IS_STATE(kernel_split_state.ray_state, ray_index, RAY_ACTIVE);
 			if(valid) {
 				value = kernel_split_sd(sd, ray_index)->shader & SHADER_MASK;
+#  ifdef __KERNEL_CPU__
+				/* Batches are large enough on the CPU to also group rays
+				 * of the same shader by direction. */
+				value = (value << 3) | kernel_split_ray_octant(&kernel_split_state.ray[ray_index]);
+#  endif
 			}
 		}
 		local_value[i + lid] = value;
@@ -55,8 +89,9 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg,
 	}
 	ccl_barrier(CCL_LOCAL_MEM_FENCE);
 
-	/* skip sorting for cpu split kernel */
-#  ifdef __KERNEL_OPENCL__
+#  if defined(__KERNEL_CPU__)
+	kernel_shader_sort_block_cpu(locals);
+#  elif defined(__KERNEL_OPENCL__)
 
 	/* bitonic sort */
 	for(uint length = 1; length < SHADER_SORT_BLOCK_SIZE; length <<= 1) {
@@ -78,7 +113,7 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg,
 			}
 		}
 	}
-#  endif /* __KERNEL_OPENCL__ */
+#  endif /* __KERNEL_CPU__ */
 
 	/* copy to destination */
 	for(uint i = 0; i < SHADER_SORT_BLOCK_SIZE; i += SHADER_SORT_LOCAL_SIZE) {
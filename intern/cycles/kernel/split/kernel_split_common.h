@@ -94,6 +94,15 @@ ccl_device_inline void kernel_split_path_end(KernelGlobals *kg, int ray_index)
 #endif
 }
 
+/* Octant of the ray direction, used to group rays that traverse the BVH in
+ * the same order. */
+ccl_device_inline uint kernel_split_ray_octant(ccl_global const Ray *ray)
+{
+	return ((ray->D.x < 0.0f)? 1: 0) |
+	       ((ray->D.y < 0.0f)? 2: 0) |
+	       ((ray->D.z < 0.0f)? 4: 0);
+}
+
 CCL_NAMESPACE_END
 
 #endif  /* __KERNEL_SPLIT_H__ */
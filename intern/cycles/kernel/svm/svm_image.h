@@ -16,9 +16,9 @@
 
 CCL_NAMESPACE_BEGIN
 
-ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, uint srgb, uint use_alpha)
+ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy, uint srgb, uint use_alpha)
 {
-	float4 r = kernel_tex_image_interp(kg, id, x, y);
+	float4 r = kernel_tex_image_interp_filtered(kg, id, x, y, dx, dy);
 	const float alpha = r.w;
 
 	if(use_alpha && alpha != 1.0f && alpha != 0.0f) {
@@ -45,28 +45,48 @@ ccl_device_inline float3 texco_remap_square(float3 co)
 	return (co - make_float3(0.5f, 0.5f, 0.5f)) * 2.0f;
 }
 
+ccl_device float2 svm_image_texture_project(float3 co, uint projection)
+{
+	if(projection == NODE_IMAGE_PROJ_SPHERE) {
+		return map_to_sphere(texco_remap_square(co));
+	}
+	else if(projection == NODE_IMAGE_PROJ_TUBE) {
+		return map_to_tube(texco_remap_square(co));
+	}
+	else {
+		return make_float2(co.x, co.y);
+	}
+}
+
 ccl_device void svm_node_tex_image(KernelGlobals *kg, ShaderData *sd, float *stack, uint4 node)
 {
 	uint id = node.y;
 	uint co_offset, out_offset, alpha_offset, srgb;
+	uint projection, co_dx_offset, co_dy_offset, unused;
 
 	decode_node_uchar4(node.z, &co_offset, &out_offset, &alpha_offset, &srgb);
+	decode_node_uchar4(node.w, &projection, &co_dx_offset, &co_dy_offset, &unused);
 
 	float3 co = stack_load_float3(stack, co_offset);
-	float2 tex_co;
+	float2 tex_co = svm_image_texture_project(co, projection);
 	uint use_alpha = stack_valid(alpha_offset);
-	if(node.w == NODE_IMAGE_PROJ_SPHERE) {
-		co = texco_remap_square(co);
-		tex_co = map_to_sphere(co);
-	}
-	else if(node.w == NODE_IMAGE_PROJ_TUBE) {
-		co = texco_remap_square(co);
-		tex_co = map_to_tube(co);
-	}
-	else {
-		tex_co = make_float2(co.x, co.y);
+
+	/* Texture coordinates shifted by the ray differentials, only available
+	 * when the image is sampled through the texture cache. */
+	float2 dx = make_float2(0.0f, 0.0f);
+	float2 dy = make_float2(0.0f, 0.0f);
+	if(stack_valid(co_dx_offset) && stack_valid(co_dy_offset)) {
+		dx = svm_image_texture_project(stack_load_float3(stack, co_dx_offset), projection) - tex_co;
+		dy = svm_image_texture_project(stack_load_float3(stack, co_dy_offset), projection) - tex_co;
+
+		if(projection != NODE_IMAGE_PROJ_FLAT) {
+			/* Don't blur across the seam of the projection. */
+			dx.x -= floorf(dx.x + 0.5f);
+			dy.x -= floorf(dy.x + 0.5f);
+		}
 	}
-	float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, srgb, use_alpha);
+
+	float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, dx, dy, srgb, use_alpha);
 
 	if(stack_valid(out_offset))
 		stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
@@ -152,20 +172,21 @@ ccl_device void svm_node_tex_image_box(KernelGlobals *kg, ShaderData *sd, float
 	uint id = node.y;
 
 	float4 f = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+	float2 zero = make_float2(0.0f, 0.0f);
 	uint use_alpha = stack_valid(alpha_offset);
 
 	/* Map so that no textures are flipped, rotation is somewhat arbitrary. */
 	if(weight.x > 0.0f) {
 		float2 uv = make_float2((signed_N.x < 0.0f)? 1.0f - co.y: co.y, co.z);
-		f += weight.x*svm_image_texture(kg, id, uv.x, uv.y, srgb, use_alpha);
+		f += weight.x*svm_image_texture(kg, id, uv.x, uv.y, zero, zero, srgb, use_alpha);
 	}
 	if(weight.y > 0.0f) {
 		float2 uv = make_float2((signed_N.y > 0.0f)? 1.0f - co.x: co.x, co.z);
-		f += weight.y*svm_image_texture(kg, id, uv.x, uv.y, srgb, use_alpha);
+		f += weight.y*svm_image_texture(kg, id, uv.x, uv.y, zero, zero, srgb, use_alpha);
 	}
 	if(weight.z > 0.0f) {
 		float2 uv = make_float2((signed_N.z > 0.0f)? 1.0f - co.y: co.y, co.x);
-		f += weight.z*svm_image_texture(kg, id, uv.x, uv.y, srgb, use_alpha);
+		f += weight.z*svm_image_texture(kg, id, uv.x, uv.y, zero, zero, srgb, use_alpha);
 	}
 
 	if(stack_valid(out_offset))
@@ -193,7 +214,8 @@ ccl_device void svm_node_tex_environment(KernelGlobals *kg, ShaderData *sd, floa
 		uv = direction_to_mirrorball(co);
 
 	uint use_alpha = stack_valid(alpha_offset);
-	float4 f = svm_image_texture(kg, id, uv.x, uv.y, srgb, use_alpha);
+	float2 zero = make_float2(0.0f, 0.0f);
+	float4 f = svm_image_texture(kg, id, uv.x, uv.y, zero, zero, srgb, use_alpha);
 
 	if(stack_valid(out_offset))
 		stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
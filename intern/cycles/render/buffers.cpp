@@ -105,6 +105,8 @@ RenderTile::RenderTile()
 	offset = 0;
 	stride = 0;
 
+	start_time = 0.0;
+
 	buffer = 0;
 
 	buffers = NULL;
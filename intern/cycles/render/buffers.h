@@ -136,6 +136,9 @@ public:
 	int stride;
 	int tile_index;
 
+	/* Time the tile was acquired, for render statistics. */
+	double start_time;
+
 	device_ptr buffer;
 
 	RenderBuffers *buffers;
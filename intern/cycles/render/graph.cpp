@@ -304,6 +304,9 @@ void ShaderGraph::simplify(Scene *scene)
 		default_inputs(scene->shader_manager->use_osl());
 		clean(scene);
 		refine_bump_nodes();
+		if(scene->image_manager->use_texture_cache(scene)) {
+			refine_image_differentials();
+		}
 
 		simplified = true;
 	}
@@ -869,6 +872,58 @@ void ShaderGraph::refine_bump_nodes()
 	}
 }
 
+void ShaderGraph::refine_image_differentials()
+{
+	/* image textures sampled through the texture cache filter over the ray
+	 * footprint. like for bump nodes, we copy the sub-graph defined by the
+	 * "Vector" input twice with texture coordinates shifted by dx/dy, and the
+	 * difference with the center gives the texture coordinate differentials. */
+
+	foreach(ShaderNode *node, nodes) {
+		if(node->special_type != SHADER_SPECIAL_TYPE_IMAGE_SLOT ||
+		   node->bump != SHADER_BUMP_NONE)
+		{
+			continue;
+		}
+
+		ShaderInput *vector_in = node->input("Vector");
+		ShaderInput *vector_dx_in = node->input("Vector DX");
+		ShaderInput *vector_dy_in = node->input("Vector DY");
+
+		if(!vector_dx_in || !vector_in->link) {
+			continue;
+		}
+
+		ImageTextureNode *image_node = (ImageTextureNode*)node;
+		if(image_node->builtin_data || image_node->projection == NODE_IMAGE_PROJ_BOX) {
+			continue;
+		}
+
+		ShaderNodeSet nodes_vector;
+		ShaderNodeMap nodes_dx;
+		ShaderNodeMap nodes_dy;
+
+		find_dependencies(nodes_vector, vector_in);
+
+		copy_nodes(nodes_vector, nodes_dx);
+		copy_nodes(nodes_vector, nodes_dy);
+
+		foreach(NodePair& pair, nodes_dx)
+			pair.second->bump = SHADER_BUMP_DX;
+		foreach(NodePair& pair, nodes_dy)
+			pair.second->bump = SHADER_BUMP_DY;
+
+		ShaderOutput *out = vector_in->link;
+		connect(nodes_dx[out->parent]->output(out->name()), vector_dx_in);
+		connect(nodes_dy[out->parent]->output(out->name()), vector_dy_in);
+
+		foreach(NodePair& pair, nodes_dx)
+			add(pair.second);
+		foreach(NodePair& pair, nodes_dy)
+			add(pair.second);
+	}
+}
+
 void ShaderGraph::bump_from_displacement(bool use_object_space)
 {
 	/* generate bump mapping automatically from displacement. bump mapping is
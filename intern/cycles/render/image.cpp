@@ -17,6 +17,7 @@
 #include "device/device.h"
 #include "render/image.h"
 #include "render/scene.h"
+#include "render/shader.h"
 
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
@@ -24,6 +25,9 @@
 #include "util/util_progress.h"
 #include "util/util_texture.h"
 
+#include <OpenImageIO/imagebufalgo.h>
+#include <OpenImageIO/texture.h>
+
 #ifdef WITH_OSL
 #include <OSL/oslexec.h>
 #endif
@@ -44,11 +48,13 @@ ImageManager::ImageManager(const DeviceInfo& info)
 {
 	need_update = true;
 	osl_texture_system = NULL;
+	texture_cache = NULL;
 	animation_frame = 0;
 
 	/* Set image limits */
 	max_num_images = TEX_NUM_MAX;
 	has_half_images = info.has_half_images;
+	has_sparse_images = info.has_sparse_images;
 
 	for(size_t type = 0; type < IMAGE_DATA_NUM_TYPES; type++) {
 		tex_num_images[type] = 0;
@@ -68,6 +74,14 @@ void ImageManager::set_osl_texture_system(void *texture_system)
 	osl_texture_system = texture_system;
 }
 
+bool ImageManager::use_texture_cache(Scene *scene)
+{
+	/* OSL reads image files through its own texture system already. */
+	return scene->params.use_texture_cache &&
+	       !scene->shader_manager->use_osl() &&
+	       scene->device->texture_cache_memory() != NULL;
+}
+
 bool ImageManager::set_animation_frame_update(int frame)
 {
 	if(frame != animation_frame) {
@@ -235,6 +249,10 @@ string ImageManager::name_from_type(int type)
 		return "half4";
 	else if(type == IMAGE_DATA_TYPE_HALF)
 		return "half";
+	else if(type == IMAGE_DATA_TYPE_FLOAT4_SPARSE)
+		return "float4_sparse";
+	else if(type == IMAGE_DATA_TYPE_FLOAT_SPARSE)
+		return "float_sparse";
 	else
 		return "byte4";
 }
@@ -280,6 +298,16 @@ int ImageManager::add_image(const string& filename,
 		}
 	}
 
+	/* Store volumes sparse when supported, so empty space takes no memory. */
+	if(has_sparse_images && metadata.depth > 1) {
+		if(type == IMAGE_DATA_TYPE_FLOAT4) {
+			type = IMAGE_DATA_TYPE_FLOAT4_SPARSE;
+		}
+		else if(type == IMAGE_DATA_TYPE_FLOAT) {
+			type = IMAGE_DATA_TYPE_FLOAT_SPARSE;
+		}
+	}
+
 	/* Fnd existing image. */
 	for(slot = 0; slot < images[type].size(); slot++) {
 		img = images[type][slot];
@@ -682,6 +710,115 @@ bool ImageManager::file_load_image(Image *img,
 	return true;
 }
 
+static bool image_voxel_is_zero(float value)
+{
+	return value == 0.0f;
+}
+
+static bool image_voxel_is_zero(const float4& value)
+{
+	return value.x == 0.0f && value.y == 0.0f && value.z == 0.0f && value.w == 0.0f;
+}
+
+/* Convert a dense 3D image to the sparse tile layout described in
+ * util_texture.h. Tiles with only zero voxels are skipped, partial tiles
+ * at the borders are padded with zeros. */
+template<typename DeviceType>
+void ImageManager::make_sparse_image(device_vector<DeviceType>& dense_img,
+                                     device_vector<DeviceType>& tex_img)
+{
+	const size_t width = max(dense_img.data_width, (size_t)1);
+	const size_t height = max(dense_img.data_height, (size_t)1);
+	const size_t depth = max(dense_img.data_depth, (size_t)1);
+	const DeviceType *voxels = dense_img.data();
+
+	const size_t tiles_x = divide_up(width, TEX_SPARSE_TILE_SIZE);
+	const size_t tiles_y = divide_up(height, TEX_SPARSE_TILE_SIZE);
+	const size_t tiles_z = divide_up(depth, TEX_SPARSE_TILE_SIZE);
+	const size_t num_tiles = tiles_x * tiles_y * tiles_z;
+
+	/* The offset table is followed by the shared empty tile. */
+	const size_t header_tiles = divide_up(num_tiles * sizeof(int),
+	                                      TEX_SPARSE_TILE_VOXELS * sizeof(DeviceType));
+	const int empty_tile = header_tiles;
+
+	vector<int> tile_offsets(num_tiles, empty_tile);
+	size_t num_active_tiles = 0;
+
+	for(size_t tz = 0, tile = 0; tz < tiles_z; tz++) {
+		for(size_t ty = 0; ty < tiles_y; ty++) {
+			for(size_t tx = 0; tx < tiles_x; tx++, tile++) {
+				const size_t x_end = min((tx + 1) * TEX_SPARSE_TILE_SIZE, width);
+				const size_t y_end = min((ty + 1) * TEX_SPARSE_TILE_SIZE, height);
+				const size_t z_end = min((tz + 1) * TEX_SPARSE_TILE_SIZE, depth);
+				bool is_empty = true;
+
+				for(size_t z = tz * TEX_SPARSE_TILE_SIZE; z < z_end && is_empty; z++) {
+					for(size_t y = ty * TEX_SPARSE_TILE_SIZE; y < y_end && is_empty; y++) {
+						for(size_t x = tx * TEX_SPARSE_TILE_SIZE; x < x_end; x++) {
+							if(!image_voxel_is_zero(voxels[x + y*width + z*width*height])) {
+								is_empty = false;
+								break;
+							}
+						}
+					}
+				}
+
+				if(!is_empty) {
+					tile_offsets[tile] = header_tiles + 1 + num_active_tiles++;
+				}
+			}
+		}
+	}
+
+	const size_t num_voxels = (header_tiles + 1 + num_active_tiles) * TEX_SPARSE_TILE_VOXELS;
+	DeviceType *data;
+
+	{
+		thread_scoped_lock device_lock(device_mutex);
+		data = tex_img.alloc(num_voxels);
+	}
+
+	memset(data, 0, num_voxels * sizeof(DeviceType));
+	memcpy(data, &tile_offsets[0], num_tiles * sizeof(int));
+
+	for(size_t tz = 0, tile = 0; tz < tiles_z; tz++) {
+		for(size_t ty = 0; ty < tiles_y; ty++) {
+			for(size_t tx = 0; tx < tiles_x; tx++, tile++) {
+				if(tile_offsets[tile] == empty_tile) {
+					continue;
+				}
+
+				DeviceType *tile_data = data + (size_t)tile_offsets[tile] * TEX_SPARSE_TILE_VOXELS;
+				const size_t x_end = min((tx + 1) * TEX_SPARSE_TILE_SIZE, width);
+				const size_t y_end = min((ty + 1) * TEX_SPARSE_TILE_SIZE, height);
+				const size_t z_end = min((tz + 1) * TEX_SPARSE_TILE_SIZE, depth);
+
+				for(size_t z = tz * TEX_SPARSE_TILE_SIZE; z < z_end; z++) {
+					for(size_t y = ty * TEX_SPARSE_TILE_SIZE; y < y_end; y++) {
+						for(size_t x = tx * TEX_SPARSE_TILE_SIZE; x < x_end; x++) {
+							tile_data[(x & TEX_SPARSE_TILE_MASK) +
+							          ((y & TEX_SPARSE_TILE_MASK) << TEX_SPARSE_TILE_SHIFT) +
+							          ((z & TEX_SPARSE_TILE_MASK) << (2 * TEX_SPARSE_TILE_SHIFT))] =
+							        voxels[x + y*width + z*width*height];
+						}
+					}
+				}
+			}
+		}
+	}
+
+	/* Kernel lookups need the resolution of the voxel grid. */
+	tex_img.data_width = width;
+	tex_img.data_height = height;
+	tex_img.data_depth = depth;
+
+	VLOG(1) << "Sparse image " << tex_img.name << ": "
+	        << num_active_tiles << " of " << num_tiles << " tiles used, "
+	        << string_human_readable_size(tex_img.memory_size()) << " instead of "
+	        << string_human_readable_size(dense_img.memory_size()) << ".";
+}
+
 void ImageManager::device_load_image(Device *device,
                                      Scene *scene,
                                      ImageDataType type,
@@ -711,6 +848,13 @@ void ImageManager::device_load_image(Device *device,
 		delete img->mem;
 		img->mem = NULL;
 	}
+	texture_cache_free_image(flat_slot);
+
+	/* Image files are read on demand by the texture cache. */
+	if(use_texture_cache(scene) && texture_cache_load_image(scene, img, flat_slot)) {
+		img->need_load = false;
+		return;
+	}
 
 	/* Create new texture. */
 	if(type == IMAGE_DATA_TYPE_FLOAT4) {
@@ -835,6 +979,69 @@ void ImageManager::device_load_image(Device *device,
 		thread_scoped_lock device_lock(device_mutex);
 		tex_img->copy_to_device();
 	}
+	else if(type == IMAGE_DATA_TYPE_FLOAT4_SPARSE) {
+		device_vector<float4> *tex_img
+			= new device_vector<float4>(device, img->mem_name.c_str(), MEM_TEXTURE);
+
+		{
+			/* Load dense first, only the sparse image is kept. */
+			device_vector<float4> dense_img(device, img->mem_name.c_str(), MEM_TEXTURE);
+
+			if(!file_load_image<TypeDesc::FLOAT, float>(img,
+			                                            IMAGE_DATA_TYPE_FLOAT4,
+			                                            texture_limit,
+			                                            dense_img))
+			{
+				/* on failure to load, we set a 1x1 pixels pink image */
+				thread_scoped_lock device_lock(device_mutex);
+				float *pixels = (float*)dense_img.alloc(1, 1);
+
+				pixels[0] = TEX_IMAGE_MISSING_R;
+				pixels[1] = TEX_IMAGE_MISSING_G;
+				pixels[2] = TEX_IMAGE_MISSING_B;
+				pixels[3] = TEX_IMAGE_MISSING_A;
+			}
+
+			make_sparse_image(dense_img, *tex_img);
+		}
+
+		img->mem = tex_img;
+		img->mem->interpolation = img->interpolation;
+		img->mem->extension = img->extension;
+
+		thread_scoped_lock device_lock(device_mutex);
+		tex_img->copy_to_device();
+	}
+	else if(type == IMAGE_DATA_TYPE_FLOAT_SPARSE) {
+		device_vector<float> *tex_img
+			= new device_vector<float>(device, img->mem_name.c_str(), MEM_TEXTURE);
+
+		{
+			/* Load dense first, only the sparse image is kept. */
+			device_vector<float> dense_img(device, img->mem_name.c_str(), MEM_TEXTURE);
+
+			if(!file_load_image<TypeDesc::FLOAT, float>(img,
+			                                            IMAGE_DATA_TYPE_FLOAT,
+			                                            texture_limit,
+			                                            dense_img))
+			{
+				/* on failure to load, we set a 1x1 pixels pink image */
+				thread_scoped_lock device_lock(device_mutex);
+				float *pixels = (float*)dense_img.alloc(1, 1);
+
+				pixels[0] = TEX_IMAGE_MISSING_R;
+			}
+
+			make_sparse_image(dense_img, *tex_img);
+		}
+
+		img->mem = tex_img;
+		img->mem->interpolation = img->interpolation;
+		img->mem->extension = img->extension;
+
+		thread_scoped_lock device_lock(device_mutex);
+		tex_img->copy_to_device();
+	}
 	else if(type == IMAGE_DATA_TYPE_HALF) {
 		device_vector<half> *tex_img
 			= new device_vector<half>(device, img->mem_name.c_str(), MEM_TEXTURE);
@@ -873,6 +1080,8 @@ void ImageManager::device_free_image(Device *, ImageDataType type, int slot)
 #endif
 		}
 
+		texture_cache_free_image(type_index_to_flattened_slot(slot, type));
+
 		if(img->mem) {
 			thread_scoped_lock device_lock(device_mutex);
 			delete img->mem;
@@ -916,6 +1125,8 @@ void ImageManager::device_update(Device *device,
 
 	pool.wait_work();
 
+	texture_cache_device_update(device);
+
 	need_update = false;
 }
 
@@ -941,6 +1152,8 @@ void ImageManager::device_update_slot(Device *device,
 			                  slot,
 			                  progress);
 	}
+
+	texture_cache_device_update(device);
 }
 
 void ImageManager::device_free_builtin(Device *device)
@@ -961,6 +1174,277 @@ void ImageManager::device_free(Device *device)
 		}
 		images[type].clear();
 	}
+
+	if(texture_cache) {
+		TextureSystem::destroy((TextureSystem*)texture_cache);
+		texture_cache = NULL;
+	}
+	texture_cache_slots.clear();
+	texture_cache_device_update(device);
+}
+
+/* Texture Cache */
+
+bool ImageManager::texture_cache_load_image(Scene *scene,
+                                            Image *img,
+                                            int flat_slot)
+{
+	/* Packed and generated images are loaded into memory as usual, as well
+	 * as images with unassociated alpha which the cache does not provide. */
+	if(img->builtin_data || !img->use_alpha) {
+		return false;
+	}
+	if(!path_exists(img->filename) || path_is_directory(img->filename)) {
+		return false;
+	}
+
+	ImageInput *in = ImageInput::create(img->filename);
+	if(!in) {
+		return false;
+	}
+
+	ImageSpec spec;
+	if(!in->open(img->filename, spec)) {
+		delete in;
+		return false;
+	}
+
+	const int width = spec.width;
+	const int height = spec.height;
+	const int depth = spec.depth;
+	const int channels = spec.nchannels;
+	const bool is_tiled = (spec.tile_width > 0);
+	const bool is_cmyk = (strcmp(in->format_name(), "jpeg") == 0 && channels == 4);
+	const bool is_mipmapped = in->seek_subimage(0, 1, spec);
+
+	in->close();
+	delete in;
+
+	if(depth > 1 || channels < 1) {
+		return false;
+	}
+	/* CMYK conversion and resizing to the texture limit are only done by
+	 * file_load_image(), keep those images in memory. */
+	if(is_cmyk) {
+		return false;
+	}
+	const int texture_limit = scene->params.texture_limit;
+	if(texture_limit > 0 && max(width, height) > texture_limit) {
+		return false;
+	}
+
+	/* Without conversion, untiled files are still split into tiles and
+	 * mip-mapped by the cache, but have to be read in full first. */
+	string filename = img->filename;
+	if(scene->params.texture_auto_convert && !(is_tiled && is_mipmapped)) {
+		filename = texture_cache_convert_image(img->filename);
+	}
+
+	thread_scoped_lock device_lock(device_mutex);
+
+	if(!texture_cache) {
+		TextureSystem *ts = TextureSystem::create(false);
+		ts->attribute("max_memory_MB", (float)scene->params.texture_cache_size);
+		ts->attribute("autotile", 64);
+		ts->attribute("automip", 1);
+		texture_cache = ts;
+	}
+
+	TextureSystem *ts = (TextureSystem*)texture_cache;
+	TextureSystem::TextureHandle *handle = ts->get_texture_handle(ustring(filename));
+	if(!handle) {
+		return false;
+	}
+
+	if(flat_slot >= texture_cache_slots.size()) {
+		texture_cache_slots.resize(flat_slot + 1);
+	}
+
+	TextureCacheSlot& cache_slot = texture_cache_slots[flat_slot];
+	cache_slot.handle = handle;
+	cache_slot.filename = filename;
+	cache_slot.channels = min(channels, 4);
+	cache_slot.interpolation = img->interpolation;
+	cache_slot.extension = img->extension;
+
+	VLOG(1) << "Image " << img->filename << " sampled through texture cache.";
+
+	return true;
+}
+
+void ImageManager::texture_cache_free_image(int flat_slot)
+{
+	thread_scoped_lock device_lock(device_mutex);
+
+	if(flat_slot >= texture_cache_slots.size()) {
+		return;
+	}
+
+	TextureCacheSlot& cache_slot = texture_cache_slots[flat_slot];
+	if(cache_slot.handle) {
+		((TextureSystem*)texture_cache)->invalidate(ustring(cache_slot.filename));
+		cache_slot = TextureCacheSlot();
+	}
+}
+
+void ImageManager::texture_cache_device_update(Device *device)
+{
+	TextureCacheGlobals *globals = (TextureCacheGlobals*)device->texture_cache_memory();
+	if(!globals) {
+		return;
+	}
+
+	if(texture_cache) {
+		globals->lookup = texture_cache_lookup;
+		globals->data = this;
+	}
+	else {
+		globals->lookup = NULL;
+		globals->data = NULL;
+	}
+}
+
+string ImageManager::texture_cache_convert_image(const string& filename)
+{
+	/* Tiled and mip-mapped copy next to the original, made once and reused
+	 * for as long as it is more recent than the original. */
+	const string tx_filename = filename + ".tx";
+
+	if(path_exists(tx_filename) &&
+	   path_modified_time(tx_filename) >= path_modified_time(filename))
+	{
+		return tx_filename;
+	}
+
+	ImageSpec config;
+	config.tile_width = 64;
+	config.tile_height = 64;
+	config.tile_depth = 1;
+
+	/* Write to a temporary file first, so other renders never see a partially
+	 * written texture. Keep the .tx extension, it selects the file format. */
+	const string tmp_filename = filename + "." +
+	                            OIIO::Filesystem::unique_path("%%%%%%%%") +
+	                            ".tx";
+
+	if(!ImageBufAlgo::make_texture(ImageBufAlgo::MakeTxTexture,
+	                               filename,
+	                               tmp_filename,
+	                               config) ||
+	   !path_rename(tmp_filename, tx_filename))
+	{
+		path_remove(tmp_filename);
+		VLOG(1) << "Failed to convert " << filename << " to tiled texture, "
+		        << "using the original file.";
+		return filename;
+	}
+
+	VLOG(1) << "Converted " << filename << " to tiled texture " << tx_filename << ".";
+
+	return tx_filename;
+}
+
+bool ImageManager::texture_cache_lookup(void *data,
+                                        int flat_slot,
+                                        float s, float t,
+                                        float dsdx, float dtdx,
+                                        float dsdy, float dtdy,
+                                        float4 *result)
+{
+	ImageManager *image_manager = (ImageManager*)data;
+
+	if(flat_slot >= image_manager->texture_cache_slots.size()) {
+		return false;
+	}
+
+	const TextureCacheSlot& cache_slot = image_manager->texture_cache_slots[flat_slot];
+	if(!cache_slot.handle) {
+		return false;
+	}
+
+	TextureOpt options;
+
+	switch(cache_slot.interpolation) {
+		case INTERPOLATION_CLOSEST:
+			options.interpmode = TextureOpt::InterpClosest;
+			break;
+		case INTERPOLATION_CUBIC:
+			options.interpmode = TextureOpt::InterpBicubic;
+			break;
+		case INTERPOLATION_SMART:
+			options.interpmode = TextureOpt::InterpSmartBicubic;
+			break;
+		case INTERPOLATION_LINEAR:
+		default:
+			options.interpmode = TextureOpt::InterpBilinear;
+			break;
+	}
+
+	switch(cache_slot.extension) {
+		case EXTENSION_EXTEND:
+			options.swrap = options.twrap = TextureOpt::WrapClamp;
+			break;
+		case EXTENSION_CLIP:
+			options.swrap = options.twrap = TextureOpt::WrapBlack;
+			break;
+		case EXTENSION_REPEAT:
+		default:
+			options.swrap = options.twrap = TextureOpt::WrapPeriodic;
+			break;
+	}
+
+	/* The texture system picks the mip level from the derivatives and reads
+	 * the tiles it needs, evicting others to stay within the memory limit. */
+	TextureSystem *ts = (TextureSystem*)image_manager->texture_cache;
+	float rgba[4];
+
+	if(!ts->texture((TextureSystem::TextureHandle*)cache_slot.handle,
+	                NULL,
+	                options,
+	                s, t,
+	                dsdx, dtdx,
+	                dsdy, dtdy,
+	                cache_slot.channels,
+	                rgba))
+	{
+		*result = make_float4(TEX_IMAGE_MISSING_R,
+		                      TEX_IMAGE_MISSING_G,
+		                      TEX_IMAGE_MISSING_B,
+		                      TEX_IMAGE_MISSING_A);
+		return true;
+	}
+
+	switch(cache_slot.channels) {
+		case 1:
+			*result = make_float4(rgba[0], rgba[0], rgba[0], 1.0f);
+			break;
+		case 2:
+			*result = make_float4(rgba[0], rgba[0], rgba[0], rgba[1]);
+			break;
+		case 3:
+			*result = make_float4(rgba[0], rgba[1], rgba[2], 1.0f);
+			break;
+		default:
+			*result = make_float4(rgba[0], rgba[1], rgba[2], rgba[3]);
+			break;
+	}
+
+	/* Same as file_load_image(), single channel values are cleared on their
+	 * own and RGBA values all together if either of them is not finite. */
+	if(cache_slot.channels == 1) {
+		if(!isfinite(rgba[0])) {
+			*result = make_float4(0.0f, 0.0f, 0.0f, 1.0f);
+		}
+	}
+	else if(!isfinite(result->x) ||
+	        !isfinite(result->y) ||
+	        !isfinite(result->z) ||
+	        !isfinite(result->w))
+	{
+		*result = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+	}
+
+	return true;
 }
 
 CCL_NAMESPACE_END
@@ -85,6 +85,9 @@ public:
 	void set_osl_texture_system(void *texture_system);
 	bool set_animation_frame_update(int frame);
 
+	/* Image files are sampled through the texture cache on the CPU device. */
+	bool use_texture_cache(Scene *scene);
+
 	device_memory *image_memory(int flat_slot);
 
 	bool need_update;
@@ -129,6 +132,7 @@ private:
 	int tex_num_images[IMAGE_DATA_NUM_TYPES];
 	int max_num_images;
 	bool has_half_images;
+	bool has_sparse_images;
 
 	thread_mutex device_mutex;
 	int animation_frame;
@@ -136,6 +140,38 @@ private:
 	vector<Image*> images[IMAGE_DATA_NUM_TYPES];
 	void *osl_texture_system;
 
+	/* Image files which are read from the texture cache on demand, indexed
+	 * by flattened slot. */
+	struct TextureCacheSlot {
+		void *handle;
+		string filename;
+		int channels;
+		InterpolationType interpolation;
+		ExtensionType extension;
+
+		TextureCacheSlot()
+		: handle(NULL),
+		  channels(0),
+		  interpolation(INTERPOLATION_LINEAR),
+		  extension(EXTENSION_REPEAT) {}
+	};
+
+	void *texture_cache;
+	vector<TextureCacheSlot> texture_cache_slots;
+
+	bool texture_cache_load_image(Scene *scene,
+	                              Image *img,
+	                              int flat_slot);
+	void texture_cache_free_image(int flat_slot);
+	void texture_cache_device_update(Device *device);
+	string texture_cache_convert_image(const string& filename);
+	static bool texture_cache_lookup(void *data,
+	                                 int flat_slot,
+	                                 float s, float t,
+	                                 float dsdx, float dtdx,
+	                                 float dsdy, float dtdy,
+	                                 float4 *result);
+
 	bool file_load_image_generic(Image *img,
 	                             ImageInput **in,
 	                             int &width,
@@ -151,6 +187,10 @@ private:
 	                     int texture_limit,
 	                     device_vector<DeviceType>& tex_img);
 
+	template<typename DeviceType>
+	void make_sparse_image(device_vector<DeviceType>& dense_img,
+	                       device_vector<DeviceType>& tex_img);
+
 	int max_flattened_slot(ImageDataType type);
 	int type_index_to_flattened_slot(int slot, ImageDataType type);
 	int flattened_slot_to_type_index(int flat_slot, ImageDataType *type);
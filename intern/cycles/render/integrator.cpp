@@ -67,6 +67,11 @@ NODE_DEFINE(Integrator)
 	SOCKET_BOOLEAN(sample_all_lights_direct, "Sample All Lights Direct", true);
 	SOCKET_BOOLEAN(sample_all_lights_indirect, "Sample All Lights Indirect", true);
 	SOCKET_FLOAT(light_sampling_threshold, "Light Sampling Threshold", 0.05f);
+	SOCKET_BOOLEAN(use_light_tree, "Use Light Tree", false);
+
+	SOCKET_BOOLEAN(use_adaptive_sampling, "Use Adaptive Sampling", false);
+	SOCKET_FLOAT(adaptive_threshold, "Adaptive Threshold", 0.0f);
+	SOCKET_INT(adaptive_min_samples, "Adaptive Min Samples", 0);
 
 	static NodeEnum method_enum;
 	method_enum.insert("path", PATH);
@@ -175,6 +180,24 @@ void Integrator::device_update(Device *device, DeviceScene *dscene, Scene *scene
 		kintegrator->light_inv_rr_threshold = 0.0f;
 	}
 
+	/* Adaptive sampling, zero threshold and minimum samples pick values
+	 * based on the total number of samples. Pixels are only checked for
+	 * convergence when the film also has the auxiliary buffer pass. */
+	kintegrator->use_adaptive_sampling = use_adaptive_sampling;
+	if(adaptive_threshold > 0.0f) {
+		kintegrator->adaptive_threshold = adaptive_threshold;
+	}
+	else {
+		kintegrator->adaptive_threshold = max(0.001f, 1.0f / (float)max(aa_samples, 1));
+	}
+	if(adaptive_min_samples > 0) {
+		kintegrator->adaptive_min_samples = adaptive_min_samples;
+	}
+	else {
+		kintegrator->adaptive_min_samples = max(4, (int)sqrtf((float)aa_samples));
+	}
+	kintegrator->adaptive_step = 4;
+
 	/* sobol directions table */
 	int max_samples = 1;
 
@@ -19,6 +19,7 @@
 #include "render/integrator.h"
 #include "render/film.h"
 #include "render/light.h"
+#include "render/light_tree.h"
 #include "render/mesh.h"
 #include "render/object.h"
 #include "render/scene.h"
@@ -287,6 +288,15 @@ void LightManager::device_update_distribution(Device *, DeviceScene *dscene, Sce
 	size_t num_distribution = num_triangles + num_lights;
 	VLOG(1) << "Total " << num_distribution << " of light distribution primitives.";
 
+	/* The light tree replaces picking a single light, sampling all lights
+	 * relies on the light distribution to sample mesh lights. */
+	Integrator *integrator = scene->integrator;
+	const bool use_light_tree = integrator->use_light_tree &&
+	        !(integrator->method == Integrator::BRANCHED_PATH &&
+	          (integrator->sample_all_lights_direct || integrator->sample_all_lights_indirect));
+	vector<LightTreePrimitive> tree_primitives;
+	vector<int> tree_infinite;
+
 	/* emission area */
 	KernelLightDistribution *distribution = dscene->light_distribution.alloc(num_distribution + 1);
 	float totarea = 0.0f;
@@ -354,7 +364,21 @@ void LightManager::device_update_distribution(Device *, DeviceScene *dscene, Sce
 					p3 = transform_point(&tfm, p3);
 				}
 
-				totarea += triangle_area(p1, p2, p3);
+				float area = triangle_area(p1, p2, p3);
+				totarea += area;
+
+				if(use_light_tree && area > 0.0f) {
+					/* Mesh lights emit from both sides. */
+					LightTreePrimitive prim;
+					prim.bounds = BoundBox::empty;
+					prim.bounds.grow(p1);
+					prim.bounds.grow(p2);
+					prim.bounds.grow(p3);
+					prim.orientation = LightTreeOrientation(normalize(cross(p2 - p1, p3 - p1)), M_PI_F, M_PI_2_F);
+					prim.energy = area;
+					prim.distribution_index = offset - 1;
+					tree_primitives.push_back(prim);
+				}
 			}
 		}
 
@@ -378,6 +402,38 @@ void LightManager::device_update_distribution(Device *, DeviceScene *dscene, Sce
 		distribution[offset].lamp.size = light->size;
 		totarea += lightarea;
 
+		if(use_light_tree) {
+			if(light->type == LIGHT_DISTANT || light->type == LIGHT_BACKGROUND) {
+				tree_infinite.push_back(offset);
+			}
+			else {
+				LightTreePrimitive prim;
+				prim.bounds = BoundBox::empty;
+				prim.energy = lightarea;
+				prim.distribution_index = offset;
+
+				if(light->type == LIGHT_AREA) {
+					float3 axisu = light->axisu*(light->sizeu*light->size);
+					float3 axisv = light->axisv*(light->sizev*light->size);
+					prim.bounds.grow(light->co - 0.5f*axisu - 0.5f*axisv);
+					prim.bounds.grow(light->co + 0.5f*axisu - 0.5f*axisv);
+					prim.bounds.grow(light->co - 0.5f*axisu + 0.5f*axisv);
+					prim.bounds.grow(light->co + 0.5f*axisu + 0.5f*axisv);
+					prim.orientation = LightTreeOrientation(safe_normalize(light->dir), 0.0f, M_PI_2_F);
+				}
+				else {
+					prim.bounds.grow(light->co, light->size);
+					if(light->type == LIGHT_SPOT) {
+						prim.orientation = LightTreeOrientation(safe_normalize(light->dir),
+						                                        light->spot_angle*0.5f,
+						                                        M_PI_2_F);
+					}
+				}
+
+				tree_primitives.push_back(prim);
+			}
+		}
+
 		if(light->size > 0.0f && light->use_mis)
 			use_lamp_mis = true;
 		if(light->type == LIGHT_BACKGROUND) {
@@ -446,6 +502,61 @@ void LightManager::device_update_distribution(Device *, DeviceScene *dscene, Sce
 		/* CDF */
 		dscene->light_distribution.copy_to_device();
 
+		/* Light tree, distant and background lights are appended as leaves
+		 * without a parent and keep their probability from the CDF. */
+		if(use_light_tree) {
+			LightTree tree(tree_primitives);
+			const vector<KernelLightTreeNode>& tree_nodes = tree.get_nodes();
+			const size_t num_tree_nodes = tree_nodes.size();
+
+			KernelLightTreeNode *knodes = dscene->light_tree_nodes.alloc(num_tree_nodes + tree_infinite.size());
+			int *leaf = dscene->light_tree_leaf.alloc(num_distribution);
+
+			for(size_t i = 0; i < num_distribution; i++) {
+				leaf[i] = -1;
+			}
+			for(size_t i = 0; i < num_tree_nodes; i++) {
+				knodes[i] = tree_nodes[i];
+				if(knodes[i].distribution_index >= 0) {
+					leaf[knodes[i].distribution_index] = i;
+				}
+			}
+			for(size_t i = 0; i < tree_infinite.size(); i++) {
+				KernelLightTreeNode& knode = knodes[num_tree_nodes + i];
+				memset(&knode, 0, sizeof(knode));
+				knode.right_child = -1;
+				knode.distribution_index = tree_infinite[i];
+				knode.parent = -1;
+				leaf[tree_infinite[i]] = num_tree_nodes + i;
+			}
+
+			kintegrator->use_light_tree = true;
+			kintegrator->light_tree_num_nodes = num_tree_nodes;
+			kintegrator->light_tree_num_infinite = tree_infinite.size();
+			if(num_tree_nodes == 0) {
+				kintegrator->light_tree_pdf_local = 0.0f;
+			}
+			else {
+				kintegrator->light_tree_pdf_local =
+				        clamp(1.0f - tree_infinite.size()*kintegrator->pdf_lights, 0.0f, 1.0f);
+			}
+
+			VLOG(1) << "Light tree with " << num_tree_nodes << " nodes and "
+			        << tree_infinite.size() << " distant lights.";
+
+			dscene->light_tree_nodes.copy_to_device();
+			dscene->light_tree_leaf.copy_to_device();
+		}
+		else {
+			dscene->light_tree_nodes.free();
+			dscene->light_tree_leaf.free();
+
+			kintegrator->use_light_tree = false;
+			kintegrator->light_tree_num_nodes = 0;
+			kintegrator->light_tree_num_infinite = 0;
+			kintegrator->light_tree_pdf_local = 0.0f;
+		}
+
 		/* Portals */
 		if(num_portals > 0) {
 			kintegrator->portal_offset = light_index;
@@ -460,7 +571,13 @@ void LightManager::device_update_distribution(Device *, DeviceScene *dscene, Sce
 	}
 	else {
 		dscene->light_distribution.free();
+		dscene->light_tree_nodes.free();
+		dscene->light_tree_leaf.free();
 
+		kintegrator->use_light_tree = false;
+		kintegrator->light_tree_num_nodes = 0;
+		kintegrator->light_tree_num_infinite = 0;
+		kintegrator->light_tree_pdf_local = 0.0f;
 		kintegrator->num_distribution = 0;
 		kintegrator->num_all_lights = 0;
 		kintegrator->pdf_triangles = 0.0f;
@@ -869,6 +986,8 @@ void LightManager::device_update(Device *device, DeviceScene *dscene, Scene *sce
 void LightManager::device_free(Device *, DeviceScene *dscene)
 {
 	dscene->light_distribution.free();
+	dscene->light_tree_nodes.free();
+	dscene->light_tree_leaf.free();
 	dscene->lights.free();
 	dscene->light_background_marginal_cdf.free();
 	dscene->light_background_conditional_cdf.free();
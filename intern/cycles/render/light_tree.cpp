@@ -0,0 +1,283 @@
+/*
+ * Copyright 2011-2017 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/light_tree.h"
+
+#include "util/util_algorithm.h"
+#include "util/util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Number of bins used to find the split with the lowest cost. */
+#define LIGHT_TREE_NUM_BINS 12
+/* Past this depth nodes are split at the median, to bound the tree depth. */
+#define LIGHT_TREE_MAX_SAOH_DEPTH 48
+
+/* Orientation Bounds */
+
+LightTreeOrientation LightTreeOrientation::merge(const LightTreeOrientation& a_,
+                                                 const LightTreeOrientation& b_)
+{
+	/* Make a the wider cone. */
+	const bool b_is_wider = (a_.theta_o < b_.theta_o);
+	const LightTreeOrientation& a = b_is_wider? b_: a_;
+	const LightTreeOrientation& b = b_is_wider? a_: b_;
+
+	const float cos_theta_d = clamp(dot(a.axis, b.axis), -1.0f, 1.0f);
+	const float theta_d = acosf(cos_theta_d);
+	const float theta_e = max(a.theta_e, b.theta_e);
+
+	/* b is inside of a. */
+	if(min(theta_d + b.theta_o, M_PI_F) <= a.theta_o) {
+		return LightTreeOrientation(a.axis, a.theta_o, theta_e);
+	}
+
+	const float theta_o = 0.5f*(a.theta_o + theta_d + b.theta_o);
+	if(theta_o >= M_PI_F) {
+		return LightTreeOrientation(a.axis, M_PI_F, theta_e);
+	}
+
+	/* Rotate the axis of a towards b, opposite axes give the full sphere. */
+	const float3 ortho = b.axis - cos_theta_d*a.axis;
+	const float ortho_len = len(ortho);
+	if(ortho_len < 1e-6f) {
+		return LightTreeOrientation(a.axis, M_PI_F, theta_e);
+	}
+
+	const float theta_r = theta_o - a.theta_o;
+	const float3 axis = cosf(theta_r)*a.axis + sinf(theta_r)*(ortho/ortho_len);
+
+	return LightTreeOrientation(normalize(axis), theta_o, theta_e);
+}
+
+float LightTreeOrientation::measure() const
+{
+	const float theta_w = min(theta_o + theta_e, M_PI_F);
+	const float sin_theta_o = sinf(theta_o);
+	const float cos_theta_o = cosf(theta_o);
+
+	return M_2PI_F*(1.0f - cos_theta_o) +
+	       M_PI_2_F*(2.0f*theta_w*sin_theta_o -
+	                 cosf(theta_o - 2.0f*theta_w) -
+	                 2.0f*theta_o*sin_theta_o +
+	                 cos_theta_o);
+}
+
+/* Tree */
+
+LightTree::LightTree(const vector<LightTreePrimitive>& primitives_)
+: primitives(primitives_)
+{
+	if(primitives.empty()) {
+		return;
+	}
+
+	nodes.reserve(2*primitives.size() - 1);
+	recursive_build(-1, 0, primitives.size(), 0);
+}
+
+int LightTree::recursive_build(int parent, int start, int end, int depth)
+{
+	BoundBox bounds = BoundBox::empty;
+	BoundBox centroid_bounds = BoundBox::empty;
+	LightTreeOrientation orientation = primitives[start].orientation;
+	float energy = 0.0f;
+
+	for(int i = start; i < end; i++) {
+		const LightTreePrimitive& prim = primitives[i];
+		bounds.grow(prim.bounds);
+		centroid_bounds.grow(prim.centroid());
+		if(i != start) {
+			orientation = LightTreeOrientation::merge(orientation, prim.orientation);
+		}
+		energy += prim.energy;
+	}
+
+	KernelLightTreeNode knode;
+	knode.bbox_min[0] = bounds.min.x;
+	knode.bbox_min[1] = bounds.min.y;
+	knode.bbox_min[2] = bounds.min.z;
+	knode.energy = energy;
+	knode.bbox_max[0] = bounds.max.x;
+	knode.bbox_max[1] = bounds.max.y;
+	knode.bbox_max[2] = bounds.max.z;
+	knode.theta_o = orientation.theta_o;
+	knode.axis[0] = orientation.axis.x;
+	knode.axis[1] = orientation.axis.y;
+	knode.axis[2] = orientation.axis.z;
+	knode.theta_e = orientation.theta_e;
+	knode.right_child = -1;
+	knode.distribution_index = -1;
+	knode.parent = parent;
+	knode.pad = 0;
+
+	const int node_index = nodes.size();
+	nodes.push_back(knode);
+
+	if(end - start == 1) {
+		nodes[node_index].distribution_index = primitives[start].distribution_index;
+		return node_index;
+	}
+
+	int mid = -1;
+	if(depth < LIGHT_TREE_MAX_SAOH_DEPTH) {
+		mid = split_saoh(start, end, bounds, centroid_bounds);
+	}
+	if(mid == -1) {
+		mid = split_median(start, end, centroid_bounds);
+	}
+
+	recursive_build(node_index, start, mid, depth + 1);
+	const int right_child = recursive_build(node_index, mid, end, depth + 1);
+	nodes[node_index].right_child = right_child;
+
+	return node_index;
+}
+
+/* Binned split minimizing the surface area orientation heuristic, returns
+ * the index of the first primitive of the second child or -1 if no valid
+ * split was found. */
+int LightTree::split_saoh(int start,
+                          int end,
+                          const BoundBox& bounds,
+                          const BoundBox& centroid_bounds)
+{
+	struct Bin {
+		BoundBox bounds;
+		LightTreeOrientation orientation;
+		float energy;
+		int count;
+
+		Bin() : bounds(BoundBox::empty), energy(0.0f), count(0) {}
+
+		void add(const BoundBox& other_bounds,
+		         const LightTreeOrientation& other_orientation,
+		         float other_energy,
+		         int other_count)
+		{
+			if(other_count == 0) {
+				return;
+			}
+			bounds.grow(other_bounds);
+			orientation = (count == 0)
+			        ? other_orientation
+			        : LightTreeOrientation::merge(orientation, other_orientation);
+			energy += other_energy;
+			count += other_count;
+		}
+
+		float cost() const
+		{
+			return energy * orientation.measure() * bounds.safe_area();
+		}
+	};
+
+	const float3 extent = bounds.size();
+	const float max_extent = max3(extent);
+	const float3 centroid_extent = centroid_bounds.size();
+
+	float min_cost = FLT_MAX;
+	int min_axis = -1;
+	int min_bin = -1;
+
+	for(int axis = 0; axis < 3; axis++) {
+		if(centroid_extent[axis] == 0.0f) {
+			continue;
+		}
+
+		const float inv_extent = LIGHT_TREE_NUM_BINS / centroid_extent[axis];
+		Bin bins[LIGHT_TREE_NUM_BINS];
+
+		for(int i = start; i < end; i++) {
+			const LightTreePrimitive& prim = primitives[i];
+			int bin = (int)((prim.centroid()[axis] - centroid_bounds.min[axis]) * inv_extent);
+			bin = clamp(bin, 0, LIGHT_TREE_NUM_BINS - 1);
+			bins[bin].add(prim.bounds, prim.orientation, prim.energy, 1);
+		}
+
+		/* Regularize the cost for thin nodes, so splits across the long
+		 * axis are preferred. */
+		const float regularization = max_extent / extent[axis];
+
+		for(int split = 1; split < LIGHT_TREE_NUM_BINS; split++) {
+			Bin left, right;
+			for(int i = 0; i < split; i++) {
+				left.add(bins[i].bounds, bins[i].orientation, bins[i].energy, bins[i].count);
+			}
+			for(int i = split; i < LIGHT_TREE_NUM_BINS; i++) {
+				right.add(bins[i].bounds, bins[i].orientation, bins[i].energy, bins[i].count);
+			}
+			if(left.count == 0 || right.count == 0) {
+				continue;
+			}
+
+			const float cost = regularization * (left.cost() + right.cost());
+			if(cost < min_cost) {
+				min_cost = cost;
+				min_axis = axis;
+				min_bin = split;
+			}
+		}
+	}
+
+	if(min_axis == -1) {
+		return -1;
+	}
+
+	/* Partition primitives by bin. */
+	const float inv_extent = LIGHT_TREE_NUM_BINS / centroid_extent[min_axis];
+	int mid = start;
+	for(int i = start; i < end; i++) {
+		int bin = (int)((primitives[i].centroid()[min_axis] - centroid_bounds.min[min_axis]) * inv_extent);
+		bin = clamp(bin, 0, LIGHT_TREE_NUM_BINS - 1);
+		if(bin < min_bin) {
+			swap(primitives[i], primitives[mid]);
+			mid++;
+		}
+	}
+
+	return mid;
+}
+
+/* Fallback splitting at the median centroid along the largest axis. */
+struct LightTreeCentroidCompare {
+	int axis;
+
+	LightTreeCentroidCompare(int axis) : axis(axis) {}
+
+	bool operator()(const LightTreePrimitive& a, const LightTreePrimitive& b) const
+	{
+		return a.centroid()[axis] < b.centroid()[axis];
+	}
+};
+
+int LightTree::split_median(int start, int end, const BoundBox& centroid_bounds)
+{
+	const float3 centroid_extent = centroid_bounds.size();
+	int axis = 0;
+	if(centroid_extent.y > centroid_extent[axis]) axis = 1;
+	if(centroid_extent.z > centroid_extent[axis]) axis = 2;
+
+	const int mid = (start + end) / 2;
+	std::nth_element(primitives.begin() + start,
+	                 primitives.begin() + mid,
+	                 primitives.begin() + end,
+	                 LightTreeCentroidCompare(axis));
+
+	return mid;
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2011-2017 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "kernel/kernel_types.h"
+
+#include "util/util_boundbox.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Orientation bounds, a cone of emitter normals around axis with spread
+ * theta_o, where each emitter spreads light over theta_e. */
+
+struct LightTreeOrientation {
+	float3 axis;
+	float theta_o;
+	float theta_e;
+
+	LightTreeOrientation()
+	: axis(make_float3(0.0f, 0.0f, 1.0f)), theta_o(M_PI_F), theta_e(M_PI_2_F) {}
+	LightTreeOrientation(const float3& axis, float theta_o, float theta_e)
+	: axis(axis), theta_o(theta_o), theta_e(theta_e) {}
+
+	static LightTreeOrientation merge(const LightTreeOrientation& a,
+	                                  const LightTreeOrientation& b);
+
+	/* Measure of the solid angle the bounds emit into. */
+	float measure() const;
+};
+
+/* Emitter with a position in the scene, referencing the light distribution. */
+
+struct LightTreePrimitive {
+	BoundBox bounds;
+	LightTreeOrientation orientation;
+	float energy;
+	int distribution_index;
+
+	float3 centroid() const { return bounds.center(); }
+};
+
+/* Binary tree over the emitters, with a single emitter per leaf and nodes
+ * stored in depth first order. */
+
+class LightTree {
+public:
+	LightTree(const vector<LightTreePrimitive>& primitives);
+
+	const vector<KernelLightTreeNode>& get_nodes() const { return nodes; }
+
+protected:
+	int recursive_build(int parent, int start, int end, int depth);
+	int split_saoh(int start, int end, const BoundBox& bounds, const BoundBox& centroid_bounds);
+	int split_median(int start, int end, const BoundBox& centroid_bounds);
+
+	vector<LightTreePrimitive> primitives;
+	vector<KernelLightTreeNode> nodes;
+};
+
+CCL_NAMESPACE_END
+
+#endif  /* __LIGHT_TREE_H__ */
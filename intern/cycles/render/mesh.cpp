@@ -37,6 +37,7 @@
 #include "util/util_logging.h"
 #include "util/util_progress.h"
 #include "util/util_set.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -1030,6 +1031,18 @@ void Mesh::pack_patches(uint *patch_data, uint vert_offset, uint face_offset, ui
 	}
 }
 
+/* OSL trace() calls into scene_intersect() from services compiled without
+ * AVX2, so it can not traverse the octo BVH of the AVX2 kernel.
+ */
+static BVHLayout mesh_bvh_layout(const SceneParams *params, Device *device)
+{
+	BVHLayoutMask supported_layouts = device->info.bvh_layout_mask;
+	if(params->shadingsystem == SHADINGSYSTEM_OSL) {
+		supported_layouts &= ~BVH_LAYOUT_BVH8;
+	}
+	return BVHParams::best_bvh_layout(params->bvh_layout, supported_layouts);
+}
+
 void Mesh::compute_bvh(Device *device,
                        DeviceScene *dscene,
                        SceneParams *params,
@@ -1055,19 +1068,23 @@ void Mesh::compute_bvh(Device *device,
 		vector<Object*> objects;
 		objects.push_back(&object);
 
-		if(bvh && !need_update_rebuild) {
+		bool need_rebuild = (bvh == NULL || need_update_rebuild);
+
+		if(!need_rebuild) {
 			progress->set_status(msg, "Refitting BVH");
 			bvh->objects = objects;
-			bvh->refit(*progress);
+			if(!bvh->refit(*progress)) {
+				VLOG(1) << "Refitted BVH of mesh " << name << " degraded, rebuilding.";
+				need_rebuild = true;
+			}
 		}
-		else {
+
+		if(need_rebuild) {
 			progress->set_status(msg, "Building BVH");
 
 			BVHParams bparams;
 			bparams.use_spatial_split = params->use_bvh_spatial_split;
-			bparams.bvh_layout = BVHParams::best_bvh_layout(
-			        params->bvh_layout,
-			        device->info.bvh_layout_mask);
+			bparams.bvh_layout = mesh_bvh_layout(params, device);
 			bparams.use_unaligned_nodes = dscene->data.bvh.have_curves &&
 			                              params->use_bvh_unaligned_nodes;
 			bparams.num_motion_triangle_steps = params->num_bvh_time_steps;
@@ -1412,7 +1429,7 @@ static void update_attribute_element_size(Mesh *mesh,
 			*attr_float_size += size;
 		}
 		else if(mattr->type == TypeDesc::TypeMatrix) {
-			*attr_float3_size += size * 4;
+			*attr_float3_size += size * 3;
 		}
 		else {
 			*attr_float3_size += size;
@@ -1526,6 +1543,86 @@ static void update_attribute_element_offset(Mesh *mesh,
 	}
 }
 
+/* Split meshes into consecutive ranges with a similar number of elements,
+ * so scenes with many small meshes don't spend their time scheduling tasks. */
+static void mesh_task_ranges(const vector<Mesh*>& meshes, vector<size_t>& range_ends)
+{
+	const size_t min_range_elements = 65536;
+	size_t range_elements = 0;
+
+	for(size_t i = 0; i < meshes.size(); i++) {
+		Mesh *mesh = meshes[i];
+
+		range_elements += mesh->verts.size() +
+		                  mesh->num_triangles() +
+		                  mesh->curve_keys.size() +
+		                  mesh->num_curves() +
+		                  mesh->subd_faces.size();
+
+		if(range_elements >= min_range_elements || i == meshes.size() - 1) {
+			range_ends.push_back(i + 1);
+			range_elements = 0;
+		}
+	}
+}
+
+void MeshManager::device_update_attributes_range(DeviceScene *dscene,
+                                                 Scene *scene,
+                                                 vector<AttributeRequestSet> *mesh_attributes,
+                                                 const vector<MeshAttributeOffsets> *attr_offsets,
+                                                 size_t start,
+                                                 size_t end,
+                                                 Progress *progress)
+{
+	if(progress->get_cancel()) return;
+
+	for(size_t i = start; i < end; i++) {
+		Mesh *mesh = scene->meshes[i];
+		AttributeRequestSet& attributes = (*mesh_attributes)[i];
+
+		size_t attr_float_offset = (*attr_offsets)[i].float_offset;
+		size_t attr_float3_offset = (*attr_offsets)[i].float3_offset;
+		size_t attr_uchar4_offset = (*attr_offsets)[i].uchar4_offset;
+
+		/* todo: we now store std and name attributes from requests even if
+		 * they actually refer to the same mesh attributes, optimize */
+		foreach(AttributeRequest& req, attributes.requests) {
+			Attribute *triangle_mattr = mesh->attributes.find(req);
+			Attribute *curve_mattr = mesh->curve_attributes.find(req);
+			Attribute *subd_mattr = mesh->subd_attributes.find(req);
+
+			update_attribute_element_offset(mesh,
+			                                dscene->attributes_float, attr_float_offset,
+			                                dscene->attributes_float3, attr_float3_offset,
+			                                dscene->attributes_uchar4, attr_uchar4_offset,
+			                                triangle_mattr,
+			                                ATTR_PRIM_TRIANGLE,
+			                                req.triangle_type,
+			                                req.triangle_desc);
+
+			update_attribute_element_offset(mesh,
+			                                dscene->attributes_float, attr_float_offset,
+			                                dscene->attributes_float3, attr_float3_offset,
+			                                dscene->attributes_uchar4, attr_uchar4_offset,
+			                                curve_mattr,
+			                                ATTR_PRIM_CURVE,
+			                                req.curve_type,
+			                                req.curve_desc);
+
+			update_attribute_element_offset(mesh,
+			                                dscene->attributes_float, attr_float_offset,
+			                                dscene->attributes_float3, attr_float3_offset,
+			                                dscene->attributes_uchar4, attr_uchar4_offset,
+			                                subd_mattr,
+			                                ATTR_PRIM_SUBD,
+			                                req.subd_type,
+			                                req.subd_desc);
+		}
+
+		if(progress->get_cancel()) return;
+	}
+}
+
 void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
 {
 	progress.set_status("Updating Mesh", "Computing attributes");
@@ -1555,9 +1652,19 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 	size_t attr_float_size = 0;
 	size_t attr_float3_size = 0;
 	size_t attr_uchar4_size = 0;
+
+	/* Offsets of the first attribute of every mesh, so meshes can be filled
+	 * in independently of each other. */
+	vector<MeshAttributeOffsets> attr_offsets(scene->meshes.size());
+
 	for(size_t i = 0; i < scene->meshes.size(); i++) {
 		Mesh *mesh = scene->meshes[i];
 		AttributeRequestSet& attributes = mesh_attributes[i];
+
+		attr_offsets[i].float_offset = attr_float_size;
+		attr_offsets[i].float3_offset = attr_float3_size;
+		attr_offsets[i].uchar4_offset = attr_uchar4_size;
+
 		foreach(AttributeRequest& req, attributes.requests) {
 			Attribute *triangle_mattr = mesh->attributes.find(req);
 			Attribute *curve_mattr = mesh->curve_attributes.find(req);
@@ -1588,52 +1695,27 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 	dscene->attributes_float3.alloc(attr_float3_size);
 	dscene->attributes_uchar4.alloc(attr_uchar4_size);
 
-	size_t attr_float_offset = 0;
-	size_t attr_float3_offset = 0;
-	size_t attr_uchar4_offset = 0;
-
-	/* Fill in attributes. */
-	for(size_t i = 0; i < scene->meshes.size(); i++) {
-		Mesh *mesh = scene->meshes[i];
-		AttributeRequestSet& attributes = mesh_attributes[i];
-
-		/* todo: we now store std and name attributes from requests even if
-		 * they actually refer to the same mesh attributes, optimize */
-		foreach(AttributeRequest& req, attributes.requests) {
-			Attribute *triangle_mattr = mesh->attributes.find(req);
-			Attribute *curve_mattr = mesh->curve_attributes.find(req);
-			Attribute *subd_mattr = mesh->subd_attributes.find(req);
-
-			update_attribute_element_offset(mesh,
-			                                dscene->attributes_float, attr_float_offset,
-			                                dscene->attributes_float3, attr_float3_offset,
-			                                dscene->attributes_uchar4, attr_uchar4_offset,
-			                                triangle_mattr,
-			                                ATTR_PRIM_TRIANGLE,
-			                                req.triangle_type,
-			                                req.triangle_desc);
-
-			update_attribute_element_offset(mesh,
-			                                dscene->attributes_float, attr_float_offset,
-			                                dscene->attributes_float3, attr_float3_offset,
-			                                dscene->attributes_uchar4, attr_uchar4_offset,
-			                                curve_mattr,
-			                                ATTR_PRIM_CURVE,
-			                                req.curve_type,
-			                                req.curve_desc);
-
-			update_attribute_element_offset(mesh,
-			                                dscene->attributes_float, attr_float_offset,
-			                                dscene->attributes_float3, attr_float3_offset,
-			                                dscene->attributes_uchar4, attr_uchar4_offset,
-			                                subd_mattr,
-			                                ATTR_PRIM_SUBD,
-			                                req.subd_type,
-			                                req.subd_desc);
+	/* Fill in attributes, in parallel for ranges of meshes. */
+	vector<size_t> range_ends;
+	mesh_task_ranges(scene->meshes, range_ends);
 
-			if(progress.get_cancel()) return;
-		}
+	TaskPool pool;
+	size_t range_start = 0;
+	foreach(size_t range_end, range_ends) {
+		pool.push(function_bind(&MeshManager::device_update_attributes_range,
+		                        this,
+		                        dscene,
+		                        scene,
+		                        &mesh_attributes,
+		                        &attr_offsets,
+		                        range_start,
+		                        range_end,
+		                        &progress));
+		range_start = range_end;
 	}
+	pool.wait_work();
+
+	if(progress.get_cancel()) return;
 
 	/* create attribute lookup maps */
 	if(scene->shader_manager->use_osl())
@@ -1763,31 +1845,57 @@ void MeshManager::device_update_mesh(Device *,
 		}
 	}
 
-	/* Fill in all the arrays. */
+	/* Allocate all the arrays. */
 	if(tri_size != 0) {
-		/* normals */
-		progress.set_status("Updating Mesh", "Computing normals");
+		dscene->tri_shader.alloc(tri_size);
+		dscene->tri_vnormal.alloc(vert_size);
+		dscene->tri_vindex.alloc(tri_size);
+		dscene->tri_patch.alloc(tri_size);
+		dscene->tri_patch_uv.alloc(vert_size);
+	}
+	if(curve_size != 0) {
+		dscene->curve_keys.alloc(curve_key_size);
+		dscene->curves.alloc(curve_size);
+	}
+	if(patch_size != 0) {
+		dscene->patches.alloc(patch_size);
+	}
+	if(for_displacement) {
+		dscene->prim_tri_verts.alloc(tri_size * 3);
+	}
 
-		uint *tri_shader = dscene->tri_shader.alloc(tri_size);
-		float4 *vnormal = dscene->tri_vnormal.alloc(vert_size);
-		uint4 *tri_vindex = dscene->tri_vindex.alloc(tri_size);
-		uint *tri_patch = dscene->tri_patch.alloc(tri_size);
-		float2 *tri_patch_uv = dscene->tri_patch_uv.alloc(vert_size);
+	/* Fill in all the arrays, in parallel for ranges of meshes. Every mesh
+	 * writes to its own part of the arrays, using the offsets computed in
+	 * mesh_calc_offset(). */
+	progress.set_status("Updating Mesh", "Packing meshes");
 
-		foreach(Mesh *mesh, scene->meshes) {
-			mesh->pack_shaders(scene,
-			                   &tri_shader[mesh->tri_offset]);
-			mesh->pack_normals(&vnormal[mesh->vert_offset]);
-			mesh->pack_verts(tri_prim_index,
-			                 &tri_vindex[mesh->tri_offset],
-			                 &tri_patch[mesh->tri_offset],
-			                 &tri_patch_uv[mesh->vert_offset],
-			                 mesh->vert_offset,
-			                 mesh->tri_offset);
-			if(progress.get_cancel()) return;
-		}
+	vector<size_t> range_ends;
+	mesh_task_ranges(scene->meshes, range_ends);
+
+	TaskPool pool;
+	size_t range_start = 0;
+	foreach(size_t range_end, range_ends) {
+		pool.push(function_bind(&MeshManager::device_update_mesh_range,
+		                        this,
+		                        dscene,
+		                        scene,
+		                        &tri_prim_index,
+		                        for_displacement,
+		                        range_start,
+		                        range_end,
+		                        &progress));
+		range_start = range_end;
+	}
+
+	TaskPool::Summary summary;
+	pool.wait_work(&summary);
+	VLOG(3) << "Mesh packing pool statistics:\n"
+	        << summary.full_report();
+
+	if(progress.get_cancel()) return;
 
-		/* vertex coordinates */
+	/* Copy to device. */
+	if(tri_size != 0) {
 		progress.set_status("Updating Mesh", "Copying Mesh to device");
 
 		dscene->tri_shader.copy_to_device();
@@ -1800,14 +1908,6 @@ void MeshManager::device_update_mesh(Device *,
 	if(curve_size != 0) {
 		progress.set_status("Updating Mesh", "Copying Strands to device");
 
-		float4 *curve_keys = dscene->curve_keys.alloc(curve_key_size);
-		float4 *curves = dscene->curves.alloc(curve_size);
-
-		foreach(Mesh *mesh, scene->meshes) {
-			mesh->pack_curves(scene, &curve_keys[mesh->curvekey_offset], &curves[mesh->curve_offset], mesh->curvekey_offset);
-			if(progress.get_cancel()) return;
-		}
-
 		dscene->curve_keys.copy_to_device();
 		dscene->curves.copy_to_device();
 	}
@@ -1815,33 +1915,81 @@ void MeshManager::device_update_mesh(Device *,
 	if(patch_size != 0) {
 		progress.set_status("Updating Mesh", "Copying Patches to device");
 
-		uint *patch_data = dscene->patches.alloc(patch_size);
+		dscene->patches.copy_to_device();
+	}
 
-		foreach(Mesh *mesh, scene->meshes) {
+	if(for_displacement) {
+		dscene->prim_tri_verts.copy_to_device();
+	}
+}
+
+void MeshManager::device_update_mesh_range(DeviceScene *dscene,
+                                           Scene *scene,
+                                           const vector<uint> *tri_prim_index,
+                                           bool for_displacement,
+                                           size_t start,
+                                           size_t end,
+                                           Progress *progress)
+{
+	if(progress->get_cancel()) return;
+
+	progress->set_status("Updating Mesh",
+	                     string_printf("Packing meshes %u/%u",
+	                                   (uint)end,
+	                                   (uint)scene->meshes.size()));
+
+	/* tri_prim_index is sized to the total number of triangles, so it is
+	 * empty when there are no triangle arrays to fill. */
+	const bool pack_triangles = !tri_prim_index->empty();
+
+	uint *tri_shader = dscene->tri_shader.data();
+	float4 *vnormal = dscene->tri_vnormal.data();
+	uint4 *tri_vindex = dscene->tri_vindex.data();
+	uint *tri_patch = dscene->tri_patch.data();
+	float2 *tri_patch_uv = dscene->tri_patch_uv.data();
+	float4 *curve_keys = dscene->curve_keys.data();
+	float4 *curves = dscene->curves.data();
+	uint *patch_data = dscene->patches.data();
+	float4 *prim_tri_verts = dscene->prim_tri_verts.data();
+
+	for(size_t i = start; i < end; i++) {
+		Mesh *mesh = scene->meshes[i];
+
+		if(pack_triangles) {
+			mesh->pack_shaders(scene,
+			                   &tri_shader[mesh->tri_offset]);
+			mesh->pack_normals(&vnormal[mesh->vert_offset]);
+			mesh->pack_verts(*tri_prim_index,
+			                 &tri_vindex[mesh->tri_offset],
+			                 &tri_patch[mesh->tri_offset],
+			                 &tri_patch_uv[mesh->vert_offset],
+			                 mesh->vert_offset,
+			                 mesh->tri_offset);
+		}
+
+		if(mesh->num_curves() != 0) {
+			mesh->pack_curves(scene, &curve_keys[mesh->curvekey_offset], &curves[mesh->curve_offset], mesh->curvekey_offset);
+		}
+
+		if(mesh->subd_faces.size() != 0) {
 			mesh->pack_patches(&patch_data[mesh->patch_offset], mesh->vert_offset, mesh->face_offset, mesh->corner_offset);
 
 			if(mesh->patch_table) {
 				mesh->patch_table->copy_adjusting_offsets(&patch_data[mesh->patch_table_offset], mesh->patch_table_offset);
 			}
-
-			if(progress.get_cancel()) return;
 		}
 
-		dscene->patches.copy_to_device();
-	}
-
-	if(for_displacement) {
-		float4 *prim_tri_verts = dscene->prim_tri_verts.alloc(tri_size * 3);
-		foreach(Mesh *mesh, scene->meshes) {
-			for(size_t i = 0; i < mesh->num_triangles(); ++i) {
-				Mesh::Triangle t = mesh->get_triangle(i);
-				size_t offset = 3 * (i + mesh->tri_offset);
+		if(for_displacement) {
+			for(size_t j = 0; j < mesh->num_triangles(); ++j) {
+				Mesh::Triangle t = mesh->get_triangle(j);
+				size_t offset = 3 * (j + mesh->tri_offset);
 				prim_tri_verts[offset + 0] = float3_to_float4(mesh->verts[t.v[0]]);
 				prim_tri_verts[offset + 1] = float3_to_float4(mesh->verts[t.v[1]]);
 				prim_tri_verts[offset + 2] = float3_to_float4(mesh->verts[t.v[2]]);
 			}
 		}
-		dscene->prim_tri_verts.copy_to_device();
+
+		if(progress->get_cancel()) return;
 	}
 }
 
@@ -1852,9 +2000,7 @@ void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *
 
 	BVHParams bparams;
 	bparams.top_level = true;
-	bparams.bvh_layout = BVHParams::best_bvh_layout(
-	        scene->params.bvh_layout,
-	        device->info.bvh_layout_mask);
+	bparams.bvh_layout = mesh_bvh_layout(&scene->params, device);
 	bparams.use_spatial_split = scene->params.use_bvh_spatial_split;
 	bparams.use_unaligned_nodes = dscene->data.bvh.have_curves &&
 	                              scene->params.use_bvh_unaligned_nodes;
@@ -2144,7 +2290,11 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 	}
 	if(progress.get_cancel()) return;
 
-	device_update_attributes(device, dscene, scene, progress);
+	{
+		scoped_timer timer;
+		device_update_attributes(device, dscene, scene, progress);
+		VLOG(1) << "Mesh attributes updated in " << timer.get_time() << " seconds.";
+	}
 	if(progress.get_cancel()) return;
 
 	/* Update displacement. */
@@ -2213,10 +2363,18 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 
 	if(progress.get_cancel()) return;
 
-	device_update_bvh(device, dscene, scene, progress);
+	{
+		scoped_timer timer;
+		device_update_bvh(device, dscene, scene, progress);
+		scene->update_times.bvh += timer.get_time();
+	}
 	if(progress.get_cancel()) return;
 
-	device_update_mesh(device, dscene, scene, false, progress);
+	{
+		scoped_timer timer;
+		device_update_mesh(device, dscene, scene, false, progress);
+		VLOG(1) << "Mesh arrays updated in " << timer.get_time() << " seconds.";
+	}
 	if(progress.get_cancel()) return;
 
 	need_update = false;
@@ -328,6 +328,13 @@ public:
 
 /* Mesh Manager */
 
+/* Start of the attributes of a mesh in the global attribute arrays. */
+struct MeshAttributeOffsets {
+	size_t float_offset;
+	size_t float3_offset;
+	size_t uchar4_offset;
+};
+
 class MeshManager {
 public:
 	bool need_update;
@@ -366,11 +373,29 @@ protected:
 	                        bool for_displacement,
 	                        Progress& progress);
 
+	/* Pack meshes in the range [start, end), run from a task pool. */
+	void device_update_mesh_range(DeviceScene *dscene,
+	                              Scene *scene,
+	                              const vector<uint> *tri_prim_index,
+	                              bool for_displacement,
+	                              size_t start,
+	                              size_t end,
+	                              Progress *progress);
+
 	void device_update_attributes(Device *device,
 	                              DeviceScene *dscene,
 	                              Scene *scene,
 	                              Progress& progress);
 
+	/* Fill attributes of meshes in the range [start, end), run from a task pool. */
+	void device_update_attributes_range(DeviceScene *dscene,
+	                                    Scene *scene,
+	                                    vector<AttributeRequestSet> *mesh_attributes,
+	                                    const vector<MeshAttributeOffsets> *attr_offsets,
+	                                    size_t start,
+	                                    size_t end,
+	                                    Progress *progress);
+
 	void device_update_bvh(Device *device,
 	                       DeviceScene *dscene,
 	                       Scene *scene,
@@ -21,6 +21,7 @@
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_texture.h"
 #include "util/util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -396,6 +397,37 @@ void VolumeMeshBuilder::convert_quads_to_tris(const vector<QuadData> &quads,
 struct VoxelAttributeGrid {
 	float *data;
 	int channels;
+
+	/* Sparse grids are stored in tiles, see util_texture.h. */
+	bool is_sparse;
+	int3 tiles;
+	int empty_tile;
+
+	/* Index of the tile in the sparse grid. */
+	int tile_index(int tx, int ty, int tz) const
+	{
+		return tx + tiles.x*(ty + tiles.y*tz);
+	}
+
+	bool tile_is_empty(int tx, int ty, int tz) const
+	{
+		return is_sparse && ((const int*)data)[tile_index(tx, ty, tz)] == empty_tile;
+	}
+
+	const float *voxel(const int3& resolution, int x, int y, int z) const
+	{
+		if(is_sparse) {
+			const int tile = tile_index(x >> TEX_SPARSE_TILE_SHIFT,
+			                            y >> TEX_SPARSE_TILE_SHIFT,
+			                            z >> TEX_SPARSE_TILE_SHIFT);
+			const size_t offset = (size_t)((const int*)data)[tile] * TEX_SPARSE_TILE_VOXELS +
+			                      (x & TEX_SPARSE_TILE_MASK) +
+			                      ((y & TEX_SPARSE_TILE_MASK) << TEX_SPARSE_TILE_SHIFT) +
+			                      ((z & TEX_SPARSE_TILE_MASK) << (2 * TEX_SPARSE_TILE_SHIFT));
+			return data + offset * channels;
+		}
+		return data + compute_voxel_index(resolution, x, y, z) * channels;
+	}
 };
 
 void MeshManager::create_volume_mesh(Scene *scene,
@@ -430,9 +462,20 @@ void MeshManager::create_volume_mesh(Scene *scene,
 			return;
 		}
 
+		ImageDataType type = (ImageDataType)kernel_tex_type(voxel->slot);
+
 		VoxelAttributeGrid voxel_grid;
 		voxel_grid.data = static_cast<float*>(image_memory->host_pointer);
 		voxel_grid.channels = image_memory->data_elements;
+		voxel_grid.is_sparse = (type == IMAGE_DATA_TYPE_FLOAT4_SPARSE ||
+		                        type == IMAGE_DATA_TYPE_FLOAT_SPARSE);
+		voxel_grid.tiles = make_int3(divide_up(resolution.x, TEX_SPARSE_TILE_SIZE),
+		                             divide_up(resolution.y, TEX_SPARSE_TILE_SIZE),
+		                             divide_up(resolution.z, TEX_SPARSE_TILE_SIZE));
+		/* The empty tile follows the tile offsets. */
+		const size_t num_tiles = voxel_grid.tiles.x * voxel_grid.tiles.y * voxel_grid.tiles.z;
+		voxel_grid.empty_tile = divide_up(num_tiles * sizeof(int),
+		                                  TEX_SPARSE_TILE_VOXELS * voxel_grid.channels * sizeof(float));
 		voxel_grids.push_back(voxel_grid);
 	}
 
@@ -488,19 +531,44 @@ void MeshManager::create_volume_mesh(Scene *scene,
 	VolumeMeshBuilder builder(&volume_params);
 	const float isovalue = mesh->volume_isovalue;
 
-	for(int z = 0; z < resolution.z; ++z) {
-		for(int y = 0; y < resolution.y; ++y) {
-			for(int x = 0; x < resolution.x; ++x) {
-				size_t voxel_index = compute_voxel_index(resolution, x, y, z);
-
-				for(size_t i = 0; i < voxel_grids.size(); ++i) {
-					const VoxelAttributeGrid &voxel_grid = voxel_grids[i];
-					const int channels = voxel_grid.channels;
+	/* Visit voxels tile by tile, so that tiles which are empty in all sparse
+	 * grids can be skipped without looking at their voxels. Rays then only
+	 * march through the space around used tiles. */
+	const int3 tiles = make_int3(divide_up(resolution.x, TEX_SPARSE_TILE_SIZE),
+	                             divide_up(resolution.y, TEX_SPARSE_TILE_SIZE),
+	                             divide_up(resolution.z, TEX_SPARSE_TILE_SIZE));
+
+	for(int tz = 0; tz < tiles.z; ++tz) {
+		for(int ty = 0; ty < tiles.y; ++ty) {
+			for(int tx = 0; tx < tiles.x; ++tx) {
+				if(isovalue > 0.0f) {
+					bool is_empty = true;
+					for(size_t i = 0; i < voxel_grids.size() && is_empty; ++i) {
+						is_empty = voxel_grids[i].tile_is_empty(tx, ty, tz);
+					}
+					if(is_empty) {
+						continue;
+					}
+				}
 
-					for(int c = 0; c < channels; c++) {
-						if(voxel_grid.data[voxel_index * channels + c] >= isovalue) {
-							builder.add_node_with_padding(x, y, z);
-							break;
+				const int x_end = min((tx + 1) * TEX_SPARSE_TILE_SIZE, resolution.x);
+				const int y_end = min((ty + 1) * TEX_SPARSE_TILE_SIZE, resolution.y);
+				const int z_end = min((tz + 1) * TEX_SPARSE_TILE_SIZE, resolution.z);
+
+				for(int z = tz * TEX_SPARSE_TILE_SIZE; z < z_end; ++z) {
+					for(int y = ty * TEX_SPARSE_TILE_SIZE; y < y_end; ++y) {
+						for(int x = tx * TEX_SPARSE_TILE_SIZE; x < x_end; ++x) {
+							for(size_t i = 0; i < voxel_grids.size(); ++i) {
+								const VoxelAttributeGrid &voxel_grid = voxel_grids[i];
+								const float *voxel = voxel_grid.voxel(resolution, x, y, z);
+
+								for(int c = 0; c < voxel_grid.channels; c++) {
+									if(voxel[c] >= isovalue) {
+										builder.add_node_with_padding(x, y, z);
+										break;
+									}
+								}
+							}
 						}
 					}
 				}
@@ -799,13 +799,22 @@ void ObjectManager::apply_static_transforms(DeviceScene *dscene, Scene *scene, P
 
 	/* apply transforms for objects with single user meshes */
 	foreach(Object *object, scene->objects) {
+		/* With persistent data, meshes which deform with unchanged topology
+		 * keep their own BVH, so it is refitted on following frames instead
+		 * of being rebuilt as part of the scene BVH. */
+		const Mesh *mesh = object->mesh;
+		const bool refit_bvh = scene->params.persistent_data &&
+		                       (mesh->bvh != NULL ||
+		                        (mesh->need_update && !mesh->need_update_rebuild));
+
 		/* Annoying feedback loop here: we can't use is_instanced() because
 		 * it'll use uninitialized transform_applied flag.
 		 *
 		 * Could be solved by moving reference counter to Mesh.
 		 */
 		if((mesh_users[object->mesh] == 1 && !object->mesh->has_surface_bssrdf) &&
-		   !object->mesh->has_true_displacement() && object->mesh->subdivision_type == Mesh::SUBDIVISION_NONE)
+		   !object->mesh->has_true_displacement() && object->mesh->subdivision_type == Mesh::SUBDIVISION_NONE &&
+		   !refit_bvh)
 		{
 			if(!(motion_blur && object->use_motion())) {
 				if(!object->mesh->transform_applied) {
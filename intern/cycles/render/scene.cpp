@@ -37,6 +37,7 @@
 #include "util/util_guarded_allocator.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -69,6 +70,8 @@ DeviceScene::DeviceScene(Device *device)
   attributes_float3(device, "__attributes_float3", MEM_TEXTURE),
   attributes_uchar4(device, "__attributes_uchar4", MEM_TEXTURE),
   light_distribution(device, "__light_distribution", MEM_TEXTURE),
+  light_tree_nodes(device, "__light_tree_nodes", MEM_TEXTURE),
+  light_tree_leaf(device, "__light_tree_leaf", MEM_TEXTURE),
   lights(device, "__lights", MEM_TEXTURE),
   light_background_marginal_cdf(device, "__light_background_marginal_cdf", MEM_TEXTURE),
   light_background_conditional_cdf(device, "__light_background_conditional_cdf", MEM_TEXTURE),
@@ -180,6 +183,8 @@ void Scene::device_update(Device *device_, Progress& progress)
 
 	bool print_stats = need_data_update();
 
+	scoped_timer total_timer;
+
 	/* The order of updates is important, because there's dependencies between
 	 * the different managers, using data computed by previous managers.
 	 *
@@ -192,7 +197,11 @@ void Scene::device_update(Device *device_, Progress& progress)
 	 */
 
 	progress.set_status("Updating Shaders");
-	shader_manager->device_update(device, &dscene, this, progress);
+	{
+		scoped_timer timer;
+		shader_manager->device_update(device, &dscene, this, progress);
+		update_times.shaders += timer.get_time();
+	}
 
 	if(progress.get_cancel() || device->have_error()) return;
 
@@ -211,7 +220,11 @@ void Scene::device_update(Device *device_, Progress& progress)
 	if(progress.get_cancel() || device->have_error()) return;
 
 	progress.set_status("Updating Objects");
-	object_manager->device_update(device, &dscene, this, progress);
+	{
+		scoped_timer timer;
+		object_manager->device_update(device, &dscene, this, progress);
+		update_times.objects += timer.get_time();
+	}
 
 	if(progress.get_cancel() || device->have_error()) return;
 
@@ -221,7 +234,11 @@ void Scene::device_update(Device *device_, Progress& progress)
 	if(progress.get_cancel() || device->have_error()) return;
 
 	progress.set_status("Updating Meshes");
-	mesh_manager->device_update(device, &dscene, this, progress);
+	{
+		scoped_timer timer;
+		mesh_manager->device_update(device, &dscene, this, progress);
+		update_times.meshes += timer.get_time();
+	}
 
 	if(progress.get_cancel() || device->have_error()) return;
 
@@ -231,7 +248,11 @@ void Scene::device_update(Device *device_, Progress& progress)
 	if(progress.get_cancel() || device->have_error()) return;
 
 	progress.set_status("Updating Images");
-	image_manager->device_update(device, this, progress);
+	{
+		scoped_timer timer;
+		image_manager->device_update(device, this, progress);
+		update_times.images += timer.get_time();
+	}
 
 	if(progress.get_cancel() || device->have_error()) return;
 
@@ -251,7 +272,11 @@ void Scene::device_update(Device *device_, Progress& progress)
 	if(progress.get_cancel() || device->have_error()) return;
 
 	progress.set_status("Updating Lights");
-	light_manager->device_update(device, &dscene, this, progress);
+	{
+		scoped_timer timer;
+		light_manager->device_update(device, &dscene, this, progress);
+		update_times.lights += timer.get_time();
+	}
 
 	if(progress.get_cancel() || device->have_error()) return;
 
@@ -280,6 +305,8 @@ void Scene::device_update(Device *device_, Progress& progress)
 		device->const_copy_to("__data", &dscene.data, sizeof(dscene.data));
 	}
 
+	update_times.total += total_timer.get_time();
+
 	if(print_stats) {
 		size_t mem_used = util_guarded_get_mem_used();
 		size_t mem_peak = util_guarded_get_mem_peak();
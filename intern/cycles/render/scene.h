@@ -102,6 +102,8 @@ public:
 
 	/* lights */
 	device_vector<KernelLightDistribution> light_distribution;
+	device_vector<KernelLightTreeNode> light_tree_nodes;
+	device_vector<int> light_tree_leaf;
 	device_vector<KernelLight> lights;
 	device_vector<float2> light_background_marginal_cdf;
 	device_vector<float2> light_background_conditional_cdf;
@@ -166,6 +168,12 @@ public:
 	bool persistent_data;
 	int texture_limit;
 
+	/* Sample image files on the CPU through a tiled, mip-mapped texture
+	 * cache of limited size instead of loading them fully. */
+	bool use_texture_cache;
+	int texture_cache_size;
+	bool texture_auto_convert;
+
 	SceneParams()
 	{
 		shadingsystem = SHADINGSYSTEM_SVM;
@@ -176,6 +184,9 @@ public:
 		num_bvh_time_steps = 0;
 		persistent_data = false;
 		texture_limit = 0;
+		use_texture_cache = false;
+		texture_cache_size = 1024;
+		texture_auto_convert = false;
 	}
 
 	bool modified(const SceneParams& params)
@@ -186,7 +197,31 @@ public:
 		&& use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes
 		&& num_bvh_time_steps == params.num_bvh_time_steps
 		&& persistent_data == params.persistent_data
-		&& texture_limit == params.texture_limit); }
+		&& texture_limit == params.texture_limit
+		&& use_texture_cache == params.use_texture_cache
+		&& texture_cache_size == params.texture_cache_size
+		&& texture_auto_convert == params.texture_auto_convert); }
+};
+
+/* Time in seconds spent in the phases of Scene::device_update, accumulated
+ * over all updates since the last reset. The BVH build is part of the mesh
+ * update and is included in its time. */
+
+struct SceneUpdateTimes {
+	double total;
+	double shaders;
+	double objects;
+	double meshes;
+	double bvh;
+	double images;
+	double lights;
+
+	SceneUpdateTimes() { reset(); }
+
+	void reset()
+	{
+		total = shaders = objects = meshes = bvh = images = lights = 0.0;
+	}
 };
 
 /* Scene */
@@ -231,6 +266,9 @@ public:
 	/* parameters */
 	SceneParams params;
 
+	/* statistics */
+	SceneUpdateTimes update_times;
+
 	/* mutex must be locked manually by callers */
 	thread_mutex mutex;
 
@@ -375,6 +375,7 @@ bool Session::acquire_tile(Device *tile_device, RenderTile& rtile)
 	rtile.resolution = tile_manager.state.resolution_divider;
 	rtile.tile_index = tile->index;
 	rtile.task = (tile->state == Tile::DENOISE)? RenderTile::DENOISE: RenderTile::PATH_TRACE;
+	rtile.start_time = time_dt();
 
 	tile_lock.unlock();
 
@@ -438,7 +439,8 @@ void Session::release_tile(RenderTile& rtile)
 {
 	thread_scoped_lock tile_lock(tile_mutex);
 
-	progress.add_finished_tile(rtile.task == RenderTile::DENOISE);
+	progress.add_finished_tile(rtile.task == RenderTile::DENOISE,
+	                           time_dt() - rtile.start_time);
 
 	bool delete_tile;
 
@@ -45,5 +45,10 @@ size_t util_guarded_get_mem_peak(void)
 	return global_stats.mem_peak;
 }
 
+void util_guarded_reset_mem_peak(void)
+{
+	global_stats.mem_peak = global_stats.mem_used;
+}
+
 
 CCL_NAMESPACE_END
@@ -161,6 +161,9 @@ public:
 size_t util_guarded_get_mem_used(void);
 size_t util_guarded_get_mem_peak(void);
 
+/* Reset the peak to the current usage, to measure the peak of a single task. */
+void util_guarded_reset_mem_peak(void);
+
 /* Call given function and keep track if it runs out of memory.
  *
  * If it does run out f memory, stop execution and set progress
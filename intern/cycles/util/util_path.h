@@ -64,6 +64,8 @@ bool path_read_text(const string& path, string& text);
 
 /* File manipulation. */
 bool path_remove(const string& path);
+/* Replaces an existing file at the destination. */
+bool path_rename(const string& old_path, const string& new_path);
 
 /* source code utility */
 string path_source_replace_includes(const string& source,
@@ -53,6 +53,8 @@ typedef enum ImageDataType {
 	IMAGE_DATA_TYPE_FLOAT = 3,
 	IMAGE_DATA_TYPE_BYTE = 4,
 	IMAGE_DATA_TYPE_HALF = 5,
+	IMAGE_DATA_TYPE_FLOAT4_SPARSE = 6,
+	IMAGE_DATA_TYPE_FLOAT_SPARSE = 7,
 
 	IMAGE_DATA_NUM_TYPES
 } ImageDataType;
@@ -60,6 +62,15 @@ typedef enum ImageDataType {
 #define IMAGE_DATA_TYPE_SHIFT 3
 #define IMAGE_DATA_TYPE_MASK 0x7
 
+/* Sparse 3D textures are split into tiles of TEX_SPARSE_TILE_SIZE^3 voxels.
+ * The data starts with an int per tile giving the index of the tile in the
+ * same array, padded to a whole number of tiles. All empty tiles point to a
+ * single tile filled with zeros, so lookups never need to branch. */
+#define TEX_SPARSE_TILE_SHIFT 3
+#define TEX_SPARSE_TILE_SIZE (1 << TEX_SPARSE_TILE_SHIFT)
+#define TEX_SPARSE_TILE_MASK (TEX_SPARSE_TILE_SIZE - 1)
+#define TEX_SPARSE_TILE_VOXELS (TEX_SPARSE_TILE_SIZE * TEX_SPARSE_TILE_SIZE * TEX_SPARSE_TILE_SIZE)
+
 /* Extension types for textures.
  *
  * Defines how the image is extrapolated past its original bounds. */
@@ -85,6 +96,23 @@ typedef struct TextureInfo {
 	uint width, height, depth;
 } TextureInfo;
 
+#ifndef __KERNEL_GPU__
+/* On the CPU device image textures can be sampled through a texture cache on
+ * the host instead of being loaded into memory. The lookup returns false for
+ * slots that are not in the cache, these use the regular texture info. */
+typedef bool (*TextureCacheLookupFunction)(void *data,
+                                           int flat_slot,
+                                           float s, float t,
+                                           float dsdx, float dtdx,
+                                           float dsdy, float dtdy,
+                                           float4 *result);
+
+typedef struct TextureCacheGlobals {
+	TextureCacheLookupFunction lookup;
+	void *data;
+} TextureCacheGlobals;
+#endif
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_TEXTURE_H__ */
@@ -427,7 +427,13 @@ class NODE_PT_quality(bpy.types.Panel):
         col.prop(tree, "use_opencl")
         col.prop(tree, "use_groupnode_buffer")
         col.prop(tree, "use_two_pass")
+        col.prop(tree, "use_full_frame")
+        col.prop(tree, "use_result_cache")
+        sub = col.column()
+        sub.active = tree.use_result_cache
+        sub.prop(tree, "cache_size")
         col.prop(tree, "use_viewer_border")
+        col.prop(tree, "use_profiling")
 
 
 class NODE_UL_interface_sockets(bpy.types.UIList):
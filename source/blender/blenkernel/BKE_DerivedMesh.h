@@ -741,6 +741,9 @@ void makeDerivedMesh(
         struct Scene *scene, struct Object *ob, struct BMEditMesh *em,
         CustomDataMask dataMask, const bool build_shapekey_layers);
 
+/* Free results of modifiers cached across evaluations. */
+void DM_modifier_stack_cache_free(void);
+
 void weight_to_rgb(float r_rgb[3], const float weight);
 /** Update the weight MCOL preview layer.
  * If weights are NULL, use object's active vgroup(s).
@@ -36,7 +36,8 @@ struct MemFileUndoData;
 #define BKE_UNDO_STR_MAX 64
 
 struct MemFileUndoData *BKE_memfile_undo_encode(struct Main *bmain, struct MemFileUndoData *mfu_prev);
-bool                    BKE_memfile_undo_decode(struct MemFileUndoData *mfu, struct bContext *C);
+bool                    BKE_memfile_undo_decode(
+        struct MemFileUndoData *mfu, const struct MemFileUndoData *mfu_current, struct bContext *C);
 void                    BKE_memfile_undo_free(struct MemFileUndoData *mfu);
 
 #ifdef __cplusplus
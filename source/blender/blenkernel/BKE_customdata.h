@@ -353,6 +353,35 @@ void CustomData_to_bmesh_block(const struct CustomData *source,
 void CustomData_from_bmesh_block(const struct CustomData *source, 
                                  struct CustomData *dest, void *src_block, int dest_index);
 
+/* layer maps for converting many elements between mesh layers and editmesh
+ * blocks, layer matching and type lookups are done once at initialization.
+ * Only meant for a single Mesh <-> BMesh conversion: the map stores layer arrays
+ * and block offsets, so it's invalid once layers of either CustomData change.
+ * Editmesh custom data keeps its per-element block storage. */
+typedef struct CustomDataBMeshCopyLayer {
+	void *array;  /* mesh layer data, NULL to set the editmesh layer to its default */
+	int offset;   /* offset of the layer in the editmesh block */
+	int size;
+	cd_copy copy;
+	void (*set_default)(void *data, int count);
+} CustomDataBMeshCopyLayer;
+
+typedef struct CustomDataBMeshCopyMap {
+	CustomDataBMeshCopyLayer *layers;
+	int totlayer;
+} CustomDataBMeshCopyMap;
+
+void CustomData_bmesh_copy_map_init_to_bmesh(
+        CustomDataBMeshCopyMap *map, const struct CustomData *source, const struct CustomData *dest,
+        bool use_default_init);
+void CustomData_bmesh_copy_map_init_from_bmesh(
+        CustomDataBMeshCopyMap *map, const struct CustomData *source, const struct CustomData *dest);
+void CustomData_bmesh_copy_map_free(CustomDataBMeshCopyMap *map);
+void CustomData_to_bmesh_block_mapped(
+        const CustomDataBMeshCopyMap *map, struct CustomData *dest, int src_index, void **dest_block);
+void CustomData_from_bmesh_block_mapped(
+        const CustomDataBMeshCopyMap *map, const void *src_block, int dest_index);
+
 void CustomData_file_write_prepare(
         struct CustomData *data,
         struct CustomDataLayer **r_write_layers, struct CustomDataLayer *write_layers_buff, size_t write_layers_size);
@@ -587,6 +587,30 @@ CCGError ccgSubSurf_syncFaceDel(CCGSubSurf *ss, CCGFaceHDL fHDL)
 	return eCCGError_None;
 }
 
+static void ccgSubSurf__partialSyncVertData(CCGSubSurf *ss, CCGVert *v, const void *vertData, short seamflag)
+{
+	if (!VertDataEqual(vertData, ccg_vert_getCo(v, 0, ss->meshIFC.vertDataSize), ss) ||
+	    ((v->flags & Vert_eSeam) != seamflag))
+	{
+		int i, j;
+
+		VertDataCopy(ccg_vert_getCo(v, 0, ss->meshIFC.vertDataSize), vertData, ss);
+		v->flags = Vert_eEffected | seamflag;
+
+		for (i = 0; i < v->numEdges; i++) {
+			CCGEdge *e = v->edges[i];
+			e->v0->flags |= Vert_eEffected;
+			e->v1->flags |= Vert_eEffected;
+		}
+		for (i = 0; i < v->numFaces; i++) {
+			CCGFace *f = v->faces[i];
+			for (j = 0; j < f->numVerts; j++) {
+				FACE_getVerts(f)[j]->flags |= Vert_eEffected;
+			}
+		}
+	}
+}
+
 CCGError ccgSubSurf_syncVert(CCGSubSurf *ss, CCGVertHDL vHDL, const void *vertData, int seam, CCGVert **v_r)
 {
 	void **prevp;
@@ -601,25 +625,8 @@ CCGError ccgSubSurf_syncVert(CCGSubSurf *ss, CCGVertHDL vHDL, const void *vertDa
 			ccg_ehash_insert(ss->vMap, (EHEntry *) v);
 			v->flags = Vert_eEffected | seamflag;
 		}
-		else if (!VertDataEqual(vertData, ccg_vert_getCo(v, 0, ss->meshIFC.vertDataSize), ss) ||
-		         ((v->flags & Vert_eSeam) != seamflag))
-		{
-			int i, j;
-
-			VertDataCopy(ccg_vert_getCo(v, 0, ss->meshIFC.vertDataSize), vertData, ss);
-			v->flags = Vert_eEffected | seamflag;
-
-			for (i = 0; i < v->numEdges; i++) {
-				CCGEdge *e = v->edges[i];
-				e->v0->flags |= Vert_eEffected;
-				e->v1->flags |= Vert_eEffected;
-			}
-			for (i = 0; i < v->numFaces; i++) {
-				CCGFace *f = v->faces[i];
-				for (j = 0; j < f->numVerts; j++) {
-					FACE_getVerts(f)[j]->flags |= Vert_eEffected;
-				}
-			}
+		else {
+			ccgSubSurf__partialSyncVertData(ss, v, vertData, seamflag);
 		}
 	}
 	else {
@@ -656,6 +663,20 @@ CCGError ccgSubSurf_syncVert(CCGSubSurf *ss, CCGVertHDL vHDL, const void *vertDa
 	return eCCGError_None;
 }
 
+/* Update the coordinates of an existing vertex during a partial sync, for
+ * callers which iterate over the vertices directly and know the topology did
+ * not change, so no handle lookup is needed. */
+CCGError ccgSubSurf_syncVertData(CCGSubSurf *ss, CCGVert *v, const void *vertData)
+{
+	if (ss->syncState != eSyncState_Partial) {
+		return eCCGError_InvalidSyncState;
+	}
+
+	ccgSubSurf__partialSyncVertData(ss, v, vertData, v->flags & Vert_eSeam);
+
+	return eCCGError_None;
+}
+
 CCGError ccgSubSurf_syncEdge(CCGSubSurf *ss, CCGEdgeHDL eHDL, CCGVertHDL e_vHDL0, CCGVertHDL e_vHDL1, float crease, CCGEdge **e_r)
 {
 	void **prevp;
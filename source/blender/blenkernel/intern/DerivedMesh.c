@@ -35,11 +35,14 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "DNA_anim_types.h"
+#include "DNA_action_types.h"
 #include "DNA_cloth_types.h"
 #include "DNA_key_types.h"
 #include "DNA_material_types.h"
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
 
@@ -49,7 +52,10 @@
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 #include "BLI_linklist.h"
+#include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "BKE_cdderivedmesh.h"
 #include "BKE_colorband.h"
@@ -1744,6 +1750,430 @@ static void dm_ensure_display_normals(DerivedMesh *dm)
 	}
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Modifier Stack Cache
+ *
+ * Results of constructive modifiers are stored in a global cache, keyed on a
+ * hash of everything the result depends on: the base mesh data and deformed
+ * coordinates, and the settings of every modifier applied so far. When an
+ * object is re-evaluated the stack resumes from the last modifier whose key
+ * is still in the cache, so editing a modifier only re-runs the stack from
+ * that modifier on, and objects sharing mesh and modifiers share results.
+ *
+ * Only modifiers that depend on nothing but their own settings and input
+ * mesh take part, see #modifier_stack_cache_supported(), and stacks with
+ * animated inputs are skipped. The total memory of cached results is limited,
+ * least recently used entries are freed first.
+ * \{ */
+
+/* Total memory of cached results, for all objects. */
+#define MODIFIER_STACK_CACHE_MEMORY_LIMIT (256 * 1024 * 1024)
+
+typedef struct ModifierStackCacheEntry {
+	struct ModifierStackCacheEntry *next, *prev;
+	uint64_t key;
+	size_t memory;
+	/* Evaluations resuming from this entry, it's not freed while in use. */
+	int users;
+	DerivedMesh *dm;
+} ModifierStackCacheEntry;
+
+static struct {
+	/* Most recently used first. */
+	ListBase entries;
+	/* Entries by their key. */
+	GHash *map;
+	size_t memory;
+} modifier_stack_cache = {{NULL, NULL}, NULL, 0};
+static ThreadMutex modifier_stack_cache_lock = BLI_MUTEX_INITIALIZER;
+
+/* Running hash of the stack, two independent 32 bit hashes form the key. */
+typedef struct ModifierStackHash {
+	BLI_HashMurmur2A mm2[2];
+} ModifierStackHash;
+
+static void modifier_stack_hash_init(ModifierStackHash *hash)
+{
+	BLI_hash_mm2a_init(&hash->mm2[0], 0x9e3779b9);
+	BLI_hash_mm2a_init(&hash->mm2[1], 0x85ebca6b);
+}
+
+static void modifier_stack_hash_add(ModifierStackHash *hash, const void *data, size_t len)
+{
+	BLI_hash_mm2a_add(&hash->mm2[0], data, len);
+	BLI_hash_mm2a_add(&hash->mm2[1], data, len);
+}
+
+static void modifier_stack_hash_add_int(ModifierStackHash *hash, int data)
+{
+	BLI_hash_mm2a_add_int(&hash->mm2[0], data);
+	BLI_hash_mm2a_add_int(&hash->mm2[1], data);
+}
+
+static uint64_t modifier_stack_hash_key(const ModifierStackHash *hash)
+{
+	/* Finalize a copy, so the running hash can be extended further. */
+	ModifierStackHash tmp = *hash;
+	return ((uint64_t)BLI_hash_mm2a_end(&tmp.mm2[0]) << 32) | (uint64_t)BLI_hash_mm2a_end(&tmp.mm2[1]);
+}
+
+static unsigned int modifier_stack_cache_key_hash(const void *key)
+{
+	const uint64_t k = *(const uint64_t *)key;
+	return (unsigned int)(k ^ (k >> 32));
+}
+
+static bool modifier_stack_cache_key_cmp(const void *a, const void *b)
+{
+	return (*(const uint64_t *)a != *(const uint64_t *)b);
+}
+
+/* Hash layer settings and contents, returns false if the layer data can't be hashed. */
+static bool modifier_stack_hash_customdata(ModifierStackHash *hash, const CustomData *data, int totelem)
+{
+	int i;
+
+	modifier_stack_hash_add_int(hash, totelem);
+	modifier_stack_hash_add_int(hash, data->totlayer);
+
+	for (i = 0; i < data->totlayer; i++) {
+		CustomDataLayer layer = data->layers[i];
+		const void *layer_data = layer.data;
+
+		layer.data = NULL;
+		modifier_stack_hash_add(hash, &layer, sizeof(layer));
+
+		if (layer_data == NULL) {
+			continue;
+		}
+
+		switch (layer.type) {
+			case CD_MDEFORMVERT:
+			{
+				const MDeformVert *dvert = layer_data;
+				int j;
+
+				for (j = 0; j < totelem; j++) {
+					modifier_stack_hash_add_int(hash, dvert[j].totweight);
+					if (dvert[j].totweight) {
+						modifier_stack_hash_add(hash, dvert[j].dw, sizeof(*dvert[j].dw) * dvert[j].totweight);
+					}
+				}
+				break;
+			}
+			case CD_MDISPS:
+			case CD_GRID_PAINT_MASK:
+				/* Data allocated per element, not worth hashing. */
+				return false;
+			default:
+				modifier_stack_hash_add(hash, layer_data, (size_t)CustomData_sizeof(layer.type) * totelem);
+				break;
+		}
+	}
+
+	return true;
+}
+
+/* Hash the mesh a stack starts from. */
+static bool modifier_stack_hash_mesh(
+        ModifierStackHash *hash, Scene *scene, Object *ob, Mesh *me,
+        float (*deformedVerts)[3], const bool need_mapping, ModifierApplyFlag app_flags)
+{
+	bDeformGroup *dg;
+
+	modifier_stack_hash_init(hash);
+
+	if (!modifier_stack_hash_customdata(hash, &me->vdata, me->totvert) ||
+	    !modifier_stack_hash_customdata(hash, &me->edata, me->totedge) ||
+	    !modifier_stack_hash_customdata(hash, &me->ldata, me->totloop) ||
+	    !modifier_stack_hash_customdata(hash, &me->pdata, me->totpoly))
+	{
+		return false;
+	}
+
+	if (deformedVerts) {
+		modifier_stack_hash_add(hash, deformedVerts, sizeof(*deformedVerts) * me->totvert);
+	}
+
+	/* Vertex groups and materials are looked up through the object. */
+	for (dg = ob->defbase.first; dg; dg = dg->next) {
+		modifier_stack_hash_add(hash, dg->name, sizeof(dg->name));
+	}
+	modifier_stack_hash_add_int(hash, ob->totcol);
+	modifier_stack_hash_add_int(hash, me->flag);
+
+	modifier_stack_hash_add_int(hash, need_mapping);
+	modifier_stack_hash_add_int(hash, app_flags);
+	modifier_stack_hash_add_int(hash, scene->r.mode & R_SIMPLIFY);
+	modifier_stack_hash_add_int(hash, scene->r.simplify_subsurf);
+
+	return true;
+}
+
+static bool modifier_stack_animdata_has_path(AnimData *adt, const char *prefix)
+{
+	FCurve *fcu;
+
+	if (adt == NULL) {
+		return false;
+	}
+	/* Strips may animate anything, don't bother looking into them. */
+	if (adt->nla_tracks.first) {
+		return true;
+	}
+	if (adt->action) {
+		for (fcu = adt->action->curves.first; fcu; fcu = fcu->next) {
+			if (fcu->rna_path && STRPREFIX(fcu->rna_path, prefix)) {
+				return true;
+			}
+		}
+	}
+	for (fcu = adt->drivers.first; fcu; fcu = fcu->next) {
+		if (fcu->rna_path && STRPREFIX(fcu->rna_path, prefix)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Animated mesh data, shape keys or modifier settings give new keys on every
+ * frame, storing those results would only push out useful ones. */
+static bool modifier_stack_cache_animated(Object *ob, Mesh *me)
+{
+	return (modifier_stack_animdata_has_path(ob->adt, "modifiers") ||
+	        modifier_stack_animdata_has_path(me->adt, "") ||
+	        (me->key && modifier_stack_animdata_has_path(me->key->adt, "")));
+}
+
+static void modifier_stack_cache_id_walk(
+        void *userData, Object *UNUSED(ob), ID **idpoin, int UNUSED(cb_flag))
+{
+	if (*idpoin) {
+		*((bool *)userData) = true;
+	}
+}
+
+/* Modifiers whose result only depends on their settings and the input mesh. */
+static bool modifier_stack_cache_supported(ModifierData *md, Object *ob, const ModifierTypeInfo *mti)
+{
+	bool has_id_links = false;
+
+	switch ((ModifierType)md->type) {
+		case eModifierType_Subsurf:
+		case eModifierType_Mirror:
+		case eModifierType_Decimate:
+		case eModifierType_Array:
+		case eModifierType_EdgeSplit:
+		case eModifierType_Smooth:
+		case eModifierType_Cast:
+		case eModifierType_Bevel:
+		case eModifierType_SimpleDeform:
+		case eModifierType_Solidify:
+		case eModifierType_Screw:
+		case eModifierType_Remesh:
+		case eModifierType_Skin:
+		case eModifierType_LaplacianSmooth:
+		case eModifierType_Triangulate:
+		case eModifierType_Wireframe:
+			break;
+		default:
+			return false;
+	}
+
+	if (mti->dependsOnTime && mti->dependsOnTime(md)) {
+		return false;
+	}
+
+	/* Objects used as offset, axis or origin. */
+	if (mti->foreachIDLink) {
+		mti->foreachIDLink(md, ob, modifier_stack_cache_id_walk, &has_id_links);
+	}
+	else if (mti->foreachObjectLink) {
+		mti->foreachObjectLink(md, ob, (ObjectWalkFunc)modifier_stack_cache_id_walk, &has_id_links);
+	}
+
+	return !has_id_links;
+}
+
+static void modifier_stack_hash_modifier(
+        ModifierStackHash *hash, ModifierData *md, const ModifierTypeInfo *mti,
+        CustomDataMask mask, CustomDataMask nextmask)
+{
+	size_t settings_end = (size_t)mti->structSize;
+
+	modifier_stack_hash_add_int(hash, md->type);
+	modifier_stack_hash_add(hash, &mask, sizeof(mask));
+	modifier_stack_hash_add(hash, &nextmask, sizeof(nextmask));
+
+	/* Settings follow the common header, runtime data at the end is skipped. */
+	if (md->type == eModifierType_Subsurf) {
+		settings_end = offsetof(SubsurfModifierData, emCache);
+	}
+	else if (md->type == eModifierType_Decimate) {
+		settings_end = offsetof(DecimateModifierData, face_count);
+	}
+
+	modifier_stack_hash_add(hash, md + 1, settings_end - sizeof(ModifierData));
+}
+
+static size_t modifier_stack_cache_dm_memory(DerivedMesh *dm)
+{
+	const struct { const CustomData *data; int totelem; } layers[] = {
+		{&dm->vertData, dm->numVertData},
+		{&dm->edgeData, dm->numEdgeData},
+		{&dm->faceData, dm->numTessFaceData},
+		{&dm->loopData, dm->numLoopData},
+		{&dm->polyData, dm->numPolyData},
+	};
+	size_t memory = sizeof(DerivedMesh);
+	int i, j;
+
+	for (i = 0; i < ARRAY_SIZE(layers); i++) {
+		for (j = 0; j < layers[i].data->totlayer; j++) {
+			memory += (size_t)CustomData_sizeof(layers[i].data->layers[j].type) * layers[i].totelem;
+		}
+	}
+
+	return memory;
+}
+
+static void modifier_stack_cache_entry_free(ModifierStackCacheEntry *entry)
+{
+	BLI_assert(entry->users == 0);
+	BLI_ghash_remove(modifier_stack_cache.map, &entry->key, NULL, NULL);
+	BLI_remlink(&modifier_stack_cache.entries, entry);
+	modifier_stack_cache.memory -= entry->memory;
+	entry->dm->release(entry->dm);
+	MEM_freeN(entry);
+}
+
+static ModifierStackCacheEntry *modifier_stack_cache_find(uint64_t key)
+{
+	if (modifier_stack_cache.map == NULL) {
+		return NULL;
+	}
+	return BLI_ghash_lookup(modifier_stack_cache.map, &key);
+}
+
+/**
+ * Returns the cached result for the key, or NULL if there is none. The entry
+ * stays valid until #modifier_stack_cache_release(), so an evaluation can
+ * look further ahead and only copy the last result it resumes from.
+ */
+static ModifierStackCacheEntry *modifier_stack_cache_acquire(uint64_t key)
+{
+	ModifierStackCacheEntry *entry;
+
+	BLI_mutex_lock(&modifier_stack_cache_lock);
+
+	entry = modifier_stack_cache_find(key);
+	if (entry) {
+		BLI_remlink(&modifier_stack_cache.entries, entry);
+		BLI_addhead(&modifier_stack_cache.entries, entry);
+		entry->users++;
+	}
+
+	BLI_mutex_unlock(&modifier_stack_cache_lock);
+
+	return entry;
+}
+
+/* Returns a copy of the cached result when requested, NULL otherwise. */
+static DerivedMesh *modifier_stack_cache_release(ModifierStackCacheEntry *entry, const bool use_result)
+{
+	DerivedMesh *dm = NULL;
+
+	/* The entry is not freed while we're using it and the cached result is
+	 * never modified, so it's copied without holding the lock. */
+	if (use_result) {
+		dm = CDDM_copy(entry->dm);
+		dm->deformedOnly = false;
+	}
+
+	BLI_mutex_lock(&modifier_stack_cache_lock);
+
+	entry->users--;
+
+	BLI_mutex_unlock(&modifier_stack_cache_lock);
+
+	return dm;
+}
+
+static void modifier_stack_cache_store(uint64_t key, DerivedMesh *dm)
+{
+	ModifierStackCacheEntry *entry;
+	DerivedMesh *cache_dm = CDDM_copy(dm);
+	const size_t memory = modifier_stack_cache_dm_memory(cache_dm);
+
+	if (memory > MODIFIER_STACK_CACHE_MEMORY_LIMIT) {
+		cache_dm->release(cache_dm);
+		return;
+	}
+
+	BLI_mutex_lock(&modifier_stack_cache_lock);
+
+	/* Another thread may have stored the same result meanwhile. */
+	if (modifier_stack_cache_find(key)) {
+		BLI_mutex_unlock(&modifier_stack_cache_lock);
+		cache_dm->release(cache_dm);
+		return;
+	}
+
+	/* Free least recently used entries, skipping those still in use. */
+	entry = modifier_stack_cache.entries.last;
+	while (entry && modifier_stack_cache.memory + memory > MODIFIER_STACK_CACHE_MEMORY_LIMIT) {
+		ModifierStackCacheEntry *entry_prev = entry->prev;
+		if (entry->users == 0) {
+			modifier_stack_cache_entry_free(entry);
+		}
+		entry = entry_prev;
+	}
+
+	if (modifier_stack_cache.map == NULL) {
+		modifier_stack_cache.map = BLI_ghash_new(
+		        modifier_stack_cache_key_hash, modifier_stack_cache_key_cmp, __func__);
+	}
+
+	entry = MEM_mallocN(sizeof(*entry), __func__);
+	entry->key = key;
+	entry->memory = memory;
+	entry->users = 0;
+	entry->dm = cache_dm;
+	BLI_addhead(&modifier_stack_cache.entries, entry);
+	BLI_ghash_insert(modifier_stack_cache.map, &entry->key, entry);
+	modifier_stack_cache.memory += memory;
+
+	BLI_mutex_unlock(&modifier_stack_cache_lock);
+}
+
+void DM_modifier_stack_cache_free(void)
+{
+	BLI_mutex_lock(&modifier_stack_cache_lock);
+
+	while (modifier_stack_cache.entries.first) {
+		modifier_stack_cache_entry_free(modifier_stack_cache.entries.first);
+	}
+	if (modifier_stack_cache.map) {
+		BLI_ghash_free(modifier_stack_cache.map, NULL, NULL);
+		modifier_stack_cache.map = NULL;
+	}
+
+	BLI_mutex_unlock(&modifier_stack_cache_lock);
+}
+
+/* Whether any modifier after md will be applied. */
+static bool modifier_stack_has_next(Scene *scene, ModifierData *md, int required_mode)
+{
+	for (md = md->next; md; md = md->next) {
+		if (modifier_isEnabled(scene, md, required_mode)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/** \} */
+
 /**
  * new value for useDeform -1  (hack for the gameengine):
  *
@@ -1791,6 +2221,13 @@ static void mesh_calc_modifiers(
 	const bool do_loop_normals = (me->flag & ME_AUTOSMOOTH) != 0;
 	const float loop_normals_split_angle = me->smoothresh;
 
+	/* Resume from cached results of an earlier evaluation, see #modifier_stack_cache_acquire(). */
+	ModifierStackHash stack_hash;
+	ModifierStackCacheEntry *cache_entry = NULL;
+	bool stack_hash_init = false;
+	bool stack_hash_valid = (!useRenderParams && !sculpt_mode && !do_init_wmcol && !build_shapekey_layers &&
+	                         !modifier_stack_cache_animated(ob, me));
+
 	VirtualModifierData virtualModifierData;
 
 	ModifierApplyFlag app_flags = useRenderParams ? MOD_APPLY_RENDER : 0;
@@ -1860,6 +2297,10 @@ static void mesh_calc_modifiers(
 			}
 
 			if (mti->type == eModifierTypeType_OnlyDeform && !sculpt_dyntopo) {
+				/* The deformed coordinates are part of the stack hash. */
+				if (!modifier_stack_cache_supported(md, ob, mti))
+					stack_hash_valid = false;
+
 				if (!deformedVerts)
 					deformedVerts = BKE_mesh_vertexCos_get(me, &numVerts);
 
@@ -1907,6 +2348,9 @@ static void mesh_calc_modifiers(
 
 	for (; md; md = md->next, curr = curr->next) {
 		const ModifierTypeInfo *mti = modifierType_getInfo(md->type);
+		ModifierStackCacheEntry *cache_hit = NULL;
+		uint64_t cache_key = 0;
+		bool cache_has_next = false;
 
 		md->scene = scene;
 
@@ -1918,7 +2362,7 @@ static void mesh_calc_modifiers(
 			continue;
 		}
 
-		if ((mti->flags & eModifierTypeFlag_RequiresOriginalData) && dm) {
+		if ((mti->flags & eModifierTypeFlag_RequiresOriginalData) && (dm || cache_entry)) {
 			modifier_setError(md, "Modifier requires original data, bad stack position");
 			continue;
 		}
@@ -1969,6 +2413,58 @@ static void mesh_calc_modifiers(
 		else
 			mask = 0;
 
+		/* determine which data layers are needed by following modifiers */
+		if (curr->next)
+			nextmask = curr->next->mask;
+		else
+			nextmask = dataMask;
+
+		if (stack_hash_valid) {
+			if (mti->type == eModifierTypeType_OnlyDeform) {
+				/* Deformers before the first constructive modifier are included in the
+				 * coordinates hashed with the mesh, later ones extend the stack hash. */
+				if (!modifier_stack_cache_supported(md, ob, mti) || (mask & CD_MASK_ORCO)) {
+					stack_hash_valid = false;
+				}
+				else if (stack_hash_init) {
+					modifier_stack_hash_modifier(&stack_hash, md, mti, curr->mask, 0);
+				}
+			}
+			else {
+				if (!stack_hash_init) {
+					BLI_assert(dm == NULL);
+					stack_hash_valid = modifier_stack_hash_mesh(
+					        &stack_hash, scene, ob, me, deformedVerts, need_mapping, app_flags);
+					stack_hash_init = true;
+				}
+
+				if (stack_hash_valid &&
+				    modifier_stack_cache_supported(md, ob, mti) &&
+				    !((mask | curr->mask | nextmask) & (CD_MASK_ORCO | CD_MASK_CLOTH_ORCO)))
+				{
+					/* Results other than CDDMs are only cached when more modifiers follow,
+					 * as the final result would lose features like the grids of subsurf. */
+					cache_has_next = modifier_stack_has_next(scene, md, required_mode);
+
+					modifier_stack_hash_modifier(&stack_hash, md, mti, curr->mask | append_mask, nextmask);
+					modifier_stack_hash_add_int(&stack_hash, cache_has_next);
+					cache_key = modifier_stack_hash_key(&stack_hash);
+					cache_hit = modifier_stack_cache_acquire(cache_key);
+				}
+				else {
+					stack_hash_valid = false;
+				}
+			}
+		}
+
+		/* A result is only copied out of the cache once the stack can't resume
+		 * from a later one, so consecutive hits cost a single copy. */
+		if (cache_entry) {
+			BLI_assert(dm == NULL && deformedVerts == NULL);
+			dm = modifier_stack_cache_release(cache_entry, cache_hit == NULL);
+			cache_entry = NULL;
+		}
+
 		if (dm && (mask & CD_MASK_ORCO))
 			add_orco_dm(ob, NULL, dm, orcodm, CD_ORCO);
 
@@ -2009,78 +2505,89 @@ static void mesh_calc_modifiers(
 		else {
 			DerivedMesh *ndm;
 
-			/* determine which data layers are needed by following modifiers */
-			if (curr->next)
-				nextmask = curr->next->mask;
-			else
-				nextmask = dataMask;
-
-			/* apply vertex coordinates or build a DerivedMesh as necessary */
-			if (dm) {
-				if (deformedVerts) {
-					DerivedMesh *tdm = CDDM_copy(dm);
+			if (cache_hit) {
+				/* Resume from the cached result, see above. */
+				if (dm) {
 					dm->release(dm);
-					dm = tdm;
+					dm = NULL;
+				}
+				if (deformedVerts) {
+					if (deformedVerts != inputVertexCos)
+						MEM_freeN(deformedVerts);
 
-					CDDM_apply_vert_coords(dm, deformedVerts);
+					deformedVerts = NULL;
 				}
+				cache_entry = cache_hit;
+				ndm = NULL;
 			}
 			else {
-				dm = CDDM_from_mesh(me);
-				ASSERT_IS_VALID_DM(dm);
-
-				if (build_shapekey_layers)
-					add_shapekey_layers(dm, me, ob);
+				/* apply vertex coordinates or build a DerivedMesh as necessary */
+				if (dm) {
+					if (deformedVerts) {
+						DerivedMesh *tdm = CDDM_copy(dm);
+						dm->release(dm);
+						dm = tdm;
 
-				if (deformedVerts) {
-					CDDM_apply_vert_coords(dm, deformedVerts);
+						CDDM_apply_vert_coords(dm, deformedVerts);
+					}
 				}
+				else {
+					dm = CDDM_from_mesh(me);
+					ASSERT_IS_VALID_DM(dm);
 
-				if (do_init_wmcol)
-					DM_update_weight_mcol(ob, dm, draw_flag, NULL, 0, NULL);
+					if (build_shapekey_layers)
+						add_shapekey_layers(dm, me, ob);
 
-				/* Constructive modifiers need to have an origindex
-				 * otherwise they wont have anywhere to copy the data from.
-				 *
-				 * Also create ORIGINDEX data if any of the following modifiers
-				 * requests it, this way Mirror, Solidify etc will keep ORIGINDEX
-				 * data by using generic DM_copy_vert_data() functions.
-				 */
-				if (need_mapping || (nextmask & CD_MASK_ORIGINDEX)) {
-					/* calc */
-					DM_add_vert_layer(dm, CD_ORIGINDEX, CD_CALLOC, NULL);
-					DM_add_edge_layer(dm, CD_ORIGINDEX, CD_CALLOC, NULL);
-					DM_add_poly_layer(dm, CD_ORIGINDEX, CD_CALLOC, NULL);
-
-					/* Not worth parallelizing this, gives less than 0.1% overall speedup in best of best cases... */
-					range_vn_i(DM_get_vert_data_layer(dm, CD_ORIGINDEX), dm->numVertData, 0);
-					range_vn_i(DM_get_edge_data_layer(dm, CD_ORIGINDEX), dm->numEdgeData, 0);
-					range_vn_i(DM_get_poly_data_layer(dm, CD_ORIGINDEX), dm->numPolyData, 0);
+					if (deformedVerts) {
+						CDDM_apply_vert_coords(dm, deformedVerts);
+					}
+
+					if (do_init_wmcol)
+						DM_update_weight_mcol(ob, dm, draw_flag, NULL, 0, NULL);
+
+					/* Constructive modifiers need to have an origindex
+					 * otherwise they wont have anywhere to copy the data from.
+					 *
+					 * Also create ORIGINDEX data if any of the following modifiers
+					 * requests it, this way Mirror, Solidify etc will keep ORIGINDEX
+					 * data by using generic DM_copy_vert_data() functions.
+					 */
+					if (need_mapping || (nextmask & CD_MASK_ORIGINDEX)) {
+						/* calc */
+						DM_add_vert_layer(dm, CD_ORIGINDEX, CD_CALLOC, NULL);
+						DM_add_edge_layer(dm, CD_ORIGINDEX, CD_CALLOC, NULL);
+						DM_add_poly_layer(dm, CD_ORIGINDEX, CD_CALLOC, NULL);
+
+						/* Not worth parallelizing this, gives less than 0.1% overall speedup in best of best cases... */
+						range_vn_i(DM_get_vert_data_layer(dm, CD_ORIGINDEX), dm->numVertData, 0);
+						range_vn_i(DM_get_edge_data_layer(dm, CD_ORIGINDEX), dm->numEdgeData, 0);
+						range_vn_i(DM_get_poly_data_layer(dm, CD_ORIGINDEX), dm->numPolyData, 0);
+					}
 				}
-			}
 
 			
-			/* set the DerivedMesh to only copy needed data */
-			mask = curr->mask;
-			/* needMapping check here fixes bug [#28112], otherwise it's
-			 * possible that it won't be copied */
-			mask |= append_mask;
-			DM_set_only_copy(dm, mask | (need_mapping ? CD_MASK_ORIGINDEX : 0));
+				/* set the DerivedMesh to only copy needed data */
+				mask = curr->mask;
+				/* needMapping check here fixes bug [#28112], otherwise it's
+				 * possible that it won't be copied */
+				mask |= append_mask;
+				DM_set_only_copy(dm, mask | (need_mapping ? CD_MASK_ORIGINDEX : 0));
 			
-			/* add cloth rest shape key if needed */
-			if (mask & CD_MASK_CLOTH_ORCO)
-				add_orco_dm(ob, NULL, dm, clothorcodm, CD_CLOTH_ORCO);
-
-			/* add an origspace layer if needed */
-			if ((curr->mask) & CD_MASK_ORIGSPACE_MLOOP) {
-				if (!CustomData_has_layer(&dm->loopData, CD_ORIGSPACE_MLOOP)) {
-					DM_add_loop_layer(dm, CD_ORIGSPACE_MLOOP, CD_CALLOC, NULL);
-					DM_init_origspace(dm);
+				/* add cloth rest shape key if needed */
+				if (mask & CD_MASK_CLOTH_ORCO)
+					add_orco_dm(ob, NULL, dm, clothorcodm, CD_CLOTH_ORCO);
+
+				/* add an origspace layer if needed */
+				if ((curr->mask) & CD_MASK_ORIGSPACE_MLOOP) {
+					if (!CustomData_has_layer(&dm->loopData, CD_ORIGSPACE_MLOOP)) {
+						DM_add_loop_layer(dm, CD_ORIGSPACE_MLOOP, CD_CALLOC, NULL);
+						DM_init_origspace(dm);
+					}
 				}
-			}
 
-			ndm = modwrap_applyModifier(md, ob, dm, app_flags);
-			ASSERT_IS_VALID_DM(ndm);
+				ndm = modwrap_applyModifier(md, ob, dm, app_flags);
+				ASSERT_IS_VALID_DM(ndm);
+			}
 
 			if (ndm) {
 				/* if the modifier returned a new dm, release the old one */
@@ -2094,6 +2601,12 @@ static void mesh_calc_modifiers(
 
 					deformedVerts = NULL;
 				}
+
+				if (stack_hash_valid && md->error == NULL &&
+				    (cache_has_next || dm->type == DM_TYPE_CDDM))
+				{
+					modifier_stack_cache_store(cache_key, dm);
+				}
 			}
 
 			/* create an orco derivedmesh in parallel */
@@ -2146,7 +2659,9 @@ static void mesh_calc_modifiers(
 				append_mask |= CD_MASK_PREVIEW_MLOOPCOL;
 			}
 
-			dm->deformedOnly = false;
+			if (dm) {
+				dm->deformedOnly = false;
+			}
 		}
 
 		isPrevDeform = (mti->type == eModifierTypeType_OnlyDeform);
@@ -2160,6 +2675,10 @@ static void mesh_calc_modifiers(
 		}
 	}
 
+	if (cache_entry) {
+		dm = modifier_stack_cache_release(cache_entry, true);
+	}
+
 	for (md = firstmd; md; md = md->next)
 		modifier_freeTemporaryData(md);
 
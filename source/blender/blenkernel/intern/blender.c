@@ -53,6 +53,7 @@
 #include "BKE_cachefile.h"
 #include "BKE_context.h"
 #include "BKE_depsgraph.h"
+#include "BKE_DerivedMesh.h"
 #include "BKE_global.h"
 #include "BKE_idprop.h"
 #include "BKE_image.h"
@@ -101,6 +102,7 @@ void BKE_blender_free(void)
 
 	BKE_sequencer_cache_destruct();
 	IMB_moviecache_destruct();
+	DM_modifier_stack_cache_free();
 	
 	free_nodesystem();
 }
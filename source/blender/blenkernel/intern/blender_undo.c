@@ -52,7 +52,9 @@
 #include "BKE_context.h"
 #include "BKE_depsgraph.h"
 #include "BKE_global.h"
+#include "BKE_library.h"
 #include "BKE_main.h"
+#include "BKE_node.h"
 
 #include "BLO_undofile.h"
 #include "BLO_writefile.h"
@@ -64,7 +66,11 @@
 
 #define UNDO_DISK   0
 
-bool BKE_memfile_undo_decode(MemFileUndoData *mfu, bContext *C)
+/**
+ * \param mfu_current: The undo data the current main was last written to or read from (may be NULL),
+ * data-blocks which didn't change since are kept instead of being read again.
+ */
+bool BKE_memfile_undo_decode(MemFileUndoData *mfu, const MemFileUndoData *mfu_current, bContext *C)
 {
 	char mainstr[sizeof(G.main->name)];
 	int success = 0, fileflags;
@@ -78,7 +84,8 @@ bool BKE_memfile_undo_decode(MemFileUndoData *mfu, bContext *C)
 		success = (BKE_blendfile_read(C, mfu->filename, NULL, 0) != BKE_BLENDFILE_READ_FAIL);
 	}
 	else {
-		success = BKE_blendfile_read_from_memfile(C, &mfu->memfile, NULL, 0);
+		const MemFile *memfile_current = mfu_current ? &mfu_current->memfile : NULL;
+		success = BKE_blendfile_read_from_memfile(C, &mfu->memfile, memfile_current, NULL, 0);
 	}
 
 	/* restore */
@@ -86,6 +93,9 @@ bool BKE_memfile_undo_decode(MemFileUndoData *mfu, bContext *C)
 	G.fileflags = fileflags;
 
 	if (success) {
+		/* The new main is the state stored in the undo step. */
+		G.main->is_memfile_undo_written = true;
+
 		/* important not to update time here, else non keyed tranforms are lost */
 		DAG_on_visible_update(G.main, false);
 	}
@@ -121,6 +131,11 @@ MemFileUndoData *BKE_memfile_undo_encode(Main *bmain, MemFileUndoData *mfu_prev)
 		mfu->undo_size = mfu->memfile.size;
 	}
 
+	/* All data-blocks are stored as they are now. */
+	BKE_main_id_tag_all(bmain, LIB_TAG_UNDO_CHANGED, false);
+	FOREACH_NODETREE(bmain, ntree, owner_id) {
+		ntree->id.tag &= ~LIB_TAG_UNDO_CHANGED;
+	} FOREACH_NODETREE_END
 	bmain->is_memfile_undo_written = true;
 
 	return mfu;
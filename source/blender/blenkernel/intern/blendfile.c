@@ -46,6 +46,7 @@
 #include "BKE_blendfile.h"
 #include "BKE_bpath.h"
 #include "BKE_context.h"
+#include "BKE_DerivedMesh.h"
 #include "BKE_global.h"
 #include "BKE_ipo.h"
 #include "BKE_library.h"
@@ -142,6 +143,11 @@ static void setup_app_data(
 		RE_FreeAllRenderResults();
 	}
 
+	/* Cached modifier results of the previous file can't be hit again */
+	if (mode != LOAD_UNDO) {
+		DM_modifier_stack_cache_free();
+	}
+
 	/* Only make filepaths compatible when loading for real (not undo) */
 	if (mode != LOAD_UNDO) {
 		clean_paths(bfd->main);
@@ -401,14 +407,14 @@ bool BKE_blendfile_read_from_memory(
 	return (bfd != NULL);
 }
 
-/* memfile is the undo buffer */
+/* memfile is the undo buffer, memfile_current the undo buffer of the current state (may be NULL) */
 bool BKE_blendfile_read_from_memfile(
-        bContext *C, struct MemFile *memfile,
+        bContext *C, struct MemFile *memfile, const struct MemFile *memfile_current,
         ReportList *reports, int skip_flags)
 {
 	BlendFileData *bfd;
 
-	bfd = BLO_read_from_memfile(CTX_data_main(C), G.main->name, memfile, reports, skip_flags);
+	bfd = BLO_read_from_memfile(CTX_data_main(C), G.main->name, memfile, memfile_current, reports, skip_flags);
 	if (bfd) {
 		/* remove the unused screens and wm */
 		while (bfd->main->wm.first)
@@ -3292,6 +3292,148 @@ void CustomData_from_bmesh_block(const CustomData *source, CustomData *dest,
 
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Mesh/BMesh Conversion Layer Maps
+ *
+ * Resolve matching layers, offsets and type callbacks once, so converting every element
+ * between mesh arrays and editmesh blocks doesn't search the layers and type info again.
+ * The results match #CustomData_to_bmesh_block and #CustomData_from_bmesh_block.
+ * \{ */
+
+static void customdata_bmesh_copy_map_add(
+        CustomDataBMeshCopyMap *map, void *array, int offset, const LayerTypeInfo *typeInfo)
+{
+	CustomDataBMeshCopyLayer *layer = &map->layers[map->totlayer++];
+
+	layer->array = array;
+	layer->offset = offset;
+	layer->size = typeInfo->size;
+	layer->copy = typeInfo->copy;
+	layer->set_default = typeInfo->set_default;
+}
+
+void CustomData_bmesh_copy_map_init_to_bmesh(
+        CustomDataBMeshCopyMap *map, const CustomData *source, const CustomData *dest, bool use_default_init)
+{
+	int dest_i = 0, src_i;
+
+	map->layers = MEM_mallocN(sizeof(*map->layers) * (size_t)max_ii(dest->totlayer, 1), __func__);
+	map->totlayer = 0;
+
+	for (src_i = 0; src_i < source->totlayer; ++src_i) {
+		while (dest_i < dest->totlayer && dest->layers[dest_i].type < source->layers[src_i].type) {
+			if (use_default_init) {
+				customdata_bmesh_copy_map_add(
+				        map, NULL, dest->layers[dest_i].offset, layerType_getInfo(dest->layers[dest_i].type));
+			}
+			dest_i++;
+		}
+
+		if (dest_i >= dest->totlayer) break;
+
+		if (dest->layers[dest_i].type == source->layers[src_i].type) {
+			customdata_bmesh_copy_map_add(
+			        map, source->layers[src_i].data, dest->layers[dest_i].offset,
+			        layerType_getInfo(dest->layers[dest_i].type));
+			dest_i++;
+		}
+	}
+
+	if (use_default_init) {
+		while (dest_i < dest->totlayer) {
+			customdata_bmesh_copy_map_add(
+			        map, NULL, dest->layers[dest_i].offset, layerType_getInfo(dest->layers[dest_i].type));
+			dest_i++;
+		}
+	}
+}
+
+void CustomData_bmesh_copy_map_init_from_bmesh(
+        CustomDataBMeshCopyMap *map, const CustomData *source, const CustomData *dest)
+{
+	int dest_i = 0, src_i;
+
+	map->layers = MEM_mallocN(sizeof(*map->layers) * (size_t)max_ii(source->totlayer, 1), __func__);
+	map->totlayer = 0;
+
+	for (src_i = 0; src_i < source->totlayer; ++src_i) {
+		while (dest_i < dest->totlayer && dest->layers[dest_i].type < source->layers[src_i].type) {
+			dest_i++;
+		}
+
+		if (dest_i >= dest->totlayer) break;
+
+		if (dest->layers[dest_i].type == source->layers[src_i].type) {
+			customdata_bmesh_copy_map_add(
+			        map, dest->layers[dest_i].data, source->layers[src_i].offset,
+			        layerType_getInfo(dest->layers[dest_i].type));
+			dest_i++;
+		}
+	}
+}
+
+void CustomData_bmesh_copy_map_free(CustomDataBMeshCopyMap *map)
+{
+	MEM_SAFE_FREE(map->layers);
+	map->totlayer = 0;
+}
+
+/**
+ * Mapped version of #CustomData_to_bmesh_block,
+ * \a map is created by #CustomData_bmesh_copy_map_init_to_bmesh.
+ */
+void CustomData_to_bmesh_block_mapped(
+        const CustomDataBMeshCopyMap *map, CustomData *dest, int src_index, void **dest_block)
+{
+	int i;
+
+	if (*dest_block == NULL)
+		CustomData_bmesh_alloc_block(dest, dest_block);
+
+	for (i = 0; i < map->totlayer; i++) {
+		const CustomDataBMeshCopyLayer *layer = &map->layers[i];
+		void *dest_data = POINTER_OFFSET(*dest_block, layer->offset);
+
+		if (layer->array) {
+			const void *src_data = POINTER_OFFSET(layer->array, (size_t)src_index * (size_t)layer->size);
+
+			if (layer->copy)
+				layer->copy(src_data, dest_data, 1);
+			else
+				memcpy(dest_data, src_data, (size_t)layer->size);
+		}
+		else if (layer->set_default) {
+			layer->set_default(dest_data, 1);
+		}
+		else {
+			memset(dest_data, 0, (size_t)layer->size);
+		}
+	}
+}
+
+/**
+ * Mapped version of #CustomData_from_bmesh_block,
+ * \a map is created by #CustomData_bmesh_copy_map_init_from_bmesh.
+ */
+void CustomData_from_bmesh_block_mapped(
+        const CustomDataBMeshCopyMap *map, const void *src_block, int dest_index)
+{
+	int i;
+
+	for (i = 0; i < map->totlayer; i++) {
+		const CustomDataBMeshCopyLayer *layer = &map->layers[i];
+		const void *src_data = POINTER_OFFSET(src_block, layer->offset);
+		void *dest_data = POINTER_OFFSET(layer->array, (size_t)dest_index * (size_t)layer->size);
+
+		if (layer->copy)
+			layer->copy(src_data, dest_data, 1);
+		else
+			memcpy(dest_data, src_data, (size_t)layer->size);
+	}
+}
+
+/** \} */
+
 void CustomData_file_write_info(int type, const char **r_struct_name, int *r_struct_num)
 {
 	const LayerTypeInfo *typeInfo = layerType_getInfo(type);
@@ -3012,6 +3012,8 @@ void DAG_id_tag_update_ex(Main *bmain, ID *id, short flag)
 		printf("%s: id=%s flag=%d\n", __func__, id->name, flag);
 	}
 
+	id->tag |= LIB_TAG_UNDO_CHANGED;
+
 	/* tag ID for update */
 	if (flag) {
 		if (flag & OB_RECALC_OB)
@@ -40,6 +40,7 @@
 #include "BLI_listbase.h"
 #include "BLI_bitmap.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -704,6 +705,51 @@ static bool calc_curve_deform(Scene *scene, Object *par, float co[3],
 	return false;
 }
 
+typedef struct CurveDeformUserdata {
+	Scene *scene;
+	Object *cuOb;
+	CurveDeform *cd;
+	float (*vertexCos)[3];
+	MDeformVert *dvert;
+	int defgrp_index;
+	short defaxis;
+	/* Vertices are not in curve space yet, when not computing bounds. */
+	bool to_curvespace;
+} CurveDeformUserdata;
+
+static void curve_deform_vert_task(
+        void *__restrict userdata,
+        const int i,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	const CurveDeformUserdata *data = userdata;
+	CurveDeform *cd = data->cd;
+	float *co = data->vertexCos[i];
+
+	if (data->defgrp_index != -1) {
+		const float weight = defvert_find_weight(&data->dvert[i], data->defgrp_index);
+
+		if (weight > 0.0f) {
+			float vec[3];
+
+			if (data->to_curvespace) {
+				mul_m4_v3(cd->curvespace, co);
+			}
+			copy_v3_v3(vec, co);
+			calc_curve_deform(data->scene, data->cuOb, vec, data->defaxis, cd, NULL);
+			interp_v3_v3v3(co, co, vec, weight);
+			mul_m4_v3(cd->objectspace, co);
+		}
+	}
+	else {
+		if (data->to_curvespace) {
+			mul_m4_v3(cd->curvespace, co);
+		}
+		calc_curve_deform(data->scene, data->cuOb, co, data->defaxis, cd, NULL);
+		mul_m4_v3(cd->objectspace, co);
+	}
+}
+
 void curve_deform_verts(
         Scene *scene, Object *cuOb, Object *target, DerivedMesh *dm, float (*vertexCos)[3],
         int numVerts, const char *vgroup, short defaxis)
@@ -750,29 +796,33 @@ void curve_deform_verts(
 			else {
 				dvert = ((Mesh *)target->data)->dvert;
 			}
+
+			/* without deformverts the group is ignored, all vertices are deformed */
+			if (dvert == NULL) {
+				defgrp_index = -1;
+			}
 		}
 	}
 
-	if (dvert) {
-		MDeformVert *dvert_iter;
-		float vec[3];
+#ifdef CYCLIC_DEPENDENCY_WORKAROUND
+	/* Make sure the path exists before deforming vertices in parallel. */
+	if (cuOb->curve_cache == NULL) {
+		BKE_displist_make_curveTypes(scene, cuOb, false);
+	}
+#endif
 
-		if (cu->flag & CU_DEFORM_BOUNDS_OFF) {
-			for (a = 0, dvert_iter = dvert; a < numVerts; a++, dvert_iter++) {
-				const float weight = defvert_find_weight(dvert_iter, defgrp_index);
+	CurveDeformUserdata data = {
+	    .scene = scene, .cuOb = cuOb, .cd = &cd, .vertexCos = vertexCos,
+	    .dvert = dvert, .defgrp_index = defgrp_index, .defaxis = defaxis,
+	    .to_curvespace = (cu->flag & CU_DEFORM_BOUNDS_OFF) != 0,
+	};
 
-				if (weight > 0.0f) {
-					mul_m4_v3(cd.curvespace, vertexCos[a]);
-					copy_v3_v3(vec, vertexCos[a]);
-					calc_curve_deform(scene, cuOb, vec, defaxis, &cd, NULL);
-					interp_v3_v3v3(vertexCos[a], vertexCos[a], vec, weight);
-					mul_m4_v3(cd.objectspace, vertexCos[a]);
-				}
-			}
-		}
-		else {
-			/* set mesh min/max bounds */
-			INIT_MINMAX(cd.dmin, cd.dmax);
+	if ((cu->flag & CU_DEFORM_BOUNDS_OFF) == 0) {
+		/* set mesh min/max bounds */
+		INIT_MINMAX(cd.dmin, cd.dmax);
+
+		if (dvert) {
+			MDeformVert *dvert_iter;
 
 			for (a = 0, dvert_iter = dvert; a < numVerts; a++, dvert_iter++) {
 				if (defvert_find_weight(dvert_iter, defgrp_index) > 0.0f) {
@@ -780,44 +830,19 @@ void curve_deform_verts(
 					minmax_v3v3_v3(cd.dmin, cd.dmax, vertexCos[a]);
 				}
 			}
-
-			for (a = 0, dvert_iter = dvert; a < numVerts; a++, dvert_iter++) {
-				const float weight = defvert_find_weight(dvert_iter, defgrp_index);
-
-				if (weight > 0.0f) {
-					/* already in 'cd.curvespace', prev for loop */
-					copy_v3_v3(vec, vertexCos[a]);
-					calc_curve_deform(scene, cuOb, vec, defaxis, &cd, NULL);
-					interp_v3_v3v3(vertexCos[a], vertexCos[a], vec, weight);
-					mul_m4_v3(cd.objectspace, vertexCos[a]);
-				}
-			}
-		}
-	}
-	else {
-		if (cu->flag & CU_DEFORM_BOUNDS_OFF) {
-			for (a = 0; a < numVerts; a++) {
-				mul_m4_v3(cd.curvespace, vertexCos[a]);
-				calc_curve_deform(scene, cuOb, vertexCos[a], defaxis, &cd, NULL);
-				mul_m4_v3(cd.objectspace, vertexCos[a]);
-			}
 		}
 		else {
-			/* set mesh min max bounds */
-			INIT_MINMAX(cd.dmin, cd.dmax);
-				
 			for (a = 0; a < numVerts; a++) {
 				mul_m4_v3(cd.curvespace, vertexCos[a]);
 				minmax_v3v3_v3(cd.dmin, cd.dmax, vertexCos[a]);
 			}
-	
-			for (a = 0; a < numVerts; a++) {
-				/* already in 'cd.curvespace', prev for loop */
-				calc_curve_deform(scene, cuOb, vertexCos[a], defaxis, &cd, NULL);
-				mul_m4_v3(cd.objectspace, vertexCos[a]);
-			}
 		}
 	}
+
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.min_iter_per_thread = 1024;
+	BLI_task_parallel_range(0, numVerts, &data, curve_deform_vert_task, &settings);
 }
 
 /* input vec and orco = local coord in armature space */
@@ -855,11 +880,37 @@ void curve_deform_vector(Scene *scene, Object *cuOb, Object *target,
 
 }
 
+typedef struct LatticeDeformUserdata {
+	LatticeDeformData *lattice_deform_data;
+	float (*vertexCos)[3];
+	MDeformVert *dvert;
+	int defgrp_index;
+	float fac;
+} LatticeDeformUserdata;
+
+static void lattice_deform_vert_task(
+        void *__restrict userdata,
+        const int i,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	const LatticeDeformUserdata *data = userdata;
+
+	if (data->defgrp_index != -1) {
+		const float weight = defvert_find_weight(&data->dvert[i], data->defgrp_index);
+
+		if (weight > 0.0f) {
+			calc_latt_deform(data->lattice_deform_data, data->vertexCos[i], weight * data->fac);
+		}
+	}
+	else {
+		calc_latt_deform(data->lattice_deform_data, data->vertexCos[i], data->fac);
+	}
+}
+
 void lattice_deform_verts(Object *laOb, Object *target, DerivedMesh *dm,
                           float (*vertexCos)[3], int numVerts, const char *vgroup, float fac)
 {
 	LatticeDeformData *lattice_deform_data;
-	int a;
 	bool use_vgroups;
 
 	if (laOb->type != OB_LATTICE)
@@ -885,29 +936,33 @@ void lattice_deform_verts(Object *laOb, Object *target, DerivedMesh *dm,
 		use_vgroups = false;
 	}
 	
+	LatticeDeformUserdata data = {
+	    .lattice_deform_data = lattice_deform_data, .vertexCos = vertexCos,
+	    .dvert = NULL, .defgrp_index = -1, .fac = fac,
+	};
+
 	if (vgroup && vgroup[0] && use_vgroups) {
 		Mesh *me = target->data;
 		const int defgrp_index = defgroup_name_index(target, vgroup);
-		float weight;
 
-		if (defgrp_index >= 0 && (me->dvert || dm)) {
-			MDeformVert *dvert = me->dvert;
-			
-			for (a = 0; a < numVerts; a++, dvert++) {
-				if (dm) dvert = dm->getVertData(dm, a, CD_MDEFORMVERT);
+		MDeformVert *dvert = (dm) ? dm->getVertDataArray(dm, CD_MDEFORMVERT) : me->dvert;
 
-				weight = defvert_find_weight(dvert, defgrp_index);
-
-				if (weight > 0.0f)
-					calc_latt_deform(lattice_deform_data, vertexCos[a], weight * fac);
-			}
+		if (defgrp_index >= 0 && dvert) {
+			data.dvert = dvert;
+			data.defgrp_index = defgrp_index;
 		}
-	}
-	else {
-		for (a = 0; a < numVerts; a++) {
-			calc_latt_deform(lattice_deform_data, vertexCos[a], fac);
+		else {
+			/* Vertex group is used but missing, all weights are zero and nothing is deformed. */
+			end_latt_deform(lattice_deform_data);
+			return;
 		}
 	}
+
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.min_iter_per_thread = 1024;
+	BLI_task_parallel_range(0, numVerts, &data, lattice_deform_vert_task, &settings);
+
 	end_latt_deform(lattice_deform_data);
 }
 
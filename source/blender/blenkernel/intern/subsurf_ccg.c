@@ -679,6 +679,112 @@ static void free_ss_weights(WeightTable *wtable)
 		MEM_freeN(wtable->weight_table);
 }
 
+/* Check whether the CCG synced on a previous evaluation has the same topology
+ * and creases as the derived mesh, in which case only the vertex coordinates
+ * need to be updated and the hashed full sync can be skipped. */
+static bool ss_sync_ccg_topology_matches(CCGSubSurf *ss,
+                                         DerivedMesh *dm,
+                                         int useFlatSubdiv)
+{
+	const float creaseFactor = (float) ccgSubSurf_getSubdivisionLevels(ss);
+	const MEdge *medge = dm->getEdgeArray(dm);
+	const MLoop *mloop = dm->getLoopArray(dm);
+	const MPoly *mpoly = dm->getPolyArray(dm);
+	const int totvert = dm->getNumVerts(dm);
+	const int totedge = dm->getNumEdges(dm);
+	const int totpoly = dm->getNumPolys(dm);
+	CCGEdgeIterator ei;
+	CCGFaceIterator fi;
+
+	/* Handles are indices into the derived mesh arrays, equal counts mean
+	 * every element of the mesh has its CCG counterpart. */
+	if (totvert == 0 ||
+	    totvert != ccgSubSurf_getNumVerts(ss) ||
+	    totedge != ccgSubSurf_getNumEdges(ss) ||
+	    totpoly != ccgSubSurf_getNumFaces(ss))
+	{
+		return false;
+	}
+
+	for (ccgSubSurf_initEdgeIterator(ss, &ei); !ccgEdgeIterator_isStopped(&ei); ccgEdgeIterator_next(&ei)) {
+		CCGEdge *e = ccgEdgeIterator_getCurrent(&ei);
+		const int index = GET_INT_FROM_POINTER(ccgSubSurf_getEdgeEdgeHandle(e));
+		const MEdge *me = &medge[index];
+		const float crease = useFlatSubdiv ? creaseFactor :
+		                     me->crease * creaseFactor / 255.0f;
+
+		if (GET_UINT_FROM_POINTER(ccgSubSurf_getVertVertHandle(ccgSubSurf_getEdgeVert0(e))) != me->v1 ||
+		    GET_UINT_FROM_POINTER(ccgSubSurf_getVertVertHandle(ccgSubSurf_getEdgeVert1(e))) != me->v2 ||
+		    ccgSubSurf_getEdgeCrease(e) != crease)
+		{
+			return false;
+		}
+	}
+
+	for (ccgSubSurf_initFaceIterator(ss, &fi); !ccgFaceIterator_isStopped(&fi); ccgFaceIterator_next(&fi)) {
+		CCGFace *f = ccgFaceIterator_getCurrent(&fi);
+		const int index = GET_INT_FROM_POINTER(ccgSubSurf_getFaceFaceHandle(f));
+		const MPoly *mp = &mpoly[index];
+		const MLoop *ml = &mloop[mp->loopstart];
+		int S;
+
+		if (ccgSubSurf_getFaceNumVerts(f) != mp->totloop) {
+			return false;
+		}
+		for (S = 0; S < mp->totloop; S++, ml++) {
+			if (GET_UINT_FROM_POINTER(ccgSubSurf_getVertVertHandle(ccgSubSurf_getFaceVert(f, S))) != ml->v) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/* Fast path for deforming meshes: walk the existing CCG elements directly and
+ * only push new coordinates and original indices, the partial sync then only
+ * subdivides the areas around vertices which actually moved. */
+static void ss_sync_ccg_coords_from_derivedmesh(CCGSubSurf *ss,
+                                                DerivedMesh *dm,
+                                                float (*vertexCos)[3])
+{
+	const MVert *mvert = dm->getVertArray(dm);
+	const int *vert_index = dm->getVertDataArray(dm, CD_ORIGINDEX);
+	const int *edge_index = dm->getEdgeDataArray(dm, CD_ORIGINDEX);
+	const int *poly_index = dm->getPolyDataArray(dm, CD_ORIGINDEX);
+	CCGVertIterator vi;
+	CCGEdgeIterator ei;
+	CCGFaceIterator fi;
+
+	if (ccgSubSurf_initPartialSync(ss) != eCCGError_None) {
+		return;
+	}
+
+	for (ccgSubSurf_initVertIterator(ss, &vi); !ccgVertIterator_isStopped(&vi); ccgVertIterator_next(&vi)) {
+		CCGVert *v = ccgVertIterator_getCurrent(&vi);
+		const int i = GET_INT_FROM_POINTER(ccgSubSurf_getVertVertHandle(v));
+
+		ccgSubSurf_syncVertData(ss, v, vertexCos ? vertexCos[i] : mvert[i].co);
+		((int *)ccgSubSurf_getVertUserData(ss, v))[1] = (vert_index) ? vert_index[i] : i;
+	}
+
+	for (ccgSubSurf_initEdgeIterator(ss, &ei); !ccgEdgeIterator_isStopped(&ei); ccgEdgeIterator_next(&ei)) {
+		CCGEdge *e = ccgEdgeIterator_getCurrent(&ei);
+		const int i = GET_INT_FROM_POINTER(ccgSubSurf_getEdgeEdgeHandle(e));
+
+		((int *)ccgSubSurf_getEdgeUserData(ss, e))[1] = (edge_index) ? edge_index[i] : i;
+	}
+
+	for (ccgSubSurf_initFaceIterator(ss, &fi); !ccgFaceIterator_isStopped(&fi); ccgFaceIterator_next(&fi)) {
+		CCGFace *f = ccgFaceIterator_getCurrent(&fi);
+		const int i = GET_INT_FROM_POINTER(ccgSubSurf_getFaceFaceHandle(f));
+
+		((int *)ccgSubSurf_getFaceUserData(ss, f))[1] = (poly_index) ? poly_index[i] : i;
+	}
+
+	ccgSubSurf_processSync(ss);
+}
+
 static void ss_sync_ccg_from_derivedmesh(CCGSubSurf *ss,
                                          DerivedMesh *dm,
                                          float (*vertexCos)[3],
@@ -704,6 +810,11 @@ static void ss_sync_ccg_from_derivedmesh(CCGSubSurf *ss,
 	int i, j;
 	int *index;
 
+	if (ss_sync_ccg_topology_matches(ss, dm, useFlatSubdiv)) {
+		ss_sync_ccg_coords_from_derivedmesh(ss, dm, vertexCos);
+		return;
+	}
+
 	ccgSubSurf_initFullSync(ss);
 
 	mv = mvert;
@@ -5163,6 +5274,31 @@ static bool subsurf_use_gpu_backend(SubsurfFlags flags)
 #endif
 }
 
+/* Whether the subsurf cached by the previous final calculation can be synced
+ * again with only new vertex coordinates. Since the arena allocator never
+ * frees, a full sync on the cache would grow its memory, so it is only kept
+ * when the topology, levels and layers are unchanged. */
+static bool ss_cache_reusable(CCGSubSurf *ss,
+                              DerivedMesh *dm,
+                              int levels,
+                              int useSimple,
+                              SubsurfFlags flags)
+{
+	CCGKey key;
+
+	if (flags & SUBSURF_ALLOC_PAINT_MASK) {
+		return false;
+	}
+	CCG_key_top_level(&key, ss);
+	if (key.has_mask ||
+	    ccgSubSurf_getSubdivisionLevels(ss) != MAX2(levels, 1) ||
+	    ccgSubSurf_getSimpleSubdiv(ss) != (useSimple != 0))
+	{
+		return false;
+	}
+	return ss_sync_ccg_topology_matches(ss, dm, useSimple);
+}
+
 struct DerivedMesh *subsurf_make_derived_from_derived(
         struct DerivedMesh *dm,
         struct SubsurfModifierData *smd,
@@ -5264,13 +5400,15 @@ struct DerivedMesh *subsurf_make_derived_from_derived(
 				}
 				else
 #endif
-				{
+				if (ss_cache_reusable(smd->mCache, dm, levels, useSimple, flags)) {
+					prevSS = smd->mCache;
+				}
+				else {
 					ccgSubSurf_free(smd->mCache);
 					smd->mCache = NULL;
 				}
 			}
 
-
 			if (flags & SUBSURF_ALLOC_PAINT_MASK)
 				ccg_flags |= CCG_ALLOC_MASK;
 
@@ -44,10 +44,16 @@
  *   #BLI_bvhtree_overlap, #BVHOverlapData_Shared, #BVHOverlapData_Thread
  * - Range Query:
  *   #BLI_bvhtree_range_query
+ * - Batched ray-cast and nearest point, evaluated in parallel:
+ *   #BLI_bvhtree_ray_cast_batch, #BLI_bvhtree_find_nearest_batch
  */
 
 #include <assert.h>
 
+#ifdef __SSE2__
+#  include <xmmintrin.h>
+#endif
+
 #include "MEM_guardedalloc.h"
 
 #include "BLI_utildefines.h"
@@ -80,6 +86,13 @@
 #  define KDOPBVH_THREAD_LEAF_THRESHOLD 1024
 #endif
 
+/* Batched queries are much more expensive than building a node, thread them sooner. */
+#ifdef DEBUG
+#  define KDOPBVH_THREAD_QUERY_THRESHOLD 0
+#else
+#  define KDOPBVH_THREAD_QUERY_THRESHOLD 64
+#endif
+
 
 /* -------------------------------------------------------------------- */
 
@@ -163,6 +176,13 @@ typedef struct BVHRayCastData {
 	float ray_dot_axis[13];
 	float idot_axis[13];
 	int index[6];
+#ifdef __SSE2__
+	/* x, y, z lanes of the ray for fast_ray_nearest_hit,
+	 * the sign mask is set where the near plane is the maximum. */
+	__m128 sse_origin;
+	__m128 sse_idot_axis;
+	__m128 sse_sign;
+#endif
 
 	BVHTreeRayHit hit;
 } BVHRayCastData;
@@ -288,6 +308,21 @@ static int floor_lg(int a)
 }
 #endif
 
+#ifdef __SSE2__
+/**
+ * Load the x, y and z slabs of a node as (min_x, min_y, min_z, min_z) and (max_x, max_y, max_z, max_z),
+ * only the first 6 values of \a bv are read.
+ */
+BLI_INLINE void bvhtree_node_bv_load_sse(const float *bv, __m128 *r_min, __m128 *r_max)
+{
+	const __m128 bv_xy = _mm_loadu_ps(bv);
+	const __m128 bv_z = _mm_loadl_pi(_mm_setzero_ps(), (const __m64 *)&bv[4]);
+
+	*r_min = _mm_shuffle_ps(bv_xy, bv_z, _MM_SHUFFLE(0, 0, 2, 0));
+	*r_max = _mm_shuffle_ps(bv_xy, bv_z, _MM_SHUFFLE(1, 1, 3, 1));
+}
+#endif
+
 static void node_minmax_init(const BVHTree *tree, BVHNode *node)
 {
 	axis_t axis_iter;
@@ -1385,6 +1420,26 @@ BVHTreeOverlap *BLI_bvhtree_overlap(
 /* Determines the nearest point of the given node BV. Returns the squared distance to that point. */
 static float calc_nearest_point_squared(const float proj[3], BVHNode *node, float nearest[3])
 {
+#ifdef __SSE2__
+	/* Same as below, clamping all three axes at once. */
+	const float *bv = node->bv;
+	__m128 bv_min, bv_max;
+	float nearest_v4[4], dist_v4[4];
+	__m128 co, nearest_sse, dist;
+
+	bvhtree_node_bv_load_sse(bv, &bv_min, &bv_max);
+
+	co = _mm_set_ps(0.0f, proj[2], proj[1], proj[0]);
+	nearest_sse = _mm_min_ps(_mm_max_ps(co, bv_min), bv_max);
+	dist = _mm_sub_ps(co, nearest_sse);
+	dist = _mm_mul_ps(dist, dist);
+
+	_mm_storeu_ps(nearest_v4, nearest_sse);
+	_mm_storeu_ps(dist_v4, dist);
+	copy_v3_v3(nearest, nearest_v4);
+
+	return dist_v4[0] + dist_v4[1] + dist_v4[2];
+#else
 	int i;
 	const float *bv = node->bv;
 
@@ -1416,6 +1471,7 @@ static float calc_nearest_point_squared(const float proj[3], BVHNode *node, floa
 #endif
 
 	return len_squared_v3v3(proj, nearest);
+#endif  /* __SSE2__ */
 }
 
 /* TODO: use a priority queue to reduce the number of nodes looked on */
@@ -1597,6 +1653,52 @@ int BLI_bvhtree_find_nearest(
 	return data.nearest.index;
 }
 
+typedef struct BVHNearestBatchData {
+	BVHTree *tree;
+	const float (*co)[3];
+	BVHTreeNearest *nearest;
+	BVHTree_NearestPointCallback callback;
+	void *userdata;
+} BVHNearestBatchData;
+
+static void bvhtree_find_nearest_batch_cb(
+        void *__restrict userdata,
+        const int i,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	BVHNearestBatchData *data = userdata;
+
+	BLI_bvhtree_find_nearest(data->tree, data->co[i], &data->nearest[i], data->callback, data->userdata);
+}
+
+/**
+ * Find the nearest node for each of \a co_len coordinates, in parallel.
+ *
+ * Each of \a nearest is used as in #BLI_bvhtree_find_nearest,
+ * so index and dist_sq must be initialized by the caller.
+ *
+ * \note \a callback is called from multiple threads at once.
+ */
+void BLI_bvhtree_find_nearest_batch(
+        BVHTree *tree, const float (*co)[3], BVHTreeNearest *nearest, int co_len,
+        BVHTree_NearestPointCallback callback, void *userdata)
+{
+	BVHNearestBatchData data = {
+		.tree = tree,
+		.co = co,
+		.nearest = nearest,
+		.callback = callback,
+		.userdata = userdata,
+	};
+
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = (co_len > KDOPBVH_THREAD_QUERY_THRESHOLD);
+	/* Queries vary a lot in cost. */
+	settings.scheduling_mode = TASK_SCHEDULING_DYNAMIC;
+	BLI_task_parallel_range(0, co_len, &data, bvhtree_find_nearest_batch_cb, &settings);
+}
+
 /** \} */
 
 
@@ -1652,6 +1754,31 @@ static float ray_nearest_hit(const BVHRayCastData *data, const float bv[6])
  * TODO this doesn't take data->ray.radius into consideration */
 static float fast_ray_nearest_hit(const BVHRayCastData *data, const BVHNode *node)
 {
+#ifdef __SSE2__
+	/* Same tests as below, on the x, y and z lanes. */
+	__m128 bv_min, bv_max, t1, t2, miss;
+	float t1_v4[4];
+
+	bvhtree_node_bv_load_sse(node->bv, &bv_min, &bv_max);
+
+	t1 = _mm_or_ps(_mm_and_ps(data->sse_sign, bv_max), _mm_andnot_ps(data->sse_sign, bv_min));
+	t2 = _mm_or_ps(_mm_and_ps(data->sse_sign, bv_min), _mm_andnot_ps(data->sse_sign, bv_max));
+	t1 = _mm_mul_ps(_mm_sub_ps(t1, data->sse_origin), data->sse_idot_axis);
+	t2 = _mm_mul_ps(_mm_sub_ps(t2, data->sse_origin), data->sse_idot_axis);
+
+	/* Compare each near distance with the far distances of the other two axes. */
+	miss = _mm_or_ps(_mm_cmpgt_ps(t1, _mm_shuffle_ps(t2, t2, _MM_SHUFFLE(3, 0, 2, 1))),
+	                 _mm_cmpgt_ps(t1, _mm_shuffle_ps(t2, t2, _MM_SHUFFLE(3, 1, 0, 2))));
+	miss = _mm_or_ps(miss, _mm_cmplt_ps(t2, _mm_setzero_ps()));
+	miss = _mm_or_ps(miss, _mm_cmpgt_ps(t1, _mm_set1_ps(data->hit.dist)));
+
+	if (_mm_movemask_ps(miss) & 0x7) {
+		return FLT_MAX;
+	}
+
+	_mm_storeu_ps(t1_v4, t1);
+	return max_fff(t1_v4[0], t1_v4[1], t1_v4[2]);
+#else
 	const float *bv = node->bv;
 	
 	float t1x = (bv[data->index[0]] - data->ray.origin[0]) * data->idot_axis[0];
@@ -1670,6 +1797,7 @@ static float fast_ray_nearest_hit(const BVHRayCastData *data, const BVHNode *nod
 	else {
 		return max_fff(t1x, t1y, t1z);
 	}
+#endif  /* __SSE2__ */
 }
 
 static void dfs_raycast(BVHRayCastData *data, BVHNode *node)
@@ -1792,6 +1920,12 @@ static void bvhtree_ray_cast_data_precalc(BVHRayCastData *data, int flag)
 		data->index[2 * i + 1] += 2 * i;
 	}
 
+#ifdef __SSE2__
+	data->sse_origin = _mm_set_ps(0.0f, data->ray.origin[2], data->ray.origin[1], data->ray.origin[0]);
+	data->sse_idot_axis = _mm_set_ps(0.0f, data->idot_axis[2], data->idot_axis[1], data->idot_axis[0]);
+	data->sse_sign = _mm_cmplt_ps(data->sse_idot_axis, _mm_setzero_ps());
+#endif
+
 #ifdef USE_KDOPBVH_WATERTIGHT
 	if (flag & BVH_RAYCAST_WATERTIGHT) {
 		isect_ray_tri_watertight_v3_precalc(&data->isect_precalc, data->ray.direction);
@@ -1923,6 +2057,58 @@ void BLI_bvhtree_ray_cast_all(
 	BLI_bvhtree_ray_cast_all_ex(tree, co, dir, radius, hit_dist, callback, userdata, BVH_RAYCAST_DEFAULT);
 }
 
+typedef struct BVHRayCastBatchData {
+	BVHTree *tree;
+	const BVHTreeRay *rays;
+	BVHTreeRayHit *hits;
+	BVHTree_RayCastCallback callback;
+	void *userdata;
+	int flag;
+} BVHRayCastBatchData;
+
+static void bvhtree_ray_cast_batch_cb(
+        void *__restrict userdata,
+        const int i,
+        const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	BVHRayCastBatchData *data = userdata;
+	const BVHTreeRay *ray = &data->rays[i];
+
+	BLI_bvhtree_ray_cast_ex(
+	        data->tree, ray->origin, ray->direction, ray->radius, &data->hits[i],
+	        data->callback, data->userdata, data->flag);
+}
+
+/**
+ * Cast \a rays_len rays, in parallel.
+ *
+ * Only origin, direction and radius of \a rays are used. Each of \a hits is used as in
+ * #BLI_bvhtree_ray_cast_ex, so index and dist must be initialized by the caller.
+ *
+ * \note \a callback is called from multiple threads at once.
+ */
+void BLI_bvhtree_ray_cast_batch(
+        BVHTree *tree, const BVHTreeRay *rays, BVHTreeRayHit *hits, int rays_len,
+        BVHTree_RayCastCallback callback, void *userdata,
+        int flag)
+{
+	BVHRayCastBatchData data = {
+		.tree = tree,
+		.rays = rays,
+		.hits = hits,
+		.callback = callback,
+		.userdata = userdata,
+		.flag = flag,
+	};
+
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = (rays_len > KDOPBVH_THREAD_QUERY_THRESHOLD);
+	/* Rays vary a lot in cost. */
+	settings.scheduling_mode = TASK_SCHEDULING_DYNAMIC;
+	BLI_task_parallel_range(0, rays_len, &data, bvhtree_ray_cast_batch_cb, &settings);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
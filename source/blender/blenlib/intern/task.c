@@ -49,18 +49,21 @@
  */
 #define MEMPOOL_SIZE 256
 
-/* Number of tasks which are pushed directly to local thread queue.
+/* Number of tasks which fits into a per-thread work-stealing deque.
  *
- * This allows thread to fetch next task without locking the whole queue.
+ * Must be a power of two. When the deque is saturated tasks are pushed to the
+ * global scheduler's queue instead. More details could be found at TaskDeque.
  */
-#define LOCAL_QUEUE_SIZE 1
+#define TASK_DEQUE_SIZE 4096
 
-/* Number of tasks which are allowed to be scheduled in a delayed manner.
- *
- * This allows to use less locks per graph node children schedule. More details
- * could be found at TaskThreadLocalStorage::do_delayed_push.
+/* Size of a CPU cache line, used to avoid false sharing between the deque
+ * indices which are modified by different threads.
  */
-#define DELAYED_QUEUE_SIZE 4096
+#define TASK_CACHE_LINE_SIZE 64
+
+/* Access value which might be modified by other threads, without any locks. */
+#define TASK_ATOMIC_LOAD(type, value) (*(type volatile *)&(value))
+#define TASK_ATOMIC_STORE(type, value, new_value) (*(type volatile *)&(value) = (new_value))
 
 #ifndef NDEBUG
 #  define ASSERT_THREAD_ID(scheduler, thread_id)                              \
@@ -142,31 +145,58 @@ typedef struct TaskThreadLocalStorage {
 	 */
 	TaskMemPool task_mempool;
 
-	/* Local queue keeps thread alive by keeping small amount of tasks ready
-	 * to be picked up without causing global thread locks for synchronization.
-	 */
-	int num_local_queue;
-	Task *local_queue[LOCAL_QUEUE_SIZE];
-
 	/* Thread can be marked for delayed tasks push. This is helpful when it's
 	 * know that lots of subsequent task pushed will happen from the same thread
 	 * without "interrupting" for task execution.
 	 *
-	 * We try to accumulate as much tasks as possible in a local queue without
-	 * any locks first, and then we push all of them into a scheduler's queue
-	 * from within a single mutex lock.
+	 * Tasks are accumulated in the thread's deque without waking up any of the
+	 * sleeping worker threads, and all of them are woken up at once when the
+	 * delayed push is finished.
 	 */
 	bool do_delayed_push;
-	int num_delayed_queue;
-	Task *delayed_queue[DELAYED_QUEUE_SIZE];
 } TaskThreadLocalStorage;
 
+/* Work-stealing deque of tasks (Chase-Lev).
+ *
+ * Every thread of the scheduler owns one deque. The owner pushes and pops tasks
+ * at the bottom end without any locks, so newest tasks (which are most likely to
+ * have their data in the CPU cache) are handled first. Other threads which ran
+ * out of work steal the oldest tasks from the top end, using a single atomic
+ * compare-and-swap.
+ *
+ * Indices are only ever increasing and are wrapped into the fixed size items
+ * array, comparison between indices is done on their difference so it stays
+ * correct when the counters overflow.
+ *
+ * The pool is stored next to the task, so thieves can check whether the task
+ * belongs to the pool they're waiting for, without accessing task memory which
+ * might be re-used already.
+ */
+typedef struct TaskDequeItem {
+	Task *task;
+	TaskPool *pool;
+} TaskDequeItem;
+
+typedef struct TaskDeque {
+	/* Index of the oldest task, advanced by thieves and by the owner when it
+	 * pops the last task.
+	 */
+	size_t top;
+	char _pad1[TASK_CACHE_LINE_SIZE - sizeof(size_t)];
+	/* Index past the newest task, only modified by the owner thread. */
+	size_t bottom;
+	char _pad2[TASK_CACHE_LINE_SIZE - sizeof(size_t)];
+	TaskDequeItem items[TASK_DEQUE_SIZE];
+} TaskDeque;
+
 struct TaskPool {
 	TaskScheduler *scheduler;
 
 	volatile size_t num;
 	ThreadMutex num_mutex;
 	ThreadCondition num_cond;
+	/* Number of threads which are waiting on num_cond for this pool. */
+	uint32_t num_waiters;
 
 	void *userdata;
 	ThreadMutex user_mutex;
@@ -210,9 +240,18 @@ struct TaskScheduler {
 	int num_threads;
 	bool background_thread_only;
 
+	/* Global queue, used for tasks pushed from outside of the scheduler's
+	 * threads, for tasks of suspended pools and when thread's deque is full.
+	 */
 	ListBase queue;
 	ThreadMutex queue_mutex;
 	ThreadCondition queue_cond;
+	/* Number of tasks in the global queue. Only modified with queue_mutex
+	 * locked, but is read without lock to check whether locking is needed.
+	 */
+	size_t num_queued;
+	/* Number of worker threads sleeping on queue_cond. */
+	uint32_t num_sleeping;
 
 	volatile bool do_exit;
 
@@ -224,6 +263,7 @@ typedef struct TaskThread {
 	TaskScheduler *scheduler;
 	int id;
 	TaskThreadLocalStorage tls;
+	TaskDeque deque;
 } TaskThread;
 
 /* Helper */
@@ -326,100 +366,337 @@ static void task_free(TaskPool *pool, Task *task, const int thread_id)
 	}
 }
 
+/* Task Deque */
+
+BLI_INLINE void task_deque_init(TaskDeque *deque)
+{
+	deque->top = 0;
+	deque->bottom = 0;
+}
+
+BLI_INLINE bool task_deque_is_empty(TaskDeque *deque)
+{
+	const size_t top = TASK_ATOMIC_LOAD(size_t, deque->top);
+	const size_t bottom = TASK_ATOMIC_LOAD(size_t, deque->bottom);
+	return (ptrdiff_t)(bottom - top) <= 0;
+}
+
+/* Only to be called by the deque owner. */
+BLI_INLINE bool task_deque_is_full(TaskDeque *deque)
+{
+	/* Top might be outdated here, but it only grows, so the worst case is that
+	 * we consider deque to be full a bit too early.
+	 */
+	const size_t top = TASK_ATOMIC_LOAD(size_t, deque->top);
+	return (ptrdiff_t)(deque->bottom - top) >= TASK_DEQUE_SIZE;
+}
+
+/* Only to be called by the deque owner, after checking deque is not full. */
+BLI_INLINE void task_deque_push(TaskDeque *deque, Task *task)
+{
+	const size_t bottom = deque->bottom;
+	TaskDequeItem *item = &deque->items[bottom & (TASK_DEQUE_SIZE - 1)];
+	BLI_assert(!task_deque_is_full(deque));
+	item->task = task;
+	item->pool = task->pool;
+	/* Publish the task, atomic operation also acts as a memory barrier. */
+	atomic_add_and_fetch_z(&deque->bottom, 1);
+}
+
+/* Pop the newest task from the deque.
+ *
+ * Only to be called by the deque owner. Tasks which are below the given limit
+ * index are left in the deque, unless they belong to the given pool.
+ */
+static Task *task_deque_pop(TaskDeque *deque, const size_t limit, TaskPool *pool)
+{
+	if ((ptrdiff_t)(deque->bottom - limit) <= 0) {
+		/* Only the owner writes items, so reading the pool is safe here. */
+		if (pool == NULL ||
+		    task_deque_is_empty(deque) ||
+		    deque->items[(deque->bottom - 1) & (TASK_DEQUE_SIZE - 1)].pool != pool)
+		{
+			return NULL;
+		}
+	}
+	const size_t bottom = atomic_sub_and_fetch_z(&deque->bottom, 1);
+	const size_t top = TASK_ATOMIC_LOAD(size_t, deque->top);
+	if ((ptrdiff_t)(bottom - top) < 0) {
+		/* Deque was emptied by thieves. */
+		TASK_ATOMIC_STORE(size_t, deque->bottom, bottom + 1);
+		return NULL;
+	}
+	Task *task = deque->items[bottom & (TASK_DEQUE_SIZE - 1)].task;
+	if (bottom == top) {
+		/* This is the last task in the deque, race against thieves for it. */
+		if (atomic_cas_z(&deque->top, top, top + 1) != top) {
+			task = NULL;
+		}
+		TASK_ATOMIC_STORE(size_t, deque->bottom, bottom + 1);
+	}
+	return task;
+}
+
+/* Steal the oldest task from the deque.
+ *
+ * Can be called from any thread. If pool is not NULL, only task which belongs
+ * to that pool will be stolen.
+ */
+static Task *task_deque_steal(TaskDeque *deque, TaskPool *pool)
+{
+	/* Cheap check first, to avoid atomic operations on empty deques. */
+	if (task_deque_is_empty(deque)) {
+		return NULL;
+	}
+	/* Atomic operation here acts as a memory barrier, so bottom is read after top. */
+	const size_t top = atomic_fetch_and_add_z(&deque->top, 0);
+	const size_t bottom = TASK_ATOMIC_LOAD(size_t, deque->bottom);
+	if ((ptrdiff_t)(bottom - top) <= 0) {
+		return NULL;
+	}
+	volatile TaskDequeItem *item = &deque->items[top & (TASK_DEQUE_SIZE - 1)];
+	Task *task = item->task;
+	if (pool != NULL && item->pool != pool) {
+		return NULL;
+	}
+	/* If top did not change since we've read it, the item was not re-used
+	 * by the owner yet and the task is ours.
+	 */
+	if (atomic_cas_z(&deque->top, top, top + 1) != top) {
+		return NULL;
+	}
+	return task;
+}
+
 /* Task Scheduler */
 
 static void task_pool_num_decrease(TaskPool *pool, size_t done)
 {
-	BLI_mutex_lock(&pool->num_mutex);
-
 	BLI_assert(pool->num >= done);
 
-	pool->num -= done;
+	/* Only last decrease is done with mutex locked, so waiting threads are
+	 * notified and pool can't be freed by them before we're done here.
+	 */
+	while (true) {
+		const size_t num = pool->num;
+		if (num == done) {
+			break;
+		}
+		if (atomic_cas_z((size_t *)&pool->num, num, num - done) == num) {
+			return;
+		}
+	}
+
+	BLI_mutex_lock(&pool->num_mutex);
 
-	if (pool->num == 0)
-		BLI_condition_notify_all(&pool->num_cond);
+	atomic_sub_and_fetch_z((size_t *)&pool->num, done);
+	BLI_condition_notify_all(&pool->num_cond);
 
 	BLI_mutex_unlock(&pool->num_mutex);
 }
 
 static void task_pool_num_increase(TaskPool *pool, size_t new)
 {
-	BLI_mutex_lock(&pool->num_mutex);
+	atomic_add_and_fetch_z((size_t *)&pool->num, new);
+}
 
-	pool->num += new;
-	BLI_condition_notify_all(&pool->num_cond);
+/* Wake up threads waiting for the pool, so they can help with new tasks.
+ * Must be called after new tasks became visible to other threads.
+ */
+static void task_pool_notify_waiters(TaskPool *pool)
+{
+	if (TASK_ATOMIC_LOAD(uint32_t, pool->num_waiters) != 0) {
+		BLI_mutex_lock(&pool->num_mutex);
+		BLI_condition_notify_all(&pool->num_cond);
+		BLI_mutex_unlock(&pool->num_mutex);
+	}
+}
 
-	BLI_mutex_unlock(&pool->num_mutex);
+/* Wake up sleeping worker threads, so they can steal new tasks.
+ * Must be called after new tasks became visible to other threads.
+ */
+static void task_scheduler_notify_workers(TaskScheduler *scheduler, const bool notify_all)
+{
+	if (TASK_ATOMIC_LOAD(uint32_t, scheduler->num_sleeping) != 0) {
+		BLI_mutex_lock(&scheduler->queue_mutex);
+		if (notify_all) {
+			BLI_condition_notify_all(&scheduler->queue_cond);
+		}
+		else {
+			BLI_condition_notify_one(&scheduler->queue_cond);
+		}
+		BLI_mutex_unlock(&scheduler->queue_mutex);
+	}
+}
+
+BLI_INLINE bool task_scheduler_can_run_task(TaskScheduler *scheduler, Task *task)
+{
+	return !scheduler->background_thread_only || task->pool->run_in_background;
+}
+
+/* Get task from the global queue, scheduler's queue_mutex is to be locked.
+ * If pool is not NULL only tasks from this pool are considered.
+ */
+static Task *task_scheduler_queue_find_locked(TaskScheduler *scheduler, TaskPool *pool)
+{
+	for (Task *task = scheduler->queue.first; task != NULL; task = task->next) {
+		if (pool != NULL) {
+			if (task->pool == pool) {
+				return task;
+			}
+		}
+		else if (task_scheduler_can_run_task(scheduler, task)) {
+			return task;
+		}
+	}
+	return NULL;
 }
 
-static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, Task **task)
+static Task *task_scheduler_queue_pop(TaskScheduler *scheduler, TaskPool *pool)
 {
-	bool found_task = false;
+	Task *task;
+
+	/* Avoid global lock when there's nothing in the queue. */
+	if (TASK_ATOMIC_LOAD(size_t, scheduler->num_queued) == 0) {
+		return NULL;
+	}
+
 	BLI_mutex_lock(&scheduler->queue_mutex);
+	task = task_scheduler_queue_find_locked(scheduler, pool);
+	if (task != NULL) {
+		BLI_remlink(&scheduler->queue, task);
+		scheduler->num_queued--;
+	}
+	BLI_mutex_unlock(&scheduler->queue_mutex);
 
-	while (!scheduler->queue.first && !scheduler->do_exit)
-		BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
+	return task;
+}
 
-	do {
-		Task *current_task;
+/* Steal task from any of the threads' deques, starting with the one after the
+ * given thread so thieves are spread across the victims.
+ */
+static Task *task_scheduler_steal(TaskScheduler *scheduler, const int thread_id, TaskPool *pool)
+{
+	if (scheduler->background_thread_only) {
+		return NULL;
+	}
+	const int num_deques = scheduler->num_threads + 1;
+	for (int i = 1; i <= num_deques; i++) {
+		TaskDeque *deque = &scheduler->task_threads[(thread_id + i) % num_deques].deque;
+		Task *task = task_deque_steal(deque, pool);
+		if (task != NULL) {
+			return task;
+		}
+	}
+	return NULL;
+}
 
-		/* Assuming we can only have a void queue in 'exit' case here seems logical (we should only be here after
-		 * our worker thread has been woken up from a condition_wait(), which only happens after a new task was
-		 * added to the queue), but it is wrong.
-		 * Waiting on condition may wake up the thread even if condition is not signaled (spurious wake-ups), and some
-		 * race condition may also empty the queue **after** condition has been signaled, but **before** awoken thread
-		 * reaches this point...
-		 * See http://stackoverflow.com/questions/8594591
-		 *
-		 * So we only abort here if do_exit is set.
+/* Check whether there's any task in the deques which can be stolen.
+ *
+ * When a pool is given, the whole range of each deque (from top to bottom) is
+ * checked for tasks of that pool. Such a task might be buried under tasks of
+ * other pools, which the waiting thread can't steal, but it is guaranteed to
+ * be uncovered: the worker threads steal from all pools and don't go to sleep
+ * while any deque is non-empty (they call this with a NULL pool), and the deque
+ * owner pops from the other end. So the invariant is that a thread waiting for
+ * a pool only goes to sleep when none of the deques holds any task of the pool,
+ * in which case the pool's remaining tasks are all running or in the queue, and
+ * the waiter is notified when they're done or new ones are pushed.
+ */
+static bool task_scheduler_has_stealable_task(TaskScheduler *scheduler, TaskPool *pool)
+{
+	if (scheduler->background_thread_only) {
+		return false;
+	}
+	for (int i = 0; i < scheduler->num_threads + 1; i++) {
+		TaskDeque *deque = &scheduler->task_threads[i].deque;
+		if (task_deque_is_empty(deque)) {
+			continue;
+		}
+		if (pool == NULL) {
+			return true;
+		}
+		/* Items might be stolen and re-used while we're looking at them, which
+		 * can only give false positives, and the caller simply tries again.
 		 */
+		const size_t top = TASK_ATOMIC_LOAD(size_t, deque->top);
+		const size_t bottom = TASK_ATOMIC_LOAD(size_t, deque->bottom);
+		for (size_t index = top; (ptrdiff_t)(bottom - index) > 0; index++) {
+			if (TASK_ATOMIC_LOAD(TaskPool *, deque->items[index & (TASK_DEQUE_SIZE - 1)].pool) == pool) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+static bool task_scheduler_thread_wait_pop(TaskThread *thread, Task **task)
+{
+	TaskScheduler *scheduler = thread->scheduler;
+	TaskDeque *deque = &thread->deque;
+
+	while (true) {
 		if (scheduler->do_exit) {
-			BLI_mutex_unlock(&scheduler->queue_mutex);
 			return false;
 		}
 
-		for (current_task = scheduler->queue.first;
-		     current_task != NULL;
-		     current_task = current_task->next)
-		{
-			TaskPool *pool = current_task->pool;
-
-			if (scheduler->background_thread_only && !pool->run_in_background) {
-				continue;
+		/* Own tasks first, no locks and best cache coherency. */
+		if (!scheduler->background_thread_only) {
+			*task = task_deque_pop(deque, TASK_ATOMIC_LOAD(size_t, deque->top), NULL);
+			if (*task != NULL) {
+				return true;
 			}
+		}
 
-			*task = current_task;
-			found_task = true;
-			BLI_remlink(&scheduler->queue, *task);
-			break;
+		*task = task_scheduler_queue_pop(scheduler, NULL);
+		if (*task != NULL) {
+			return true;
 		}
-		if (!found_task)
-			BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
-	} while (!found_task);
 
-	BLI_mutex_unlock(&scheduler->queue_mutex);
+		*task = task_scheduler_steal(scheduler, thread->id, NULL);
+		if (*task != NULL) {
+			return true;
+		}
 
-	return true;
+		/* Nothing to do, go to sleep.
+		 *
+		 * Sleeping counter is increased before checking for tasks, and threads
+		 * which are pushing tasks check that counter after task is published.
+		 * This way either we see the new task here, or the pushing thread sees
+		 * us sleeping and notifies the condition (which it can only do after we
+		 * started waiting on it, since we're holding the mutex).
+		 *
+		 * Waiting on condition may wake up the thread even if condition is not
+		 * signaled (spurious wake-ups), and some race condition may also empty
+		 * the queue **after** condition has been signaled, so we simply start
+		 * over after waking up.
+		 * See http://stackoverflow.com/questions/8594591
+		 */
+		BLI_mutex_lock(&scheduler->queue_mutex);
+		atomic_add_and_fetch_uint32(&scheduler->num_sleeping, 1);
+		if (!scheduler->do_exit &&
+		    task_scheduler_queue_find_locked(scheduler, NULL) == NULL &&
+		    !task_scheduler_has_stealable_task(scheduler, NULL))
+		{
+			BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
+		}
+		atomic_sub_and_fetch_uint32(&scheduler->num_sleeping, 1);
+		BLI_mutex_unlock(&scheduler->queue_mutex);
+	}
 }
 
-BLI_INLINE void handle_local_queue(TaskThreadLocalStorage *tls,
-                                   const int thread_id)
+BLI_INLINE void task_run_and_free(Task *task, const int thread_id)
 {
-	BLI_assert(!tls->do_delayed_push);
-	while (tls->num_local_queue > 0) {
-		/* We pop task from queue before handling it so handler of the task can
-		 * push next job to the local queue.
-		 */
-		tls->num_local_queue--;
-		Task *local_task = tls->local_queue[tls->num_local_queue];
-		/* TODO(sergey): Double-check work_and_wait() doesn't handle other's
-		 * pool tasks.
-		 */
-		TaskPool *local_pool = local_task->pool;
-		local_task->run(local_pool, local_task->taskdata, thread_id);
-		task_free(local_pool, local_task, thread_id);
-	}
-	BLI_assert(!tls->do_delayed_push);
+	TaskPool *pool = task->pool;
+
+	/* run task */
+	task->run(pool, task->taskdata, thread_id);
+
+	/* delete task */
+	task_free(pool, task, thread_id);
+
+	/* notify pool task was done */
+	task_pool_num_decrease(pool, 1);
 }
 
 static void *task_scheduler_thread_run(void *thread_p)
@@ -432,23 +709,13 @@ static void *task_scheduler_thread_run(void *thread_p)
 
 	pthread_setspecific(scheduler->tls_id_key, thread);
 
-	/* keep popping off tasks */
-	while (task_scheduler_thread_wait_pop(scheduler, &task)) {
-		TaskPool *pool = task->pool;
+	UNUSED_VARS_NDEBUG(tls);
 
-		/* run task */
+	/* keep popping off tasks */
+	while (task_scheduler_thread_wait_pop(thread, &task)) {
 		BLI_assert(!tls->do_delayed_push);
-		task->run(pool, task->taskdata, thread_id);
+		task_run_and_free(task, thread_id);
 		BLI_assert(!tls->do_delayed_push);
-
-		/* delete task */
-		task_free(pool, task, thread_id);
-
-		/* Handle all tasks from local queue. */
-		handle_local_queue(tls, thread_id);
-
-		/* notify pool task was done */
-		task_pool_num_decrease(pool, 1);
 	}
 
 	return NULL;
@@ -485,6 +752,7 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
 
 	/* Initialize TLS for main thread. */
 	initialize_task_tls(&scheduler->task_threads[0].tls);
+	task_deque_init(&scheduler->task_threads[0].deque);
 
 	pthread_key_create(&scheduler->tls_id_key, NULL);
 
@@ -500,7 +768,11 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
 			thread->scheduler = scheduler;
 			thread->id = i + 1;
 			initialize_task_tls(&thread->tls);
+			task_deque_init(&thread->deque);
+		}
 
+		for (i = 0; i < num_threads; i++) {
+			TaskThread *thread = &scheduler->task_threads[i + 1];
 			if (pthread_create(&scheduler->threads[i], NULL, task_scheduler_thread_run, thread) != 0) {
 				fprintf(stderr, "TaskScheduler failed to launch thread %d/%d\n", i, num_threads);
 			}
@@ -538,6 +810,7 @@ void BLI_task_scheduler_free(TaskScheduler *scheduler)
 	if (scheduler->task_threads) {
 		for (int i = 0; i < scheduler->num_threads + 1; ++i) {
 			TaskThreadLocalStorage *tls = &scheduler->task_threads[i].tls;
+			BLI_assert(task_deque_is_empty(&scheduler->task_threads[i].deque));
 			free_task_tls(tls);
 		}
 
@@ -564,7 +837,9 @@ int BLI_task_scheduler_num_threads(TaskScheduler *scheduler)
 
 static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriority priority)
 {
-	task_pool_num_increase(task->pool, 1);
+	TaskPool *pool = task->pool;
+
+	task_pool_num_increase(pool, 1);
 
 	/* add task to queue */
 	BLI_mutex_lock(&scheduler->queue_mutex);
@@ -573,30 +848,14 @@ static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriori
 		BLI_addhead(&scheduler->queue, task);
 	else
 		BLI_addtail(&scheduler->queue, task);
+	scheduler->num_queued++;
 
-	BLI_condition_notify_one(&scheduler->queue_cond);
-	BLI_mutex_unlock(&scheduler->queue_mutex);
-}
-
-static void task_scheduler_push_all(TaskScheduler *scheduler,
-                                    TaskPool *pool,
-                                    Task **tasks,
-                                    int num_tasks)
-{
-	if (num_tasks == 0) {
-		return;
-	}
-
-	task_pool_num_increase(pool, num_tasks);
-
-	BLI_mutex_lock(&scheduler->queue_mutex);
-
-	for (int i = 0; i < num_tasks; i++) {
-		BLI_addhead(&scheduler->queue, tasks[i]);
+	if (scheduler->num_sleeping != 0) {
+		BLI_condition_notify_one(&scheduler->queue_cond);
 	}
-
-	BLI_condition_notify_all(&scheduler->queue_cond);
 	BLI_mutex_unlock(&scheduler->queue_mutex);
+
+	task_pool_notify_waiters(pool);
 }
 
 static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
@@ -617,11 +876,14 @@ static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
 			done++;
 		}
 	}
+	scheduler->num_queued -= done;
 
 	BLI_mutex_unlock(&scheduler->queue_mutex);
 
 	/* notify done */
-	task_pool_num_decrease(pool, done);
+	if (done != 0) {
+		task_pool_num_decrease(pool, done);
+	}
 }
 
 /* Task Pool */
@@ -647,6 +909,7 @@ static TaskPool *task_pool_create_ex(TaskScheduler *scheduler,
 
 	pool->scheduler = scheduler;
 	pool->num = 0;
+	pool->num_waiters = 0;
 	pool->do_cancel = false;
 	pool->do_work = false;
 	pool->is_suspended = is_suspended;
@@ -771,6 +1034,24 @@ BLI_INLINE bool task_can_use_local_queues(TaskPool *pool, int thread_id)
 	return (thread_id != -1 && (thread_id != pool->thread_id || pool->do_work));
 }
 
+/* Get work-stealing deque owned by the given thread, or NULL if the thread
+ * does not have one (non-scheduler thread, or single threaded scheduler where
+ * only tasks from background pools are to be handled by the worker thread).
+ */
+BLI_INLINE TaskDeque *get_task_deque(TaskPool *pool, const int thread_id)
+{
+	TaskScheduler *scheduler = pool->scheduler;
+	BLI_assert(thread_id >= 0);
+	BLI_assert(thread_id <= scheduler->num_threads);
+	if (scheduler->background_thread_only) {
+		return NULL;
+	}
+	if (pool->use_local_tls && thread_id == 0) {
+		return NULL;
+	}
+	return &scheduler->task_threads[thread_id].deque;
+}
+
 static void task_pool_push(
         TaskPool *pool, TaskRunFunction run, void *taskdata,
         bool free_taskdata, TaskFreeFunction freedata, TaskPriority priority,
@@ -794,29 +1075,28 @@ static void task_pool_push(
 		atomic_fetch_and_add_z(&pool->num_suspended, 1);
 		return;
 	}
-	/* Populate to any local queue first, this is cheapest push ever. */
+	/* Populate to the thread's own deque first, this is cheapest push ever.
+	 * Task will be picked up by this thread next, unless some other thread
+	 * runs out of work and steals it.
+	 */
 	if (task_can_use_local_queues(pool, thread_id)) {
 		ASSERT_THREAD_ID(pool->scheduler, thread_id);
-		TaskThreadLocalStorage *tls = get_task_tls(pool, thread_id);
-		/* Try to push to a local execution queue.
-		 * These tasks will be picked up next.
-		 */
-		if (tls->num_local_queue < LOCAL_QUEUE_SIZE) {
-			tls->local_queue[tls->num_local_queue] = task;
-			tls->num_local_queue++;
-			return;
-		}
-		/* If we are in the delayed tasks push mode, we push tasks to a
-		 * temporary local queue first without any locks, and then move them
-		 * to global execution queue with a single lock.
-		 */
-		if (tls->do_delayed_push && tls->num_delayed_queue < DELAYED_QUEUE_SIZE) {
-			tls->delayed_queue[tls->num_delayed_queue] = task;
-			tls->num_delayed_queue++;
+		TaskDeque *deque = get_task_deque(pool, thread_id);
+		if (deque != NULL && !task_deque_is_full(deque)) {
+			TaskThreadLocalStorage *tls = get_task_tls(pool, thread_id);
+			task_pool_num_increase(pool, 1);
+			task_deque_push(deque, task);
+			/* In the delayed push mode threads are notified once all the
+			 * tasks are pushed.
+			 */
+			if (!tls->do_delayed_push) {
+				task_scheduler_notify_workers(pool->scheduler, false);
+				task_pool_notify_waiters(pool);
+			}
 			return;
 		}
 	}
-	/* Do push to a global execution ppol, slowest possible method,
+	/* Do push to a global execution pool, slowest possible method,
 	 * causes quite reasonable amount of threading overhead.
 	 */
 	task_scheduler_push(pool->scheduler, task, priority);
@@ -841,20 +1121,53 @@ void BLI_task_pool_push_from_thread(TaskPool *pool, TaskRunFunction run,
 	task_pool_push(pool, run, taskdata, free_taskdata, NULL, priority, thread_id);
 }
 
+/* Move tasks of suspended pool to execution, preferably to the deque of the
+ * thread which is going to work on them, so other threads can steal them
+ * without any locks.
+ */
+static void task_pool_activate_suspended(TaskPool *pool, TaskDeque *deque)
+{
+	TaskScheduler *scheduler = pool->scheduler;
+
+	task_pool_num_increase(pool, pool->num_suspended);
+
+	if (deque != NULL) {
+		Task *task, *task_next;
+		for (task = pool->suspended_queue.first; task != NULL; task = task_next) {
+			task_next = task->next;
+			if (task_deque_is_full(deque)) {
+				break;
+			}
+			BLI_remlink(&pool->suspended_queue, task);
+			task_deque_push(deque, task);
+		}
+	}
+
+	if (pool->suspended_queue.first != NULL) {
+		BLI_mutex_lock(&scheduler->queue_mutex);
+		scheduler->num_queued += BLI_listbase_count(&pool->suspended_queue);
+		BLI_movelisttolist(&scheduler->queue, &pool->suspended_queue);
+		BLI_mutex_unlock(&scheduler->queue_mutex);
+	}
+
+	task_scheduler_notify_workers(scheduler, true);
+}
+
 void BLI_task_pool_work_and_wait(TaskPool *pool)
 {
 	TaskThreadLocalStorage *tls = get_task_tls(pool, pool->thread_id);
+	TaskDeque *deque = get_task_deque(pool, pool->thread_id);
 	TaskScheduler *scheduler = pool->scheduler;
+	/* Tasks of other pools which were in the deque before we started are owned
+	 * by the outer tasks of this thread, they are not to be handled from here.
+	 */
+	size_t deque_limit = (deque != NULL) ? deque->bottom : 0;
+
+	UNUSED_VARS_NDEBUG(tls);
 
 	if (atomic_fetch_and_and_uint8((uint8_t *)&pool->is_suspended, 0)) {
 		if (pool->num_suspended) {
-			task_pool_num_increase(pool, pool->num_suspended);
-			BLI_mutex_lock(&scheduler->queue_mutex);
-
-			BLI_movelisttolist(&scheduler->queue, &pool->suspended_queue);
-
-			BLI_condition_notify_all(&scheduler->queue_cond);
-			BLI_mutex_unlock(&scheduler->queue_mutex);
+			task_pool_activate_suspended(pool, deque);
 		}
 	}
 
@@ -862,70 +1175,108 @@ void BLI_task_pool_work_and_wait(TaskPool *pool)
 
 	ASSERT_THREAD_ID(pool->scheduler, pool->thread_id);
 
-	BLI_mutex_lock(&pool->num_mutex);
-
 	while (pool->num != 0) {
-		Task *task, *work_task = NULL;
-		bool found_task = false;
-
-		BLI_mutex_unlock(&pool->num_mutex);
-
-		BLI_mutex_lock(&scheduler->queue_mutex);
-
-		/* find task from this pool. if we get a task from another pool,
-		 * we can get into deadlock */
+		Task *task = NULL;
 
-		for (task = scheduler->queue.first; task; task = task->next) {
-			if (task->pool == pool) {
-				work_task = task;
-				found_task = true;
-				BLI_remlink(&scheduler->queue, task);
-				break;
+		/* Find task to work on: tasks which were pushed from this thread while
+		 * waiting first, then tasks from this pool in the global queue and
+		 * deques of other threads. If we get a task from another pool, we can
+		 * get into deadlock.
+		 */
+		if (deque != NULL) {
+			task = task_deque_pop(deque, deque_limit, pool);
+			if (task != NULL && (ptrdiff_t)(deque->bottom - deque_limit) < 0) {
+				/* Popped a task of this pool which was pushed before we started,
+				 * everything above it is ours now.
+				 */
+				deque_limit = deque->bottom;
 			}
 		}
-
-		BLI_mutex_unlock(&scheduler->queue_mutex);
+		if (task == NULL) {
+			task = task_scheduler_queue_pop(scheduler, pool);
+		}
+		if (task == NULL) {
+			task = task_scheduler_steal(scheduler, pool->thread_id, pool);
+		}
 
 		/* if found task, do it, otherwise wait until other tasks are done */
-		if (found_task) {
-			/* run task */
+		if (task != NULL) {
 			BLI_assert(!tls->do_delayed_push);
-			work_task->run(pool, work_task->taskdata, pool->thread_id);
+			task_run_and_free(task, pool->thread_id);
 			BLI_assert(!tls->do_delayed_push);
-
-			/* delete task */
-			task_free(pool, task, pool->thread_id);
-
-			/* Handle all tasks from local queue. */
-			handle_local_queue(tls, pool->thread_id);
-
-			/* notify pool task was done */
-			task_pool_num_decrease(pool, 1);
+			continue;
 		}
 
+		/* Same as with the worker threads sleeping, waiters counter is
+		 * increased before checking for tasks, so either we see new tasks
+		 * here or the thread which pushes them notifies us.
+		 *
+		 * While any deque holds a task of this pool we don't sleep, even if it
+		 * is buried under tasks of other pools, since only the last finished
+		 * task notifies us. We try again instead, the task is uncovered by the
+		 * threads working on that deque.
+		 */
 		BLI_mutex_lock(&pool->num_mutex);
-		if (pool->num == 0)
-			break;
-
-		if (!found_task)
-			BLI_condition_wait(&pool->num_cond, &pool->num_mutex);
+		atomic_add_and_fetch_uint32(&pool->num_waiters, 1);
+		if (pool->num != 0 && !task_scheduler_has_stealable_task(scheduler, pool)) {
+			bool has_queued_task;
+			BLI_mutex_lock(&scheduler->queue_mutex);
+			has_queued_task = (task_scheduler_queue_find_locked(scheduler, pool) != NULL);
+			BLI_mutex_unlock(&scheduler->queue_mutex);
+			if (!has_queued_task) {
+				BLI_condition_wait(&pool->num_cond, &pool->num_mutex);
+			}
+		}
+		atomic_sub_and_fetch_uint32(&pool->num_waiters, 1);
+		BLI_mutex_unlock(&pool->num_mutex);
 	}
 
+	/* Make sure thread which did the last decrease is done with the pool. */
+	BLI_mutex_lock(&pool->num_mutex);
 	BLI_mutex_unlock(&pool->num_mutex);
 
-	handle_local_queue(tls, pool->thread_id);
+	/* Handle tasks of other pools which were pushed to our deque while waiting. */
+	if (deque != NULL) {
+		Task *task;
+		while ((task = task_deque_pop(deque, deque_limit, NULL)) != NULL) {
+			task_run_and_free(task, pool->thread_id);
+		}
+	}
 }
 
 void BLI_task_pool_cancel(TaskPool *pool)
 {
+	TaskScheduler *scheduler = pool->scheduler;
+
 	pool->do_cancel = true;
 
-	task_scheduler_clear(pool->scheduler, pool);
+	task_scheduler_clear(scheduler, pool);
+
+	/* Tasks which are in the threads' deques can't be removed from there,
+	 * so we steal and discard them. Tasks which are buried under the tasks
+	 * of other pools will be handled by the deque owners.
+	 */
+	while (pool->num != 0) {
+		Task *task = task_scheduler_steal(scheduler, pool->thread_id, pool);
+		if (task != NULL) {
+			task_data_free(task, pool->thread_id);
+			MEM_freeN(task);
+			task_pool_num_decrease(pool, 1);
+			continue;
+		}
+
+		/* wait until all entries are cleared */
+		BLI_mutex_lock(&pool->num_mutex);
+		atomic_add_and_fetch_uint32(&pool->num_waiters, 1);
+		if (pool->num != 0 && !task_scheduler_has_stealable_task(scheduler, pool)) {
+			BLI_condition_wait(&pool->num_cond, &pool->num_mutex);
+		}
+		atomic_sub_and_fetch_uint32(&pool->num_waiters, 1);
+		BLI_mutex_unlock(&pool->num_mutex);
+	}
 
-	/* wait until all entries are cleared */
+	/* Make sure thread which did the last decrease is done with the pool. */
 	BLI_mutex_lock(&pool->num_mutex);
-	while (pool->num)
-		BLI_condition_wait(&pool->num_cond, &pool->num_mutex);
 	BLI_mutex_unlock(&pool->num_mutex);
 
 	pool->do_cancel = false;
@@ -961,12 +1312,9 @@ void BLI_task_pool_delayed_push_end(TaskPool *pool, int thread_id)
 		ASSERT_THREAD_ID(pool->scheduler, thread_id);
 		TaskThreadLocalStorage *tls = get_task_tls(pool, thread_id);
 		BLI_assert(tls->do_delayed_push);
-		task_scheduler_push_all(pool->scheduler,
-		                        pool,
-		                        tls->delayed_queue,
-		                        tls->num_delayed_queue);
 		tls->do_delayed_push = false;
-		tls->num_delayed_queue = 0;
+		task_scheduler_notify_workers(pool->scheduler, true);
+		task_pool_notify_waiters(pool);
 	}
 }
 
@@ -77,4 +77,30 @@ enum {
 
 #define BLEN_THUMB_MEMSIZE_FILE(_x, _y) (sizeof(int) * (2 + (size_t)(_x) * (size_t)(_y)))
 
+/**
+ * Compressed files are written as a series of gzip members (frames), each holding
+ * #BLEND_GZIP_FRAME_SIZE bytes of the file, so they can be compressed and decompressed in parallel.
+ * Any gzip reader reads them as one stream.
+ *
+ * The last member is empty and stores a table of the frames in a gzip extra field
+ * with subfield ID #BLEND_GZIP_TABLE_SI1, #BLEND_GZIP_TABLE_SI2, so readers can seek to any frame.
+ * The subfield data is (little endian):
+ * - uint32 frame size, #BLEND_GZIP_FRAME_SIZE when written.
+ * - uint64 uncompressed size of the file.
+ * - uint32 compressed size of every frame.
+ * - uint32 number of frames.
+ * - #BLEND_GZIP_TABLE_SI1, #BLEND_GZIP_TABLE_SI2, 'T', 'B'.
+ */
+#define BLEND_GZIP_FRAME_SIZE (1 << 20)
+#define BLEND_GZIP_TABLE_SI1 'B'
+#define BLEND_GZIP_TABLE_SI2 'F'
+/* gzip header, XLEN and subfield header */
+#define BLEND_GZIP_TABLE_HEADER_SIZE (10 + 2 + 4)
+/* size of the subfield data besides the frame sizes */
+#define BLEND_GZIP_TABLE_DATA_SIZE (4 + 8 + 4 + 4)
+/* empty deflate stream, CRC32 and ISIZE */
+#define BLEND_GZIP_TABLE_FOOTER_SIZE (2 + 4 + 4)
+/* the subfield data has to fit in XLEN */
+#define BLEND_GZIP_TABLE_FRAMES_MAX ((0xffff - 4 - BLEND_GZIP_TABLE_DATA_SIZE) / 4)
+
 #endif  /* __BLO_BLEND_DEFS_H__ */
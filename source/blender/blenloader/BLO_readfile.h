@@ -88,7 +88,7 @@ BlendFileData *BLO_read_from_memory(
         const void *mem, int memsize,
         struct ReportList *reports, eBLOReadSkip skip_flag);
 BlendFileData *BLO_read_from_memfile(
-        struct Main *oldmain, const char *filename, struct MemFile *memfile,
+        struct Main *oldmain, const char *filename, struct MemFile *memfile, const struct MemFile *memfile_current,
         struct ReportList *reports, eBLOReadSkip skip_flag);
 
 void BLO_blendfiledata_free(BlendFileData *bfd);
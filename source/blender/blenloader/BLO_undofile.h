@@ -33,6 +33,7 @@
  *  \ingroup blenloader
  */
 
+struct GHash;
 struct Scene;
 
 typedef struct {
@@ -42,6 +43,11 @@ typedef struct {
 	unsigned int size;
 	/** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
 	bool is_identical;
+	/**
+	 * Address of the ID this chunk was written for, NULL for data not owned by an ID.
+	 * Chunks never span multiple ID's, so the chunks of each ID can be compared between undo steps.
+	 */
+	const void *id;
 } MemFileChunk;
 
 typedef struct MemFile {
@@ -57,9 +63,13 @@ typedef struct MemFileUndoData {
 
 /* actually only used writefile.c */
 extern void memfile_chunk_add(
-        MemFile *memfile, const char *buf, unsigned int size,
+        MemFile *memfile, const char *buf, unsigned int size, const void *id,
         MemFileChunk **compchunk_step);
 
+/* used by writefile.c and readfile.c */
+extern struct GHash *memfile_id_chunk_map_create(const MemFile *memfile);
+extern bool memfile_id_chunks_equal(const MemFileChunk *chunk_a, const MemFileChunk *chunk_b);
+
 /* exports */
 extern void BLO_memfile_free(MemFile *memfile);
 extern void BLO_memfile_merge(MemFile *first, MemFile *second);
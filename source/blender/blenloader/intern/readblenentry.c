@@ -210,11 +210,11 @@ LinkNode *BLO_blendhandle_get_previews(BlendHandle *bh, int ofblocktype, int *to
 					if (prv) {
 						memcpy(new_prv, prv, sizeof(PreviewImage));
 						if (prv->rect[0] && prv->w[0] && prv->h[0]) {
-							unsigned int *rect = NULL;
+							const unsigned int *rect = NULL;
 							size_t len = new_prv->w[0] * new_prv->h[0] * sizeof(unsigned int);
 							new_prv->rect[0] = MEM_callocN(len, __func__);
 							bhead = blo_nextbhead(fd, bhead);
-							rect = (unsigned int *)(bhead + 1);
+							rect = (const unsigned int *)blo_bhead_data(bhead);
 							BLI_assert(len == bhead->len);
 							memcpy(new_prv->rect[0], rect, len);
 						}
@@ -227,11 +227,11 @@ LinkNode *BLO_blendhandle_get_previews(BlendHandle *bh, int ofblocktype, int *to
 						}
 						
 						if (prv->rect[1] && prv->w[1] && prv->h[1]) {
-							unsigned int *rect = NULL;
+							const unsigned int *rect = NULL;
 							size_t len = new_prv->w[1] * new_prv->h[1] * sizeof(unsigned int);
 							new_prv->rect[1] = MEM_callocN(len, __func__);
 							bhead = blo_nextbhead(fd, bhead);
-							rect = (unsigned int *)(bhead + 1);
+							rect = (const unsigned int *)blo_bhead_data(bhead);
 							BLI_assert(len == bhead->len);
 							memcpy(new_prv->rect[1], rect, len);
 						}
@@ -367,9 +367,12 @@ BlendFileData *BLO_read_from_memory(
  *
  * \param oldmain old main, from which we will keep libraries and other datablocks that should not have changed.
  * \param filename current file, only for retrieving library data.
+ * \param memfile_current The memfile \a oldmain was last written to or read from (may be NULL),
+ * data-blocks unchanged between both memfiles are kept from \a oldmain instead of being read again.
+ * \a oldmain must then be the main being replaced by the one read.
  */
 BlendFileData *BLO_read_from_memfile(
-        Main *oldmain, const char *filename, MemFile *memfile,
+        Main *oldmain, const char *filename, MemFile *memfile, const MemFile *memfile_current,
         ReportList *reports, eBLOReadSkip skip_flags)
 {
 	BlendFileData *bfd = NULL;
@@ -398,6 +401,11 @@ BlendFileData *BLO_read_from_memfile(
 
 		/* make lookups of existing sound data in old main */
 		blo_make_sound_pointer_map(fd, oldmain);
+
+		/* make lookups of unchanged data-blocks in old main */
+		if (memfile_current) {
+			blo_make_undo_reuse_id_map(fd, oldmain, memfile_current);
+		}
 		
 		/* removed packed data from this trick - it's internal data that needs saves */
 		
@@ -412,6 +420,10 @@ BlendFileData *BLO_read_from_memfile(
 		/* ensures relinked sounds are not freed */
 		blo_end_sound_pointer_map(fd, oldmain);
 
+		if (bfd) {
+			blo_end_undo_reuse_id_map(fd, bfd->main);
+		}
+
 		/* Still in-use libraries have already been moved from oldmain to new mainlist,
 		 * but oldmain itself shall *never* be 'transferred' to new mainlist! */
 		BLI_assert(old_mainlist.first == oldmain);
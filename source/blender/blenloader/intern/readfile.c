@@ -46,6 +46,7 @@
 #include "BLI_utildefines.h"
 #ifndef WIN32
 #  include <unistd.h> // for read close
+#  include <sys/mman.h> // for mmap
 #else
 #  include <io.h> // for open close read
 #  include "winsock2.h"
@@ -110,6 +111,7 @@
 #include "BLI_math.h"
 #include "BLI_threads.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -217,6 +219,13 @@
 /* use GHash for BHead name-based lookups (speeds up linking) */
 #define USE_GHASH_BHEAD
 
+/* Memory map uncompressed files, the data of blocks is used from the mapping instead of being copied.
+ * Pages of blocks that are never read (data-blocks not linked from a library) are never loaded.
+ * Compressed files written in frames are decompressed in parallel and used the same way. */
+#ifndef WIN32
+#  define USE_BHEAD_MMAP
+#endif
+
 /* Use GHash for restoring pointers by name */
 #define USE_GHASH_RESTORE_POINTER
 
@@ -237,13 +246,34 @@ typedef struct OldNew {
 	int nr;
 } OldNew;
 
+/**
+ * Map of the old pointers stored in the file to the newly read data.
+ *
+ * Entries are kept in insertion order in an array, the old pointers are looked up
+ * with an open addressing hash table that stores indices into the entries array.
+ */
 typedef struct OldNewMap {
 	OldNew *entries;
 	int nentries, entriessize;
-	bool sorted;
-	int lasthit;
+	/* hash table of indices into entries, -1 for empty slots, twice the size of entries */
+	int *map;
 } OldNewMap;
 
+#define OLDNEWMAP_DEFAULT_SIZE 64
+#define OLDNEWMAP_MAP_SIZE(onm) ((onm)->entriessize * 2)
+#define OLDNEWMAP_PERTURB_SHIFT 5
+
+/* Probing as done by Python dicts, all bits of the hash are used for collisions. */
+#define OLDNEWMAP_ITER_SLOTS(onm, addr, slot, index) \
+	const unsigned int _mask = (unsigned int)OLDNEWMAP_MAP_SIZE(onm) - 1; \
+	unsigned int _perturb = BLI_ghashutil_ptrhash(addr); \
+	unsigned int slot = _perturb & _mask; \
+	int index = (onm)->map[slot]; \
+	for (;; \
+	     slot = _mask & ((5 * slot) + 1 + _perturb), \
+	     _perturb >>= OLDNEWMAP_PERTURB_SHIFT, \
+	     index = (onm)->map[slot])
+
 
 /* local prototypes */
 static void *read_struct(FileData *fd, BHead *bh, const char *blockname);
@@ -284,31 +314,46 @@ static const char *library_parent_filepath(Library *lib)
 	return lib->parent ? lib->parent->filepath : "<direct>";
 }
 
-static OldNewMap *oldnewmap_new(void) 
+static void oldnewmap_map_insert(OldNewMap *onm, const void *addr, int index)
 {
-	OldNewMap *onm= MEM_callocN(sizeof(*onm), "OldNewMap");
-	
-	onm->entriessize = 1024;
-	onm->entries = MEM_malloc_arrayN(onm->entriessize, sizeof(*onm->entries), "OldNewMap.entries");
-	
-	return onm;
+	OLDNEWMAP_ITER_SLOTS(onm, addr, slot, stored_index) {
+		if (stored_index == -1 || onm->entries[stored_index].old == addr) {
+			/* a later insert of the same address replaces the earlier one for lookups */
+			onm->map[slot] = index;
+			break;
+		}
+	}
 }
 
-static int verg_oldnewmap(const void *v1, const void *v2)
+static void oldnewmap_map_alloc(OldNewMap *onm)
 {
-	const struct OldNew *x1=v1, *x2=v2;
-	
-	if (x1->old > x2->old) return 1;
-	else if (x1->old < x2->old) return -1;
-	return 0;
+	onm->map = MEM_malloc_arrayN(OLDNEWMAP_MAP_SIZE(onm), sizeof(*onm->map), "OldNewMap.map");
+	memset(onm->map, 0xff, sizeof(*onm->map) * OLDNEWMAP_MAP_SIZE(onm));
 }
 
+static void oldnewmap_grow(OldNewMap *onm)
+{
+	int i;
+
+	onm->entriessize *= 2;
+	onm->entries = MEM_reallocN(onm->entries, sizeof(*onm->entries) * onm->entriessize);
+
+	MEM_freeN(onm->map);
+	oldnewmap_map_alloc(onm);
+	for (i = 0; i < onm->nentries; i++) {
+		oldnewmap_map_insert(onm, onm->entries[i].old, i);
+	}
+}
 
-static void oldnewmap_sort(FileData *fd) 
+static OldNewMap *oldnewmap_new(void) 
 {
-	BLI_assert(fd->libmap->sorted == false);
-	qsort(fd->libmap->entries, fd->libmap->nentries, sizeof(OldNew), verg_oldnewmap);
-	fd->libmap->sorted = 1;
+	OldNewMap *onm= MEM_callocN(sizeof(*onm), "OldNewMap");
+	
+	onm->entriessize = OLDNEWMAP_DEFAULT_SIZE;
+	onm->entries = MEM_malloc_arrayN(onm->entriessize, sizeof(*onm->entries), "OldNewMap.entries");
+	oldnewmap_map_alloc(onm);
+	
+	return onm;
 }
 
 /* nr is zero for data, and ID code for libdata */
@@ -319,14 +364,15 @@ static void oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr,
 	if (oldaddr==NULL || newaddr==NULL) return;
 	
 	if (UNLIKELY(onm->nentries == onm->entriessize)) {
-		onm->entriessize *= 2;
-		onm->entries = MEM_reallocN(onm->entries, sizeof(*onm->entries) * onm->entriessize);
+		oldnewmap_grow(onm);
 	}
 
-	entry = &onm->entries[onm->nentries++];
+	entry = &onm->entries[onm->nentries];
 	entry->old = oldaddr;
 	entry->newp = newaddr;
 	entry->nr = nr;
+
+	oldnewmap_map_insert(onm, oldaddr, onm->nentries++);
 }
 
 void blo_do_versions_oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr, int nr)
@@ -334,77 +380,26 @@ void blo_do_versions_oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void
 	oldnewmap_insert(onm, oldaddr, newaddr, nr);
 }
 
-/**
- * Do a full search (no state).
- *
- * \param lasthit: Use as a reference position to avoid a full search
- * from either end of the array, giving more efficient lookups.
- *
- * \note This would seem an ideal case for hash or btree lookups.
- * However the data is written in-order, using the \a lasthit will normally avoid calling this function.
- * Creating a btree/hash structure adds overhead for the common-case to optimize the corner-case
- * (since most entries will never be retrieved).
- * So just keep full lookups as a fall-back.
- */
-static int oldnewmap_lookup_entry_full(const OldNewMap *onm, const void *addr, int lasthit)
+static OldNew *oldnewmap_lookup_entry(const OldNewMap *onm, const void *addr)
 {
-	const int nentries = onm->nentries;
-	const OldNew *entries = onm->entries;
-	int i;
-
-	/* search relative to lasthit where possible */
-	if (lasthit >= 0 && lasthit < nentries) {
-
-		/* search forwards */
-		i = lasthit;
-		while (++i != nentries) {
-			if (entries[i].old == addr) {
-				return i;
-			}
-		}
-
-		/* search backwards */
-		i = lasthit + 1;
-		while (i--) {
-			if (entries[i].old == addr) {
-				return i;
-			}
+	OLDNEWMAP_ITER_SLOTS(onm, addr, slot, index) {
+		if (index == -1) {
+			return NULL;
 		}
-	}
-	else {
-		/* search backwards (full) */
-		i = nentries;
-		while (i--) {
-			if (entries[i].old == addr) {
-				return i;
-			}
+		else if (onm->entries[index].old == addr) {
+			return &onm->entries[index];
 		}
 	}
-
-	return -1;
 }
 
 static void *oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool increase_users)
 {
-	int i;
+	OldNew *entry;
 	
 	if (addr == NULL) return NULL;
 	
-	if (onm->lasthit < onm->nentries-1) {
-		OldNew *entry = &onm->entries[++onm->lasthit];
-		
-		if (entry->old == addr) {
-			if (increase_users)
-				entry->nr++;
-			return entry->newp;
-		}
-	}
-	
-	i = oldnewmap_lookup_entry_full(onm, addr, onm->lasthit);
-	if (i != -1) {
-		OldNew *entry = &onm->entries[i];
-		BLI_assert(entry->old == addr);
-		onm->lasthit = i;
+	entry = oldnewmap_lookup_entry(onm, addr);
+	if (entry) {
 		if (increase_users)
 			entry->nr++;
 		return entry->newp;
@@ -416,32 +411,18 @@ static void *oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool inc
 /* for libdata, nr has ID code, no increment */
 static void *oldnewmap_liblookup(OldNewMap *onm, const void *addr, const void *lib)
 {
+	OldNew *entry;
+
 	if (addr == NULL) {
 		return NULL;
 	}
 
-	/* lasthit works fine for non-libdata, linking there is done in same sequence as writing */
-	if (onm->sorted) {
-		const OldNew entry_s = {.old = addr};
-		OldNew *entry = bsearch(&entry_s, onm->entries, onm->nentries, sizeof(OldNew), verg_oldnewmap);
-		if (entry) {
-			ID *id = entry->newp;
+	entry = oldnewmap_lookup_entry(onm, addr);
+	if (entry) {
+		ID *id = entry->newp;
 
-			if (id && (!lib || id->lib)) {
-				return id;
-			}
-		}
-	}
-	else {
-		/* note, this can be a bottle neck when loading some files */
-		const int i = oldnewmap_lookup_entry_full(onm, addr, -1);
-		if (i != -1) {
-			OldNew *entry = &onm->entries[i];
-			ID *id = entry->newp;
-			BLI_assert(entry->old == addr);
-			if (id && (!lib || id->lib)) {
-				return id;
-			}
+		if (id && (!lib || id->lib)) {
+			return id;
 		}
 	}
 
@@ -463,13 +444,23 @@ static void oldnewmap_free_unused(OldNewMap *onm)
 
 static void oldnewmap_clear(OldNewMap *onm) 
 {
+	/* shrink back, the map is cleared for every ID that is read */
+	if (onm->entriessize != OLDNEWMAP_DEFAULT_SIZE) {
+		MEM_freeN(onm->map);
+		onm->entriessize = OLDNEWMAP_DEFAULT_SIZE;
+		onm->entries = MEM_reallocN(onm->entries, sizeof(*onm->entries) * onm->entriessize);
+		oldnewmap_map_alloc(onm);
+	}
+	else {
+		memset(onm->map, 0xff, sizeof(*onm->map) * OLDNEWMAP_MAP_SIZE(onm));
+	}
 	onm->nentries = 0;
-	onm->lasthit = 0;
 }
 
 static void oldnewmap_free(OldNewMap *onm) 
 {
 	MEM_freeN(onm->entries);
+	MEM_freeN(onm->map);
 	MEM_freeN(onm);
 }
 
@@ -797,10 +788,27 @@ static BHeadN *get_bhead(FileData *fd)
 			/* bhead now contains the (converted) bhead structure. Now read
 			 * the associated data and put everything in a BHeadN (creative naming !)
 			 */
-			if (!fd->eof) {
+			if (fd->eof) {
+				/* pass */
+			}
+			else if (fd->map_buffer && !(fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
+				/* the data stays in the file in memory, endian switching needs a writable copy */
+				if ((size_t)bhead.len <= fd->map_size - fd->map_offset) {
+					new_bhead = MEM_mallocN(sizeof(BHeadN), "new_bhead");
+					new_bhead->next = new_bhead->prev = NULL;
+					new_bhead->mapped_data = fd->map_buffer + fd->map_offset;
+					new_bhead->bhead = bhead;
+					fd->map_offset += bhead.len;
+				}
+				else {
+					fd->eof = 1;
+				}
+			}
+			else {
 				new_bhead = MEM_mallocN(sizeof(BHeadN) + bhead.len, "new_bhead");
 				if (new_bhead) {
 					new_bhead->next = new_bhead->prev = NULL;
+					new_bhead->mapped_data = NULL;
 					new_bhead->bhead = bhead;
 					
 					readsize = fd->read(fd, new_bhead + 1, bhead.len);
@@ -882,10 +890,20 @@ BHead *blo_nextbhead(FileData *fd, BHead *thisblock)
 	return(bhead);
 }
 
+/**
+ * Data of a block, either following the BHead or in the file in memory.
+ * \note data of a file in memory is read-only.
+ */
+const void *blo_bhead_data(const BHead *bhead)
+{
+	const BHeadN *bheadn = (const BHeadN *)POINTER_OFFSET(bhead, -offsetof(BHeadN, bhead));
+	return bheadn->mapped_data ? bheadn->mapped_data : (const void *)(bhead + 1);
+}
+
 /* Warning! Caller's responsibility to ensure given bhead **is** and ID one! */
 const char *bhead_id_name(const FileData *fd, const BHead *bhead)
 {
-	return (const char *)POINTER_OFFSET(bhead, sizeof(*bhead) + fd->id_name_offs);
+	return (const char *)POINTER_OFFSET(blo_bhead_data(bhead), fd->id_name_offs);
 }
 
 static void decode_blender_header(FileData *fd)
@@ -942,7 +960,7 @@ static bool read_file_dna(FileData *fd, const char **r_error_message)
 		if (bhead->code == DNA1) {
 			const bool do_endian_swap = (fd->flags & FD_FLAGS_SWITCH_ENDIAN) != 0;
 			
-			fd->filesdna = DNA_sdna_from_data(&bhead[1], bhead->len, do_endian_swap, true, r_error_message);
+			fd->filesdna = DNA_sdna_from_data(blo_bhead_data(bhead), bhead->len, do_endian_swap, true, r_error_message);
 			if (fd->filesdna) {
 				fd->compflags = DNA_struct_get_compareflags(fd->filesdna, fd->memsdna);
 				/* used to retrieve ID names from (bhead+1) */
@@ -971,7 +989,8 @@ static int *read_file_thumbnail(FileData *fd)
 	for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
 		if (bhead->code == TEST) {
 			const bool do_endian_swap = (fd->flags & FD_FLAGS_SWITCH_ENDIAN) != 0;
-			int *data = (int *)(bhead + 1);
+			/* only written when switching endian, in which case the block is never mapped */
+			int *data = (int *)blo_bhead_data(bhead);
 
 			if (bhead->len < (2 * sizeof(int))) {
 				break;
@@ -1018,6 +1037,234 @@ static int fd_read_from_file(FileData *filedata, void *buffer, unsigned int size
 	return readsize;
 }
 
+static int fd_read_from_map(FileData *filedata, void *buffer, unsigned int size)
+{
+	/* don't read more bytes then there are available in the file */
+	const size_t readsize = MIN2((size_t)size, filedata->map_size - filedata->map_offset);
+
+	memcpy(buffer, filedata->map_buffer + filedata->map_offset, readsize);
+	filedata->map_offset += readsize;
+
+	return (int)readsize;
+}
+
+static uint64_t gzip_frames_get_uint(const unsigned char *p, int bytes)
+{
+	uint64_t value = 0;
+	int i;
+	for (i = bytes - 1; i >= 0; i--) {
+		value = (value << 8) | p[i];
+	}
+	return value;
+}
+
+static bool blo_read_fully(int file, void *buffer, size_t size)
+{
+	while (size) {
+		const int len = read(file, buffer, (unsigned int)MIN2(size, (size_t)INT_MAX));
+		if (len <= 0) {
+			return false;
+		}
+		buffer = (char *)buffer + len;
+		size -= len;
+	}
+	return true;
+}
+
+typedef struct GzipFramesData {
+	const char *compressed;
+	char *uncompressed;
+	const size_t *offsets;
+	const uint *compressed_sizes;
+	size_t frame_size;
+	size_t total_len;
+	bool *failed;
+} GzipFramesData;
+
+static void gzip_frame_decompress_cb(
+        void *__restrict userdata, const int iter, const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	GzipFramesData *data = userdata;
+	const size_t start = (size_t)iter * data->frame_size;
+	const size_t len = MIN2(data->frame_size, data->total_len - start);
+	z_stream strm = {NULL};
+
+	if (inflateInit2(&strm, 16 + MAX_WBITS) != Z_OK) {
+		data->failed[iter] = true;
+		return;
+	}
+
+	strm.next_in = (Bytef *)(data->compressed + data->offsets[iter]);
+	strm.avail_in = data->compressed_sizes[iter];
+	strm.next_out = (Bytef *)(data->uncompressed + start);
+	strm.avail_out = (uInt)len;
+
+	if (inflate(&strm, Z_FINISH) != Z_STREAM_END || strm.total_out != len) {
+		data->failed[iter] = true;
+	}
+
+	inflateEnd(&strm);
+}
+
+/**
+ * Read a compressed file written in frames, see #BLEND_GZIP_FRAME_SIZE.
+ * The frame table is used to decompress all frames in parallel into one buffer.
+ * \return false when the file has no frame table, it should then be read with gzip.
+ */
+static bool blo_read_gzip_frames(const char *filepath, char **r_mem, size_t *r_size)
+{
+	unsigned char tail[BLEND_GZIP_TABLE_FOOTER_SIZE + 8];
+	unsigned char *member = NULL;
+	char *compressed = NULL, *uncompressed = NULL;
+	size_t *offsets = NULL;
+	uint *compressed_sizes = NULL;
+	bool *failed = NULL;
+	size_t size, data_len, member_len, frame_size, total_len, offset;
+	uint frames_len, i;
+	bool ok = false;
+	int file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+
+	if (file == -1) {
+		return false;
+	}
+
+	size = BLI_file_descriptor_size(file);
+	if (size == (size_t)-1 || size < sizeof(tail) + BLEND_GZIP_TABLE_HEADER_SIZE + BLEND_GZIP_TABLE_DATA_SIZE ||
+	    lseek(file, size - sizeof(tail), SEEK_SET) == -1 ||
+	    !blo_read_fully(file, tail, sizeof(tail)) ||
+	    tail[4] != BLEND_GZIP_TABLE_SI1 || tail[5] != BLEND_GZIP_TABLE_SI2 || tail[6] != 'T' || tail[7] != 'B')
+	{
+		goto finally;
+	}
+
+	/* read the member holding the table */
+	frames_len = (uint)gzip_frames_get_uint(tail, 4);
+	if (frames_len == 0 || frames_len > BLEND_GZIP_TABLE_FRAMES_MAX) {
+		goto finally;
+	}
+	data_len = BLEND_GZIP_TABLE_DATA_SIZE + 4 * (size_t)frames_len;
+	member_len = BLEND_GZIP_TABLE_HEADER_SIZE + data_len + BLEND_GZIP_TABLE_FOOTER_SIZE;
+	if (member_len > size) {
+		goto finally;
+	}
+	member = MEM_mallocN(member_len, __func__);
+	if (lseek(file, size - member_len, SEEK_SET) == -1 ||
+	    !blo_read_fully(file, member, member_len) ||
+	    member[0] != 0x1f || member[1] != 0x8b || !(member[3] & 4) ||
+	    gzip_frames_get_uint(member + 10, 2) != data_len + 4 ||
+	    member[12] != BLEND_GZIP_TABLE_SI1 || member[13] != BLEND_GZIP_TABLE_SI2 ||
+	    gzip_frames_get_uint(member + 14, 2) != data_len)
+	{
+		goto finally;
+	}
+
+	frame_size = (size_t)gzip_frames_get_uint(member + BLEND_GZIP_TABLE_HEADER_SIZE, 4);
+	total_len = (size_t)gzip_frames_get_uint(member + BLEND_GZIP_TABLE_HEADER_SIZE + 4, 8);
+	if (frame_size == 0 || total_len <= frame_size * (frames_len - 1) || total_len > frame_size * frames_len) {
+		goto finally;
+	}
+
+	offsets = MEM_malloc_arrayN(frames_len, sizeof(*offsets), __func__);
+	compressed_sizes = MEM_malloc_arrayN(frames_len, sizeof(*compressed_sizes), __func__);
+	for (i = 0, offset = 0; i < frames_len; i++) {
+		compressed_sizes[i] = (uint)gzip_frames_get_uint(member + BLEND_GZIP_TABLE_HEADER_SIZE + 12 + 4 * i, 4);
+		offsets[i] = offset;
+		offset += compressed_sizes[i];
+	}
+	if (offset + member_len != size) {
+		goto finally;
+	}
+
+	compressed = MEM_mallocN(offset, __func__);
+	if (lseek(file, 0, SEEK_SET) == -1 || !blo_read_fully(file, compressed, offset)) {
+		goto finally;
+	}
+
+	{
+		GzipFramesData data;
+		ParallelRangeSettings settings;
+
+		uncompressed = MEM_mallocN(total_len, __func__);
+		failed = MEM_callocN(sizeof(*failed) * frames_len, __func__);
+
+		data.compressed = compressed;
+		data.uncompressed = uncompressed;
+		data.offsets = offsets;
+		data.compressed_sizes = compressed_sizes;
+		data.frame_size = frame_size;
+		data.total_len = total_len;
+		data.failed = failed;
+
+		BLI_parallel_range_settings_defaults(&settings);
+		settings.use_threading = (frames_len > 1);
+		BLI_task_parallel_range(0, (int)frames_len, &data, gzip_frame_decompress_cb, &settings);
+
+		ok = true;
+		for (i = 0; i < frames_len; i++) {
+			if (failed[i]) {
+				ok = false;
+				break;
+			}
+		}
+	}
+
+	if (ok) {
+		*r_mem = uncompressed;
+		*r_size = total_len;
+		uncompressed = NULL;
+	}
+
+finally:
+	close(file);
+	MEM_SAFE_FREE(member);
+	MEM_SAFE_FREE(compressed);
+	MEM_SAFE_FREE(uncompressed);
+	MEM_SAFE_FREE(offsets);
+	MEM_SAFE_FREE(compressed_sizes);
+	MEM_SAFE_FREE(failed);
+
+	return ok;
+}
+
+#ifdef USE_BHEAD_MMAP
+/**
+ * Map an uncompressed file into memory.
+ * \return false for compressed files or when mapping fails, the file should then be read with gzip.
+ */
+static bool blo_mmap_file(const char *filepath, const char **r_mem, size_t *r_size)
+{
+	unsigned char magic[2];
+	size_t size;
+	void *mem;
+	int file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+
+	if (file == -1) {
+		return false;
+	}
+
+	size = BLI_file_descriptor_size(file);
+	if (size == (size_t)-1 || size < SIZEOFBLENDERHEADER ||
+	    read(file, magic, sizeof(magic)) != sizeof(magic) ||
+	    (magic[0] == 0x1f && magic[1] == 0x8b))
+	{
+		close(file);
+		return false;
+	}
+
+	mem = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+	/* the mapping stays valid after closing */
+	close(file);
+
+	if (mem == MAP_FAILED) {
+		return false;
+	}
+
+	*r_mem = mem;
+	*r_size = size;
+	return true;
+}
+#endif
+
 static int fd_read_gzip_from_file(FileData *filedata, void *buffer, unsigned int size)
 {
 	int readsize = gzread(filedata->gzfiledes, buffer, size);
@@ -1146,6 +1393,37 @@ static FileData *blo_decode_and_check(FileData *fd, ReportList *reports)
 FileData *blo_openblenderfile(const char *filepath, ReportList *reports)
 {
 	gzFile gzfile;
+
+	{
+		const char *mem;
+		char *mem_alloc;
+		size_t size;
+		FileData *fd = NULL;
+
+#ifdef USE_BHEAD_MMAP
+		if (blo_mmap_file(filepath, &mem, &size)) {
+			fd = filedata_new();
+			fd->flags |= FD_FLAGS_MAP_BUFFER_MMAP;
+		}
+		else
+#endif
+		if (blo_read_gzip_frames(filepath, &mem_alloc, &size)) {
+			fd = filedata_new();
+			mem = mem_alloc;
+		}
+
+		if (fd) {
+			fd->map_buffer = mem;
+			fd->map_size = size;
+			fd->read = fd_read_from_map;
+
+			/* needed for library_append and read_libraries */
+			BLI_strncpy(fd->relabase, filepath, sizeof(fd->relabase));
+
+			return blo_decode_and_check(fd, reports);
+		}
+	}
+
 	errno = 0;
 	gzfile = BLI_gzopen(filepath, "rb");
 	
@@ -1305,6 +1583,18 @@ void blo_freefiledata(FileData *fd)
 		// Free all BHeadN data blocks
 		BLI_freelistN(&fd->listbase);
 
+		if (fd->map_buffer) {
+#ifdef USE_BHEAD_MMAP
+			if (fd->flags & FD_FLAGS_MAP_BUFFER_MMAP) {
+				munmap((void *)fd->map_buffer, fd->map_size);
+			}
+			else
+#endif
+			{
+				MEM_freeN((void *)fd->map_buffer);
+			}
+		}
+
 		if (fd->filesdna)
 			DNA_sdna_free(fd->filesdna);
 		if (fd->compflags)
@@ -1326,6 +1616,8 @@ void blo_freefiledata(FileData *fd)
 			oldnewmap_free(fd->libmap);
 		if (fd->bheadmap)
 			MEM_freeN(fd->bheadmap);
+		if (fd->undo_reuse_id_map)
+			BLI_ghash_free(fd->undo_reuse_id_map, NULL, NULL);
 		
 #ifdef USE_GHASH_BHEAD
 		if (fd->bhead_idname_hash) {
@@ -1463,31 +1755,6 @@ static void *newdataadr(FileData *fd, const void *adr)		/* only direct databocks
 	return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
 }
 
-/* This is a special version of newdataadr() which allows us to keep lasthit of
- * map unchanged. In certain cases this makes file loading time significantly
- * faster.
- *
- * Use this function in cases like restoring pointer from one list element to
- * another list element, but keep lasthit value so we can continue restoring
- * pointers efficiently.
- *
- * Example of this could be found in direct_link_fcurves() which restores the
- * fcurve group pointer and keeps lasthit optimal for linking all further
- * fcurves.
- */
-static void *newdataadr_ex(FileData *fd, const void *adr, bool increase_lasthit)		/* only direct databocks */
-{
-	if (increase_lasthit) {
-		return newdataadr(fd, adr);
-	}
-	else {
-		int lasthit = fd->datamap->lasthit;
-		void *newadr = newdataadr(fd, adr);
-		fd->datamap->lasthit = lasthit;
-		return newadr;
-	}
-}
-
 static void *newdataadr_no_us(FileData *fd, const void *adr)		/* only direct databocks */
 {
 	return oldnewmap_lookup_and_inc(fd->datamap, adr, false);
@@ -1565,9 +1832,6 @@ static void change_idid_adr_fd(FileData *fd, const void *old, void *new)
 {
 	int i;
 	
-	/* use a binary search if we have a sorted libmap, for now it's not needed. */
-	BLI_assert(fd->libmap->sorted == false);
-
 	for (i = 0; i < fd->libmap->nentries; i++) {
 		OldNew *entry = &fd->libmap->entries[i];
 		
@@ -1781,6 +2045,192 @@ void blo_end_sound_pointer_map(FileData *fd, Main *oldmain)
 	}
 }
 
+/* Undo: ID's of the old main which are unchanged in the memfile being read can be kept as they are,
+ * instead of being freed and read again (see read_libblock_undo_reuse).
+ *
+ * An ID is reused when:
+ * - It's not tagged with LIB_TAG_UNDO_CHANGED, so it wasn't edited since the memfile of the current state
+ *   was written, and it has the address stored in that memfile (ID's read again by undo are tagged too).
+ * - Its chunks are identical in the memfile being read and in the memfile of the current state.
+ * - All local ID's it uses are reused too, pointers to them then remain valid.
+ */
+
+static bool undo_reuse_id_supported(ID *id)
+{
+	if (id->tag & LIB_TAG_UNDO_CHANGED) {
+		return false;
+	}
+	/* Edits of embedded node-trees only tag the node-tree. */
+	bNodeTree *ntree = ntreeFromID(id);
+	if (ntree && (ntree->id.tag & LIB_TAG_UNDO_CHANGED)) {
+		return false;
+	}
+
+	switch (GS(id->name)) {
+		case ID_WM:
+		case ID_SCR:
+		case ID_SCE:
+		case ID_LI:
+			/* UI and scenes are restored by their own code after reading. */
+			return false;
+		case ID_OB:
+		{
+			/* Rigid body simulation data is owned by the scene's physics world. */
+			const Object *ob = (const Object *)id;
+			return (ob->rigidbody_object == NULL && ob->rigidbody_constraint == NULL);
+		}
+		default:
+			return true;
+	}
+}
+
+typedef struct UndoReuseCheckData {
+	GSet *reused_ids;
+	bool is_reusable;
+} UndoReuseCheckData;
+
+static int undo_reuse_id_check_cb(void *user_data, ID *UNUSED(id_self), ID **id_pointer, int cb_flag)
+{
+	UndoReuseCheckData *data = user_data;
+	ID *id = *id_pointer;
+
+	/* Embedded node-trees are part of the ID itself, linked data is kept on undo anyway. */
+	if (id == NULL || id->lib != NULL || (cb_flag & IDWALK_CB_PRIVATE)) {
+		return IDWALK_RET_NOP;
+	}
+	if (!BLI_gset_haskey(data->reused_ids, id)) {
+		data->is_reusable = false;
+		return IDWALK_RET_STOP_ITER;
+	}
+	return IDWALK_RET_NOP;
+}
+
+/**
+ * \param memfile_current: The memfile \a oldmain was last written to or read from,
+ * no ID's may have been added to or removed from \a oldmain since.
+ */
+void blo_make_undo_reuse_id_map(FileData *fd, Main *oldmain, const MemFile *memfile_current)
+{
+	GHash *id_chunks_read = memfile_id_chunk_map_create(fd->memfile);
+	GHash *id_chunks_current = memfile_id_chunk_map_create(memfile_current);
+	GSet *old_ids = BLI_gset_ptr_new(__func__);
+	GSet *reused_ids = BLI_gset_ptr_new(__func__);
+
+	ListBase *lbarray[MAX_LIBARRAY];
+	int a = set_listbasepointers(oldmain, lbarray);
+	while (a--) {
+		for (ID *id = lbarray[a]->first; id; id = id->next) {
+			if (undo_reuse_id_supported(id)) {
+				BLI_gset_add(old_ids, id);
+			}
+		}
+	}
+
+	/* Unchanged ID's, the address in the memfile being read is the one of the ID in the old main. */
+	const unsigned int candidates_len = BLI_ghash_len(id_chunks_read);
+	ID **candidates = MEM_malloc_arrayN(candidates_len, sizeof(*candidates), __func__);
+	unsigned int tot = 0;
+
+	GHashIterator gh_iter;
+	GHASH_ITER (gh_iter, id_chunks_read) {
+		ID *id = BLI_ghashIterator_getKey(&gh_iter);
+		const MemFileChunk *chunk_read = BLI_ghashIterator_getValue(&gh_iter);
+		const MemFileChunk *chunk_current = BLI_ghash_lookup(id_chunks_current, id);
+
+		if (chunk_current == NULL || !BLI_gset_haskey(old_ids, id)) {
+			continue;
+		}
+
+		if (memfile_id_chunks_equal(chunk_read, chunk_current)) {
+			candidates[tot] = id;
+			BLI_gset_add(reused_ids, id);
+			tot++;
+		}
+	}
+
+	/* Drop ID's using ID's which are read again, until no more are dropped. */
+	bool changed;
+	do {
+		changed = false;
+		for (unsigned int i = 0; i < tot; i++) {
+			if (candidates[i] == NULL) {
+				continue;
+			}
+			UndoReuseCheckData data = {.reused_ids = reused_ids, .is_reusable = true};
+			BKE_library_foreach_ID_link(NULL, candidates[i], undo_reuse_id_check_cb, &data, IDWALK_READONLY);
+			if (!data.is_reusable) {
+				BLI_gset_remove(reused_ids, candidates[i], NULL);
+				candidates[i] = NULL;
+				changed = true;
+			}
+		}
+	} while (changed);
+
+	fd->undo_reuse_id_map = BLI_ghash_ptr_new_ex(__func__, BLI_gset_len(reused_ids));
+	for (unsigned int i = 0; i < tot; i++) {
+		if (candidates[i] != NULL) {
+			BLI_ghash_insert(fd->undo_reuse_id_map, candidates[i], candidates[i]);
+		}
+	}
+
+	MEM_freeN(candidates);
+	BLI_gset_free(old_ids, NULL);
+	BLI_gset_free(reused_ids, NULL);
+	BLI_ghash_free(id_chunks_read, NULL, NULL);
+	BLI_ghash_free(id_chunks_current, NULL, NULL);
+}
+
+static int undo_reuse_id_users_cb(void *UNUSED(user_data), ID *UNUSED(id_self), ID **id_pointer, int cb_flag)
+{
+	ID *id = *id_pointer;
+
+	if (id != NULL) {
+		if (cb_flag & IDWALK_CB_USER) {
+			id_us_plus_no_lib(id);
+		}
+		else if (cb_flag & IDWALK_CB_USER_ONE) {
+			id_us_ensure_real(id);
+		}
+	}
+	return IDWALK_RET_NOP;
+}
+
+/**
+ * Finish the state reused ID's, which skipped linking (user counts are added by the ID's using them).
+ *
+ * ID's read again have other addresses than in the memfile, they're tagged so they're not reused
+ * by the next undo, until the next undo push writes them.
+ */
+void blo_end_undo_reuse_id_map(FileData *fd, Main *mainvar)
+{
+	ListBase *lbarray[MAX_LIBARRAY];
+	int a = set_listbasepointers(mainvar, lbarray);
+	while (a--) {
+		for (ID *id = lbarray[a]->first; id; id = id->next) {
+			if (fd->undo_reuse_id_map == NULL || !BLI_ghash_haskey(fd->undo_reuse_id_map, id)) {
+				id->tag |= LIB_TAG_UNDO_CHANGED;
+			}
+		}
+	}
+
+	if (fd->undo_reuse_id_map) {
+		GHashIterator gh_iter;
+		GHASH_ITER (gh_iter, fd->undo_reuse_id_map) {
+			ID *id = BLI_ghashIterator_getValue(&gh_iter);
+
+			BKE_library_foreach_ID_link(NULL, id, undo_reuse_id_users_cb, NULL, IDWALK_READONLY);
+
+			if (GS(id->name) == ID_OB) {
+				/* Cleared by blo_clear_proxy_pointers_from_lib(). */
+				Object *ob = (Object *)id;
+				if (ob->proxy && ob->proxy->id.lib) {
+					ob->proxy->proxy_from = ob;
+				}
+			}
+		}
+	}
+}
+
 /* XXX disabled this feature - packed files also belong in temp saves and quit.blend, to make restore work */
 
 static void insert_packedmap(FileData *fd, PackedFile *pf)
@@ -1887,6 +2337,8 @@ static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
 	int blocksize, nblocks;
 	char *data;
 	
+	BLI_assert(blo_bhead_data(bhead) == (bhead + 1));
+
 	data = (char *)(bhead+1);
 	blocksize = filesdna->typelens[ filesdna->structs[bhead->SDNAnr][0] ];
 	
@@ -1909,12 +2361,12 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 		
 		if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
 			if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
-				temp = DNA_struct_reconstruct(fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, (bh+1));
+				temp = DNA_struct_reconstruct(fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, blo_bhead_data(bh));
 			}
 			else {
 				/* SDNA_CMP_EQUAL */
 				temp = MEM_mallocN(bh->len, blockname);
-				memcpy(temp, (bh+1), bh->len);
+				memcpy(temp, blo_bhead_data(bh), bh->len);
 			}
 		}
 	}
@@ -2529,7 +2981,7 @@ static void direct_link_fcurves(FileData *fd, ListBase *list)
 		fcu->rna_path = newdataadr(fd, fcu->rna_path);
 		
 		/* group */
-		fcu->grp = newdataadr_ex(fd, fcu->grp, false);
+		fcu->grp = newdataadr(fd, fcu->grp);
 		
 		/* clear disabled flag - allows disabled drivers to be tried again ([#32155]),
 		 * but also means that another method for "reviving disabled F-Curves" exists
@@ -8152,6 +8604,31 @@ static BHead *read_data_into_oldnewmap(FileData *fd, BHead *bhead, const char *a
 	return bhead;
 }
 
+/**
+ * Undo: keep an unchanged ID of the old main (see blo_make_undo_reuse_id_map), skipping its data.
+ */
+static BHead *read_libblock_undo_reuse(FileData *fd, Main *main, BHead *bhead, ID *id, const short tag)
+{
+	Main *oldmain = fd->old_mainlist->first;
+	const short idcode = GS(id->name);
+
+	BLI_remlink(which_libbase(oldmain, idcode), id);
+	BLI_addtail(which_libbase(main, idcode), id);
+
+	oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
+
+	/* Users are added again by the ID's using it, it's not linked itself,
+	 * see blo_end_undo_reuse_id_map. */
+	id->us = ID_FAKE_USERS(id);
+	id->newid = NULL;
+	id->tag = tag | LIB_TAG_NEW;
+
+	for (bhead = blo_nextbhead(fd, bhead); bhead && bhead->code == DATA; bhead = blo_nextbhead(fd, bhead)) {
+		/* pass */
+	}
+	return bhead;
+}
+
 static BHead *read_libblock(FileData *fd, Main *main, BHead *bhead, const short tag, ID **r_id)
 {
 	/* this routine reads a libblock and its direct data. Use link functions to connect it all
@@ -8214,6 +8691,15 @@ static BHead *read_libblock(FileData *fd, Main *main, BHead *bhead, const short
 		}
 	}
 
+	if (fd->undo_reuse_id_map && (main->curlib == NULL) && (bhead->code != ID_ID)) {
+		if ((id = BLI_ghash_lookup(fd->undo_reuse_id_map, bhead->old))) {
+			if (r_id) {
+				*r_id = id;
+			}
+			return read_libblock_undo_reuse(fd, main, bhead, id, tag);
+		}
+	}
+
 	/* read libblock */
 	id = read_struct(fd, bhead, "lib block");
 
@@ -8523,8 +9009,6 @@ static void do_versions_after_linking(Main *main)
 
 static void lib_link_all(FileData *fd, Main *main)
 {
-	oldnewmap_sort(fd);
-	
 	/* No load UI for undo memfiles */
 	if (fd->memfile == NULL) {
 		lib_link_windowmanager(fd, main);
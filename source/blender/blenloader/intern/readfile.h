@@ -62,6 +62,11 @@ typedef struct FileData {
 	int filedes;
 	gzFile gzfiledes;
 
+	// variables needed for reading from a file in memory, memory mapped or decompressed
+	const char *map_buffer;
+	size_t map_size;
+	size_t map_offset;
+
 	// now only in use for library appending
 	char relabase[FILE_MAX];
 	
@@ -100,6 +105,9 @@ typedef struct FileData {
 	ListBase *mainlist;
 	ListBase *old_mainlist;  /* Used for undo. */
 
+	/* Undo: map ID addresses in the memfile to unchanged ID's of the old main, kept as is. */
+	struct GHash *undo_reuse_id_map;
+
 	/* ick ick, used to return
 	 * data through streamglue.
 	 */
@@ -109,6 +117,8 @@ typedef struct FileData {
 
 typedef struct BHeadN {
 	struct BHeadN *next, *prev;
+	/* data of the block in the file in memory, NULL when the data follows the bhead */
+	const void *mapped_data;
 	struct BHead bhead;
 } BHeadN;
 
@@ -120,6 +130,7 @@ enum {
 	FD_FLAGS_FILE_OK               = 1 << 3,
 	FD_FLAGS_NOT_MY_BUFFER         = 1 << 4,
 	FD_FLAGS_NOT_MY_LIBMAP         = 1 << 5,  /* XXX Unused in practice (checked once but never set). */
+	FD_FLAGS_MAP_BUFFER_MMAP       = 1 << 6,  /* map_buffer is memory mapped, otherwise allocated */
 };
 
 #define SIZEOFBLENDERHEADER 12
@@ -142,6 +153,8 @@ void blo_make_movieclip_pointer_map(FileData *fd, Main *oldmain);
 void blo_end_movieclip_pointer_map(FileData *fd, Main *oldmain);
 void blo_make_sound_pointer_map(FileData *fd, Main *oldmain);
 void blo_end_sound_pointer_map(FileData *fd, Main *oldmain);
+void blo_make_undo_reuse_id_map(FileData *fd, Main *oldmain, const struct MemFile *memfile_current);
+void blo_end_undo_reuse_id_map(FileData *fd, Main *mainvar);
 void blo_make_packed_pointer_map(FileData *fd, Main *oldmain);
 void blo_end_packed_pointer_map(FileData *fd, Main *oldmain);
 void blo_add_library_pointer_map(ListBase *old_mainlist, FileData *fd);
@@ -151,6 +164,7 @@ void blo_freefiledata(FileData *fd);
 BHead *blo_firstbhead(FileData *fd);
 BHead *blo_nextbhead(FileData *fd, BHead *thisblock);
 BHead *blo_prevbhead(FileData *fd, BHead *thisblock);
+const void *blo_bhead_data(const BHead *bhead);
 
 const char *bhead_id_name(const FileData *fd, const BHead *bhead);
 
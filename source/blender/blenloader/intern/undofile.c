@@ -49,6 +49,7 @@
 #include "DNA_listBase.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
 
 #include "BLO_undofile.h"
 #include "BLO_readfile.h"
@@ -79,31 +80,40 @@ void BLO_memfile_free(MemFile *memfile)
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
 	MemFileChunk *fc, *sc;
-	
-	fc = first->chunks.first;
-	sc = second->chunks.first;
-	while (fc || sc) {
-		if (fc && sc) {
-			if (sc->is_identical) {
+	GHash *buf_owners = BLI_ghash_ptr_new_ex(__func__, (unsigned int)BLI_listbase_count(&first->chunks));
+
+	/* Chunks are shared per ID rather than by position (see #memfile_chunk_add),
+	 * so find the owner of each shared buffer by its address. */
+	for (fc = first->chunks.first; fc; fc = fc->next) {
+		if (fc->is_identical == false) {
+			BLI_ghash_insert(buf_owners, (void *)fc->buf, fc);
+		}
+	}
+
+	for (sc = second->chunks.first; sc; sc = sc->next) {
+		if (sc->is_identical) {
+			fc = BLI_ghash_popkey(buf_owners, sc->buf, NULL);
+			if (fc) {
 				sc->is_identical = false;
 				fc->is_identical = true;
 			}
 		}
-		if (fc) fc = fc->next;
-		if (sc) sc = sc->next;
 	}
-	
+
+	BLI_ghash_free(buf_owners, NULL, NULL);
+
 	BLO_memfile_free(first);
 }
 
 void memfile_chunk_add(
-        MemFile *memfile, const char *buf, unsigned int size,
+        MemFile *memfile, const char *buf, unsigned int size, const void *id,
         MemFileChunk **compchunk_step)
 {
 	MemFileChunk *curchunk = MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk");
 	curchunk->size = size;
 	curchunk->buf = NULL;
 	curchunk->is_identical = false;
+	curchunk->id = id;
 	BLI_addtail(&memfile->chunks, curchunk);
 
 	/* we compare compchunk with buf */
@@ -127,10 +137,54 @@ void memfile_chunk_add(
 	}
 }
 
+/**
+ * \return A map from ID addresses to the first chunk written for that ID.
+ */
+GHash *memfile_id_chunk_map_create(const MemFile *memfile)
+{
+	GHash *id_chunk_map = BLI_ghash_ptr_new(__func__);
+	const void *id_prev = NULL;
+
+	for (MemFileChunk *chunk = memfile->chunks.first; chunk; chunk = chunk->next) {
+		if (chunk->id != NULL && chunk->id != id_prev) {
+			BLI_ghash_insert(id_chunk_map, (void *)chunk->id, chunk);
+		}
+		id_prev = chunk->id;
+	}
+
+	return id_chunk_map;
+}
+
+/**
+ * Compare all chunks of an ID, starting at the first chunk written for it in two memfiles.
+ *
+ * \return true when the ID was written identically.
+ */
+bool memfile_id_chunks_equal(const MemFileChunk *chunk_a, const MemFileChunk *chunk_b)
+{
+	const void *id = chunk_a->id;
+
+	BLI_assert(id != NULL && chunk_b->id == id);
+
+	while (chunk_a && chunk_b && chunk_a->id == id && chunk_b->id == id) {
+		if (chunk_a->buf != chunk_b->buf) {
+			if ((chunk_a->size != chunk_b->size) || memcmp(chunk_a->buf, chunk_b->buf, chunk_a->size) != 0) {
+				return false;
+			}
+		}
+		chunk_a = chunk_a->next;
+		chunk_b = chunk_b->next;
+	}
+
+	/* Both must run out of chunks for this ID at the same time. */
+	return ((chunk_a == NULL || chunk_a->id != id) &&
+	        (chunk_b == NULL || chunk_b->id != id));
+}
+
 struct Main *BLO_memfile_main_get(struct MemFile *memfile, struct Main *oldmain, struct Scene **r_scene)
 {
 	struct Main *bmain_undo = NULL;
-	BlendFileData *bfd = BLO_read_from_memfile(oldmain, oldmain->name, memfile, NULL, BLO_READ_SKIP_NONE);
+	BlendFileData *bfd = BLO_read_from_memfile(oldmain, oldmain->name, memfile, NULL, NULL, BLO_READ_SKIP_NONE);
 
 	if (bfd) {
 		bmain_undo = bfd->main;
@@ -1813,6 +1813,14 @@ void blo_do_versions_270(FileData *fd, Library *UNUSED(lib), Main *main)
 			}
 			scene->r.ffcodecdata.ffmpeg_preset = preset;
 		}
+
+		if (!DNA_struct_elem_find(fd->filesdna, "bNodeTree", "int", "cache_size")) {
+			for (Scene *scene = main->scene.first; scene; scene = scene->id.next) {
+				if (scene->nodetree) {
+					scene->nodetree->cache_size = 256;
+				}
+			}
+		}
 	}
 }
 
@@ -152,8 +152,10 @@
 #include "MEM_guardedalloc.h" // MEM_freeN
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
 #include "BLI_linklist.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
 
 #include "BKE_action.h"
 #include "BKE_blender_version.h"
@@ -218,7 +220,7 @@ struct WriteWrap {
 	/* internal */
 	union {
 		int file_handle;
-		gzFile gz_handle;
+		struct ZlibWriter *zlib_writer;
 	} _user_data;
 };
 
@@ -250,31 +252,241 @@ static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
-/* zlib */
+/* zlib, see BLEND_GZIP_FRAME_SIZE */
 #define FILE_HANDLE(ww) \
-	(ww)->_user_data.gz_handle
+	(ww)->_user_data.zlib_writer
+
+typedef struct ZlibFrame {
+	char *data;
+	size_t data_len;
+	char *compressed;
+	size_t compressed_size;
+	/* 0 when compression failed */
+	size_t compressed_len;
+} ZlibFrame;
+
+typedef struct ZlibWriter {
+	int file_handle;
+
+	/* frames that are compressed in parallel, the last one being filled */
+	ZlibFrame *frames;
+	int frames_len;
+	int frames_used;
+
+	/* compressed size of all written frames */
+	uint *table;
+	int table_len;
+	int table_size;
+	uint64_t total_len;
 
-static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
+	bool error;
+} ZlibWriter;
+
+static void zlib_frame_compress_cb(
+        void *__restrict userdata, const int iter, const ParallelRangeTLS *__restrict UNUSED(tls))
 {
-	gzFile file;
+	ZlibFrame *frame = &((ZlibFrame *)userdata)[iter];
+	z_stream strm = {NULL};
+	size_t bound;
 
-	file = BLI_gzopen(filepath, "wb1");
+	frame->compressed_len = 0;
 
-	if (file != Z_NULL) {
-		FILE_HANDLE(ww) = file;
+	/* level 1 and gzip header, same as the "wb1" stream used before */
+	if (deflateInit2(&strm, 1, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+		return;
+	}
+
+	bound = deflateBound(&strm, frame->data_len);
+	if (frame->compressed_size < bound) {
+		MEM_SAFE_FREE(frame->compressed);
+		frame->compressed = MEM_mallocN(bound, __func__);
+		frame->compressed_size = bound;
+	}
+
+	strm.next_in = (Bytef *)frame->data;
+	strm.avail_in = frame->data_len;
+	strm.next_out = (Bytef *)frame->compressed;
+	strm.avail_out = frame->compressed_size;
+
+	if (deflate(&strm, Z_FINISH) == Z_STREAM_END) {
+		frame->compressed_len = strm.total_out;
+	}
+
+	deflateEnd(&strm);
+}
+
+static bool zlib_writer_write(ZlibWriter *writer, const void *data, size_t data_len)
+{
+	while (data_len) {
+		const int len = write(writer->file_handle, data, data_len);
+		if (len <= 0) {
+			return false;
+		}
+		data = (const char *)data + len;
+		data_len -= len;
+	}
+	return true;
+}
+
+/* compress the full frames in parallel and write them in order */
+static void zlib_writer_flush(ZlibWriter *writer, bool flush_last)
+{
+	ParallelRangeSettings settings;
+	int frames_len = writer->frames_used;
+	int i;
+
+	if (flush_last && writer->frames[frames_len].data_len) {
+		frames_len++;
+	}
+
+	if (writer->error || frames_len == 0) {
+		writer->frames_used = 0;
+		return;
+	}
+
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = (frames_len > 1);
+	BLI_task_parallel_range(0, frames_len, writer->frames, zlib_frame_compress_cb, &settings);
+
+	for (i = 0; i < frames_len && !writer->error; i++) {
+		ZlibFrame *frame = &writer->frames[i];
+
+		if (frame->compressed_len == 0 || !zlib_writer_write(writer, frame->compressed, frame->compressed_len)) {
+			writer->error = true;
+			break;
+		}
+
+		if (UNLIKELY(writer->table_len == writer->table_size)) {
+			writer->table_size *= 2;
+			writer->table = MEM_reallocN(writer->table, sizeof(*writer->table) * writer->table_size);
+		}
+		writer->table[writer->table_len++] = (uint)frame->compressed_len;
+		writer->total_len += frame->data_len;
+		frame->data_len = 0;
+	}
+
+	writer->frames_used = 0;
+}
+
+static char *zlib_table_put_uint(char *p, uint64_t value, int bytes)
+{
+	int i;
+	for (i = 0; i < bytes; i++) {
+		*p++ = (char)((value >> (8 * i)) & 0xff);
+	}
+	return p;
+}
+
+/* write the empty gzip member holding the frame table */
+static bool zlib_writer_write_table(ZlibWriter *writer)
+{
+	const size_t data_len = BLEND_GZIP_TABLE_DATA_SIZE + 4 * (size_t)writer->table_len;
+	const size_t member_len = BLEND_GZIP_TABLE_HEADER_SIZE + data_len + BLEND_GZIP_TABLE_FOOTER_SIZE;
+	char *member, *p;
+	bool ok;
+	int i;
+
+	if (writer->table_len > BLEND_GZIP_TABLE_FRAMES_MAX) {
+		/* still a valid file, readers can't seek in it */
 		return true;
 	}
-	else {
+
+	member = p = MEM_mallocN(member_len, __func__);
+
+	/* gzip header with FEXTRA flag, no modification time, unknown OS */
+	*p++ = 0x1f; *p++ = (char)0x8b; *p++ = 8; *p++ = 4;
+	p = zlib_table_put_uint(p, 0, 4);
+	*p++ = 0; *p++ = (char)0xff;
+	p = zlib_table_put_uint(p, data_len + 4, 2);
+	*p++ = BLEND_GZIP_TABLE_SI1; *p++ = BLEND_GZIP_TABLE_SI2;
+	p = zlib_table_put_uint(p, data_len, 2);
+
+	p = zlib_table_put_uint(p, BLEND_GZIP_FRAME_SIZE, 4);
+	p = zlib_table_put_uint(p, writer->total_len, 8);
+	for (i = 0; i < writer->table_len; i++) {
+		p = zlib_table_put_uint(p, writer->table[i], 4);
+	}
+	p = zlib_table_put_uint(p, writer->table_len, 4);
+	*p++ = BLEND_GZIP_TABLE_SI1; *p++ = BLEND_GZIP_TABLE_SI2; *p++ = 'T'; *p++ = 'B';
+
+	/* empty deflate stream, CRC32 and size of no data */
+	*p++ = 3; *p++ = 0;
+	p = zlib_table_put_uint(p, 0, 8);
+
+	BLI_assert(p == member + member_len);
+
+	ok = zlib_writer_write(writer, member, member_len);
+	MEM_freeN(member);
+	return ok;
+}
+
+static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
+{
+	TaskScheduler *scheduler = BLI_task_scheduler_get();
+	ZlibWriter *writer;
+	int file, i;
+
+	file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
+
+	if (file == -1) {
 		return false;
 	}
+
+	writer = MEM_callocN(sizeof(*writer), __func__);
+	writer->file_handle = file;
+	/* enough frames to keep all threads busy, without holding too much of the file in memory */
+	writer->frames_len = CLAMPIS(BLI_task_scheduler_num_threads(scheduler) * 2, 2, 64);
+	writer->frames = MEM_callocN(sizeof(*writer->frames) * writer->frames_len, __func__);
+	for (i = 0; i < writer->frames_len; i++) {
+		writer->frames[i].data = MEM_mallocN(BLEND_GZIP_FRAME_SIZE, __func__);
+	}
+	writer->table_size = 64;
+	writer->table = MEM_mallocN(sizeof(*writer->table) * writer->table_size, __func__);
+
+	FILE_HANDLE(ww) = writer;
+	return true;
 }
 static bool ww_close_zlib(WriteWrap *ww)
 {
-	return (gzclose(FILE_HANDLE(ww)) == Z_OK);
+	ZlibWriter *writer = FILE_HANDLE(ww);
+	bool ok;
+	int i;
+
+	zlib_writer_flush(writer, true);
+	ok = !writer->error && zlib_writer_write_table(writer);
+	ok = (close(writer->file_handle) != -1) && ok;
+
+	for (i = 0; i < writer->frames_len; i++) {
+		MEM_freeN(writer->frames[i].data);
+		MEM_SAFE_FREE(writer->frames[i].compressed);
+	}
+	MEM_freeN(writer->frames);
+	MEM_freeN(writer->table);
+	MEM_freeN(writer);
+
+	return ok;
 }
 static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 {
-	return gzwrite(FILE_HANDLE(ww), buf, buf_len);
+	ZlibWriter *writer = FILE_HANDLE(ww);
+	size_t written = 0;
+
+	while (written < buf_len && !writer->error) {
+		ZlibFrame *frame = &writer->frames[writer->frames_used];
+		const size_t len = MIN2(buf_len - written, BLEND_GZIP_FRAME_SIZE - frame->data_len);
+
+		memcpy(frame->data + frame->data_len, buf + written, len);
+		frame->data_len += len;
+		written += len;
+
+		if (frame->data_len == BLEND_GZIP_FRAME_SIZE) {
+			if (++writer->frames_used == writer->frames_len) {
+				zlib_writer_flush(writer, false);
+			}
+		}
+	}
+
+	return writer->error ? 0 : written;
 }
 #undef FILE_HANDLE
 
@@ -330,6 +542,10 @@ typedef struct {
 		MemFile      *compare;
 		/** Use to de-duplicate chunks when writing. */
 		MemFileChunk *compare_chunk;
+		/** Map ID addresses to their first chunk in #WriteData.mem.compare (may be NULL). */
+		GHash        *compare_id_chunk_map;
+		/** The ID being written (see #mywrite_id_begin), stored in its chunks. */
+		const ID     *current_id;
 	} mem;
 	/** When true, write to #WriteData.current, could also call 'is_undo'. */
 	bool use_memfile;
@@ -371,7 +587,7 @@ static void writedata_do_write(WriteData *wd, const void *mem, int memlen)
 
 	/* memory based save */
 	if (wd->use_memfile) {
-		memfile_chunk_add(wd->mem.current, mem, memlen, &wd->mem.compare_chunk);
+		memfile_chunk_add(wd->mem.current, mem, memlen, wd->mem.current_id, &wd->mem.compare_chunk);
 	}
 	else {
 		if (wd->ww->write(wd->ww, mem, memlen) != memlen) {
@@ -382,6 +598,9 @@ static void writedata_do_write(WriteData *wd, const void *mem, int memlen)
 
 static void writedata_free(WriteData *wd)
 {
+	if (wd->mem.compare_id_chunk_map) {
+		BLI_ghash_free(wd->mem.compare_id_chunk_map, NULL, NULL);
+	}
 	MEM_freeN(wd->buf);
 	MEM_freeN(wd);
 }
@@ -468,6 +687,7 @@ static WriteData *mywrite_begin(WriteWrap *ww, MemFile *compare, MemFile *curren
 		wd->mem.current = current;
 		wd->mem.compare = compare;
 		wd->mem.compare_chunk = compare ? compare->chunks.first : NULL;
+		wd->mem.compare_id_chunk_map = compare ? memfile_id_chunk_map_create(compare) : NULL;
 		wd->use_memfile = true;
 	}
 
@@ -493,6 +713,35 @@ static bool mywrite_end(WriteData *wd)
 	return err;
 }
 
+/**
+ * Start writing an ID, for undo its data is kept in separate chunks which are compared
+ * with the chunks of the same ID in the previous undo step, wherever they are in that step.
+ * This way adding or removing an ID doesn't cause all data written after it to be duplicated,
+ * and undo can tell which ID's are unchanged.
+ */
+static void mywrite_id_begin(WriteData *wd, const ID *id)
+{
+	if (wd->use_memfile) {
+		mywrite_flush(wd);
+		wd->mem.current_id = id;
+
+		if (wd->mem.compare_id_chunk_map) {
+			MemFileChunk *compare_chunk = BLI_ghash_lookup(wd->mem.compare_id_chunk_map, id);
+			if (compare_chunk) {
+				wd->mem.compare_chunk = compare_chunk;
+			}
+		}
+	}
+}
+
+static void mywrite_id_end(WriteData *wd, const ID *UNUSED(id))
+{
+	if (wd->use_memfile) {
+		mywrite_flush(wd);
+		wd->mem.current_id = NULL;
+	}
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -3880,6 +4129,8 @@ static bool write_file_handle(
 			/* We should never attempt to write non-regular IDs (i.e. all kind of temp/runtime ones). */
 			BLI_assert((id->tag & (LIB_TAG_NO_MAIN | LIB_TAG_NO_USER_REFCOUNT | LIB_TAG_NOT_ALLOCATED)) == 0);
 
+			mywrite_id_begin(wd, id);
+
 			switch ((ID_Type)GS(id->name)) {
 				case ID_WM:
 					write_windowmanager(wd, (wmWindowManager *)id);
@@ -3989,6 +4240,8 @@ static bool write_file_handle(
 					BLI_assert(0);
 					break;
 			}
+
+			mywrite_id_end(wd, id);
 		}
 
 		mywrite_flush(wd);
@@ -4147,9 +4400,12 @@ bool BLO_write_file(
 	}
 
 	/* actual file writing */
-	const bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, thumb);
+	bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, thumb);
 
-	ww.close(&ww);
+	/* compressed files are written when closing */
+	if (ww.close(&ww) == false) {
+		err = true;
+	}
 
 	if (UNLIKELY(path_list_backup)) {
 		BKE_bpath_list_restore(mainvar, path_list_flag, path_list_backup);
@@ -347,6 +347,12 @@ void BM_mesh_bm_from_me(
 	const int cd_shape_keyindex_offset = is_new && (tot_shape_keys || params->add_key_index) ?
 	          CustomData_get_offset(&bm->vdata, CD_SHAPE_KEYINDEX) : -1;
 
+	CustomDataBMeshCopyMap vmap, emap, lmap, pmap;
+	CustomData_bmesh_copy_map_init_to_bmesh(&vmap, &me->vdata, &bm->vdata, true);
+	CustomData_bmesh_copy_map_init_to_bmesh(&emap, &me->edata, &bm->edata, true);
+	CustomData_bmesh_copy_map_init_to_bmesh(&lmap, &me->ldata, &bm->ldata, true);
+	CustomData_bmesh_copy_map_init_to_bmesh(&pmap, &me->pdata, &bm->pdata, true);
+
 	vtable = MEM_mallocN(sizeof(BMVert **) * me->totvert, __func__);
 
 	for (i = 0, mvert = me->mvert; i < me->totvert; i++, mvert++) {
@@ -364,7 +370,7 @@ void BM_mesh_bm_from_me(
 		normal_short_to_float_v3(v->no, mvert->no);
 
 		/* Copy Custom Data */
-		CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
+		CustomData_to_bmesh_block_mapped(&vmap, &bm->vdata, i, &v->head.data);
 
 		if (cd_vert_bweight_offset != -1) BM_ELEM_CD_SET_FLOAT(v, cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
 
@@ -399,7 +405,7 @@ void BM_mesh_bm_from_me(
 		}
 
 		/* Copy Custom Data */
-		CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
+		CustomData_to_bmesh_block_mapped(&emap, &bm->edata, i, &e->head.data);
 
 		if (cd_edge_bweight_offset != -1) BM_ELEM_CD_SET_FLOAT(e, cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
 		if (cd_edge_crease_offset  != -1) BM_ELEM_CD_SET_FLOAT(e, cd_edge_crease_offset,  (float)medge->crease  / 255.0f);
@@ -454,11 +460,11 @@ void BM_mesh_bm_from_me(
 			BM_elem_index_set(l_iter, totloops++); /* set_ok */
 
 			/* Save index of correspsonding MLoop */
-			CustomData_to_bmesh_block(&me->ldata, &bm->ldata, j++, &l_iter->head.data, true);
+			CustomData_to_bmesh_block_mapped(&lmap, &bm->ldata, j++, &l_iter->head.data);
 		} while ((l_iter = l_iter->next) != l_first);
 
 		/* Copy Custom Data */
-		CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
+		CustomData_to_bmesh_block_mapped(&pmap, &bm->pdata, i, &f->head.data);
 
 		if (params->calc_face_normal) {
 			BM_face_normal_update(f);
@@ -468,6 +474,11 @@ void BM_mesh_bm_from_me(
 		bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP); /* added in order, clear dirty flag */
 	}
 
+	CustomData_bmesh_copy_map_free(&vmap);
+	CustomData_bmesh_copy_map_free(&emap);
+	CustomData_bmesh_copy_map_free(&lmap);
+	CustomData_bmesh_copy_map_free(&pmap);
+
 	/* -------------------------------------------------------------------- */
 	/* MSelect clears the array elements (avoid adding multiple times).
 	 *
@@ -671,6 +682,12 @@ void BM_mesh_bm_to_me(
 	/* this is called again, 'dotess' arg is used there */
 	BKE_mesh_update_customdata_pointers(me, 0);
 
+	CustomDataBMeshCopyMap vmap, emap, lmap, pmap;
+	CustomData_bmesh_copy_map_init_from_bmesh(&vmap, &bm->vdata, &me->vdata);
+	CustomData_bmesh_copy_map_init_from_bmesh(&emap, &bm->edata, &me->edata);
+	CustomData_bmesh_copy_map_init_from_bmesh(&lmap, &bm->ldata, &me->ldata);
+	CustomData_bmesh_copy_map_init_from_bmesh(&pmap, &bm->pdata, &me->pdata);
+
 	i = 0;
 	BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
 		copy_v3_v3(mvert->co, v->co);
@@ -681,7 +698,7 @@ void BM_mesh_bm_to_me(
 		BM_elem_index_set(v, i); /* set_inline */
 
 		/* copy over customdat */
-		CustomData_from_bmesh_block(&bm->vdata, &me->vdata, v->head.data, i);
+		CustomData_from_bmesh_block_mapped(&vmap, v->head.data, i);
 
 		if (cd_vert_bweight_offset != -1) mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, cd_vert_bweight_offset);
 
@@ -703,7 +720,7 @@ void BM_mesh_bm_to_me(
 		BM_elem_index_set(e, i); /* set_inline */
 
 		/* copy over customdata */
-		CustomData_from_bmesh_block(&bm->edata, &me->edata, e->head.data, i);
+		CustomData_from_bmesh_block_mapped(&emap, e->head.data, i);
 
 		bmesh_quick_edgedraw_flag(med, e);
 
@@ -731,7 +748,7 @@ void BM_mesh_bm_to_me(
 			mloop->v = BM_elem_index_get(l_iter->v);
 
 			/* copy over customdata */
-			CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
+			CustomData_from_bmesh_block_mapped(&lmap, l_iter->head.data, j);
 
 			j++;
 			mloop++;
@@ -743,13 +760,18 @@ void BM_mesh_bm_to_me(
 		if (f == bm->act_face) me->act_face = i;
 
 		/* copy over customdata */
-		CustomData_from_bmesh_block(&bm->pdata, &me->pdata, f->head.data, i);
+		CustomData_from_bmesh_block_mapped(&pmap, f->head.data, i);
 
 		i++;
 		mpoly++;
 		BM_CHECK_ELEMENT(f);
 	}
 
+	CustomData_bmesh_copy_map_free(&vmap);
+	CustomData_bmesh_copy_map_free(&emap);
+	CustomData_bmesh_copy_map_free(&lmap);
+	CustomData_bmesh_copy_map_free(&pmap);
+
 	/* patch hook indices and vertex parents */
 	if (params->calc_object_remap && (ototvert > 0)) {
 		Object *ob;
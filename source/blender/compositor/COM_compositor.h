@@ -319,6 +319,20 @@ void COM_execute(RenderData *rd, Scene *scene, bNodeTree *editingtree, int rende
                  const ColorManagedViewSettings *viewSettings, const ColorManagedDisplaySettings *displaySettings,
                  const char *viewName);
 
+/**
+ * @brief Write the profile of the last execution of a tree as trace event JSON file.
+ * Profiling is enabled per tree with NTREE_COM_PROFILE, the file can be opened in chrome://tracing.
+ *
+ * @return 0 when the last profiled execution was not of editingtree or the file could not be written
+ */
+int COM_profile_write(const bNodeTree *editingtree, const char *filepath);
+
+/**
+ * @brief Tell the compositor render results have been rendered or read again.
+ * Results calculated from the previous render results are not reused.
+ */
+void COM_render_results_changed(void);
+
 /**
  * @brief Deinitialize the compositor caches and allocated memory.
  * Use COM_clearCaches to only free the caches.
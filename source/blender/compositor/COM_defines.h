@@ -109,6 +109,13 @@ typedef enum OrderOfChunks {
 #define COM_NUM_CHANNELS_VECTOR 3
 #define COM_NUM_CHANNELS_COLOR 4
 
+/**
+ * @brief Maximum number of pixels which are calculated in a single row execution.
+ * Operations can use stack buffers of this size to read their inputs.
+ * @see SocketReader.executeRow
+ */
+#define COM_ROW_LENGTH_MAX 64
+
 #define COM_BLUR_BOKEH_PIXELS 512
 
 #endif  /* __COM_DEFINES_H__ */
@@ -21,6 +21,7 @@
  */
 
 #include "COM_CPUDevice.h"
+#include "COM_Profiler.h"
 
 CPUDevice::CPUDevice(int thread_id)
   : Device(),
@@ -33,11 +34,13 @@ void CPUDevice::execute(WorkPackage *work)
 	const unsigned int chunkNumber = work->getChunkNumber();
 	ExecutionGroup *executionGroup = work->getExecutionGroup();
 	rcti rect;
+	const double start = Profiler::chunk_started(this->m_thread_id + 1);
 
 	executionGroup->determineChunkRect(&rect, chunkNumber);
 
 	executionGroup->getOutputOperation()->executeRegion(&rect, chunkNumber);
 
+	Profiler::chunk_finished(executionGroup, chunkNumber, start);
 	executionGroup->finalizeChunkExecution(chunkNumber, NULL);
 }
 
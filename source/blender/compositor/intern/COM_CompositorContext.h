@@ -200,6 +200,22 @@ public:
 	void setFastCalculation(bool fastCalculation) {this->m_fastCalculation = fastCalculation;}
 	bool isFastCalculation() const { return this->m_fastCalculation; }
 	bool isGroupnodeBufferEnabled() const { return (this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER) != 0; }
+	bool isFullFrame() const { return (this->getbNodeTree()->flag & NTREE_COM_FULL_FRAME) != 0; }
+	bool isProfiling() const { return (this->getbNodeTree()->flag & NTREE_COM_PROFILE) != 0; }
+
+	/**
+	 * @brief results are cached between executions, never when rendering
+	 * @see ResultCache
+	 */
+	bool isResultCacheEnabled() const { return !this->m_rendering && (this->getbNodeTree()->flag & NTREE_COM_RESULT_CACHE) != 0; }
+
+	/**
+	 * @brief memory budget of the result cache in bytes
+	 */
+	size_t getResultCacheSize() const {
+		const int size = this->getbNodeTree()->cache_size;
+		return (size > 0) ? (size_t)size * 1024 * 1024 : 0;
+	}
 };
 
 
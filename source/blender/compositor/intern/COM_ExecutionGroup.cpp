@@ -36,6 +36,7 @@
 #include "COM_ViewerOperation.h"
 #include "COM_ChunkOrder.h"
 #include "COM_Debug.h"
+#include "COM_Profiler.h"
 
 #include "MEM_guardedalloc.h"
 #include "BLI_math.h"
@@ -62,6 +63,7 @@ ExecutionGroup::ExecutionGroup()
 	this->m_singleThreaded = false;
 	this->m_chunksFinished = 0;
 	BLI_rcti_init(&this->m_viewerBorder, 0, 0, 0, 0);
+	BLI_rcti_init(&this->m_fullFrameArea, 0, 0, 0, 0);
 	this->m_executionStartTime = 0;
 }
 
@@ -138,6 +140,12 @@ void ExecutionGroup::initExecution()
 	maxNumber++;
 	this->m_cachedMaxReadBufferOffset = maxNumber;
 
+	if (this->m_isOutput) {
+		this->m_fullFrameArea = this->m_viewerBorder;
+	}
+	else {
+		BLI_rcti_init(&this->m_fullFrameArea, 0, 0, 0, 0);
+	}
 }
 
 void ExecutionGroup::deinitExecution()
@@ -350,6 +358,99 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
 	MEM_freeN(chunkOrder);
 }
 
+void ExecutionGroup::addFullFrameArea(const rcti *area)
+{
+	if (BLI_rcti_is_empty(area)) {
+		return;
+	}
+	if (BLI_rcti_is_empty(&this->m_fullFrameArea)) {
+		this->m_fullFrameArea = *area;
+	}
+	else {
+		BLI_rcti_union(&this->m_fullFrameArea, area);
+	}
+}
+
+void ExecutionGroup::determineFullFrameDependencies()
+{
+	if (this->m_numberOfChunks == 0 || BLI_rcti_is_empty(&this->m_fullFrameArea)) {
+		return;
+	}
+
+	int minxchunk, maxxchunk, minychunk, maxychunk;
+	determineChunkRange(&this->m_fullFrameArea, &minxchunk, &maxxchunk, &minychunk, &maxychunk);
+
+	rcti rect;
+	rcti area;
+	for (int indexy = minychunk; indexy < maxychunk; indexy++) {
+		for (int indexx = minxchunk; indexx < maxxchunk; indexx++) {
+			determineChunkRect(&rect, indexx, indexy);
+			for (unsigned int index = 0; index < this->m_cachedReadOperations.size(); index++) {
+				ReadBufferOperation *readOperation = (ReadBufferOperation *)this->m_cachedReadOperations[index];
+				BLI_rcti_init(&area, 0, 0, 0, 0);
+				determineDependingAreaOfInterest(&rect, readOperation, &area);
+				readOperation->getMemoryProxy()->getExecutor()->addFullFrameArea(&area);
+			}
+		}
+	}
+}
+
+void ExecutionGroup::executeFullFrame(ExecutionSystem *graph)
+{
+	const CompositorContext &context = graph->getContext();
+	const bNodeTree *bTree = context.getbNodeTree();
+	if (this->m_width == 0 || this->m_height == 0) {return; } /// @note: break out... no pixels to calculate.
+	if (this->m_numberOfChunks == 0) {return; } /// @note: early break out
+	if (BLI_rcti_is_empty(&this->m_fullFrameArea)) {return; } /// @note: no consumer needs this group
+
+	this->m_executionStartTime = PIL_check_seconds_timer();
+
+	this->m_chunksFinished = 0;
+	/* progress is only reported by output groups, like in execute */
+	this->m_bTree = this->m_isOutput ? bTree : NULL;
+
+	/* buffers are allocated just before the execution of the group that writes them */
+	for (unsigned int index = 0; index < this->m_cachedReadOperations.size(); index++) {
+		ReadBufferOperation *readOperation = (ReadBufferOperation *)this->m_cachedReadOperations[index];
+		readOperation->updateMemoryBuffer();
+	}
+
+	DebugInfo::execution_group_started(this);
+
+	int minxchunk, maxxchunk, minychunk, maxychunk;
+	determineChunkRange(&this->m_fullFrameArea, &minxchunk, &maxxchunk, &minychunk, &maxychunk);
+	for (int indexy = minychunk; indexy < maxychunk; indexy++) {
+		for (int indexx = minxchunk; indexx < maxxchunk; indexx++) {
+			scheduleChunk(indexy * this->m_numberOfXChunks + indexx);
+		}
+	}
+
+	WorkScheduler::finish();
+
+	DebugInfo::execution_group_finished(this);
+}
+
+void ExecutionGroup::setExecuted()
+{
+	for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+		this->m_chunkExecutionStates[index] = COM_ES_EXECUTED;
+	}
+	this->m_chunksFinished = this->m_numberOfChunks;
+}
+
+bool ExecutionGroup::isFullyExecuted() const
+{
+	if (this->m_chunkExecutionStates == NULL) {
+		return false;
+	}
+	for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+		if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED) {
+			return false;
+		}
+	}
+	return true;
+}
+
 MemoryBuffer **ExecutionGroup::getInputBuffersOpenCL(int chunkNumber)
 {
 	rcti rect;
@@ -448,15 +549,17 @@ MemoryBuffer *ExecutionGroup::allocateOutputBuffer(int /*chunkNumber*/,
 }
 
 
-bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area)
+void ExecutionGroup::determineChunkRange(const rcti *area, int *r_minxchunk, int *r_maxxchunk,
+                                         int *r_minychunk, int *r_maxychunk) const
 {
 	if (this->m_singleThreaded) {
-		return scheduleChunkWhenPossible(graph, 0, 0);
+		*r_minxchunk = *r_minychunk = 0;
+		*r_maxxchunk = *r_maxychunk = 1;
+		return;
 	}
 	// find all chunks inside the rect
 	// determine minxchunk, minychunk, maxxchunk, maxychunk where x and y are chunknumbers
 
-	int indexx, indexy;
 	int minx = max_ii(area->xmin - m_viewerBorder.xmin, 0);
 	int maxx = min_ii(area->xmax - m_viewerBorder.xmin, m_viewerBorder.xmax - m_viewerBorder.xmin);
 	int miny = max_ii(area->ymin - m_viewerBorder.ymin, 0);
@@ -465,10 +568,21 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
 	int maxxchunk = (maxx + (int)m_chunkSize - 1) / (int)m_chunkSize;
 	int minychunk = miny / (int)m_chunkSize;
 	int maxychunk = (maxy + (int)m_chunkSize - 1) / (int)m_chunkSize;
-	minxchunk = max_ii(minxchunk, 0);
-	minychunk = max_ii(minychunk, 0);
-	maxxchunk = min_ii(maxxchunk, (int)m_numberOfXChunks);
-	maxychunk = min_ii(maxychunk, (int)m_numberOfYChunks);
+	*r_minxchunk = max_ii(minxchunk, 0);
+	*r_minychunk = max_ii(minychunk, 0);
+	*r_maxxchunk = min_ii(maxxchunk, (int)m_numberOfXChunks);
+	*r_maxychunk = min_ii(maxychunk, (int)m_numberOfYChunks);
+}
+
+bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area)
+{
+	if (this->m_singleThreaded) {
+		return scheduleChunkWhenPossible(graph, 0, 0);
+	}
+
+	int indexx, indexy;
+	int minxchunk, maxxchunk, minychunk, maxychunk;
+	determineChunkRange(area, &minxchunk, &maxxchunk, &minychunk, &maxychunk);
 
 	bool result = true;
 	for (indexx = minxchunk; indexx < maxxchunk; indexx++) {
@@ -547,6 +661,7 @@ bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph, int xChun
 
 void ExecutionGroup::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
 {
+	Profiler::area_of_interest_determined(this);
 	this->getOutputOperation()->determineDependingAreaOfInterest(input, readOperation, output);
 }
 
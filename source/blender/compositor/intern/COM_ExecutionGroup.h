@@ -178,6 +178,13 @@ private:
 	 */
 	double m_executionStartTime;
 
+	/**
+	 * @brief area of this ExecutionGroup that needs to be calculated by the full frame execution
+	 * @note measured in pixel space
+	 * @see ExecutionSystem.executeFullFrame
+	 */
+	rcti m_fullFrameArea;
+
 	// methods
 	/**
 	 * @brief check whether parameter operation can be added to the execution group
@@ -219,6 +226,12 @@ private:
 	 */
 	bool scheduleChunkWhenPossible(ExecutionSystem *graph, int xChunk, int yChunk);
 
+	/**
+	 * @brief determine the range of chunks that overlap an area.
+	 * @note the range is clamped to the chunks of this ExecutionGroup, max values are exclusive
+	 */
+	void determineChunkRange(const rcti *area, int *r_minxchunk, int *r_maxxchunk, int *r_minychunk, int *r_maxychunk) const;
+
 	/**
 	 * @brief try to schedule a specific area.
 	 * @note Check if a certain area is available, when not available this are will be checked.
@@ -376,6 +389,39 @@ public:
 	 */
 	void execute(ExecutionSystem *system);
 	
+	/**
+	 * @brief extend the area of this ExecutionGroup that will be calculated by executeFullFrame
+	 * @note output ExecutionGroups start with their viewer border, other groups with an empty area
+	 */
+	void addFullFrameArea(const rcti *area);
+
+	/**
+	 * @brief propagate the full frame area of this ExecutionGroup to the ExecutionGroups it depends on
+	 * @note the area of interest is determined per chunk, so the result matches the areas
+	 * @note requested by the tiled execution.
+	 */
+	void determineFullFrameDependencies();
+
+	/**
+	 * @brief calculate all chunks of the full frame area in one go
+	 * @note unlike execute, no dependencies are scheduled. All ExecutionGroups this group
+	 * @note depends on have to be executed already.
+	 * @see ExecutionSystem.executeFullFrame
+	 * @param system
+	 */
+	void executeFullFrame(ExecutionSystem *system);
+
+	/**
+	 * @brief mark all chunks as executed, used when the result is taken from the ResultCache
+	 * @note call after initExecution
+	 */
+	void setExecuted();
+
+	/**
+	 * @brief check if all chunks of this ExecutionGroup have been executed
+	 */
+	bool isFullyExecuted() const;
+
 	/**
 	 * @brief this method determines the MemoryProxy's where this execution group depends on.
 	 * @note After this method determineDependingAreaOfInterest can be called to determine
@@ -413,8 +459,9 @@ public:
 
 	void setRenderBorder(float xmin, float xmax, float ymin, float ymax);
 
-	/* allow the DebugInfo class to look at internals */
+	/* allow the DebugInfo and Profiler classes to look at internals */
 	friend class DebugInfo;
+	friend class Profiler;
 
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:ExecutionGroup")
@@ -22,9 +22,15 @@
 
 #include "COM_ExecutionSystem.h"
 
+#include <algorithm>
+#include <map>
+#include <stdio.h>
+
 #include "PIL_time.h"
 #include "BLI_utildefines.h"
+#include "BLI_string.h"
 extern "C" {
+#include "BKE_global.h"
 #include "BKE_node.h"
 }
 
@@ -36,7 +42,9 @@ extern "C" {
 #include "COM_ExecutionGroup.h"
 #include "COM_WorkScheduler.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
 #include "COM_Debug.h"
+#include "COM_Profiler.h"
 
 #ifdef WITH_CXX_GUARDEDALLOC
 #include "MEM_guardedalloc.h"
@@ -46,6 +54,8 @@ ExecutionSystem::ExecutionSystem(RenderData *rd, Scene *scene, bNodeTree *editin
                                  const ColorManagedViewSettings *viewSettings, const ColorManagedDisplaySettings *displaySettings,
                                  const char *viewName)
 {
+	this->m_bufferMemory = 0;
+	this->m_peakBufferMemory = 0;
 	this->m_context.setViewName(viewName);
 	this->m_context.setScene(scene);
 	this->m_context.setbNodeTree(editingtree);
@@ -129,9 +139,11 @@ void ExecutionSystem::set_operations(const Operations &operations, const Groups
 void ExecutionSystem::execute()
 {
 	const bNodeTree *editingtree = this->m_context.getbNodeTree();
+	const bool fullFrame = this->m_context.isFullFrame();
 	editingtree->stats_draw(editingtree->sdh, IFACE_("Compositing | Initializing execution"));
 
 	DebugInfo::execute_started(this);
+	Profiler::execute_started(this);
 	
 	unsigned int order = 0;
 	for (vector<NodeOperation *>::iterator iter = this->m_operations.begin(); iter != this->m_operations.end(); ++iter) {
@@ -144,12 +156,28 @@ void ExecutionSystem::execute()
 	}
 	unsigned int index;
 
-	// First allocale all write buffer
+	this->m_cacheKeys.clear();
+	this->m_cacheHits.clear();
+	if (this->m_context.isResultCacheEnabled()) {
+		ResultCache::beginExecution(this->m_context.getResultCacheSize());
+		ResultCache::determineKeys(this->m_context, this->m_operations, &this->m_cacheKeys);
+	}
+	else {
+		ResultCache::clear();
+	}
+
+	// First allocale all write buffer, full frame execution allocates them when needed
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
 		if (operation->isWriteBufferOperation()) {
+			WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
 			operation->setbNodeTree(this->m_context.getbNodeTree());
+			const double start = Profiler::operation_started(operation);
 			operation->initExecution();
+			Profiler::operation_finished(operation, Profiler::PROFILE_INIT, start);
+			if (!findCachedBuffer(writeOperation->getMemoryProxy()) && !fullFrame) {
+				allocateBuffer(writeOperation->getMemoryProxy());
+			}
 		}
 	}
 	// Connect read buffers to their write buffers
@@ -165,7 +193,9 @@ void ExecutionSystem::execute()
 		NodeOperation *operation = this->m_operations[index];
 		if (!operation->isWriteBufferOperation()) {
 			operation->setbNodeTree(this->m_context.getbNodeTree());
+			const double start = Profiler::operation_started(operation);
 			operation->initExecution();
+			Profiler::operation_finished(operation, Profiler::PROFILE_INIT, start);
 		}
 	}
 	for (index = 0; index < this->m_groups.size(); index++) {
@@ -173,27 +203,62 @@ void ExecutionSystem::execute()
 		executionGroup->setChunksize(this->m_context.getChunksize());
 		executionGroup->initExecution();
 	}
+	for (index = 0; index < this->m_cacheHits.size(); index++) {
+		this->m_cacheHits[index]->getExecutor()->setExecuted();
+	}
+
+	const double startTime = PIL_check_seconds_timer();
 
 	WorkScheduler::start(this->m_context);
 
-	executeGroups(COM_PRIORITY_HIGH);
-	if (!this->getContext().isFastCalculation()) {
-		executeGroups(COM_PRIORITY_MEDIUM);
-		executeGroups(COM_PRIORITY_LOW);
+	if (fullFrame) {
+		executeFullFrame();
+	}
+	else {
+		executeGroups(COM_PRIORITY_HIGH);
+		if (!this->getContext().isFastCalculation()) {
+			executeGroups(COM_PRIORITY_MEDIUM);
+			executeGroups(COM_PRIORITY_LOW);
+		}
 	}
 
 	WorkScheduler::finish();
 	WorkScheduler::stop();
 
+	storeCachedBuffers(editingtree->test_break && editingtree->test_break(editingtree->tbh));
+
+	if (G.debug & G_DEBUG) {
+		printf("Compositor: %s execution took %.3fs, peak buffer memory %.2fM, %d of %d results cached (%.2fM)\n",
+		       fullFrame ? "full frame" : "tiled",
+		       PIL_check_seconds_timer() - startTime,
+		       (double)this->m_peakBufferMemory / (1024.0 * 1024.0),
+		       (int)this->m_cacheHits.size(), (int)this->m_cacheKeys.size(),
+		       (double)ResultCache::getMemoryUsage() / (1024.0 * 1024.0));
+	}
+
 	editingtree->stats_draw(editingtree->sdh, IFACE_("Compositing | De-initializing execution"));
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
+		const double start = Profiler::operation_started(operation);
 		operation->deinitExecution();
+		Profiler::operation_finished(operation, Profiler::PROFILE_DEINIT, start);
 	}
 	for (index = 0; index < this->m_groups.size(); index++) {
 		ExecutionGroup *executionGroup = this->m_groups[index];
 		executionGroup->deinitExecution();
 	}
+
+	if (Profiler::is_enabled()) {
+		Profiler::execute_finished(this);
+		if (G.debug & G_DEBUG) {
+			Profiler::print_stats();
+		}
+	}
+
+	char buf[128];
+	BLI_snprintf(buf, sizeof(buf), IFACE_("Compositing | Peak buffer memory %.2fM"),
+	             (double)this->m_peakBufferMemory / (1024.0 * 1024.0));
+	editingtree->stats_draw(editingtree->sdh, buf);
 }
 
 void ExecutionSystem::executeGroups(CompositorPriority priority)
@@ -229,3 +294,172 @@ void ExecutionSystem::findOutputExecutionGroup(vector<ExecutionGroup *> *result)
 		}
 	}
 }
+
+void ExecutionSystem::executeFullFrame()
+{
+	const bNodeTree *editingtree = this->m_context.getbNodeTree();
+	vector<ExecutionGroup *> executionGroups;
+	vector<ExecutionGroup *> order;
+	unsigned int index;
+
+	findOutputExecutionGroup(&executionGroups, COM_PRIORITY_HIGH);
+	if (!this->getContext().isFastCalculation()) {
+		findOutputExecutionGroup(&executionGroups, COM_PRIORITY_MEDIUM);
+		findOutputExecutionGroup(&executionGroups, COM_PRIORITY_LOW);
+	}
+	for (index = 0; index < executionGroups.size(); index++) {
+		determineFullFrameOrder(executionGroups[index], &order);
+	}
+
+	/* Propagate the needed areas from the outputs to the inputs. Groups reading
+	 * the output of a group come after it in the order. */
+	for (index = order.size(); index > 0; index--) {
+		order[index - 1]->determineFullFrameDependencies();
+	}
+
+	/* count the groups reading every buffer */
+	std::map<MemoryProxy *, unsigned int> readers;
+	vector<vector<MemoryProxy *> > groupProxies(order.size());
+	for (index = 0; index < order.size(); index++) {
+		vector<MemoryProxy *> &memoryProxies = groupProxies[index];
+		order[index]->determineDependingMemoryProxies(&memoryProxies);
+		std::sort(memoryProxies.begin(), memoryProxies.end());
+		memoryProxies.erase(std::unique(memoryProxies.begin(), memoryProxies.end()), memoryProxies.end());
+		for (unsigned int proxyIndex = 0; proxyIndex < memoryProxies.size(); proxyIndex++) {
+			readers[memoryProxies[proxyIndex]]++;
+		}
+	}
+
+	for (index = 0; index < order.size(); index++) {
+		ExecutionGroup *group = order[index];
+		NodeOperation *outputOperation = group->getOutputOperation();
+		if (outputOperation->isWriteBufferOperation()) {
+			allocateBuffer(((WriteBufferOperation *)outputOperation)->getMemoryProxy());
+		}
+
+		group->executeFullFrame(this);
+
+		/* buffers are recycled as soon as their last reader has been executed */
+		const vector<MemoryProxy *> &memoryProxies = groupProxies[index];
+		for (unsigned int proxyIndex = 0; proxyIndex < memoryProxies.size(); proxyIndex++) {
+			MemoryProxy *memoryProxy = memoryProxies[proxyIndex];
+			if (--readers[memoryProxy] == 0) {
+				releaseBuffer(memoryProxy);
+			}
+		}
+
+		if (editingtree->test_break && editingtree->test_break(editingtree->tbh)) {
+			break;
+		}
+	}
+
+	freeBuffers();
+}
+
+void ExecutionSystem::determineFullFrameOrder(ExecutionGroup *group, vector<ExecutionGroup *> *order) const
+{
+	if (std::find(order->begin(), order->end(), group) != order->end()) {
+		return;
+	}
+	/* the result was found in the ResultCache, nothing to calculate */
+	if (group->isFullyExecuted()) {
+		return;
+	}
+
+	vector<MemoryProxy *> memoryProxies;
+	group->determineDependingMemoryProxies(&memoryProxies);
+	for (unsigned int index = 0; index < memoryProxies.size(); index++) {
+		determineFullFrameOrder(memoryProxies[index]->getExecutor(), order);
+	}
+
+	order->push_back(group);
+}
+
+void ExecutionSystem::allocateBuffer(MemoryProxy *memoryProxy)
+{
+	WriteBufferOperation *writeOperation = memoryProxy->getWriteBufferOperation();
+	const int width = writeOperation->getWidth();
+	const int height = writeOperation->getHeight();
+
+	for (unsigned int index = 0; index < this->m_freeBuffers.size(); index++) {
+		MemoryBuffer *buffer = this->m_freeBuffers[index];
+		if (buffer->getWidth() == width && buffer->getHeight() == height &&
+		    buffer->getDataType() == memoryProxy->getDataType())
+		{
+			this->m_freeBuffers.erase(this->m_freeBuffers.begin() + index);
+			memoryProxy->setBuffer(buffer);
+			return;
+		}
+	}
+
+	/* none of the free buffers fit, don't keep them around while allocating more */
+	freeBuffers();
+
+	memoryProxy->allocate(width, height);
+	this->m_bufferMemory += memoryProxy->getBuffer()->getMemorySize();
+	Profiler::buffer_allocated(writeOperation, memoryProxy->getBuffer()->getMemorySize());
+	this->m_peakBufferMemory = max(this->m_peakBufferMemory, this->m_bufferMemory);
+}
+
+void ExecutionSystem::releaseBuffer(MemoryProxy *memoryProxy)
+{
+	/* keep buffers that go to the ResultCache after execution */
+	if (getCacheKey(memoryProxy) != 0) {
+		return;
+	}
+
+	MemoryBuffer *buffer = memoryProxy->takeBuffer();
+	if (buffer) {
+		this->m_freeBuffers.push_back(buffer);
+	}
+}
+
+void ExecutionSystem::freeBuffers()
+{
+	for (unsigned int index = 0; index < this->m_freeBuffers.size(); index++) {
+		MemoryBuffer *buffer = this->m_freeBuffers[index];
+		this->m_bufferMemory -= buffer->getMemorySize();
+		delete buffer;
+	}
+	this->m_freeBuffers.clear();
+}
+
+ResultCache::Key ExecutionSystem::getCacheKey(MemoryProxy *memoryProxy) const
+{
+	ResultCache::Keys::const_iterator it = this->m_cacheKeys.find(memoryProxy);
+	return (it != this->m_cacheKeys.end()) ? it->second : 0;
+}
+
+bool ExecutionSystem::findCachedBuffer(MemoryProxy *memoryProxy)
+{
+	MemoryBuffer *buffer = ResultCache::find(getCacheKey(memoryProxy), memoryProxy);
+	if (buffer == NULL) {
+		return false;
+	}
+	memoryProxy->setBuffer(buffer);
+	this->m_cacheHits.push_back(memoryProxy);
+	return true;
+}
+
+void ExecutionSystem::storeCachedBuffers(bool canceled)
+{
+	unsigned int index;
+
+	/* buffers found in the cache are still owned by it */
+	for (index = 0; index < this->m_cacheHits.size(); index++) {
+		this->m_cacheHits[index]->takeBuffer();
+	}
+
+	if (canceled) {
+		return;
+	}
+
+	for (ResultCache::Keys::const_iterator it = this->m_cacheKeys.begin(); it != this->m_cacheKeys.end(); ++it) {
+		MemoryProxy *memoryProxy = it->first;
+		if (it->second != 0 && memoryProxy->getBuffer() && memoryProxy->getExecutor()->isFullyExecuted()) {
+			MemoryBuffer *buffer = memoryProxy->takeBuffer();
+			this->m_bufferMemory -= buffer->getMemorySize();
+			ResultCache::store(it->second, buffer);
+		}
+	}
+}
@@ -31,6 +31,7 @@ class ExecutionGroup;
 #include "BKE_text.h"
 #include "COM_ExecutionGroup.h"
 #include "COM_NodeOperation.h"
+#include "COM_ResultCache.h"
 
 /**
  * @page execution Execution model
@@ -105,6 +106,18 @@ class ExecutionGroup;
  * @see ExecutionSystem.addReadWriteBufferOperations
  * @see NodeOperation.isComplex
  * @see ExecutionGroup class representing the ExecutionGroup
+ *
+ * @section EM_FullFrame Full frame execution
+ * By default output ExecutionGroups are calculated chunk by chunk, scheduling the chunks of the
+ * ExecutionGroups they depend on when needed. All MemoryBuffers are allocated for the whole execution.
+ *
+ * When full frame execution is enabled (NTREE_COM_FULL_FRAME) the ExecutionGroups are ordered so every
+ * group comes after the groups it depends on. The area needed of every group is determined up front
+ * and each group calculates that area once. A MemoryBuffer is allocated just before its group is executed
+ * and recycled as soon as the last group reading it has finished.
+ *
+ * @see ExecutionSystem.executeFullFrame
+ * @see ExecutionGroup.executeFullFrame
  */
 
 /**
@@ -131,6 +144,31 @@ private:
 	 */
 	Groups m_groups;
 
+	/**
+	 * @brief MemoryBuffers that are not used anymore and can be recycled by allocateBuffer
+	 */
+	vector<MemoryBuffer *> m_freeBuffers;
+
+	/**
+	 * @brief memory in bytes currently allocated for the MemoryProxy buffers
+	 */
+	size_t m_bufferMemory;
+
+	/**
+	 * @brief maximum memory in bytes allocated for the MemoryProxy buffers during execution
+	 */
+	size_t m_peakBufferMemory;
+
+	/**
+	 * @brief keys of the MemoryProxy's in the ResultCache, empty when the cache is disabled
+	 */
+	ResultCache::Keys m_cacheKeys;
+
+	/**
+	 * @brief MemoryProxy's that use a buffer found in the ResultCache
+	 */
+	vector<MemoryProxy *> m_cacheHits;
+
 private: //methods
 	/**
 	 * find all execution group with output nodes
@@ -142,6 +180,44 @@ private: //methods
 	 */
 	void findOutputExecutionGroup(vector<ExecutionGroup *> *result) const;
 
+	/**
+	 * @brief add an ExecutionGroup to the full frame execution order, after the groups it depends on
+	 */
+	void determineFullFrameOrder(ExecutionGroup *group, vector<ExecutionGroup *> *order) const;
+
+	/**
+	 * @brief allocate the buffer of a MemoryProxy, recycling a free buffer when possible
+	 */
+	void allocateBuffer(MemoryProxy *memoryProxy);
+
+	/**
+	 * @brief detach the buffer from a MemoryProxy and keep it for recycling
+	 */
+	void releaseBuffer(MemoryProxy *memoryProxy);
+
+	/**
+	 * @brief free all buffers kept for recycling
+	 */
+	void freeBuffers();
+
+	/**
+	 * @brief get the ResultCache key of a MemoryProxy, 0 when it is not cached
+	 */
+	ResultCache::Key getCacheKey(MemoryProxy *memoryProxy) const;
+
+	/**
+	 * @brief try to use a cached buffer for a MemoryProxy
+	 * @return true when a buffer was found and the ExecutionGroup writing it can be skipped
+	 */
+	bool findCachedBuffer(MemoryProxy *memoryProxy);
+
+	/**
+	 * @brief hand the completely calculated buffers to the ResultCache
+	 * @note the cached buffers used by this execution are detached from their MemoryProxy
+	 * @param canceled when the execution was canceled, nothing new is stored
+	 */
+	void storeCachedBuffers(bool canceled);
+
 public:
 	/**
 	 * @brief Create a new ExecutionSystem and initialize it with the
@@ -174,11 +250,23 @@ public:
 	 */
 	const CompositorContext &getContext() const { return this->m_context; }
 
+	/**
+	 * @brief get the maximum memory in bytes used by the MemoryBuffers during the last execution
+	 */
+	size_t getPeakBufferMemory() const { return this->m_peakBufferMemory; }
+
 private:
 	void executeGroups(CompositorPriority priority);
 
-	/* allow the DebugInfo class to look at internals */
+	/**
+	 * @brief execute all needed ExecutionGroups once over their whole area
+	 * @see EM_FullFrame
+	 */
+	void executeFullFrame();
+
+	/* allow the DebugInfo and Profiler classes to look at internals */
 	friend class DebugInfo;
+	friend class Profiler;
 
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:ExecutionSystem")
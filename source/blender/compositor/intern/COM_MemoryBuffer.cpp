@@ -21,6 +21,7 @@
  */
 
 #include "COM_MemoryBuffer.h"
+#include "COM_Profiler.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -91,10 +92,12 @@ MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
 	this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
 	this->m_state = COM_MB_TEMPORARILY;
 	this->m_datatype = dataType;
+	Profiler::memory_allocated(getMemorySize());
 }
 MemoryBuffer *MemoryBuffer::duplicate()
 {
 	MemoryBuffer *result = new MemoryBuffer(this->m_memoryProxy, &this->m_rect);
+	Profiler::memory_allocated(result->getMemorySize());
 	memcpy(result->m_buffer, this->m_buffer, this->determineBufferSize() * this->m_num_channels * sizeof(float));
 	return result;
 }
@@ -129,6 +129,22 @@ public:
 
 	unsigned int get_num_channels() { return this->m_num_channels; }
 
+	/**
+	 * @brief size of the data of this MemoryBuffer in bytes
+	 */
+	size_t getMemorySize() const { return sizeof(float) * this->m_width * this->m_height * this->m_num_channels; }
+
+	/**
+	 * @brief get the data type of this MemoryBuffer
+	 */
+	DataType getDataType() const { return this->m_datatype; }
+
+	/**
+	 * @brief set the MemoryProxy this MemoryBuffer belongs to
+	 * @note used when a buffer is recycled for another proxy
+	 */
+	void setMemoryProxy(MemoryProxy *memoryProxy) { this->m_memoryProxy = memoryProxy; }
+
 	/**
 	 * @brief get the data of this MemoryBuffer
 	 * @note buffer should already be available in memory
@@ -227,6 +243,46 @@ public:
 		}
 	}
 
+	/**
+	 * @brief read a row of pixels, pixels outside of the rect are zero
+	 * @param result array to store the pixels, pixels are stride floats apart
+	 * @param x the x-coordinate of the first pixel of the row
+	 * @param y the y-coordinate of the row
+	 * @param length number of pixels to read
+	 * @param stride number of floats between two pixels in result
+	 */
+	inline void readRow(float *result, int x, int y, int length, int stride)
+	{
+		const int num_channels = this->m_num_channels;
+		const size_t pixel_size = sizeof(float) * num_channels;
+		int start = 0, end = 0;
+
+		if (y >= m_rect.ymin && y < m_rect.ymax) {
+			start = min_ii(max_ii(m_rect.xmin - x, 0), length);
+			end = max_ii(min_ii(m_rect.xmax - x, length), start);
+		}
+
+		/* clip result outside rect is zero */
+		for (int i = 0; i < start; i++) {
+			memset(&result[i * stride], 0, pixel_size);
+		}
+		if (start < end) {
+			const int offset = (this->m_width * (y - m_rect.ymin) + x + start - m_rect.xmin) * num_channels;
+			const float *buffer = &this->m_buffer[offset];
+			if (stride == num_channels) {
+				memcpy(&result[start * stride], buffer, pixel_size * (end - start));
+			}
+			else {
+				for (int i = start; i < end; i++, buffer += num_channels) {
+					memcpy(&result[i * stride], buffer, pixel_size);
+				}
+			}
+		}
+		for (int i = end; i < length; i++) {
+			memset(&result[i * stride], 0, pixel_size);
+		}
+	}
+
 	inline void readNoCheck(float *result, int x, int y,
 	                        MemoryBufferExtend extend_x = COM_MB_CLIP,
 	                        MemoryBufferExtend extend_y = COM_MB_CLIP)
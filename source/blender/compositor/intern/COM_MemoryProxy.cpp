@@ -27,6 +27,7 @@ MemoryProxy::MemoryProxy(DataType datatype)
 {
 	this->m_writeBufferOperation = NULL;
 	this->m_executor = NULL;
+	this->m_buffer = NULL;
 	this->m_datatype = datatype;
 }
 
@@ -49,3 +50,16 @@ void MemoryProxy::free()
 	}
 }
 
+void MemoryProxy::setBuffer(MemoryBuffer *buffer)
+{
+	BLI_assert(this->m_buffer == NULL);
+	buffer->setMemoryProxy(this);
+	this->m_buffer = buffer;
+}
+
+MemoryBuffer *MemoryProxy::takeBuffer()
+{
+	MemoryBuffer *buffer = this->m_buffer;
+	this->m_buffer = NULL;
+	return buffer;
+}
@@ -104,6 +104,19 @@ public:
 	 */
 	void free();
 
+	/**
+	 * @brief use already allocated memory for this proxy
+	 * @note the buffer must have the resolution and data type of this proxy
+	 * @see ExecutionSystem.allocateBuffer
+	 */
+	void setBuffer(MemoryBuffer *buffer);
+
+	/**
+	 * @brief detach the allocated memory from this proxy without freeing it
+	 * @see ExecutionSystem.releaseBuffer
+	 */
+	MemoryBuffer *takeBuffer();
+
 	/**
 	 * @brief get the allocated memory
 	 */
@@ -41,6 +41,7 @@ NodeOperation::NodeOperation()
 	this->m_isResolutionSet = false;
 	this->m_openCL = false;
 	this->m_btree = NULL;
+	this->m_settingsHash = 1;
 }
 
 NodeOperation::~NodeOperation()
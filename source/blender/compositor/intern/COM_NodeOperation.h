@@ -31,6 +31,7 @@ extern "C" {
 #include "BLI_math_color.h"
 #include "BLI_math_vector.h"
 #include "BLI_threads.h"
+#include "BLI_sys_types.h"
 }
 
 #include "COM_Node.h"
@@ -125,6 +126,13 @@ private:
 	 * @brief set to truth when resolution for this operation is set
 	 */
 	bool m_isResolutionSet;
+
+	/**
+	 * @brief hash of the settings this operation was created with
+	 * 0 when the result of this operation can not be cached
+	 * @see ResultCache
+	 */
+	uint64_t m_settingsHash;
 	
 public:
 	virtual ~NodeOperation();
@@ -166,6 +174,8 @@ public:
 	virtual int isSingleThreaded() { return false; }
 
 	void setbNodeTree(const bNodeTree *tree) { this->m_btree = tree; }
+	void setSettingsHash(uint64_t hash) { this->m_settingsHash = hash; }
+	uint64_t getSettingsHash() const { return this->m_settingsHash; }
 	virtual void initExecution();
 	
 	/**
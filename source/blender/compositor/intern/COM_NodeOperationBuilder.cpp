@@ -28,6 +28,8 @@ extern "C" {
 #include "COM_Debug.h"
 #include "COM_ExecutionSystem.h"
 #include "COM_Node.h"
+#include "COM_Profiler.h"
+#include "COM_ResultCache.h"
 #include "COM_SocketProxyNode.h"
 
 #include "COM_NodeOperation.h"
@@ -59,6 +61,8 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 	/* interface handle for nodes */
 	NodeConverter converter(this);
 	
+	Profiler::convert_started();
+	
 	for (int index = 0; index < m_graph.nodes().size(); index++) {
 		Node *node = (Node *)m_graph.nodes()[index];
 		
@@ -130,6 +134,12 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 
 void NodeOperationBuilder::addOperation(NodeOperation *operation)
 {
+	if (m_current_node) {
+		operation->setSettingsHash(ResultCache::hashNode(m_current_node->getbNode(), *m_context));
+		if (m_context->isProfiling()) {
+			Profiler::operation_added(operation, m_current_node);
+		}
+	}
 	m_operations.push_back(operation);
 }
 
@@ -325,6 +335,7 @@ void NodeOperationBuilder::add_input_constant_value(NodeOperationInput *input, N
 			
 			SetValueOperation *op = new SetValueOperation();
 			op->setValue(value);
+			op->setSettingsHash(ResultCache::hashData(1, &value, sizeof(value)));
 			addOperation(op);
 			addLink(op->getOutputSocket(), input);
 			break;
@@ -338,6 +349,7 @@ void NodeOperationBuilder::add_input_constant_value(NodeOperationInput *input, N
 			
 			SetColorOperation *op = new SetColorOperation();
 			op->setChannels(value);
+			op->setSettingsHash(ResultCache::hashData(1, value, sizeof(value)));
 			addOperation(op);
 			addLink(op->getOutputSocket(), input);
 			break;
@@ -351,6 +363,7 @@ void NodeOperationBuilder::add_input_constant_value(NodeOperationInput *input, N
 			
 			SetVectorOperation *op = new SetVectorOperation();
 			op->setVector(value);
+			op->setSettingsHash(ResultCache::hashData(1, value, sizeof(value)));
 			addOperation(op);
 			addLink(op->getOutputSocket(), input);
 			break;
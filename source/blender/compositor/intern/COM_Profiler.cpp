@@ -0,0 +1,464 @@
+/*
+ * Copyright 2017, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <typeinfo>
+
+#include "COM_Profiler.h"
+
+#include "COM_ExecutionGroup.h"
+#include "COM_ExecutionSystem.h"
+#include "COM_Node.h"
+#include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
+
+#include "PIL_time.h"
+
+extern "C" {
+#include "BLI_fileops.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_node_types.h"
+#include "DNA_scene_types.h"
+}
+
+bool Profiler::m_enabled = false;
+const bNodeTree *Profiler::m_tree = NULL;
+double Profiler::m_startTime = 0.0;
+double Profiler::m_endTime = 0.0;
+Profiler::OperationNodeMap Profiler::m_operationNodes;
+Profiler::OperationStatsMap Profiler::m_operations;
+Profiler::GroupStatsMap Profiler::m_groups;
+std::vector<Profiler::Event> Profiler::m_events;
+size_t Profiler::m_unattributedMemory = 0;
+
+static ThreadMutex g_profileMutex = BLI_MUTEX_INITIALIZER;
+/* operation measured by this thread, MemoryBuffers allocated are attributed to it */
+static ThreadLocal(const NodeOperation *) g_currentOperation;
+/* thread number used for the trace events, stored as pointer */
+static ThreadLocal(void *) g_currentThread;
+
+static const char *profile_phase_names[PROFILE_PHASE_TOT] = {"init", "tile_data", "deinit"};
+
+/* class name without the compiler specific decoration */
+static std::string operation_class_name(const NodeOperation *operation)
+{
+	const char *name = typeid(*operation).name();
+	if (strncmp(name, "class ", 6) == 0) {
+		name += 6;
+	}
+	while (*name >= '0' && *name <= '9') {
+		name++;
+	}
+	return std::string(name);
+}
+
+void Profiler::convert_started()
+{
+	m_operationNodes.clear();
+}
+
+void Profiler::operation_added(const NodeOperation *operation, const Node *node)
+{
+	if (node->getbNode()) {
+		m_operationNodes[operation] = std::string(node->getbNode()->name);
+	}
+}
+
+/* The editor executes a localized copy of the scene's tree, profiles are
+ * attributed to the original tree so they can be written from it. Localized
+ * nodes point back to their original with new_node. */
+static const bNodeTree *profiled_tree(const CompositorContext &context)
+{
+	const bNodeTree *tree = context.getbNodeTree();
+
+	if (tree && (tree->flag & NTREE_IS_LOCALIZED)) {
+		const Scene *scene = context.getScene();
+		const bNode *node = (const bNode *)tree->nodes.first;
+
+		if (scene && scene->nodetree && node && node->new_node == scene->nodetree->nodes.first) {
+			return scene->nodetree;
+		}
+	}
+	return tree;
+}
+
+void Profiler::execute_started(const ExecutionSystem *system)
+{
+	const CompositorContext &context = system->getContext();
+
+	m_operations.clear();
+	m_groups.clear();
+	m_events.clear();
+	m_unattributedMemory = 0;
+	m_tree = NULL;
+
+	m_enabled = context.isProfiling();
+	if (!m_enabled) {
+		m_operationNodes.clear();
+		return;
+	}
+
+	BLI_thread_local_create(g_currentOperation);
+	BLI_thread_local_create(g_currentThread);
+
+	m_tree = profiled_tree(context);
+
+	for (unsigned int index = 0; index < system->m_operations.size(); index++) {
+		const NodeOperation *operation = system->m_operations[index];
+		OperationStats &stats = m_operations[operation];
+
+		stats.index = index;
+		stats.name = operation_class_name(operation);
+		stats.tileDataCount = 0;
+		stats.memory = 0;
+		for (int phase = 0; phase < PROFILE_PHASE_TOT; phase++) {
+			stats.time[phase] = 0.0;
+		}
+
+		/* buffer operations are added after conversion, name them after the operation they buffer */
+		const NodeOperation *nodeOperation = operation;
+		if (operation->isReadBufferOperation()) {
+			nodeOperation = ((ReadBufferOperation *)operation)->getMemoryProxy()->getWriteBufferOperation();
+		}
+		if (nodeOperation->isWriteBufferOperation() && nodeOperation->getNumberOfInputSockets() > 0) {
+			NodeOperationOutput *link = nodeOperation->getInputSocket(0)->getLink();
+			if (link) {
+				nodeOperation = &link->getOperation();
+			}
+		}
+		OperationNodeMap::const_iterator it = m_operationNodes.find(nodeOperation);
+		if (it != m_operationNodes.end()) {
+			stats.node = it->second;
+		}
+	}
+
+	for (unsigned int index = 0; index < system->m_groups.size(); index++) {
+		const ExecutionGroup *group = system->m_groups[index];
+		const NodeOperation *output = group->getOutputOperation();
+		GroupStats &stats = m_groups[group];
+
+		stats.index = index;
+		stats.name = m_operations[output].name;
+		stats.node = m_operations[output].node;
+		stats.operations = group->m_operations.size();
+		stats.chunks = 0;
+		stats.areasOfInterest = 0;
+		stats.time = 0.0;
+		stats.minTime = 0.0;
+		stats.maxTime = 0.0;
+	}
+
+	m_startTime = PIL_check_seconds_timer();
+	m_endTime = m_startTime;
+}
+
+void Profiler::execute_finished(const ExecutionSystem * /*system*/)
+{
+	if (!m_enabled) {
+		return;
+	}
+
+	m_endTime = PIL_check_seconds_timer();
+	m_enabled = false;
+	m_operationNodes.clear();
+
+	BLI_thread_local_delete(g_currentOperation);
+	BLI_thread_local_delete(g_currentThread);
+}
+
+Profiler::OperationStats *Profiler::operation_stats(const NodeOperation *operation)
+{
+	OperationStatsMap::iterator it = m_operations.find(operation);
+	return (it != m_operations.end()) ? &it->second : NULL;
+}
+
+void Profiler::add_event(const void *object, const char *category, int thread, int chunkNumber, double start, double end)
+{
+	Event event;
+	event.object = object;
+	event.category = category;
+	event.thread = thread;
+	event.chunkNumber = chunkNumber;
+	event.start = start;
+	event.end = end;
+	m_events.push_back(event);
+}
+
+double Profiler::operation_started(const NodeOperation *operation)
+{
+	if (!m_enabled) {
+		return 0.0;
+	}
+	BLI_thread_local_set(g_currentOperation, operation);
+	return PIL_check_seconds_timer();
+}
+
+void Profiler::operation_finished(const NodeOperation *operation, ProfilePhase phase, double start)
+{
+	if (!m_enabled) {
+		return;
+	}
+	const double end = PIL_check_seconds_timer();
+	const int thread = GET_INT_FROM_POINTER(BLI_thread_local_get(g_currentThread));
+	BLI_thread_local_set(g_currentOperation, NULL);
+
+	BLI_mutex_lock(&g_profileMutex);
+	OperationStats *stats = operation_stats(operation);
+	if (stats) {
+		stats->time[phase] += end - start;
+		if (phase == PROFILE_TILE_DATA) {
+			stats->tileDataCount++;
+		}
+		add_event(operation, profile_phase_names[phase], thread, -1, start, end);
+	}
+	BLI_mutex_unlock(&g_profileMutex);
+}
+
+double Profiler::chunk_started(int thread)
+{
+	if (!m_enabled) {
+		return 0.0;
+	}
+	BLI_thread_local_set(g_currentThread, SET_INT_IN_POINTER(thread));
+	return PIL_check_seconds_timer();
+}
+
+void Profiler::chunk_finished(const ExecutionGroup *group, unsigned int chunkNumber, double start)
+{
+	if (!m_enabled) {
+		return;
+	}
+	const double end = PIL_check_seconds_timer();
+	const double time = end - start;
+	const int thread = GET_INT_FROM_POINTER(BLI_thread_local_get(g_currentThread));
+
+	BLI_mutex_lock(&g_profileMutex);
+	GroupStatsMap::iterator it = m_groups.find(group);
+	if (it != m_groups.end()) {
+		GroupStats &stats = it->second;
+		stats.minTime = (stats.chunks == 0) ? time : min(stats.minTime, time);
+		stats.maxTime = max(stats.maxTime, time);
+		stats.time += time;
+		stats.chunks++;
+		add_event(group, "chunk", thread, chunkNumber, start, end);
+	}
+	BLI_mutex_unlock(&g_profileMutex);
+}
+
+void Profiler::area_of_interest_determined(const ExecutionGroup *group)
+{
+	if (!m_enabled) {
+		return;
+	}
+	BLI_mutex_lock(&g_profileMutex);
+	GroupStatsMap::iterator it = m_groups.find(group);
+	if (it != m_groups.end()) {
+		it->second.areasOfInterest++;
+	}
+	BLI_mutex_unlock(&g_profileMutex);
+}
+
+void Profiler::buffer_allocated(const NodeOperation *operation, size_t size)
+{
+	if (!m_enabled) {
+		return;
+	}
+	BLI_mutex_lock(&g_profileMutex);
+	OperationStats *stats = operation_stats(operation);
+	if (stats) {
+		stats->memory += size;
+	}
+	else {
+		m_unattributedMemory += size;
+	}
+	BLI_mutex_unlock(&g_profileMutex);
+}
+
+void Profiler::memory_allocated(size_t size)
+{
+	if (!m_enabled) {
+		return;
+	}
+	buffer_allocated((const NodeOperation *)BLI_thread_local_get(g_currentOperation), size);
+}
+
+/* ******** Output ******** */
+
+static bool group_stats_slower(const Profiler::GroupStats *a, const Profiler::GroupStats *b)
+{
+	return a->time > b->time;
+}
+
+static double operation_stats_time(const Profiler::OperationStats *stats)
+{
+	double time = 0.0;
+	for (int phase = 0; phase < PROFILE_PHASE_TOT; phase++) {
+		time += stats->time[phase];
+	}
+	return time;
+}
+
+static bool operation_stats_slower(const Profiler::OperationStats *a, const Profiler::OperationStats *b)
+{
+	return operation_stats_time(a) > operation_stats_time(b);
+}
+
+void Profiler::print_stats()
+{
+	std::vector<const GroupStats *> groups;
+	std::vector<const OperationStats *> operations;
+
+	for (GroupStatsMap::const_iterator it = m_groups.begin(); it != m_groups.end(); ++it) {
+		if (it->second.chunks > 0) {
+			groups.push_back(&it->second);
+		}
+	}
+	for (OperationStatsMap::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+		operations.push_back(&it->second);
+	}
+	std::sort(groups.begin(), groups.end(), group_stats_slower);
+	std::sort(operations.begin(), operations.end(), operation_stats_slower);
+
+	printf("Compositor profile: %.3fs\n", m_endTime - m_startTime);
+	printf("  %-6s %-32s %-24s %8s %10s %10s %10s %6s\n",
+	       "group", "output", "node", "chunks", "total", "min", "max", "areas");
+	for (unsigned int index = 0; index < groups.size(); index++) {
+		const GroupStats *stats = groups[index];
+		printf("  %-6d %-32s %-24s %8u %9.3fs %9.3fs %9.3fs %6u\n",
+		       stats->index, stats->name.c_str(), stats->node.c_str(), stats->chunks,
+		       stats->time, stats->minTime, stats->maxTime, stats->areasOfInterest);
+	}
+
+	printf("  %-6s %-32s %-24s %8s %10s %10s %10s %9s\n",
+	       "op", "operation", "node", "tiles", "init", "tile data", "deinit", "memory");
+	for (unsigned int index = 0; index < operations.size() && index < 10; index++) {
+		const OperationStats *stats = operations[index];
+		printf("  %-6d %-32s %-24s %8u %9.3fs %9.3fs %9.3fs %8.2fM\n",
+		       stats->index, stats->name.c_str(), stats->node.c_str(), stats->tileDataCount,
+		       stats->time[PROFILE_INIT], stats->time[PROFILE_TILE_DATA], stats->time[PROFILE_DEINIT],
+		       (double)stats->memory / (1024.0 * 1024.0));
+	}
+}
+
+static void json_string(FILE *file, const std::string &str)
+{
+	fputc('"', file);
+	for (unsigned int index = 0; index < str.size(); index++) {
+		const unsigned char c = str[index];
+		if (c == '"' || c == '\\') {
+			fprintf(file, "\\%c", c);
+		}
+		else if (c < 0x20) {
+			fprintf(file, "\\u%04x", c);
+		}
+		else {
+			fputc(c, file);
+		}
+	}
+	fputc('"', file);
+}
+
+static std::string event_name(const std::string &name, const std::string &node)
+{
+	return node.empty() ? name : name + " (" + node + ")";
+}
+
+bool Profiler::write_trace(const bNodeTree *tree, const char *filepath)
+{
+	if (tree == NULL || tree != m_tree || m_enabled) {
+		return false;
+	}
+
+	FILE *file = BLI_fopen(filepath, "w");
+	if (file == NULL) {
+		return false;
+	}
+
+	/* trace event timestamps are in microseconds */
+	fprintf(file, "{\n\"displayTimeUnit\": \"ms\",\n\"traceEvents\": [\n");
+	fprintf(file, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"main\"}}");
+	for (unsigned int index = 0; index < m_events.size(); index++) {
+		const Event &event = m_events[index];
+		std::string name;
+		if (event.chunkNumber >= 0) {
+			const GroupStats &stats = m_groups[(const ExecutionGroup *)event.object];
+			char prefix[32];
+			BLI_snprintf(prefix, sizeof(prefix), "Group %d: ", stats.index);
+			name = prefix + event_name(stats.name, stats.node);
+		}
+		else {
+			const OperationStats &stats = m_operations[(const NodeOperation *)event.object];
+			name = event_name(stats.name, stats.node);
+		}
+
+		fprintf(file, ",\n{\"name\": ");
+		json_string(file, name);
+		fprintf(file, ", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f",
+		        event.category, event.thread,
+		        (event.start - m_startTime) * 1e6, (event.end - event.start) * 1e6);
+		if (event.chunkNumber >= 0) {
+			fprintf(file, ", \"args\": {\"chunk\": %d}", event.chunkNumber);
+		}
+		fprintf(file, "}");
+	}
+	fprintf(file, "\n],\n");
+
+	fprintf(file, "\"total_time\": %f,\n", m_endTime - m_startTime);
+	fprintf(file, "\"unattributed_memory\": %lu,\n", (unsigned long)m_unattributedMemory);
+
+	fprintf(file, "\"groups\": [");
+	bool first = true;
+	for (GroupStatsMap::const_iterator it = m_groups.begin(); it != m_groups.end(); ++it) {
+		const GroupStats &stats = it->second;
+		fprintf(file, "%s\n{\"index\": %d, \"name\": ", first ? "" : ",", stats.index);
+		json_string(file, stats.name);
+		fprintf(file, ", \"node\": ");
+		json_string(file, stats.node);
+		fprintf(file, ", \"operations\": %u, \"chunks\": %u, \"areas_of_interest\": %u, "
+		        "\"time\": %f, \"min_chunk_time\": %f, \"max_chunk_time\": %f}",
+		        stats.operations, stats.chunks, stats.areasOfInterest,
+		        stats.time, stats.minTime, stats.maxTime);
+		first = false;
+	}
+	fprintf(file, "\n],\n");
+
+	fprintf(file, "\"operations\": [");
+	first = true;
+	for (OperationStatsMap::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+		const OperationStats &stats = it->second;
+		fprintf(file, "%s\n{\"index\": %d, \"name\": ", first ? "" : ",", stats.index);
+		json_string(file, stats.name);
+		fprintf(file, ", \"node\": ");
+		json_string(file, stats.node);
+		fprintf(file, ", \"init_time\": %f, \"tile_data_time\": %f, \"deinit_time\": %f, "
+		        "\"tile_data_count\": %u, \"memory\": %lu}",
+		        stats.time[PROFILE_INIT], stats.time[PROFILE_TILE_DATA], stats.time[PROFILE_DEINIT],
+		        stats.tileDataCount, (unsigned long)stats.memory);
+		first = false;
+	}
+	fprintf(file, "\n]\n}\n");
+
+	const bool ok = (ferror(file) == 0);
+	fclose(file);
+	return ok;
+}
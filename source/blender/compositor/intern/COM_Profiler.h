@@ -0,0 +1,164 @@
+/*
+ * Copyright 2017, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_Profiler_h
+#define _COM_Profiler_h
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "COM_defines.h"
+
+extern "C" {
+#include "BLI_sys_types.h"
+}
+
+class Node;
+class NodeOperation;
+class ExecutionSystem;
+class ExecutionGroup;
+struct bNodeTree;
+
+/**
+ * @brief timing and memory statistics of the operations and groups of one execution
+ * @ingroup Execution
+ *
+ * Enabled per tree with NTREE_COM_PROFILE. The statistics of the last profiled execution are
+ * kept until the next one starts, they can be printed and written as a trace event file
+ * (chrome://tracing) with extra sections for the totals of every operation and group.
+ *
+ * Operations pull their pixels from their inputs, so the time spent calculating a chunk can
+ * only be measured per ExecutionGroup. Per operation the time of initExecution, deinitExecution
+ * and initializeTileData is measured, the last one being where complex operations do their work.
+ *
+ * @note only used from COM_execute, which is serialized by the compositor mutex. Chunks and
+ * tile data are recorded from the worker threads.
+ */
+class Profiler {
+public:
+	typedef enum ProfilePhase {
+		PROFILE_INIT = 0,
+		PROFILE_TILE_DATA = 1,
+		PROFILE_DEINIT = 2,
+	} ProfilePhase;
+#define PROFILE_PHASE_TOT 3
+
+	typedef struct OperationStats {
+		int index;                          /**< index of the operation in the ExecutionSystem */
+		std::string name;                   /**< class name of the operation */
+		std::string node;                   /**< name of the node the operation was created for */
+		double time[PROFILE_PHASE_TOT];     /**< seconds spent in every phase */
+		unsigned int tileDataCount;         /**< number of initializeTileData calls */
+		size_t memory;                      /**< bytes of MemoryBuffers allocated */
+	} OperationStats;
+
+	typedef struct GroupStats {
+		int index;                          /**< index of the group in the ExecutionSystem */
+		std::string name;                   /**< name of the output operation */
+		std::string node;
+		unsigned int operations;            /**< number of operations in the group */
+		unsigned int chunks;                /**< chunks calculated */
+		unsigned int areasOfInterest;       /**< number of depending areas of interest determined */
+		double time;                        /**< seconds spent calculating chunks */
+		double minTime, maxTime;            /**< fastest and slowest chunk */
+	} GroupStats;
+
+	typedef struct Event {
+		const void *object;                 /**< NodeOperation or ExecutionGroup */
+		const char *category;
+		int thread;
+		int chunkNumber;
+		double start, end;
+	} Event;
+
+	typedef std::map<const NodeOperation *, OperationStats> OperationStatsMap;
+	typedef std::map<const ExecutionGroup *, GroupStats> GroupStatsMap;
+	typedef std::map<const NodeOperation *, std::string> OperationNodeMap;
+
+private:
+	static bool m_enabled;
+	static const bNodeTree *m_tree;         /**< original tree of the profiled execution, only used for comparing */
+	static double m_startTime;
+	static double m_endTime;
+	static OperationNodeMap m_operationNodes;
+	static OperationStatsMap m_operations;
+	static GroupStatsMap m_groups;
+	static std::vector<Event> m_events;
+	static size_t m_unattributedMemory;     /**< bytes allocated outside any measured phase */
+
+	static OperationStats *operation_stats(const NodeOperation *operation);
+	static void add_event(const void *object, const char *category, int thread, int chunkNumber, double start, double end);
+
+public:
+	/**
+	 * @brief true while an execution is being profiled
+	 */
+	static bool is_enabled() { return m_enabled; }
+
+	static void convert_started();
+
+	/**
+	 * @brief remember the node an operation was created for
+	 * @note only called when profiling, see CompositorContext.isProfiling
+	 */
+	static void operation_added(const NodeOperation *operation, const Node *node);
+
+	static void execute_started(const ExecutionSystem *system);
+	static void execute_finished(const ExecutionSystem *system);
+
+	/**
+	 * @brief start measuring a phase of an operation
+	 * @note MemoryBuffers allocated by this thread until operation_finished are attributed to the operation
+	 * @return start time, pass it to operation_finished
+	 */
+	static double operation_started(const NodeOperation *operation);
+	static void operation_finished(const NodeOperation *operation, ProfilePhase phase, double start);
+
+	/**
+	 * @brief start measuring the calculation of a chunk
+	 * @param thread 0 for the main thread, worker threads start at 1
+	 * @return start time, pass it to chunk_finished
+	 */
+	static double chunk_started(int thread);
+	static void chunk_finished(const ExecutionGroup *group, unsigned int chunkNumber, double start);
+	static void area_of_interest_determined(const ExecutionGroup *group);
+
+	/**
+	 * @brief register a MemoryProxy buffer allocated for a WriteBufferOperation
+	 */
+	static void buffer_allocated(const NodeOperation *operation, size_t size);
+
+	/**
+	 * @brief register a MemoryBuffer allocated by the operation running on this thread
+	 */
+	static void memory_allocated(size_t size);
+
+	/**
+	 * @brief print the totals per group and the slowest operations to stdout
+	 */
+	static void print_stats();
+
+	/**
+	 * @brief write the last profiled execution of tree as trace event JSON file
+	 * @return false when tree was not profiled or the file could not be written
+	 */
+	static bool write_trace(const bNodeTree *tree, const char *filepath);
+};
+
+#endif
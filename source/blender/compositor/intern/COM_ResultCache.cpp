@@ -0,0 +1,371 @@
+/*
+ * Copyright 2017, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+#include <typeinfo>
+
+#include "COM_ResultCache.h"
+#include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "atomic_ops.h"
+
+extern "C" {
+#  include "DNA_camera_types.h"
+#  include "DNA_color_types.h"
+#  include "DNA_genfile.h"
+#  include "DNA_node_types.h"
+#  include "DNA_object_types.h"
+#  include "DNA_scene_types.h"
+#  include "DNA_sdna_types.h"
+#  include "BKE_image.h"
+#  include "BKE_node.h"
+}
+
+/* FNV-1a */
+#define HASH_INIT 14695981039346656037ULL
+#define HASH_PRIME 1099511628211ULL
+
+typedef struct ResultCacheEntry {
+	MemoryBuffer *buffer;
+	/* number of the last execution that used this entry */
+	unsigned int lastUsed;
+} ResultCacheEntry;
+
+typedef std::map<ResultCache::Key, ResultCacheEntry> ResultCacheEntries;
+typedef std::map<NodeOperation *, ResultCache::Key> OperationKeys;
+
+static ResultCacheEntries g_entries;
+static size_t g_memoryUsage = 0;
+static size_t g_budget = 0;
+static unsigned int g_execution = 0;
+static unsigned int g_renderGeneration = 0;
+
+ResultCache::Key ResultCache::hashData(Key hash, const void *data, size_t size)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	for (size_t index = 0; index < size; index++) {
+		hash ^= bytes[index];
+		hash *= HASH_PRIME;
+	}
+	return hash;
+}
+
+static ResultCache::Key hash_camera(ResultCache::Key hash, const Object *camob)
+{
+	hash = ResultCache::hashData(hash, &camob, sizeof(camob));
+	if (camob && camob->type == OB_CAMERA) {
+		const Camera *camera = (const Camera *)camob->data;
+		hash = ResultCache::hashData(hash, camob->obmat, sizeof(camob->obmat));
+		hash = ResultCache::hashData(hash, &camera->lens, sizeof(camera->lens));
+		hash = ResultCache::hashData(hash, &camera->sensor_x, sizeof(camera->sensor_x));
+		hash = ResultCache::hashData(hash, &camera->sensor_y, sizeof(camera->sensor_y));
+		hash = ResultCache::hashData(hash, &camera->sensor_fit, sizeof(camera->sensor_fit));
+		hash = ResultCache::hashData(hash, &camera->YF_dofdist, sizeof(camera->YF_dofdist));
+		hash = ResultCache::hashData(hash, &camera->dof_ob, sizeof(camera->dof_ob));
+		if (camera->dof_ob) {
+			hash = ResultCache::hashData(hash, camera->dof_ob->obmat, sizeof(camera->dof_ob->obmat));
+		}
+	}
+	return hash;
+}
+
+/* Node storage is duplicated when the tree is localized for execution, so
+ * pointers to data owned by the storage change on every execution and can't be
+ * part of the hash. References to IDs are kept and can be hashed like node->id. */
+static bool dna_struct_is_hashable(const SDNA *sdna, const int struct_nr)
+{
+	const short *sp = sdna->structs[struct_nr];
+	const int members_len = sp[1];
+
+	sp += 2;
+	for (int index = 0; index < members_len; index++, sp += 2) {
+		const char *type = sdna->types[sp[0]];
+		const char *name = sdna->names[sp[1]];
+		const int member_struct_nr = DNA_struct_find_nr(sdna, type);
+
+		if (name[0] == '*' || name[0] == '(') {
+			/* Only single pointers to IDs, the first member of an ID type is the ID itself. */
+			if (name[1] == '*' || name[0] == '(' || member_struct_nr == -1 ||
+			    !STREQ(sdna->types[sdna->structs[member_struct_nr][2]], "ID"))
+			{
+				return false;
+			}
+		}
+		else if (member_struct_nr != -1 && !dna_struct_is_hashable(sdna, member_struct_nr)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static ResultCache::Key hash_curve_mapping(ResultCache::Key hash, const CurveMapping *cumap)
+{
+	/* cur, changed_timestamp and sample are only used for drawing. */
+	hash = ResultCache::hashData(hash, &cumap->flag, sizeof(cumap->flag));
+	hash = ResultCache::hashData(hash, &cumap->preset, sizeof(cumap->preset));
+	hash = ResultCache::hashData(hash, &cumap->curr, sizeof(cumap->curr));
+	hash = ResultCache::hashData(hash, &cumap->clipr, sizeof(cumap->clipr));
+	for (int index = 0; index < CM_TOT; index++) {
+		const CurveMap *cuma = &cumap->cm[index];
+		hash = ResultCache::hashData(hash, &cuma->totpoint, sizeof(cuma->totpoint));
+		hash = ResultCache::hashData(hash, &cuma->flag, sizeof(cuma->flag));
+		hash = ResultCache::hashData(hash, cuma->ext_in, sizeof(cuma->ext_in));
+		hash = ResultCache::hashData(hash, cuma->ext_out, sizeof(cuma->ext_out));
+		if (cuma->curve) {
+			hash = ResultCache::hashData(hash, cuma->curve, sizeof(*cuma->curve) * cuma->totpoint);
+		}
+	}
+	hash = ResultCache::hashData(hash, cumap->black, sizeof(cumap->black));
+	hash = ResultCache::hashData(hash, cumap->white, sizeof(cumap->white));
+	return hash;
+}
+
+/* Hash the node storage by content, returns 0 when it can't be hashed. */
+static ResultCache::Key hash_node_storage(ResultCache::Key hash, const bNode *node)
+{
+	const char *storagename = node->typeinfo->storagename;
+
+	if (STREQ(storagename, "CurveMapping")) {
+		return hash_curve_mapping(hash, (const CurveMapping *)node->storage);
+	}
+
+	const SDNA *sdna = DNA_sdna_current_get();
+	const int struct_nr = (sdna && storagename[0]) ? DNA_struct_find_nr(sdna, storagename) : -1;
+	if (struct_nr == -1 || !dna_struct_is_hashable(sdna, struct_nr)) {
+		return 0;
+	}
+	return ResultCache::hashData(hash, node->storage, MEM_allocN_len(node->storage));
+}
+
+ResultCache::Key ResultCache::hashNode(const bNode *node, const CompositorContext &context)
+{
+	bool usesRenderResult = false;
+	if (node->id) {
+		switch (GS(node->id->name)) {
+			case ID_IM:  /* pixels of images are assumed unchanged, see class description */
+			{
+				const Image *image = (const Image *)node->id;
+				if (image->type == IMA_TYPE_COMPOSITE) {
+					/* the viewer image is written by the compositor itself */
+					return 0;
+				}
+				usesRenderResult = (image->type == IMA_TYPE_R_RESULT);
+				break;
+			}
+			case ID_SCE: /* render layers and the camera of the defocus node */
+				usesRenderResult = (node->type == CMP_NODE_R_LAYERS);
+				break;
+			case ID_NT:  /* group nodes, the nodes inside are hashed separately */
+				break;
+			default:
+				return 0;
+		}
+	}
+
+	Key hash = HASH_INIT;
+	hash = hashData(hash, &node->type, sizeof(node->type));
+	hash = hashData(hash, &node->custom1, sizeof(node->custom1));
+	hash = hashData(hash, &node->custom2, sizeof(node->custom2));
+	hash = hashData(hash, &node->custom3, sizeof(node->custom3));
+	hash = hashData(hash, &node->custom4, sizeof(node->custom4));
+	hash = hashData(hash, &node->id, sizeof(node->id));
+	if (node->storage) {
+		hash = hash_node_storage(hash, node);
+		if (hash == 0) {
+			return 0;
+		}
+	}
+	/* value and RGB nodes store their value in the output */
+	const ListBase *sockets[2] = {&node->inputs, &node->outputs};
+	for (int index = 0; index < 2; index++) {
+		for (const bNodeSocket *sock = (const bNodeSocket *)sockets[index]->first; sock; sock = sock->next) {
+			if (sock->default_value) {
+				hash = hashData(hash, sock->default_value, MEM_allocN_len(sock->default_value));
+			}
+		}
+	}
+	if (usesRenderResult) {
+		const unsigned int renderGeneration = atomic_add_and_fetch_u(&g_renderGeneration, 0);
+		hash = hashData(hash, &renderGeneration, sizeof(renderGeneration));
+	}
+
+	if (node->type == CMP_NODE_DEFOCUS) {
+		const Scene *scene = node->id ? (const Scene *)node->id : context.getScene();
+		hash = hash_camera(hash, scene ? scene->camera : NULL);
+	}
+
+	return (hash != 0) ? hash : 1;
+}
+
+static ResultCache::Key hash_context(const CompositorContext &context)
+{
+	const Scene *scene = context.getScene();
+	const RenderData *rd = context.getRenderData();
+	const int framenumber = context.getFramenumber();
+	const CompositorQuality quality = context.getQuality();
+	const bool fastCalculation = context.isFastCalculation();
+
+	ResultCache::Key hash = HASH_INIT;
+	hash = ResultCache::hashData(hash, &scene, sizeof(scene));
+	hash = ResultCache::hashData(hash, &framenumber, sizeof(framenumber));
+	hash = ResultCache::hashData(hash, &quality, sizeof(quality));
+	hash = ResultCache::hashData(hash, &fastCalculation, sizeof(fastCalculation));
+	if (rd) {
+		hash = ResultCache::hashData(hash, &rd->subframe, sizeof(rd->subframe));
+		hash = ResultCache::hashData(hash, &rd->xsch, sizeof(rd->xsch));
+		hash = ResultCache::hashData(hash, &rd->ysch, sizeof(rd->ysch));
+		hash = ResultCache::hashData(hash, &rd->size, sizeof(rd->size));
+	}
+	if (context.getViewName()) {
+		hash = ResultCache::hashData(hash, context.getViewName(), strlen(context.getViewName()));
+	}
+	return hash;
+}
+
+static ResultCache::Key operation_key(NodeOperation *operation, ResultCache::Key contextHash, OperationKeys &keys)
+{
+	OperationKeys::const_iterator it = keys.find(operation);
+	if (it != keys.end()) {
+		return it->second;
+	}
+
+	ResultCache::Key key = 0;
+	if (operation->getSettingsHash() != 0) {
+		const char *name = typeid(*operation).name();
+		const ResultCache::Key settingsHash = operation->getSettingsHash();
+		const unsigned int width = operation->getWidth();
+		const unsigned int height = operation->getHeight();
+
+		key = ResultCache::hashData(contextHash, name, strlen(name));
+		key = ResultCache::hashData(key, &settingsHash, sizeof(settingsHash));
+		key = ResultCache::hashData(key, &width, sizeof(width));
+		key = ResultCache::hashData(key, &height, sizeof(height));
+
+		if (operation->isReadBufferOperation()) {
+			MemoryProxy *memoryProxy = ((ReadBufferOperation *)operation)->getMemoryProxy();
+			const ResultCache::Key inputKey = operation_key(memoryProxy->getWriteBufferOperation(), contextHash, keys);
+			key = (inputKey != 0) ? ResultCache::hashData(key, &inputKey, sizeof(inputKey)) : 0;
+		}
+
+		for (unsigned int index = 0; index < operation->getNumberOfInputSockets() && key != 0; index++) {
+			NodeOperationOutput *link = operation->getInputSocket(index)->getLink();
+			const ResultCache::Key inputKey = link ? operation_key(&link->getOperation(), contextHash, keys) : 1;
+			key = (inputKey != 0) ? ResultCache::hashData(key, &inputKey, sizeof(inputKey)) : 0;
+		}
+	}
+
+	keys[operation] = key;
+	return key;
+}
+
+void ResultCache::determineKeys(const CompositorContext &context, const std::vector<NodeOperation *> &operations, Keys *keys)
+{
+	const Key contextHash = hash_context(context);
+	OperationKeys operationKeys;
+
+	for (unsigned int index = 0; index < operations.size(); index++) {
+		NodeOperation *operation = operations[index];
+		if (operation->isWriteBufferOperation()) {
+			WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+			(*keys)[writeOperation->getMemoryProxy()] = operation_key(operation, contextHash, operationKeys);
+		}
+	}
+}
+
+static void result_cache_evict(size_t budget)
+{
+	while (g_memoryUsage > budget && !g_entries.empty()) {
+		ResultCacheEntries::iterator oldest = g_entries.begin();
+		for (ResultCacheEntries::iterator it = g_entries.begin(); it != g_entries.end(); ++it) {
+			if (it->second.lastUsed < oldest->second.lastUsed) {
+				oldest = it;
+			}
+		}
+		g_memoryUsage -= oldest->second.buffer->getMemorySize();
+		delete oldest->second.buffer;
+		g_entries.erase(oldest);
+	}
+}
+
+void ResultCache::beginExecution(size_t budget)
+{
+	g_execution++;
+	g_budget = budget;
+	result_cache_evict(g_budget);
+}
+
+MemoryBuffer *ResultCache::find(Key key, MemoryProxy *memoryProxy)
+{
+	if (key == 0) {
+		return NULL;
+	}
+
+	ResultCacheEntries::iterator it = g_entries.find(key);
+	if (it == g_entries.end()) {
+		return NULL;
+	}
+
+	MemoryBuffer *buffer = it->second.buffer;
+	const WriteBufferOperation *writeOperation = memoryProxy->getWriteBufferOperation();
+	if (buffer->getWidth() != (int)writeOperation->getWidth() ||
+	    buffer->getHeight() != (int)writeOperation->getHeight() ||
+	    buffer->getDataType() != memoryProxy->getDataType())
+	{
+		return NULL;
+	}
+
+	it->second.lastUsed = g_execution;
+	return buffer;
+}
+
+void ResultCache::store(Key key, MemoryBuffer *buffer)
+{
+	BLI_assert(key != 0);
+
+	if (g_entries.find(key) != g_entries.end()) {
+		/* same result calculated twice in one execution */
+		delete buffer;
+		return;
+	}
+
+	ResultCacheEntry entry;
+	entry.buffer = buffer;
+	entry.lastUsed = g_execution;
+	g_entries[key] = entry;
+	g_memoryUsage += buffer->getMemorySize();
+
+	result_cache_evict(g_budget);
+}
+
+void ResultCache::clear()
+{
+	result_cache_evict(0);
+}
+
+void ResultCache::renderResultsChanged()
+{
+	atomic_add_and_fetch_u(&g_renderGeneration, 1);
+}
+
+size_t ResultCache::getMemoryUsage()
+{
+	return g_memoryUsage;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2017, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_ResultCache_h_
+#define _COM_ResultCache_h_
+
+#include <map>
+#include <vector>
+
+#include "COM_CompositorContext.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_MemoryProxy.h"
+#include "COM_NodeOperation.h"
+
+extern "C" {
+#  include "BLI_sys_types.h"
+}
+
+struct bNode;
+
+/**
+ * @brief cache of MemoryBuffers between executions of the compositor
+ * @ingroup Memory
+ *
+ * Every MemoryProxy gets a key, a hash of the settings of all operations that are used to calculate
+ * its buffer and of the CompositorContext. When the tree is executed again and the key of a MemoryProxy
+ * is found in the cache, the stored buffer is used and the ExecutionGroup writing the MemoryProxy is
+ * not executed, neither are the groups only it depends on.
+ *
+ * The settings of an operation are hashed from the bNode it was created for, see hashNode.
+ * Nodes using data that can change without the node changing (movie clips, masks, textures, the viewer
+ * image) are never cached. Changes to the pixels of images (painting) are not detected. Render results
+ * are hashed with a counter that changes whenever they are rendered or read again, see renderResultsChanged.
+ *
+ * Cached buffers are evicted least recently used first when the cache grows over its budget.
+ *
+ * @note the cache is only used from COM_execute, which is serialized by the compositor mutex.
+ * @see ExecutionSystem.execute
+ */
+class ResultCache {
+public:
+	typedef uint64_t Key;
+	typedef std::map<MemoryProxy *, Key> Keys;
+
+	/**
+	 * @brief hash a block of memory into an existing hash
+	 */
+	static Key hashData(Key hash, const void *data, size_t size);
+
+	/**
+	 * @brief hash the settings of a bNode
+	 * @return the hash, or 0 when operations of this node can not be cached
+	 */
+	static Key hashNode(const bNode *node, const CompositorContext &context);
+
+	/**
+	 * @brief determine the keys of the MemoryProxy's of all WriteBufferOperations
+	 * @note MemoryProxy's that can not be cached get the key 0
+	 */
+	static void determineKeys(const CompositorContext &context, const std::vector<NodeOperation *> &operations, Keys *keys);
+
+	/**
+	 * @brief start a new execution of the compositor, evicts buffers until the cache fits in budget
+	 * @param budget maximum memory of the cached buffers, in bytes
+	 */
+	static void beginExecution(size_t budget);
+
+	/**
+	 * @brief find the buffer stored for a MemoryProxy
+	 * @return the buffer, or NULL when not cached. The buffer stays owned by the cache.
+	 */
+	static MemoryBuffer *find(Key key, MemoryProxy *memoryProxy);
+
+	/**
+	 * @brief store a completely calculated buffer
+	 * @note the cache takes ownership of the buffer
+	 */
+	static void store(Key key, MemoryBuffer *buffer);
+
+	/**
+	 * @brief free all cached buffers
+	 */
+	static void clear();
+
+	/**
+	 * @brief render results have been rendered or read again
+	 * buffers calculated from the previous render results are no longer found and get evicted.
+	 * @note may be called from the render thread, while the compositor is executing
+	 */
+	static void renderResultsChanged();
+
+	/**
+	 * @brief memory used by the cached buffers, in bytes
+	 */
+	static size_t getMemoryUsage();
+};
+
+#endif
@@ -95,6 +95,41 @@ protected:
 	                                  float /*x*/, float /*y*/,
 	                                  float /*dx*/[2], float /*dy*/[2]) {}
 
+	/**
+	 * @brief calculate a row of pixels
+	 * @note this method is called for non-complex, the result must be the same as
+	 * calling executePixelSampled with COM_PS_NEAREST for every pixel of the row.
+	 * The default implementation does exactly that, operations can override it
+	 * to process the whole row in a single loop.
+	 * @param output array to store the result, pixels are stride floats apart
+	 * @param x the x-coordinate of the first pixel of the row in image space
+	 * @param y the y-coordinate of the row in image space
+	 * @param length number of pixels in the row, at most COM_ROW_LENGTH_MAX
+	 * @param stride number of floats between two pixels in the output array
+	 */
+	virtual void executeRow(float *output, int x, int y, int length, int stride) {
+		for (int i = 0; i < length; i++, output += stride) {
+			executePixelSampled(output, x + i, y, COM_PS_NEAREST);
+		}
+	}
+
+	/**
+	 * @brief calculate a row of pixels
+	 * @note this method is called for complex, the result must be the same as
+	 * calling executePixel for every pixel of the row.
+	 * @param output array to store the result, pixels are stride floats apart
+	 * @param x the x-coordinate of the first pixel of the row in image space
+	 * @param y the y-coordinate of the row in image space
+	 * @param length number of pixels in the row, at most COM_ROW_LENGTH_MAX
+	 * @param stride number of floats between two pixels in the output array
+	 * @param chunkData chunk specific data a during execution time.
+	 */
+	virtual void executeTileRow(float *output, int x, int y, int length, int stride, void *chunkData) {
+		for (int i = 0; i < length; i++, output += stride) {
+			executePixel(output, x + i, y, chunkData);
+		}
+	}
+
 public:
 	inline void readSampled(float result[4], float x, float y, PixelSampler sampler) {
 		executePixelSampled(result, x, y, sampler);
@@ -105,6 +140,12 @@ public:
 	inline void readFiltered(float result[4], float x, float y, float dx[2], float dy[2]) {
 		executePixelFiltered(result, x, y, dx, dy);
 	}
+	inline void readRow(float *result, int x, int y, int length, int stride) {
+		executeRow(result, x, y, length, stride);
+	}
+	inline void readTileRow(float *result, int x, int y, int length, int stride, void *chunkData) {
+		executeTileRow(result, x, y, length, stride, chunkData);
+	}
 
 	virtual void *initializeTileData(rcti * /*rect*/) { return 0; }
 	virtual void deinitializeTileData(rcti * /*rect*/, void * /*data*/) {}
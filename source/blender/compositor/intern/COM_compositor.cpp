@@ -32,6 +32,8 @@ extern "C" {
 
 #include "COM_compositor.h"
 #include "COM_ExecutionSystem.h"
+#include "COM_Profiler.h"
+#include "COM_ResultCache.h"
 #include "COM_WorkScheduler.h"
 #include "clew.h"
 #include "COM_MovieDistortionOperation.h"
@@ -111,11 +113,30 @@ void COM_execute(RenderData *rd, Scene *scene, bNodeTree *editingtree, int rende
 	BLI_mutex_unlock(&s_compositorMutex);
 }
 
+int COM_profile_write(const bNodeTree *editingtree, const char *filepath)
+{
+	if (is_compositorMutex_init == false) {
+		return 0;
+	}
+
+	BLI_mutex_lock(&s_compositorMutex);
+	const bool ok = Profiler::write_trace(editingtree, filepath);
+	BLI_mutex_unlock(&s_compositorMutex);
+
+	return ok;
+}
+
+void COM_render_results_changed(void)
+{
+	ResultCache::renderResultsChanged();
+}
+
 void COM_deinitialize()
 {
 	if (is_compositorMutex_init) {
 		BLI_mutex_lock(&s_compositorMutex);
 		WorkScheduler::deinitialize();
+		ResultCache::clear();
 		is_compositorMutex_init = false;
 		BLI_mutex_unlock(&s_compositorMutex);
 		BLI_mutex_end(&s_compositorMutex);
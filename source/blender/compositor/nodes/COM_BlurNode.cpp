@@ -33,11 +33,36 @@
 #include "COM_SetValueOperation.h"
 #include "COM_GammaCorrectOperation.h"
 
+/* When enabled, gaussian blurs with a larger radius are approximated with the recursive filter of the
+ * fast gaussian. Its cost does not depend on the radius, but it is calculated on a single thread and
+ * the result differs slightly, so it is opt-in. */
+#define BLUR_RECURSIVE_GAUSS_RADIUS 200.0f
+
 BlurNode::BlurNode(bNode *editorNode) : Node(editorNode)
 {
 	/* pass */
 }
 
+static bool blur_use_recursive_gauss(const bNode *editorNode, float size, bool connectedSizeSocket)
+{
+	const NodeBlurData *data = (const NodeBlurData *)editorNode->storage;
+
+	if ((editorNode->custom1 & CMP_NODEFLAG_BLUR_APPROXIMATE) == 0) {
+		return false;
+	}
+	if (data->filtertype != R_FILTER_GAUSS || data->relative || connectedSizeSocket) {
+		return false;
+	}
+
+	const float radius_x = data->sizex * size;
+	const float radius_y = data->sizey * size;
+	if (radius_x <= 0.0f && radius_y <= 0.0f) {
+		return false;
+	}
+	return (radius_x <= 0.0f || radius_x >= BLUR_RECURSIVE_GAUSS_RADIUS) &&
+	       (radius_y <= 0.0f || radius_y >= BLUR_RECURSIVE_GAUSS_RADIUS);
+}
+
 void BlurNode::convertToOperations(NodeConverter &converter, const CompositorContext &context) const
 {
 	bNode *editorNode = this->getbNode();
@@ -106,6 +131,19 @@ void BlurNode::convertToOperations(NodeConverter &converter, const CompositorCon
 		output_operation = operation;
 		input_operation = operation;
 	}
+	else if (!data->bokeh && blur_use_recursive_gauss(editorNode, size, connectedSizeSocket)) {
+		/* the gaussian filter is truncated at 3 sigma */
+		FastGaussianBlurOperation *operationfgb = new FastGaussianBlurOperation();
+		operationfgb->setData(data);
+		operationfgb->setExtendBounds(extend_bounds);
+		operationfgb->setSigmaFactor(1.0f / 3.0f);
+		converter.addOperation(operationfgb);
+
+		converter.mapInputSocket(getInputSocket(1), operationfgb->getInputSocket(1));
+
+		input_operation = operationfgb;
+		output_operation = operationfgb;
+	}
 	else if (!data->bokeh) {
 		GaussianXBlurOperation *operationx = new GaussianXBlurOperation();
 		operationx->setData(data);
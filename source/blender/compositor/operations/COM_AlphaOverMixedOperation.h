@@ -41,7 +41,7 @@ public:
 	/**
 	 * the inner loop of this program
 	 */
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 	
 	void setX(float x) { this->m_x = x; }
 };
@@ -38,6 +38,13 @@ private:
 	bool m_greenChannelEnabled;
 	bool m_blueChannelEnabled;
 
+	/**
+	 * @brief apply the color correction to a row of pixels
+	 * @param output array to store the result, pixels are stride floats apart
+	 * @param inputImageColors, inputMasks input pixels, COM_NUM_CHANNELS_COLOR floats apart
+	 */
+	void correctRow(float *output, int stride, float *inputImageColors, float *inputMasks, int length);
+
 public:
 	ColorCorrectionOperation();
 	
@@ -45,6 +52,7 @@ public:
 	 * the inner loop of this program
 	 */
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int length, int stride);
 	
 	/**
 	 * Initialize the execution
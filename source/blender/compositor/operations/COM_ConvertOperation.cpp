@@ -41,6 +41,23 @@ void ConvertBaseOperation::deinitExecution()
 	this->m_inputOperation = NULL;
 }
 
+void ConvertBaseOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+{
+	float input[4];
+	this->m_inputOperation->readSampled(input, x, y, sampler);
+	this->convertRow(output, COM_NUM_CHANNELS_COLOR, input, 1);
+}
+
+void ConvertBaseOperation::executeRow(float *output, int x, int y, int length, int stride)
+{
+	float inputs[COM_ROW_LENGTH_MAX * COM_NUM_CHANNELS_COLOR];
+
+	BLI_assert(length <= COM_ROW_LENGTH_MAX);
+
+	this->m_inputOperation->readRow(inputs, x, y, length, COM_NUM_CHANNELS_COLOR);
+	this->convertRow(output, stride, inputs, length);
+}
+
 
 /* ******** Value to Color ******** */
 
@@ -50,12 +67,14 @@ ConvertValueToColorOperation::ConvertValueToColorOperation() : ConvertBaseOperat
 	this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertValueToColorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertValueToColorOperation::convertRow(float *output, int stride, float *inputs, int length)
 {
-	float value;
-	this->m_inputOperation->readSampled(&value, x, y, sampler);
-	output[0] = output[1] = output[2] = value;
-	output[3] = 1.0f;
+	for (int i = 0; i < length; i++, output += stride) {
+		float *input = &inputs[i * COM_NUM_CHANNELS_COLOR];
+
+		output[0] = output[1] = output[2] = input[0];
+		output[3] = 1.0f;
+	}
 }
 
 
@@ -67,11 +86,13 @@ ConvertColorToValueOperation::ConvertColorToValueOperation() : ConvertBaseOperat
 	this->addOutputSocket(COM_DT_VALUE);
 }
 
-void ConvertColorToValueOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertColorToValueOperation::convertRow(float *output, int stride, float *inputs, int length)
 {
-	float inputColor[4];
-	this->m_inputOperation->readSampled(inputColor, x, y, sampler);
-	output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
+	for (int i = 0; i < length; i++, output += stride) {
+		float *input = &inputs[i * COM_NUM_CHANNELS_COLOR];
+
+		output[0] = (input[0] + input[1] + input[2]) / 3.0f;
+	}
 }
 
 
@@ -83,11 +104,13 @@ ConvertColorToBWOperation::ConvertColorToBWOperation() : ConvertBaseOperation()
 	this->addOutputSocket(COM_DT_VALUE);
 }
 
-void ConvertColorToBWOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertColorToBWOperation::convertRow(float *output, int stride, float *inputs, int length)
 {
-	float inputColor[4];
-	this->m_inputOperation->readSampled(inputColor, x, y, sampler);
-	output[0] = IMB_colormanagement_get_luminance(inputColor);
+	for (int i = 0; i < length; i++, output += stride) {
+		float *input = &inputs[i * COM_NUM_CHANNELS_COLOR];
+
+		output[0] = IMB_colormanagement_get_luminance(input);
+	}
 }
 
 
@@ -99,11 +122,14 @@ ConvertColorToVectorOperation::ConvertColorToVectorOperation() : ConvertBaseOper
 	this->addOutputSocket(COM_DT_VECTOR);
 }
 
-void ConvertColorToVectorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertColorToVectorOperation::convertRow(float *output, int stride, float *inputs, int length)
 {
-	float color[4];
-	this->m_inputOperation->readSampled(color, x, y, sampler);
-	copy_v3_v3(output, color);}
+	for (int i = 0; i < length; i++, output += stride) {
+		float *input = &inputs[i * COM_NUM_CHANNELS_COLOR];
+
+		copy_v3_v3(output, input);
+	}
+}
 
 
 /* ******** Value to Vector ******** */
@@ -114,11 +140,13 @@ ConvertValueToVectorOperation::ConvertValueToVectorOperation() : ConvertBaseOper
 	this->addOutputSocket(COM_DT_VECTOR);
 }
 
-void ConvertValueToVectorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertValueToVectorOperation::convertRow(float *output, int stride, float *inputs, int length)
 {
-	float value;
-	this->m_inputOperation->readSampled(&value, x, y, sampler);
-	output[0] = output[1] = output[2] = value;
+	for (int i = 0; i < length; i++, output += stride) {
+		float *input = &inputs[i * COM_NUM_CHANNELS_COLOR];
+
+		output[0] = output[1] = output[2] = input[0];
+	}
 }
 
 
@@ -130,10 +158,14 @@ ConvertVectorToColorOperation::ConvertVectorToColorOperation() : ConvertBaseOper
 	this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertVectorToColorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertVectorToColorOperation::convertRow(float *output, int stride, float *inputs, int length)
 {
-	this->m_inputOperation->readSampled(output, x, y, sampler);
-	output[3] = 1.0f;
+	for (int i = 0; i < length; i++, output += stride) {
+		float *input = &inputs[i * COM_NUM_CHANNELS_COLOR];
+
+		copy_v3_v3(output, input);
+		output[3] = 1.0f;
+	}
 }
 
 
@@ -145,11 +177,13 @@ ConvertVectorToValueOperation::ConvertVectorToValueOperation() : ConvertBaseOper
 	this->addOutputSocket(COM_DT_VALUE);
 }
 
-void ConvertVectorToValueOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertVectorToValueOperation::convertRow(float *output, int stride, float *inputs, int length)
 {
-	float input[4];
-	this->m_inputOperation->readSampled(input, x, y, sampler);
-	output[0] = (input[0] + input[1] + input[2]) / 3.0f;
+	for (int i = 0; i < length; i++, output += stride) {
+		float *input = &inputs[i * COM_NUM_CHANNELS_COLOR];
+
+		output[0] = (input[0] + input[1] + input[2]) / 3.0f;
+	}
 }
 
 
@@ -177,18 +211,20 @@ void ConvertRGBToYCCOperation::setMode(int mode)
 	}
 }
 
-void ConvertRGBToYCCOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertRGBToYCCOperation::convertRow(float *output, int stride, float *inputs, int length)
 {
-	float inputColor[4];
-	float color[3];
+	for (int i = 0; i < length; i++, output += stride) {
+		float *input = &inputs[i * COM_NUM_CHANNELS_COLOR];
+
+		float color[3];
 
-	this->m_inputOperation->readSampled(inputColor, x, y, sampler);
-	rgb_to_ycc(inputColor[0], inputColor[1], inputColor[2], &color[0], &color[1], &color[2], this->m_mode);
+		rgb_to_ycc(input[0], input[1], input[2], &color[0], &color[1], &color[2], this->m_mode);
 
-	/* divided by 255 to normalize for viewing in */
-	/* R,G,B --> Y,Cb,Cr */
-	mul_v3_v3fl(output, color, 1.0f / 255.0f);
-	output[3] = inputColor[3];
+		/* divided by 255 to normalize for viewing in */
+		/* R,G,B --> Y,Cb,Cr */
+		mul_v3_v3fl(output, color, 1.0f / 255.0f);
+		output[3] = input[3];
+	}
 }
 
 /* ******** YCC to RGB ******** */
@@ -215,17 +251,20 @@ void ConvertYCCToRGBOperation::setMode(int mode)
 	}
 }
 
-void ConvertYCCToRGBOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertYCCToRGBOperation::convertRow(float *output, int stride, float *inputs, int length)
 {
-	float inputColor[4];
-	this->m_inputOperation->readSampled(inputColor, x, y, sampler);
+	for (int i = 0; i < length; i++, output += stride) {
+		float *input = &inputs[i * COM_NUM_CHANNELS_COLOR];
+
+		float color[3];
 
-	/* need to un-normalize the data */
-	/* R,G,B --> Y,Cb,Cr */
-	mul_v3_fl(inputColor, 255.0f);
+		/* need to un-normalize the data */
+		/* R,G,B --> Y,Cb,Cr */
+		mul_v3_v3fl(color, input, 255.0f);
 
-	ycc_to_rgb(inputColor[0], inputColor[1], inputColor[2], &output[0], &output[1], &output[2], this->m_mode);
-	output[3] = inputColor[3];
+		ycc_to_rgb(color[0], color[1], color[2], &output[0], &output[1], &output[2], this->m_mode);
+		output[3] = input[3];
+	}
 }
 
 
@@ -237,12 +276,14 @@ ConvertRGBToYUVOperation::ConvertRGBToYUVOperation() : ConvertBaseOperation()
 	this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertRGBToYUVOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertRGBToYUVOperation::convertRow(float *output, int stride, float *inputs, int length)
 {
-	float inputColor[4];
-	this->m_inputOperation->readSampled(inputColor, x, y, sampler);
-	rgb_to_yuv(inputColor[0], inputColor[1], inputColor[2], &output[0], &output[1], &output[2]);
-	output[3] = inputColor[3];
+	for (int i = 0; i < length; i++, output += stride) {
+		float *input = &inputs[i * COM_NUM_CHANNELS_COLOR];
+
+		rgb_to_yuv(input[0], input[1], input[2], &output[0], &output[1], &output[2]);
+		output[3] = input[3];
+	}
 }
 
 
@@ -254,12 +295,14 @@ ConvertYUVToRGBOperation::ConvertYUVToRGBOperation() : ConvertBaseOperation()
 	this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertYUVToRGBOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertYUVToRGBOperation::convertRow(float *output, int stride, float *inputs, int length)
 {
-	float inputColor[4];
-	this->m_inputOperation->readSampled(inputColor, x, y, sampler);
-	yuv_to_rgb(inputColor[0], inputColor[1], inputColor[2], &output[0], &output[1], &output[2]);
-	output[3] = inputColor[3];
+	for (int i = 0; i < length; i++, output += stride) {
+		float *input = &inputs[i * COM_NUM_CHANNELS_COLOR];
+
+		yuv_to_rgb(input[0], input[1], input[2], &output[0], &output[1], &output[2]);
+		output[3] = input[3];
+	}
 }
 
 
@@ -271,12 +314,14 @@ ConvertRGBToHSVOperation::ConvertRGBToHSVOperation() : ConvertBaseOperation()
 	this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertRGBToHSVOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertRGBToHSVOperation::convertRow(float *output, int stride, float *inputs, int length)
 {
-	float inputColor[4];
-	this->m_inputOperation->readSampled(inputColor, x, y, sampler);
-	rgb_to_hsv_v(inputColor, output);
-	output[3] = inputColor[3];
+	for (int i = 0; i < length; i++, output += stride) {
+		float *input = &inputs[i * COM_NUM_CHANNELS_COLOR];
+
+		rgb_to_hsv_v(input, output);
+		output[3] = input[3];
+	}
 }
 
 
@@ -288,15 +333,17 @@ ConvertHSVToRGBOperation::ConvertHSVToRGBOperation() : ConvertBaseOperation()
 	this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertHSVToRGBOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertHSVToRGBOperation::convertRow(float *output, int stride, float *inputs, int length)
 {
-	float inputColor[4];
-	this->m_inputOperation->readSampled(inputColor, x, y, sampler);
-	hsv_to_rgb_v(inputColor, output);
-	output[0] = max_ff(output[0], 0.0f);
-	output[1] = max_ff(output[1], 0.0f);
-	output[2] = max_ff(output[2], 0.0f);
-	output[3] = inputColor[3];
+	for (int i = 0; i < length; i++, output += stride) {
+		float *input = &inputs[i * COM_NUM_CHANNELS_COLOR];
+
+		hsv_to_rgb_v(input, output);
+		output[0] = max_ff(output[0], 0.0f);
+		output[1] = max_ff(output[1], 0.0f);
+		output[2] = max_ff(output[2], 0.0f);
+		output[3] = input[3];
+	}
 }
 
 
@@ -308,23 +355,23 @@ ConvertPremulToStraightOperation::ConvertPremulToStraightOperation() : ConvertBa
 	this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertPremulToStraightOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertPremulToStraightOperation::convertRow(float *output, int stride, float *inputs, int length)
 {
-	float inputValue[4];
-	float alpha;
+	for (int i = 0; i < length; i++, output += stride) {
+		float *input = &inputs[i * COM_NUM_CHANNELS_COLOR];
 
-	this->m_inputOperation->readSampled(inputValue, x, y, sampler);
-	alpha = inputValue[3];
+		const float alpha = input[3];
 
-	if (fabsf(alpha) < 1e-5f) {
-		zero_v3(output);
-	}
-	else {
-		mul_v3_v3fl(output, inputValue, 1.0f / alpha);
-	}
+		if (fabsf(alpha) < 1e-5f) {
+			zero_v3(output);
+		}
+		else {
+			mul_v3_v3fl(output, input, 1.0f / alpha);
+		}
 
-	/* never touches the alpha */
-	output[3] = alpha;
+		/* never touches the alpha */
+		output[3] = alpha;
+	}
 }
 
 
@@ -336,18 +383,18 @@ ConvertStraightToPremulOperation::ConvertStraightToPremulOperation() : ConvertBa
 	this->addOutputSocket(COM_DT_COLOR);
 }
 
-void ConvertStraightToPremulOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void ConvertStraightToPremulOperation::convertRow(float *output, int stride, float *inputs, int length)
 {
-	float inputValue[4];
-	float alpha;
+	for (int i = 0; i < length; i++, output += stride) {
+		float *input = &inputs[i * COM_NUM_CHANNELS_COLOR];
 
-	this->m_inputOperation->readSampled(inputValue, x, y, sampler);
-	alpha = inputValue[3];
+		const float alpha = input[3];
 
-	mul_v3_v3fl(output, inputValue, alpha);
+		mul_v3_v3fl(output, input, alpha);
 
-	/* never touches the alpha */
-	output[3] = alpha;
+		/* never touches the alpha */
+		output[3] = alpha;
+	}
 }
 
 
@@ -377,6 +424,19 @@ void SeparateChannelOperation::executePixelSampled(float output[4], float x, flo
 	output[0] = input[this->m_channel];
 }
 
+void SeparateChannelOperation::executeRow(float *output, int x, int y, int length, int stride)
+{
+	float inputs[COM_ROW_LENGTH_MAX * COM_NUM_CHANNELS_COLOR];
+	const float *input = &inputs[this->m_channel];
+
+	BLI_assert(length <= COM_ROW_LENGTH_MAX);
+
+	this->m_inputOperation->readRow(inputs, x, y, length, COM_NUM_CHANNELS_COLOR);
+	for (int i = 0; i < length; i++, output += stride, input += COM_NUM_CHANNELS_COLOR) {
+		output[0] = *input;
+	}
+}
+
 
 /* ******** Combine Channels ******** */
 
@@ -431,3 +491,26 @@ void CombineChannelsOperation::executePixelSampled(float output[4], float x, flo
 		output[3] = input[0];
 	}
 }
+
+void CombineChannelsOperation::executeRow(float *output, int x, int y, int length, int stride)
+{
+	SocketReader *inputOperations[4] = {this->m_inputChannel1Operation,
+	                                    this->m_inputChannel2Operation,
+	                                    this->m_inputChannel3Operation,
+	                                    this->m_inputChannel4Operation};
+	float inputs[COM_ROW_LENGTH_MAX];
+
+	BLI_assert(length <= COM_ROW_LENGTH_MAX);
+
+	for (int channel = 0; channel < 4; channel++) {
+		if (inputOperations[channel]) {
+			float *channelOutput = &output[channel];
+
+			/* value inputs write a single float per pixel */
+			inputOperations[channel]->readRow(inputs, x, y, length, COM_NUM_CHANNELS_VALUE);
+			for (int i = 0; i < length; i++, channelOutput += stride) {
+				*channelOutput = inputs[i];
+			}
+		}
+	}
+}
@@ -35,62 +35,80 @@ public:
 	
 	void initExecution();
 	void deinitExecution();
+
+	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int length, int stride);
+
+protected:
+	/**
+	 * @brief convert a row of pixels
+	 * @param output array to store the result, pixels are stride floats apart
+	 * @param inputs input pixels, COM_NUM_CHANNELS_COLOR floats apart
+	 */
+	virtual void convertRow(float *output, int stride, float *inputs, int length) = 0;
 };
 
 
 class ConvertValueToColorOperation : public ConvertBaseOperation {
 public:
 	ConvertValueToColorOperation();
-	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+protected:
+	void convertRow(float *output, int stride, float *inputs, int length);
 };
 
 
 class ConvertColorToValueOperation : public ConvertBaseOperation {
 public:
 	ConvertColorToValueOperation();
-	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+protected:
+	void convertRow(float *output, int stride, float *inputs, int length);
 };
 
 
 class ConvertColorToBWOperation : public ConvertBaseOperation {
 public:
 	ConvertColorToBWOperation();
-	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+protected:
+	void convertRow(float *output, int stride, float *inputs, int length);
 };
 
 
 class ConvertColorToVectorOperation : public ConvertBaseOperation {
 public:
 	ConvertColorToVectorOperation();
-	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+protected:
+	void convertRow(float *output, int stride, float *inputs, int length);
 };
 
 
 class ConvertValueToVectorOperation : public ConvertBaseOperation {
 public:
 	ConvertValueToVectorOperation();
-	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+protected:
+	void convertRow(float *output, int stride, float *inputs, int length);
 };
 
 
 class ConvertVectorToColorOperation : public ConvertBaseOperation {
 public:
 	ConvertVectorToColorOperation();
-	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+protected:
+	void convertRow(float *output, int stride, float *inputs, int length);
 };
 
 
 class ConvertVectorToValueOperation : public ConvertBaseOperation {
 public:
 	ConvertVectorToValueOperation();
-	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+protected:
+	void convertRow(float *output, int stride, float *inputs, int length);
 };
 
 
@@ -101,10 +119,11 @@ private:
 public:
 	ConvertRGBToYCCOperation();
 
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
-
 	/** Set the YCC mode */
 	void setMode(int mode);
+
+protected:
+	void convertRow(float *output, int stride, float *inputs, int length);
 };
 
 
@@ -114,43 +133,48 @@ private:
 	int m_mode;
 public:
 	ConvertYCCToRGBOperation();
-	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
-	
+
 	/** Set the YCC mode */
 	void setMode(int mode);
+
+protected:
+	void convertRow(float *output, int stride, float *inputs, int length);
 };
 
 
 class ConvertRGBToYUVOperation : public ConvertBaseOperation {
 public:
 	ConvertRGBToYUVOperation();
-	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+protected:
+	void convertRow(float *output, int stride, float *inputs, int length);
 };
 
 
 class ConvertYUVToRGBOperation : public ConvertBaseOperation {
 public:
 	ConvertYUVToRGBOperation();
-	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+protected:
+	void convertRow(float *output, int stride, float *inputs, int length);
 };
 
 
 class ConvertRGBToHSVOperation : public ConvertBaseOperation {
 public:
 	ConvertRGBToHSVOperation();
-	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+protected:
+	void convertRow(float *output, int stride, float *inputs, int length);
 };
 
 
 class ConvertHSVToRGBOperation : public ConvertBaseOperation {
 public:
 	ConvertHSVToRGBOperation();
-	
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+protected:
+	void convertRow(float *output, int stride, float *inputs, int length);
 };
 
 
@@ -158,7 +182,8 @@ class ConvertPremulToStraightOperation : public ConvertBaseOperation {
 public:
 	ConvertPremulToStraightOperation();
 
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void convertRow(float *output, int stride, float *inputs, int length);
 };
 
 
@@ -166,7 +191,8 @@ class ConvertStraightToPremulOperation : public ConvertBaseOperation {
 public:
 	ConvertStraightToPremulOperation();
 
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void convertRow(float *output, int stride, float *inputs, int length);
 };
 
 
@@ -177,6 +203,7 @@ private:
 public:
 	SeparateChannelOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int length, int stride);
 	
 	void initExecution();
 	void deinitExecution();
@@ -194,6 +221,7 @@ private:
 public:
 	CombineChannelsOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int length, int stride);
 	
 	void initExecution();
 	void deinitExecution();
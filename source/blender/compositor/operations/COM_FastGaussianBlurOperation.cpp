@@ -29,6 +29,7 @@
 FastGaussianBlurOperation::FastGaussianBlurOperation() : BlurBaseOperation(COM_DT_COLOR)
 {
 	this->m_iirgaus = NULL;
+	this->m_sigmaFactor = 0.5f;
 }
 
 void FastGaussianBlurOperation::executePixel(float output[4], int x, int y, void *data)
@@ -87,22 +88,18 @@ void *FastGaussianBlurOperation::initializeTileData(rcti *rect)
 		MemoryBuffer *copy = newBuf->duplicate();
 		updateSize();
 
-		int c;
-		this->m_sx = this->m_data.sizex * this->m_size / 2.0f;
-		this->m_sy = this->m_data.sizey * this->m_size / 2.0f;
+		this->m_sx = this->m_data.sizex * this->m_size * this->m_sigmaFactor;
+		this->m_sy = this->m_data.sizey * this->m_size * this->m_sigmaFactor;
 		
 		if ((this->m_sx == this->m_sy) && (this->m_sx > 0.0f)) {
-			for (c = 0; c < COM_NUM_CHANNELS_COLOR; ++c)
-				IIR_gauss(copy, this->m_sx, c, 3);
+			IIR_gauss(copy, this->m_sx, 3);
 		}
 		else {
 			if (this->m_sx > 0.0f) {
-				for (c = 0; c < COM_NUM_CHANNELS_COLOR; ++c)
-					IIR_gauss(copy, this->m_sx, c, 1);
+				IIR_gauss(copy, this->m_sx, 1);
 			}
 			if (this->m_sy > 0.0f) {
-				for (c = 0; c < COM_NUM_CHANNELS_COLOR; ++c)
-					IIR_gauss(copy, this->m_sy, c, 2);
+				IIR_gauss(copy, this->m_sy, 2);
 			}
 		}
 		this->m_iirgaus = copy;
@@ -111,28 +108,18 @@ void *FastGaussianBlurOperation::initializeTileData(rcti *rect)
 	return this->m_iirgaus;
 }
 
-void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src, float sigma, unsigned int chan, unsigned int xy)
+/* coefficients of the recursive gaussian */
+typedef struct IIRGaussCoefficients {
+	double cf[4];
+	double tsM[9];  /* Triggs/Sdika border corrections */
+} IIRGaussCoefficients;
+
+static void iir_gauss_coefficients(float sigma, IIRGaussCoefficients *coef)
 {
-	double q, q2, sc, cf[4], tsM[9], tsu[3], tsv[3];
-	double *X, *Y, *W;
-	const unsigned int src_width = src->getWidth();
-	const unsigned int src_height = src->getHeight();
-	unsigned int x, y, sz;
-	unsigned int i;
-	float *buffer = src->getBuffer();
-	const unsigned int num_channels = src->get_num_channels();
-	
-	// <0.5 not valid, though can have a possibly useful sort of sharpening effect
-	if (sigma < 0.5f) return;
-	
-	if ((xy < 1) || (xy > 3)) xy = 3;
-	
-	// XXX The YVV macro defined below explicitly expects sources of at least 3x3 pixels,
-	//     so just skiping blur along faulty direction if src's def is below that limit!
-	if (src_width < 3) xy &= ~1;
-	if (src_height < 3) xy &= ~2;
-	if (xy < 1) return;
-	
+	double q, q2, sc;
+	double *cf = coef->cf;
+	double *tsM = coef->tsM;
+
 	// see "Recursive Gabor Filtering" by Young/VanVliet
 	// all factors here in double.prec. Required, because for single.prec it seems to blow up if sigma > ~200
 	if (sigma >= 3.556f)
@@ -148,7 +135,7 @@ void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src, float sigma, unsign
 	// 0 & 3 unchanged
 	cf[3] = q2 * q / sc;
 	cf[0] = 1.0 - cf[1] - cf[2] - cf[3];
-	
+
 	// Triggs/Sdika border corrections,
 	// it seems to work, not entirely sure if it is actually totally correct,
 	// Besides J.M.Geusebroek's anigauss.c (see http://www.science.uva.nl/~mark),
@@ -166,76 +153,145 @@ void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src, float sigma, unsign
 	tsM[6] = sc * (cf[3] * cf[1] + cf[2] + cf[1] * cf[1] - cf[2] * cf[2]);
 	tsM[7] = sc * (cf[1] * cf[2] + cf[3] * cf[2] * cf[2] - cf[1] * cf[3] * cf[3] - cf[3] * cf[3] * cf[3] - cf[3] * cf[2] + cf[3]);
 	tsM[8] = sc * (cf[3] * (cf[1] + cf[3] * cf[2]));
-	
-#define YVV(L)                                                                          \
-{                                                                                       \
-	W[0] = cf[0] * X[0] + cf[1] * X[0] + cf[2] * X[0] + cf[3] * X[0];                   \
-	W[1] = cf[0] * X[1] + cf[1] * W[0] + cf[2] * X[0] + cf[3] * X[0];                   \
-	W[2] = cf[0] * X[2] + cf[1] * W[1] + cf[2] * W[0] + cf[3] * X[0];                   \
-	for (i = 3; i < L; i++) {                                                           \
-		W[i] = cf[0] * X[i] + cf[1] * W[i - 1] + cf[2] * W[i - 2] + cf[3] * W[i - 3];   \
-	}                                                                                   \
-	tsu[0] = W[L - 1] - X[L - 1];                                                       \
-	tsu[1] = W[L - 2] - X[L - 1];                                                       \
-	tsu[2] = W[L - 3] - X[L - 1];                                                       \
-	tsv[0] = tsM[0] * tsu[0] + tsM[1] * tsu[1] + tsM[2] * tsu[2] + X[L - 1];            \
-	tsv[1] = tsM[3] * tsu[0] + tsM[4] * tsu[1] + tsM[5] * tsu[2] + X[L - 1];            \
-	tsv[2] = tsM[6] * tsu[0] + tsM[7] * tsu[1] + tsM[8] * tsu[2] + X[L - 1];            \
-	Y[L - 1] = cf[0] * W[L - 1] + cf[1] * tsv[0] + cf[2] * tsv[1] + cf[3] * tsv[2];     \
-	Y[L - 2] = cf[0] * W[L - 2] + cf[1] * Y[L - 1] + cf[2] * tsv[0] + cf[3] * tsv[1];   \
-	Y[L - 3] = cf[0] * W[L - 3] + cf[1] * Y[L - 2] + cf[2] * Y[L - 1] + cf[3] * tsv[0]; \
-	/* 'i != UINT_MAX' is really 'i >= 0', but necessary for unsigned int wrapping */   \
-	for (i = L - 4; i != UINT_MAX; i--) {                                               \
-		Y[i] = cf[0] * W[i] + cf[1] * Y[i + 1] + cf[2] * Y[i + 2] + cf[3] * Y[i + 3];   \
-	}                                                                                   \
-} (void)0
-	
-	// intermediate buffers
-	sz = max(src_width, src_height);
+}
+
+/**
+ * Filter a line of L values forward and backward. Every value is a vector of n doubles
+ * that are filtered independently (the channels of a pixel, or of a strip of pixels),
+ * so the inner loops run over contiguous memory.
+ */
+static void iir_gauss_line(const IIRGaussCoefficients *coef, const double *X, double *W, double *Y,
+                           unsigned int L, unsigned int n)
+{
+	const double *cf = coef->cf;
+	const double *tsM = coef->tsM;
+	unsigned int i, k;
+
+	for (k = 0; k < n; k++) {
+		W[k] = cf[0] * X[k] + cf[1] * X[k] + cf[2] * X[k] + cf[3] * X[k];
+		W[n + k] = cf[0] * X[n + k] + cf[1] * W[k] + cf[2] * X[k] + cf[3] * X[k];
+		W[2 * n + k] = cf[0] * X[2 * n + k] + cf[1] * W[n + k] + cf[2] * W[k] + cf[3] * X[k];
+	}
+	for (i = 3; i < L; i++) {
+		const double *x = &X[i * n];
+		double *w = &W[i * n];
+		const double *w1 = w - n, *w2 = w - 2 * n, *w3 = w - 3 * n;
+		for (k = 0; k < n; k++) {
+			w[k] = cf[0] * x[k] + cf[1] * w1[k] + cf[2] * w2[k] + cf[3] * w3[k];
+		}
+	}
+
+	for (k = 0; k < n; k++) {
+		const double *x = &X[(L - 1) * n + k];
+		const double *w = &W[(L - 1) * n + k];
+		double *y = &Y[(L - 1) * n + k];
+		double tsu[3], tsv[3];
+
+		tsu[0] = w[0] - x[0];
+		tsu[1] = w[-(int)n] - x[0];
+		tsu[2] = w[-2 * (int)n] - x[0];
+		tsv[0] = tsM[0] * tsu[0] + tsM[1] * tsu[1] + tsM[2] * tsu[2] + x[0];
+		tsv[1] = tsM[3] * tsu[0] + tsM[4] * tsu[1] + tsM[5] * tsu[2] + x[0];
+		tsv[2] = tsM[6] * tsu[0] + tsM[7] * tsu[1] + tsM[8] * tsu[2] + x[0];
+		y[0] = cf[0] * w[0] + cf[1] * tsv[0] + cf[2] * tsv[1] + cf[3] * tsv[2];
+		y[-(int)n] = cf[0] * w[-(int)n] + cf[1] * y[0] + cf[2] * tsv[0] + cf[3] * tsv[1];
+		y[-2 * (int)n] = cf[0] * w[-2 * (int)n] + cf[1] * y[-(int)n] + cf[2] * y[0] + cf[3] * tsv[0];
+	}
+	/* 'i != UINT_MAX' is really 'i >= 0', but necessary for unsigned int wrapping */
+	for (i = L - 4; i != UINT_MAX; i--) {
+		const double *w = &W[i * n];
+		double *y = &Y[i * n];
+		const double *y1 = y + n, *y2 = y + 2 * n, *y3 = y + 3 * n;
+		for (k = 0; k < n; k++) {
+			y[k] = cf[0] * w[k] + cf[1] * y1[k] + cf[2] * y2[k] + cf[3] * y3[k];
+		}
+	}
+}
+
+/* number of columns filtered together by the vertical pass */
+#define IIR_GAUSS_STRIP 16
+
+/* filter channels [chan, chan + chan_len) of src */
+static void iir_gauss(MemoryBuffer *src, float sigma, unsigned int chan, unsigned int chan_len, unsigned int xy)
+{
+	IIRGaussCoefficients coef;
+	double *X, *Y, *W;
+	const unsigned int src_width = src->getWidth();
+	const unsigned int src_height = src->getHeight();
+	unsigned int x, y, c, sz;
+	float *buffer = src->getBuffer();
+	const unsigned int num_channels = src->get_num_channels();
+
+	// <0.5 not valid, though can have a possibly useful sort of sharpening effect
+	if (sigma < 0.5f) return;
+
+	if ((xy < 1) || (xy > 3)) xy = 3;
+
+	// The filter explicitly expects sources of at least 3x3 pixels,
+	// so just skiping blur along faulty direction if src's def is below that limit!
+	if (src_width < 3) xy &= ~1;
+	if (src_height < 3) xy &= ~2;
+	if (xy < 1) return;
+
+	iir_gauss_coefficients(sigma, &coef);
+
+	// intermediate buffers, a row of pixels or a strip of columns
+	sz = max(src_width, src_height * IIR_GAUSS_STRIP) * chan_len;
 	X = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss X buf");
 	Y = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss Y buf");
 	W = (double *)MEM_callocN(sz * sizeof(double), "IIR_gauss W buf");
 	if (xy & 1) {   // H
-		int offset;
 		for (y = 0; y < src_height; ++y) {
-			const int yx = y * src_width;
-			offset = yx * num_channels + chan;
+			float *row = &buffer[y * src_width * num_channels + chan];
 			for (x = 0; x < src_width; ++x) {
-				X[x] = buffer[offset];
-				offset += num_channels;
+				for (c = 0; c < chan_len; c++) {
+					X[x * chan_len + c] = row[x * num_channels + c];
+				}
 			}
-			YVV(src_width);
-			offset = yx * num_channels + chan;
+			iir_gauss_line(&coef, X, W, Y, src_width, chan_len);
 			for (x = 0; x < src_width; ++x) {
-				buffer[offset] = Y[x];
-				offset += num_channels;
+				for (c = 0; c < chan_len; c++) {
+					row[x * num_channels + c] = Y[x * chan_len + c];
+				}
 			}
 		}
 	}
 	if (xy & 2) {   // V
-		int offset;
-		const int add = src_width * num_channels;
-
-		for (x = 0; x < src_width; ++x) {
-			offset = x * num_channels + chan;
+		/* filter strips of columns, reading the buffer row by row */
+		for (x = 0; x < src_width; x += IIR_GAUSS_STRIP) {
+			const unsigned int strip_len = min(src_width - x, (unsigned int)IIR_GAUSS_STRIP) * chan_len;
+			unsigned int i;
 			for (y = 0; y < src_height; ++y) {
-				X[y] = buffer[offset];
-				offset += add;
+				const float *row = &buffer[(y * src_width + x) * num_channels + chan];
+				double *line = &X[y * strip_len];
+				for (i = 0; i < strip_len; i++) {
+					line[i] = row[(i / chan_len) * num_channels + (i % chan_len)];
+				}
 			}
-			YVV(src_height);
-			offset = x * num_channels + chan;
+			iir_gauss_line(&coef, X, W, Y, src_height, strip_len);
 			for (y = 0; y < src_height; ++y) {
-				buffer[offset] = Y[y];
-				offset += add;
+				float *row = &buffer[(y * src_width + x) * num_channels + chan];
+				const double *line = &Y[y * strip_len];
+				for (i = 0; i < strip_len; i++) {
+					row[(i / chan_len) * num_channels + (i % chan_len)] = line[i];
+				}
 			}
 		}
 	}
-	
+
 	MEM_freeN(X);
 	MEM_freeN(W);
 	MEM_freeN(Y);
-#undef YVV
-	
+}
+
+void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src, float sigma, unsigned int chan, unsigned int xy)
+{
+	iir_gauss(src, sigma, chan, 1, xy);
+}
+
+void FastGaussianBlurOperation::IIR_gauss(MemoryBuffer *src, float sigma, unsigned int xy)
+{
+	iir_gauss(src, sigma, 0, src->get_num_channels(), xy);
 }
 
 
@@ -294,7 +350,7 @@ void *FastGaussianBlurValueOperation::initializeTileData(rcti *rect)
 	if (!this->m_iirgaus) {
 		MemoryBuffer *newBuf = (MemoryBuffer *)this->m_inputprogram->initializeTileData(rect);
 		MemoryBuffer *copy = newBuf->duplicate();
-		FastGaussianBlurOperation::IIR_gauss(copy, this->m_sigma, 0, 3);
+		FastGaussianBlurOperation::IIR_gauss(copy, this->m_sigma, 3);
 
 		if (this->m_overlay == FAST_GAUSS_OVERLAY_MIN) {
 			float *src = newBuf->getBuffer();
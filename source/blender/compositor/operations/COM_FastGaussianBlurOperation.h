@@ -30,13 +30,29 @@ class FastGaussianBlurOperation : public BlurBaseOperation {
 private:
 	float m_sx;
 	float m_sy;
+	float m_sigmaFactor;
 	MemoryBuffer *m_iirgaus;
 public:
 	FastGaussianBlurOperation();
 	bool determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output);
 	void executePixel(float output[4], int x, int y, void *data);
 	
+	/**
+	 * @brief recursive gaussian blur of a single channel
+	 * @param xy 1: horizontal, 2: vertical, 3: both
+	 */
 	static void IIR_gauss(MemoryBuffer *src, float sigma, unsigned int channel, unsigned int xy);
+
+	/**
+	 * @brief recursive gaussian blur of all channels at once
+	 */
+	static void IIR_gauss(MemoryBuffer *src, float sigma, unsigned int xy);
+
+	/**
+	 * @brief sigma of the gaussian relative to the blur size
+	 * 0.5 for the Fast Gaussian filter, 1/3 approximates the Gaussian filter
+	 */
+	void setSigmaFactor(float factor) { this->m_sigmaFactor = factor; }
 	void *initializeTileData(rcti *rect);
 	void deinitExecution();
 	void initExecution();
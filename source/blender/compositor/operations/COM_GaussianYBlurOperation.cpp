@@ -125,6 +125,66 @@ void GaussianYBlurOperation::executePixel(float output[4], int x, int y, void *d
 	mul_v4_v4fl(output, color_accum, 1.0f / multiplier_accum);
 }
 
+void GaussianYBlurOperation::executeTileRow(float *output, int x, int y, int length, int stride, void *data)
+{
+	MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
+	rcti &rect = *inputBuffer->getRect();
+
+	/* executePixel clamps pixels left of the buffer */
+	if (x < rect.xmin || x + length > rect.xmax) {
+		BlurBaseOperation::executeTileRow(output, x, y, length, stride, data);
+		return;
+	}
+
+	float *buffer = inputBuffer->getBuffer();
+	int bufferwidth = inputBuffer->getWidth();
+	int ymin = max_ii(y - m_filtersize,     rect.ymin);
+	int ymax = min_ii(y + m_filtersize + 1, rect.ymax);
+	int step = getStep();
+	float multiplier_accum = 0.0f;
+	int i;
+
+#ifdef __SSE2__
+	__m128 accum_r[COM_ROW_LENGTH_MAX];
+	for (i = 0; i < length; i++) {
+		accum_r[i] = _mm_setzero_ps();
+	}
+	for (int ny = ymin; ny < ymax; ny += step) {
+		const int index = (ny - y) + this->m_filtersize;
+		const float *row = &buffer[((ny - rect.ymin) * bufferwidth + (x - rect.xmin)) * 4];
+		const __m128 multiplier = this->m_gausstab_sse[index];
+		for (i = 0; i < length; i++) {
+			__m128 reg_a = _mm_load_ps(&row[i * 4]);
+			reg_a = _mm_mul_ps(reg_a, multiplier);
+			accum_r[i] = _mm_add_ps(accum_r[i], reg_a);
+		}
+		multiplier_accum += this->m_gausstab[index];
+	}
+	for (i = 0; i < length; i++, output += stride) {
+		float ATTR_ALIGN(16) color_accum[4];
+		_mm_store_ps(color_accum, accum_r[i]);
+		mul_v4_v4fl(output, color_accum, 1.0f / multiplier_accum);
+	}
+#else
+	float color_accum[COM_ROW_LENGTH_MAX][4];
+	for (i = 0; i < length; i++) {
+		zero_v4(color_accum[i]);
+	}
+	for (int ny = ymin; ny < ymax; ny += step) {
+		const int index = (ny - y) + this->m_filtersize;
+		const float *row = &buffer[((ny - rect.ymin) * bufferwidth + (x - rect.xmin)) * 4];
+		const float multiplier = this->m_gausstab[index];
+		for (i = 0; i < length; i++) {
+			madd_v4_v4fl(color_accum[i], &row[i * 4], multiplier);
+		}
+		multiplier_accum += multiplier;
+	}
+	for (i = 0; i < length; i++, output += stride) {
+		mul_v4_v4fl(output, color_accum[i], 1.0f / multiplier_accum);
+	}
+#endif
+}
+
 void GaussianYBlurOperation::executeOpenCL(OpenCLDevice *device,
                                            MemoryBuffer *outputMemoryBuffer, cl_mem clOutputBuffer,
                                            MemoryBuffer **inputMemoryBuffers, list<cl_mem> *clMemToCleanUp,
@@ -41,6 +41,11 @@ public:
 	 */
 	void executePixel(float output[4], int x, int y, void *data);
 
+	/**
+	 * the taps are added a row at a time, so the input is read row by row instead of per column
+	 */
+	void executeTileRow(float *output, int x, int y, int length, int stride, void *data);
+
 	void executeOpenCL(OpenCLDevice *device,
 	                   MemoryBuffer *outputMemoryBuffer, cl_mem clOutputBuffer,
 	                   MemoryBuffer **inputMemoryBuffers, list<cl_mem> *clMemToCleanUp,
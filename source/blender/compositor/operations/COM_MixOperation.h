@@ -50,6 +50,15 @@ protected:
 			CLAMP(color[3], 0.0f, 1.0f);
 		}
 	}
+
+	/**
+	 * the inner loop of this program, mixes a row of already read input pixels
+	 * @param output row to write the result to, pixels are stride floats apart
+	 * @param inputValues, inputColors1, inputColors2 rows of the input pixels,
+	 * COM_NUM_CHANNELS_COLOR floats apart
+	 * @param length number of pixels in the row
+	 */
+	virtual void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 	
 public:
 	/**
@@ -57,10 +66,8 @@ public:
 	 */
 	MixBaseOperation();
 	
-	/**
-	 * the inner loop of this program
-	 */
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, int x, int y, int length, int stride);
 	
 	/**
 	 * Initialize the execution
@@ -83,115 +90,134 @@ public:
 class MixAddOperation : public MixBaseOperation {
 public:
 	MixAddOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixBlendOperation : public MixBaseOperation {
 public:
 	MixBlendOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixBurnOperation : public MixBaseOperation {
 public:
 	MixBurnOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixColorOperation : public MixBaseOperation {
 public:
 	MixColorOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixDarkenOperation : public MixBaseOperation {
 public:
 	MixDarkenOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixDifferenceOperation : public MixBaseOperation {
 public:
 	MixDifferenceOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixDivideOperation : public MixBaseOperation {
 public:
 	MixDivideOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixDodgeOperation : public MixBaseOperation {
 public:
 	MixDodgeOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixGlareOperation : public MixBaseOperation {
 public:
 	MixGlareOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixHueOperation : public MixBaseOperation {
 public:
 	MixHueOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixLightenOperation : public MixBaseOperation {
 public:
 	MixLightenOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixLinearLightOperation : public MixBaseOperation {
 public:
 	MixLinearLightOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixMultiplyOperation : public MixBaseOperation {
 public:
 	MixMultiplyOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
 public:
 	MixOverlayOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixSaturationOperation : public MixBaseOperation {
 public:
 	MixSaturationOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixScreenOperation : public MixBaseOperation {
 public:
 	MixScreenOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixSoftLightOperation : public MixBaseOperation {
 public:
 	MixSoftLightOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixSubtractOperation : public MixBaseOperation {
 public:
 	MixSubtractOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 class MixValueOperation : public MixBaseOperation {
 public:
 	MixValueOperation();
-	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+protected:
+	void mixRow(float *output, int stride, float *inputValues, float *inputColors1, float *inputColors2, int length);
 };
 
 #endif
@@ -74,6 +74,19 @@ void ReadBufferOperation::executePixelSampled(float output[4], float x, float y,
 	}
 }
 
+void ReadBufferOperation::executeRow(float *output, int x, int y, int length, int stride)
+{
+	if (m_single_value) {
+		/* write buffer has a single value stored at (0,0) */
+		for (int i = 0; i < length; i++, output += stride) {
+			m_buffer->read(output, 0, 0);
+		}
+	}
+	else {
+		m_buffer->readRow(output, x, y, length, stride);
+	}
+}
+
 void ReadBufferOperation::executePixelExtend(float output[4], float x, float y, PixelSampler sampler,
                                              MemoryBufferExtend extend_x, MemoryBufferExtend extend_y)
 {
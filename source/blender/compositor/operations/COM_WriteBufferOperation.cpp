@@ -24,6 +24,7 @@
 #include "COM_defines.h"
 #include <stdio.h>
 #include "COM_OpenCLDevice.h"
+#include "COM_Profiler.h"
 
 WriteBufferOperation::WriteBufferOperation(DataType datatype) : NodeOperation()
 {
@@ -48,7 +49,7 @@ void WriteBufferOperation::executePixelSampled(float output[4], float x, float y
 void WriteBufferOperation::initExecution()
 {
 	this->m_input = this->getInputOperation(0);
-	this->m_memoryProxy->allocate(this->m_width, this->m_height);
+	/* memory is allocated by the ExecutionSystem, see ExecutionSystem.allocateBuffer */
 }
 
 void WriteBufferOperation::deinitExecution()
@@ -63,7 +64,9 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
 	float *buffer = memoryBuffer->getBuffer();
 	const int num_channels = memoryBuffer->get_num_channels();
 	if (this->m_input->isComplex()) {
+		const double start = Profiler::operation_started(this->m_input);
 		void *data = this->m_input->initializeTileData(rect);
+		Profiler::operation_finished(this->m_input, Profiler::PROFILE_TILE_DATA, start);
 		int x1 = rect->xmin;
 		int y1 = rect->ymin;
 		int x2 = rect->xmax;
@@ -73,9 +76,10 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
 		bool breaked = false;
 		for (y = y1; y < y2 && (!breaked); y++) {
 			int offset4 = (y * memoryBuffer->getWidth() + x1) * num_channels;
-			for (x = x1; x < x2; x++) {
-				this->m_input->read(&(buffer[offset4]), x, y, data);
-				offset4 += num_channels;
+			for (x = x1; x < x2; x += COM_ROW_LENGTH_MAX) {
+				const int length = min_ii(x2 - x, COM_ROW_LENGTH_MAX);
+				this->m_input->readTileRow(&(buffer[offset4]), x, y, length, num_channels, data);
+				offset4 += length * num_channels;
 			}
 			if (isBreaked()) {
 				breaked = true;
@@ -98,9 +102,10 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
 		bool breaked = false;
 		for (y = y1; y < y2 && (!breaked); y++) {
 			int offset4 = (y * memoryBuffer->getWidth() + x1) * num_channels;
-			for (x = x1; x < x2; x++) {
-				this->m_input->readSampled(&(buffer[offset4]), x, y, COM_PS_NEAREST);
-				offset4 += num_channels;
+			for (x = x1; x < x2; x += COM_ROW_LENGTH_MAX) {
+				const int length = min_ii(x2 - x, COM_ROW_LENGTH_MAX);
+				this->m_input->readRow(&(buffer[offset4]), x, y, length, num_channels);
+				offset4 += length * num_channels;
 			}
 			if (isBreaked()) {
 				breaked = true;
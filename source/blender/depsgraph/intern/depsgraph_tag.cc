@@ -181,6 +181,7 @@ void DEG_id_tag_update_ex(Main *bmain, ID *id, short flag)
 		return;
 	}
 	DEG_DEBUG_PRINTF(TAG, "%s: id=%s flag=%d\n", __func__, id->name, flag);
+	id->tag |= LIB_TAG_UNDO_CHANGED;
 	lib_id_recalc_tag_flag(bmain, id, flag);
 	for (Scene *scene = (Scene *)bmain->scene.first;
 	     scene != NULL;
@@ -1393,6 +1393,9 @@ static void node_composit_buts_blur(uiLayout *layout, bContext *UNUSED(C), Point
 			uiItemR(col, ptr, "use_bokeh", 0, NULL, ICON_NONE);
 		}
 		uiItemR(col, ptr, "use_gamma_correction", 0, NULL, ICON_NONE);
+		if (filter == R_FILTER_GAUSS && !reference) {
+			uiItemR(col, ptr, "use_approximate", 0, NULL, ICON_NONE);
+		}
 	}
 	
 	uiItemR(col, ptr, "use_relative", 0, NULL, ICON_NONE);
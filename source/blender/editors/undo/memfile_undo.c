@@ -28,9 +28,11 @@
 #include "BLI_sys_types.h"
 
 #include "DNA_object_enums.h"
+#include "DNA_object_types.h"
 
 #include "BKE_blender_undo.h"
 #include "BKE_context.h"
+#include "BKE_main.h"
 #include "BKE_undo_system.h"
 
 #include "WM_api.h"
@@ -81,13 +83,28 @@ static bool memfile_undosys_step_encode(struct bContext *C, UndoStep *us_p)
 
 static void memfile_undosys_step_decode(struct bContext *C, UndoStep *us_p, int UNUSED(dir))
 {
+	/* The active step holds the current state, unless it's from another undo system, data-blocks were
+	 * added or removed since, or leaving the current mode changes data, then all data-blocks have to
+	 * be read again. Other edits since the step was written tag the changed data-blocks. */
+	MemFileUndoStep *us_current = NULL;
+	{
+		UndoStack *ustack = ED_undo_stack_get();
+		Object *obact = CTX_data_active_object(C);
+		if ((ustack->step_active != NULL) && (ustack->step_active->type == BKE_UNDOSYS_TYPE_MEMFILE) &&
+		    CTX_data_main(C)->is_memfile_undo_written &&
+		    (obact == NULL || obact->mode == OB_MODE_OBJECT))
+		{
+			us_current = (MemFileUndoStep *)ustack->step_active;
+		}
+	}
+
 	/* Loading the content will correctly switch into compatible non-object modes. */
 	ED_object_mode_set(C, OB_MODE_OBJECT);
 
 	/* This is needed so undoing/redoing doesn't crash with threaded previews going */
 	ED_viewport_render_kill_jobs(CTX_wm_manager(C), CTX_data_main(C), true);
 	MemFileUndoStep *us = (MemFileUndoStep *)us_p;
-	BKE_memfile_undo_decode(us->data, C);
+	BKE_memfile_undo_decode(us->data, us_current ? us_current->data : NULL, C);
 
 	WM_event_add_notifier(C, NC_SCENE | ND_LAYER_CONTENT, CTX_data_scene(C));
 }
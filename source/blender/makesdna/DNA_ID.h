@@ -354,6 +354,10 @@ enum {
 	/* Datablock was not allocated by standard system (BKE_libblock_alloc), do not free its memory
 	 * (usual type-specific freeing is called though). */
 	LIB_TAG_NOT_ALLOCATED     = 1 << 14,
+
+	/* RESET_AFTER_USE tag datablock as edited since the last global undo push, set by depsgraph and RNA updates,
+	 * cleared when the undo step is written. Untagged datablocks are kept as they are on undo when unchanged. */
+	LIB_TAG_UNDO_CHANGED      = 1 << 15,
 };
 
 enum {
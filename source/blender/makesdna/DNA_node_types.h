@@ -354,7 +354,7 @@ typedef struct bNodeTree {
 	int update;						/* update flags */
 	short is_updating;				/* flag to prevent reentrant update calls */
 	short done;						/* generic temporary flag for recursion check (DFS/BFS) */
-	int pad2;
+	int cache_size;					/* memory budget of the compositor result cache, in MB */
 	
 	int nodetype DNA_DEPRECATED;	/* specific node type this tree is used for */
 
@@ -417,6 +417,9 @@ typedef struct bNodeTree {
 #define NTREE_COM_GROUPNODE_BUFFER	8	/* use groupnode buffers */
 #define NTREE_VIEWER_BORDER			16	/* use a border for viewer nodes */
 #define NTREE_IS_LOCALIZED			32	/* tree is localized copy, free when deleting node groups */
+#define NTREE_COM_FULL_FRAME		64	/* evaluate each execution group once over its whole area */
+#define NTREE_COM_RESULT_CACHE		128	/* keep results between compositor executions */
+#define NTREE_COM_PROFILE			256	/* measure time and memory used by the compositor operations */
 
 /* XXX not nice, but needed as a temporary flags
  * for group updates after library linking.
@@ -512,6 +515,7 @@ enum {
 enum {
 	CMP_NODEFLAG_BLUR_VARIABLE_SIZE = (1 << 0),
 	CMP_NODEFLAG_BLUR_EXTEND_BOUNDS = (1 << 1),
+	CMP_NODEFLAG_BLUR_APPROXIMATE   = (1 << 2),  /* large gaussian blurs use the recursive filter */
 };
 
 typedef struct NodeFrame {
@@ -1953,6 +1953,11 @@ static void rna_property_update(bContext *C, Main *bmain, Scene *scene, PointerR
 	const bool is_rna = (prop->magic == RNA_MAGIC);
 	prop = rna_ensure_property(prop);
 
+	/* Not every update tags the depsgraph, undo still needs to know the data-block changed. */
+	if (ptr->id.data) {
+		((ID *)ptr->id.data)->tag |= LIB_TAG_UNDO_CHANGED;
+	}
+
 	if (is_rna) {
 		if (prop->update) {
 			/* ideally no context would be needed for update, but there's some
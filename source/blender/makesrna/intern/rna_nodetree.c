@@ -29,6 +29,7 @@
 #include <limits.h>
 
 #include "BLI_listbase.h"
+#include "BLI_path_util.h"
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 
@@ -874,6 +875,14 @@ static void rna_NodeTree_link_clear(bNodeTree *ntree, ReportList *reports)
 	WM_main_add_notifier(NC_NODE | NA_EDITED, ntree);
 }
 
+static void rna_CompositorNodeTree_profile_write(bNodeTree *ntree, ReportList *reports, const char *filepath)
+{
+	if (!ntreeCompositProfileWrite(ntree, filepath)) {
+		BKE_reportf(reports, RPT_ERROR, "Cannot write compositor profile to '%s', enable profiling and "
+		            "execute the tree first", filepath);
+	}
+}
+
 static int rna_NodeTree_active_input_get(PointerRNA *ptr)
 {
 	bNodeTree *ntree = (bNodeTree *)ptr->data;
@@ -4596,6 +4605,13 @@ static void def_cmp_blur(StructRNA *srna)
 	RNA_def_property_ui_text(prop, "Extend Bounds", "Extend bounds of the input image to fully fit blurred image");
 	RNA_def_property_update(prop, NC_NODE | NA_EDITED, "rna_Node_update");
 
+	prop = RNA_def_property(srna, "use_approximate", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "custom1", CMP_NODEFLAG_BLUR_APPROXIMATE);
+	RNA_def_property_ui_text(prop, "Approximate",
+	                         "Approximate Gaussian blurs with a radius of 200 pixels or more with a recursive filter, "
+	                         "which is much faster for large sizes but gives slightly different results");
+	RNA_def_property_update(prop, NC_NODE | NA_EDITED, "rna_Node_update");
+
 	RNA_def_struct_sdna_from(srna, "NodeBlurData", "storage");
 	
 	prop = RNA_def_property(srna, "size_x", PROP_INT, PROP_NONE);
@@ -8337,7 +8353,8 @@ static void rna_def_nodetree(BlenderRNA *brna)
 static void rna_def_composite_nodetree(BlenderRNA *brna)
 {
 	StructRNA *srna;
-	PropertyRNA *prop;
+	PropertyRNA *prop, *parm;
+	FunctionRNA *func;
 
 	srna = RNA_def_struct(brna, "CompositorNodeTree", "NodeTree");
 	RNA_def_struct_ui_text(srna, "Compositor Node Tree", "Node tree consisting of linked nodes used for compositing");
@@ -8373,6 +8390,34 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
 	RNA_def_property_ui_text(prop, "Two Pass", "Use two pass execution during editing: first calculate fast nodes, "
 	                                           "second pass calculate all nodes");
 
+	prop = RNA_def_property(srna, "use_full_frame", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_FULL_FRAME);
+	RNA_def_property_ui_text(prop, "Full Frame", "Calculate each node once for the whole frame instead of per tile, "
+	                                             "intermediate buffers are freed as soon as they are no longer needed");
+
+	prop = RNA_def_property(srna, "use_result_cache", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_RESULT_CACHE);
+	RNA_def_property_ui_text(prop, "Cache Results", "Keep intermediate results while editing, so unchanged parts "
+	                                                "of the tree are not calculated again");
+
+	prop = RNA_def_property(srna, "cache_size", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "cache_size");
+	RNA_def_property_range(prop, 0, INT_MAX);
+	RNA_def_property_ui_range(prop, 0, 16384, 64, -1);
+	RNA_def_property_ui_text(prop, "Cache Size", "Maximum memory used for cached results (in megabytes)");
+
+	prop = RNA_def_property(srna, "use_profiling", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_PROFILE);
+	RNA_def_property_ui_text(prop, "Profile", "Measure the time and memory used by every operation, "
+	                                          "print the results with --debug or write them with profile_write()");
+
+	func = RNA_def_function(srna, "profile_write", "rna_CompositorNodeTree_profile_write");
+	RNA_def_function_ui_description(func, "Write the profile of the last execution as trace event JSON file "
+	                                "(chrome://tracing), with the totals per operation and group");
+	RNA_def_function_flag(func, FUNC_USE_REPORTS);
+	parm = RNA_def_string_file_path(func, "filepath", NULL, FILE_MAX, "File Path", "File to write");
+	RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+
 	prop = RNA_def_property(srna, "use_viewer_border", PROP_BOOLEAN, PROP_NONE);
 	RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_VIEWER_BORDER);
 	RNA_def_property_ui_text(prop, "Viewer Border", "Use boundaries for viewer nodes and composite backdrop");
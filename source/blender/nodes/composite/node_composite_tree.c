@@ -238,6 +238,16 @@ void ntreeCompositExecTree(Scene *scene, bNodeTree *ntree, RenderData *rd, int r
 	UNUSED_VARS(do_preview);
 }
 
+int ntreeCompositProfileWrite(const bNodeTree *ntree, const char *filepath)
+{
+#ifdef WITH_COMPOSITOR
+	return COM_profile_write(ntree, filepath);
+#else
+	UNUSED_VARS(ntree, filepath);
+	return 0;
+#endif
+}
+
 /* *********************************************** */
 
 /* Update the outputs of the render layer nodes.
@@ -280,6 +290,11 @@ void ntreeCompositTagRender(Scene *curscene)
 {
 	Scene *sce;
 
+#ifdef WITH_COMPOSITOR
+	/* cached results of render layer nodes are outdated */
+	COM_render_results_changed();
+#endif
+
 	for (sce = G.main->scene.first; sce; sce = sce->id.next) {
 		if (sce->nodetree) {
 			bNode *node;
@@ -757,6 +757,7 @@ void *dualcon(const DualConInput *input_mesh,
 void COM_execute(RenderData *rd, Scene *scene, bNodeTree *editingtree, int rendering,
                  const ColorManagedViewSettings *viewSettings, const ColorManagedDisplaySettings *displaySettings,
                  const char *viewName) RET_NONE
+int COM_profile_write(const bNodeTree *editingtree, const char *filepath) RET_ZERO
 
 /*multiview*/
 bool RE_RenderResult_is_stereo(RenderResult *res) RET_ZERO
@@ -0,0 +1,107 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_curve_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_curve.h"
+#include "BKE_deform.h"
+#include "BKE_lattice.h"
+#include "BKE_library.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+#include "BKE_object_deform.h"
+}
+
+#define TOT_VERTS 8
+
+/* Straight poly curve along X, used as path. */
+static Object *curve_deform_test_path(Main *bmain)
+{
+	Curve *cu = BKE_curve_add(bmain, "Curve", OB_CURVE);
+	Object *ob = BKE_object_add_only_object(bmain, OB_CURVE, "Curve");
+	Nurb *nu = (Nurb *)MEM_callocN(sizeof(Nurb), __func__);
+	int i;
+
+	nu->type = CU_POLY;
+	nu->pntsu = 3;
+	nu->pntsv = 1;
+	nu->orderu = nu->orderv = 1;
+	nu->bp = (BPoint *)MEM_callocN(sizeof(BPoint) * nu->pntsu, __func__);
+	for (i = 0; i < nu->pntsu; i++) {
+		nu->bp[i].vec[0] = (float)i * 2.0f;
+		nu->bp[i].vec[1] = (float)(i % 2);
+		nu->bp[i].vec[3] = 1.0f;
+	}
+	BLI_addtail(&cu->nurb, nu);
+
+	cu->flag |= CU_PATH | CU_3D;
+	ob->data = cu;
+
+	return ob;
+}
+
+static void curve_deform_test_coords(float (*vertexCos)[3])
+{
+	int i;
+
+	for (i = 0; i < TOT_VERTS; i++) {
+		vertexCos[i][0] = (float)i * 0.5f;
+		vertexCos[i][1] = (float)(i % 3) * 0.25f;
+		vertexCos[i][2] = 0.1f;
+	}
+}
+
+/* A vertex group without any deform-vert data must not be used for weights,
+ * all vertices are deformed as without vertex group. */
+TEST(curve_deform, GroupWithoutDeformVerts)
+{
+	Main *bmain = BKE_main_new();
+	/* Only used for evaluating the path, no need for a fully initialized scene. */
+	Scene *scene = (Scene *)MEM_callocN(sizeof(Scene), __func__);
+	Object *cuOb = curve_deform_test_path(bmain);
+	Object *ob = BKE_object_add_only_object(bmain, OB_MESH, "Mesh");
+	Mesh *me = BKE_mesh_add(bmain, "Mesh");
+	float vertexCos[TOT_VERTS][3], vertexCos_ref[TOT_VERTS][3], vertexCos_orig[TOT_VERTS][3];
+	bool is_deformed = false;
+	int i;
+
+	ob->data = me;
+	id_us_plus(&me->id);
+	BKE_object_defgroup_add_name(ob, "Group");
+	ASSERT_TRUE(me->dvert == NULL);
+
+	curve_deform_test_coords(vertexCos_orig);
+	curve_deform_test_coords(vertexCos_ref);
+	curve_deform_verts(scene, cuOb, ob, NULL, vertexCos_ref, TOT_VERTS, NULL, MOD_CURVE_POSX - 1);
+
+	curve_deform_test_coords(vertexCos);
+	curve_deform_verts(scene, cuOb, ob, NULL, vertexCos, TOT_VERTS, "Group", MOD_CURVE_POSX - 1);
+
+	for (i = 0; i < TOT_VERTS; i++) {
+		EXPECT_EQ(vertexCos_ref[i][0], vertexCos[i][0]);
+		EXPECT_EQ(vertexCos_ref[i][1], vertexCos[i][1]);
+		EXPECT_EQ(vertexCos_ref[i][2], vertexCos[i][2]);
+
+		if (!equals_v3v3(vertexCos_orig[i], vertexCos[i])) {
+			is_deformed = true;
+		}
+	}
+
+	EXPECT_TRUE(is_deformed);
+
+	MEM_freeN(scene);
+	BKE_main_free(bmain);
+}
@@ -0,0 +1,132 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+
+#include "BKE_cdderivedmesh.h"
+#include "BKE_DerivedMesh.h"
+#include "BKE_modifier.h"
+#include "BKE_subsurf.h"
+}
+
+#define GRID_SIZE 4
+
+/* Grid of GRID_SIZE x GRID_SIZE quads with a few creased edges. */
+static DerivedMesh *subsurf_test_grid_dm(void)
+{
+	const int totvert = (GRID_SIZE + 1) * (GRID_SIZE + 1);
+	const int totpoly = GRID_SIZE * GRID_SIZE;
+	DerivedMesh *dm = CDDM_new(totvert, 0, 0, totpoly * 4, totpoly);
+	MVert *mvert = dm->getVertArray(dm);
+	MLoop *mloop = dm->getLoopArray(dm);
+	MPoly *mpoly = dm->getPolyArray(dm);
+	MEdge *medge;
+	int x, y, i;
+
+	for (y = 0; y <= GRID_SIZE; y++) {
+		for (x = 0; x <= GRID_SIZE; x++) {
+			MVert *mv = &mvert[y * (GRID_SIZE + 1) + x];
+			mv->co[0] = (float)x;
+			mv->co[1] = (float)y;
+			mv->co[2] = (float)((x * y) % 3) * 0.25f;
+		}
+	}
+
+	for (y = 0; y < GRID_SIZE; y++) {
+		for (x = 0; x < GRID_SIZE; x++) {
+			const int p = y * GRID_SIZE + x;
+			const int v = y * (GRID_SIZE + 1) + x;
+
+			mpoly[p].loopstart = p * 4;
+			mpoly[p].totloop = 4;
+			mloop[p * 4 + 0].v = v;
+			mloop[p * 4 + 1].v = v + 1;
+			mloop[p * 4 + 2].v = v + GRID_SIZE + 2;
+			mloop[p * 4 + 3].v = v + GRID_SIZE + 1;
+		}
+	}
+
+	CDDM_calc_edges(dm);
+
+	medge = dm->getEdgeArray(dm);
+	for (i = 0; i < dm->getNumEdges(dm); i += 3) {
+		medge[i].crease = 128;
+	}
+
+	return dm;
+}
+
+static void subsurf_test_expect_equal_verts(DerivedMesh *dm_a, DerivedMesh *dm_b)
+{
+	const int totvert = dm_a->getNumVerts(dm_a);
+	int i;
+
+	ASSERT_EQ(totvert, dm_b->getNumVerts(dm_b));
+
+	for (i = 0; i < totvert; i++) {
+		float co_a[3], co_b[3];
+
+		dm_a->getVertCo(dm_a, i, co_a);
+		dm_b->getVertCo(dm_b, i, co_b);
+
+		EXPECT_EQ(co_a[0], co_b[0]);
+		EXPECT_EQ(co_a[1], co_b[1]);
+		EXPECT_EQ(co_a[2], co_b[2]);
+	}
+}
+
+/* Syncing only the moved coordinates into the subsurf kept from the previous
+ * final calculation must give the same result as syncing a new one. */
+TEST(subsurf, PartialSyncMatchesFullSync)
+{
+	BKE_modifier_init();
+
+	SubsurfModifierData *smd_cached = (SubsurfModifierData *)modifier_new(eModifierType_Subsurf);
+	SubsurfModifierData *smd_full = (SubsurfModifierData *)modifier_new(eModifierType_Subsurf);
+	DerivedMesh *dm = subsurf_test_grid_dm();
+	const int totvert = dm->getNumVerts(dm);
+	float (*vertCos)[3] = (float (*)[3])MEM_mallocN(sizeof(*vertCos) * totvert, __func__);
+	int iter, i;
+
+	smd_cached->levels = smd_full->levels = 2;
+	dm->getVertCos(dm, vertCos);
+
+	DerivedMesh *result = subsurf_make_derived_from_derived(dm, smd_cached, NULL, SUBSURF_IS_FINAL_CALC);
+	void *cache = smd_cached->mCache;
+	ASSERT_TRUE(cache != NULL);
+	result->release(result);
+
+	for (iter = 0; iter < 3; iter++) {
+		/* Move a different set of vertices each time. */
+		for (i = iter; i < totvert; i += 4) {
+			vertCos[i][2] += 0.5f;
+			vertCos[i][0] -= 0.125f * iter;
+		}
+
+		DerivedMesh *result_cached = subsurf_make_derived_from_derived(
+		        dm, smd_cached, vertCos, SUBSURF_IS_FINAL_CALC);
+		DerivedMesh *result_full = subsurf_make_derived_from_derived(
+		        dm, smd_full, vertCos, (SubsurfFlags)0);
+
+		/* Topology is unchanged, so the cached subsurf is kept. */
+		EXPECT_EQ(cache, smd_cached->mCache);
+		EXPECT_TRUE(smd_full->mCache == NULL);
+
+		subsurf_test_expect_equal_verts(result_cached, result_full);
+
+		result_cached->release(result_cached);
+		result_full->release(result_full);
+	}
+
+	MEM_freeN(vertCos);
+	dm->release(dm);
+	modifier_free((ModifierData *)smd_cached);
+	modifier_free((ModifierData *)smd_full);
+}
@@ -0,0 +1,130 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_compiler_attrs.h"
+#include "BLI_kdopbvh.h"
+#include "BLI_rand.h"
+#include "BLI_math_vector.h"
+#include "BLI_threads.h"
+#include "MEM_guardedalloc.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include "stubs/bf_intern_eigen_stubs.h"
+
+/* Compares single queries in a loop with the batched (threaded) queries. */
+
+static void rng_v3(float (*coords)[3], int coords_len, struct RNG *rng, float scale)
+{
+	for (int i = 0; i < coords_len; i++) {
+		for (int j = 0; j < 3; j++) {
+			coords[i][j] = (BLI_rng_get_float(rng) * 2.0f - 1.0f) * scale;
+		}
+	}
+}
+
+static BVHTree *tree_create(float (*points)[3], int points_len, struct RNG *rng)
+{
+	BVHTree *tree = BLI_bvhtree_new(points_len, 0.0f, 4, 6);
+
+	rng_v3(points, points_len, rng, 1.0f);
+	for (int i = 0; i < points_len; i++) {
+		BLI_bvhtree_insert(tree, i, points[i], 1);
+	}
+	BLI_bvhtree_balance(tree);
+
+	return tree;
+}
+
+static void find_nearest_performance(int points_len, int co_len)
+{
+	BLI_threadapi_init();
+
+	struct RNG *rng = BLI_rng_new(1234);
+	float (*points)[3] = (float (*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+	float (*co)[3] = (float (*)[3])MEM_mallocN(sizeof(float[3]) * co_len, __func__);
+	BVHTreeNearest *nearest = (BVHTreeNearest *)MEM_mallocN(sizeof(*nearest) * co_len, __func__);
+	BVHTree *tree = tree_create(points, points_len, rng);
+
+	printf("\n========== find nearest, %d points, %d queries ==========\n", points_len, co_len);
+	rng_v3(co, co_len, rng, 1.5f);
+
+	{
+		TIMEIT_START(find_nearest_single);
+		for (int i = 0; i < co_len; i++) {
+			nearest[i].index = -1;
+			nearest[i].dist_sq = FLT_MAX;
+			BLI_bvhtree_find_nearest(tree, co[i], &nearest[i], NULL, NULL);
+		}
+		TIMEIT_END(find_nearest_single);
+	}
+
+	{
+		TIMEIT_START(find_nearest_batch);
+		for (int i = 0; i < co_len; i++) {
+			nearest[i].index = -1;
+			nearest[i].dist_sq = FLT_MAX;
+		}
+		BLI_bvhtree_find_nearest_batch(tree, co, nearest, co_len, NULL, NULL);
+		TIMEIT_END(find_nearest_batch);
+	}
+
+	BLI_bvhtree_free(tree);
+	BLI_rng_free(rng);
+	MEM_freeN(points);
+	MEM_freeN(co);
+	MEM_freeN(nearest);
+}
+
+static void ray_cast_performance(int points_len, int rays_len, float radius)
+{
+	BLI_threadapi_init();
+
+	struct RNG *rng = BLI_rng_new(1234);
+	float (*points)[3] = (float (*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+	BVHTreeRay *rays = (BVHTreeRay *)MEM_mallocN(sizeof(*rays) * rays_len, __func__);
+	BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(*hits) * rays_len, __func__);
+	BVHTree *tree = tree_create(points, points_len, rng);
+
+	printf("\n========== ray cast, %d points, %d rays, radius %f ==========\n", points_len, rays_len, radius);
+	for (int i = 0; i < rays_len; i++) {
+		rng_v3(&rays[i].origin, 1, rng, 2.0f);
+		rng_v3(&rays[i].direction, 1, rng, 1.0f);
+		normalize_v3(rays[i].direction);
+		rays[i].radius = radius;
+	}
+
+	{
+		TIMEIT_START(ray_cast_single);
+		for (int i = 0; i < rays_len; i++) {
+			hits[i].index = -1;
+			hits[i].dist = BVH_RAYCAST_DIST_MAX;
+			BLI_bvhtree_ray_cast(tree, rays[i].origin, rays[i].direction, radius, &hits[i], NULL, NULL);
+		}
+		TIMEIT_END(ray_cast_single);
+	}
+
+	{
+		TIMEIT_START(ray_cast_batch);
+		for (int i = 0; i < rays_len; i++) {
+			hits[i].index = -1;
+			hits[i].dist = BVH_RAYCAST_DIST_MAX;
+		}
+		BLI_bvhtree_ray_cast_batch(tree, rays, hits, rays_len, NULL, NULL, BVH_RAYCAST_DEFAULT);
+		TIMEIT_END(ray_cast_batch);
+	}
+
+	BLI_bvhtree_free(tree);
+	BLI_rng_free(rng);
+	MEM_freeN(points);
+	MEM_freeN(rays);
+	MEM_freeN(hits);
+}
+
+TEST(kdopbvh, FindNearest_100000)		{ find_nearest_performance(100000, 1000000); }
+TEST(kdopbvh, FindNearest_1000000)		{ find_nearest_performance(1000000, 1000000); }
+TEST(kdopbvh, RayCast_100000)			{ ray_cast_performance(100000, 1000000, 0.0f); }
+TEST(kdopbvh, RayCast_1000000)			{ ray_cast_performance(1000000, 1000000, 0.0f); }
+TEST(kdopbvh, RayCastRadius_100000)		{ ray_cast_performance(100000, 1000000, 0.001f); }
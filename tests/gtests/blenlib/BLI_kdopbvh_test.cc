@@ -9,6 +9,7 @@ extern "C" {
 #include "BLI_kdopbvh.h"
 #include "BLI_rand.h"
 #include "BLI_math_vector.h"
+#include "BLI_threads.h"
 #include "MEM_guardedalloc.h"
 }
 
@@ -95,3 +96,104 @@ static void find_nearest_points_test(int points_len, float scale, int round, int
 TEST(kdopbvh, FindNearest_1)		{ find_nearest_points_test(1, 1.0, 1000, 1234); }
 TEST(kdopbvh, FindNearest_2)		{ find_nearest_points_test(2, 1.0, 1000, 123); }
 TEST(kdopbvh, FindNearest_500)		{ find_nearest_points_test(500, 1.0, 1000, 12); }
+
+/* -------------------------------------------------------------------- */
+/* Batched Queries */
+
+static BVHTree *points_tree_create(float (*points)[3], int points_len, struct RNG *rng, int round)
+{
+	BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 4, 6);
+	for (int i = 0; i < points_len; i++) {
+		rng_v3_round(points[i], 3, rng, round, 1.0f);
+		BLI_bvhtree_insert(tree, i, points[i], 1);
+	}
+	BLI_bvhtree_balance(tree);
+	return tree;
+}
+
+/**
+ * Batched results must match single queries exactly.
+ */
+static void find_nearest_batch_test(int points_len, int co_len, int random_seed)
+{
+	BLI_threadapi_init();
+
+	struct RNG *rng = BLI_rng_new(random_seed);
+	float (*points)[3] = (float (*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+	float (*co)[3] = (float (*)[3])MEM_mallocN(sizeof(float[3]) * co_len, __func__);
+	BVHTreeNearest *nearest = (BVHTreeNearest *)MEM_mallocN(sizeof(*nearest) * co_len, __func__);
+	BVHTree *tree = points_tree_create(points, points_len, rng, 1000);
+
+	for (int i = 0; i < co_len; i++) {
+		rng_v3_round(co[i], 3, rng, 100000, 1.5f);
+		nearest[i].index = -1;
+		nearest[i].dist_sq = FLT_MAX;
+	}
+
+	BLI_bvhtree_find_nearest_batch(tree, co, nearest, co_len, NULL, NULL);
+
+	for (int i = 0; i < co_len; i++) {
+		BVHTreeNearest nearest_single;
+		nearest_single.index = -1;
+		nearest_single.dist_sq = FLT_MAX;
+		BLI_bvhtree_find_nearest(tree, co[i], &nearest_single, NULL, NULL);
+
+		EXPECT_EQ(nearest_single.index, nearest[i].index);
+		EXPECT_EQ(nearest_single.dist_sq, nearest[i].dist_sq);
+	}
+
+	BLI_bvhtree_free(tree);
+	BLI_rng_free(rng);
+	MEM_freeN(points);
+	MEM_freeN(co);
+	MEM_freeN(nearest);
+}
+
+static void ray_cast_batch_test(int points_len, int rays_len, float radius, int random_seed)
+{
+	BLI_threadapi_init();
+
+	struct RNG *rng = BLI_rng_new(random_seed);
+	float (*points)[3] = (float (*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+	BVHTreeRay *rays = (BVHTreeRay *)MEM_mallocN(sizeof(*rays) * rays_len, __func__);
+	BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(*hits) * rays_len, __func__);
+	BVHTree *tree = points_tree_create(points, points_len, rng, 1000);
+	int hits_tot = 0;
+
+	for (int i = 0; i < rays_len; i++) {
+		rng_v3_round(rays[i].origin, 3, rng, 100000, 2.0f);
+		/* Aim near an existing point, so most rays hit something. */
+		const int target = BLI_rng_get_int(rng) % points_len;
+		sub_v3_v3v3(rays[i].direction, points[target], rays[i].origin);
+		normalize_v3(rays[i].direction);
+		rays[i].radius = radius;
+		hits[i].index = -1;
+		hits[i].dist = BVH_RAYCAST_DIST_MAX;
+	}
+
+	BLI_bvhtree_ray_cast_batch(tree, rays, hits, rays_len, NULL, NULL, BVH_RAYCAST_DEFAULT);
+
+	for (int i = 0; i < rays_len; i++) {
+		BVHTreeRayHit hit_single;
+		hit_single.index = -1;
+		hit_single.dist = BVH_RAYCAST_DIST_MAX;
+		BLI_bvhtree_ray_cast(tree, rays[i].origin, rays[i].direction, radius, &hit_single, NULL, NULL);
+
+		EXPECT_EQ(hit_single.index, hits[i].index);
+		EXPECT_EQ(hit_single.dist, hits[i].dist);
+		hits_tot += (hits[i].index != -1);
+	}
+	EXPECT_GT(hits_tot, 0);
+
+	BLI_bvhtree_free(tree);
+	BLI_rng_free(rng);
+	MEM_freeN(points);
+	MEM_freeN(rays);
+	MEM_freeN(hits);
+}
+
+TEST(kdopbvh, FindNearestBatch_1)		{ find_nearest_batch_test(1, 100, 1234); }
+TEST(kdopbvh, FindNearestBatch_5000)	{ find_nearest_batch_test(5000, 10000, 12); }
+TEST(kdopbvh, RayCastBatch_1)			{ ray_cast_batch_test(1, 100, 0.0f, 1234); }
+TEST(kdopbvh, RayCastBatch_5000)		{ ray_cast_batch_test(5000, 10000, 0.0f, 12); }
+TEST(kdopbvh, RayCastBatchRadius_5000)	{ ray_cast_batch_test(5000, 10000, 0.01f, 123); }
@@ -0,0 +1,42 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_task_test_util.h"
+
+extern "C" {
+#include "BLI_threads.h"
+};
+
+#define NUM_ITEMS 10000
+
+TEST(task, PoolPushPop)
+{
+	BLI_threadapi_init();
+
+	const int num_iterations = 10;
+	const int max_threads = BLI_system_thread_count() > 2 ? BLI_system_thread_count() : 2;
+
+	printf("\nThreads   Tree (tasks/sec)   Flat (tasks/sec)\n");
+	for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+		TaskScheduler *scheduler = BLI_task_scheduler_create(num_threads);
+		double time_tree = 0.0, time_flat = 0.0;
+
+		for (int iter = 0; iter < num_iterations; iter++) {
+			uint32_t count = 0;
+			time_tree += task_pool_run_tree(scheduler, &count);
+			EXPECT_EQ(count, num_tree_tasks);
+
+			count = 0;
+			time_flat += task_pool_run_flat(scheduler, &count, NUM_ITEMS);
+			EXPECT_EQ(count, NUM_ITEMS);
+		}
+
+		printf("%7d   %16.0f   %16.0f\n",
+		       num_threads,
+		       (double)num_tree_tasks * num_iterations / time_tree,
+		       (double)NUM_ITEMS * num_iterations / time_flat);
+
+		BLI_task_scheduler_free(scheduler);
+	}
+}
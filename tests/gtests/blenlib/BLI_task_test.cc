@@ -8,9 +8,12 @@
 extern "C" {
 #include "BLI_mempool.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 };
 
+#include "BLI_task_test_util.h"
+
 #define NUM_ITEMS 10000
 
 static void task_mempool_iter_func(void *userdata, MempoolIterData *item) {
@@ -74,3 +77,25 @@ TEST(task, MempoolIter)
 
 	BLI_mempool_destroy(mempool);
 }
+
+/* Task pool pushes and work-stealing. */
+
+TEST(task, PoolPushFromThread)
+{
+	BLI_threadapi_init();
+
+	const int thread_counts[] = {1, 2, 4, 8};
+	for (int i = 0; i < ARRAY_SIZE(thread_counts); i++) {
+		TaskScheduler *scheduler = BLI_task_scheduler_create(thread_counts[i]);
+
+		uint32_t count = 0;
+		task_pool_run_tree(scheduler, &count);
+		EXPECT_EQ(count, num_tree_tasks);
+
+		count = 0;
+		task_pool_run_flat(scheduler, &count, NUM_ITEMS);
+		EXPECT_EQ(count, NUM_ITEMS);
+
+		BLI_task_scheduler_free(scheduler);
+	}
+}
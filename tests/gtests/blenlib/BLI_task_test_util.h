@@ -0,0 +1,73 @@
+/* Apache License, Version 2.0 */
+
+#ifndef __BLENDER_TESTING_BLI_TASK_TEST_UTIL_H__
+#define __BLENDER_TESTING_BLI_TASK_TEST_UTIL_H__
+
+/* Task pool pushes and work-stealing, shared by the correctness and performance tests. */
+
+#include "atomic_ops.h"
+
+extern "C" {
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+#include "PIL_time.h"
+};
+
+#define NUM_TREE_LEVELS 12
+
+static void task_tree_func(TaskPool *__restrict pool, void *taskdata, int thread_id)
+{
+	const int level = GET_INT_FROM_POINTER(taskdata);
+	uint32_t *count = (uint32_t *)BLI_task_pool_userdata(pool);
+
+	atomic_add_and_fetch_uint32(count, 1);
+
+	if (level < NUM_TREE_LEVELS) {
+		/* Children are pushed to the thread's own deque, from where they are
+		 * stolen by other threads. */
+		BLI_task_pool_delayed_push_begin(pool, thread_id);
+		for (int i = 0; i < 2; i++) {
+			BLI_task_pool_push_from_thread(pool, task_tree_func,
+			                               SET_INT_IN_POINTER(level + 1), false,
+			                               TASK_PRIORITY_LOW, thread_id);
+		}
+		BLI_task_pool_delayed_push_end(pool, thread_id);
+	}
+}
+
+static void task_flat_func(TaskPool *__restrict pool, void *UNUSED(taskdata), int UNUSED(thread_id))
+{
+	uint32_t *count = (uint32_t *)BLI_task_pool_userdata(pool);
+	atomic_add_and_fetch_uint32(count, 1);
+}
+
+/* Number of tasks in a full binary tree of NUM_TREE_LEVELS depth. */
+static const uint32_t num_tree_tasks = (1u << (NUM_TREE_LEVELS + 1)) - 1;
+
+/* Run a binary tree of tasks, returns the time it took in seconds. */
+static double task_pool_run_tree(TaskScheduler *scheduler, uint32_t *count)
+{
+	TaskPool *pool = BLI_task_pool_create(scheduler, count);
+	const double time_start = PIL_check_seconds_timer();
+	BLI_task_pool_push(pool, task_tree_func, SET_INT_IN_POINTER(0), false, TASK_PRIORITY_LOW);
+	BLI_task_pool_work_and_wait(pool);
+	const double time = PIL_check_seconds_timer() - time_start;
+	BLI_task_pool_free(pool);
+	return time;
+}
+
+/* Run num_tasks independent tasks, returns the time it took in seconds. */
+static double task_pool_run_flat(TaskScheduler *scheduler, uint32_t *count, const int num_tasks)
+{
+	TaskPool *pool = BLI_task_pool_create(scheduler, count);
+	const double time_start = PIL_check_seconds_timer();
+	for (int i = 0; i < num_tasks; i++) {
+		BLI_task_pool_push(pool, task_flat_func, NULL, false, TASK_PRIORITY_LOW);
+	}
+	BLI_task_pool_work_and_wait(pool);
+	const double time = PIL_check_seconds_timer() - time_start;
+	BLI_task_pool_free(pool);
+	return time;
+}
+
+#endif  /* __BLENDER_TESTING_BLI_TASK_TEST_UTIL_H__ */
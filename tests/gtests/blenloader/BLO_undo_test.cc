@@ -0,0 +1,112 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+
+#include "DNA_genfile.h"
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_depsgraph.h"
+#include "BKE_global.h"
+#include "BKE_library.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+#include "BLO_readfile.h"
+#include "BLO_undofile.h"
+#include "BLO_writefile.h"
+}
+
+class UndoReuseTest : public testing::Test
+{
+protected:
+	Main *bmain;
+	Mesh *me;
+	Object *ob;
+	MemFile memfile;
+
+	virtual void SetUp()
+	{
+		DNA_sdna_current_init();
+
+		bmain = BKE_main_new();
+		me = BKE_mesh_add(bmain, "Mesh");
+		ob = BKE_object_add_only_object(bmain, OB_MESH, "Object");
+		ob->data = me;
+		id_us_plus(&me->id);
+
+		memset(&memfile, 0, sizeof(memfile));
+		BLO_write_file_mem(bmain, NULL, &memfile, 0);
+	}
+
+	virtual void TearDown()
+	{
+		BLO_memfile_free(&memfile);
+		BKE_main_free(bmain);
+		DNA_sdna_current_free();
+	}
+
+	/* Read the undo step, the new main replaces the current one which was written to the same step. */
+	void undo()
+	{
+		BlendFileData *bfd = BLO_read_from_memfile(bmain, "", &memfile, &memfile, NULL, BLO_READ_SKIP_NONE);
+		ASSERT_TRUE(bfd != NULL);
+
+		BKE_main_free(bmain);
+		bmain = bfd->main;
+		bfd->main = NULL;
+		BLO_blendfiledata_free(bfd);
+	}
+};
+
+TEST_F(UndoReuseTest, UnchangedIDsAreKept)
+{
+	undo();
+
+	EXPECT_EQ(me, bmain->mesh.first);
+	EXPECT_EQ(ob, bmain->object.first);
+	EXPECT_EQ(me, ob->data);
+	EXPECT_EQ(1, me->id.us);
+}
+
+/* Edits made without an undo push must be reverted as well, they're tagged by the depsgraph update. */
+TEST_F(UndoReuseTest, EditWithoutPushIsRestored)
+{
+	ob->loc[0] = 1.0f;
+	DAG_id_tag_update_ex(bmain, &ob->id, OB_RECALC_OB);
+
+	undo();
+
+	Object *ob_undo = (Object *)bmain->object.first;
+	ASSERT_TRUE(ob_undo != NULL);
+	EXPECT_NE(ob, ob_undo);
+	EXPECT_EQ(0.0f, ob_undo->loc[0]);
+
+	/* The mesh didn't change and is still used by the object read again. */
+	EXPECT_EQ(me, bmain->mesh.first);
+	EXPECT_EQ(me, ob_undo->data);
+	EXPECT_EQ(1, me->id.us);
+}
+
+/* Data-blocks read again have other addresses than in the memfile, the next undo can't keep them. */
+TEST_F(UndoReuseTest, ReadAgainIsTagged)
+{
+	DAG_id_tag_update_ex(bmain, &ob->id, OB_RECALC_OB);
+
+	undo();
+
+	Object *ob_undo = (Object *)bmain->object.first;
+	EXPECT_TRUE(ob_undo->id.tag & LIB_TAG_UNDO_CHANGED);
+	EXPECT_FALSE(me->id.tag & LIB_TAG_UNDO_CHANGED);
+
+	undo();
+
+	EXPECT_NE(ob_undo, bmain->object.first);
+	EXPECT_EQ(me, bmain->mesh.first);
+}
@@ -1,9 +1,16 @@
 #include "testing/testing.h"
 
+#include "MEM_guardedalloc.h"
+
 #include "BLI_utildefines.h"
 #include "bmesh.h"
 #include "BLI_math.h"
 
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_customdata.h"
+
 TEST(bmesh_core, BMVertCreate) {
 	BMesh *bm;
 	BMVert *bv1, *bv2, *bv3;
@@ -37,3 +44,70 @@ TEST(bmesh_core, BMVertCreate) {
 	EXPECT_EQ(BM_mesh_elem_count(bm, BM_VERT), 3);
 	BM_mesh_free(bm);
 }
+
+TEST(bmesh_core, MeshConvertCustomData) {
+	BMesh *bm;
+	BMVert *verts[4];
+	BMFace *f;
+	BMLoop *l;
+	BMIter iter;
+	Mesh me;
+	int i;
+	const float cos[4][3] = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+
+	BMeshCreateParams bm_params = {0};
+	bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+	BM_data_layer_add(bm, &bm->vdata, CD_PROP_FLT);
+	BM_data_layer_add(bm, &bm->ldata, CD_MLOOPUV);
+	for (i = 0; i < 4; i++) {
+		verts[i] = BM_vert_create(bm, cos[i], NULL, BM_CREATE_NOP);
+		BM_elem_float_data_set(&bm->vdata, verts[i], CD_PROP_FLT, 0.5f * i);
+	}
+	f = BM_face_create_verts(bm, verts, 4, NULL, BM_CREATE_NOP, true);
+	ASSERT_TRUE(f != NULL);
+	const int cd_loop_uv_offset = CustomData_get_offset(&bm->ldata, CD_MLOOPUV);
+	BM_ITER_ELEM (l, &iter, f, BM_LOOPS_OF_FACE) {
+		MLoopUV *luv = (MLoopUV *)BM_ELEM_CD_GET_VOID_P(l, cd_loop_uv_offset);
+		copy_v2_v2(luv->uv, l->v->co);
+	}
+
+	memset(&me, 0, sizeof(me));
+	BMeshToMeshParams to_me_params = {0};
+	BM_mesh_bm_to_me(bm, &me, &to_me_params);
+	BM_mesh_free(bm);
+
+	EXPECT_EQ(me.totvert, 4);
+	EXPECT_EQ(me.totloop, 4);
+	const float *vfloat = (const float *)CustomData_get_layer(&me.vdata, CD_PROP_FLT);
+	const MLoopUV *mloopuv = (const MLoopUV *)CustomData_get_layer(&me.ldata, CD_MLOOPUV);
+	ASSERT_TRUE(vfloat != NULL);
+	ASSERT_TRUE(mloopuv != NULL);
+	for (i = 0; i < 4; i++) {
+		EXPECT_EQ(vfloat[i], 0.5f * i);
+		EXPECT_TRUE(equals_v2v2(mloopuv[i].uv, me.mvert[me.mloop[i].v].co));
+	}
+
+	bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+	BMeshFromMeshParams from_me_params = {0};
+	BM_mesh_bm_from_me(bm, &me, &from_me_params);
+	EXPECT_EQ(bm->totvert, 4);
+	EXPECT_EQ(bm->totface, 1);
+	BMVert *v;
+	BM_ITER_MESH_INDEX (v, &iter, bm, BM_VERTS_OF_MESH, i) {
+		EXPECT_EQ(BM_elem_float_data_get(&bm->vdata, v, CD_PROP_FLT), 0.5f * i);
+	}
+	const int cd_loop_uv_offset_new = CustomData_get_offset(&bm->ldata, CD_MLOOPUV);
+	f = BM_face_at_index_find(bm, 0);
+	BM_ITER_ELEM (l, &iter, f, BM_LOOPS_OF_FACE) {
+		const MLoopUV *luv = (const MLoopUV *)BM_ELEM_CD_GET_VOID_P(l, cd_loop_uv_offset_new);
+		EXPECT_TRUE(equals_v2v2(luv->uv, l->v->co));
+	}
+	BM_mesh_free(bm);
+
+	CustomData_free(&me.vdata, me.totvert);
+	CustomData_free(&me.edata, me.totedge);
+	CustomData_free(&me.fdata, me.totface);
+	CustomData_free(&me.ldata, me.totloop);
+	CustomData_free(&me.pdata, me.totpoly);
+	MEM_SAFE_FREE(me.mselect);
+}
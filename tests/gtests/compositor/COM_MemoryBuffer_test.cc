@@ -0,0 +1,65 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "COM_MemoryBuffer.h"
+
+/* Fill the buffer with a color that encodes the pixel coordinates. */
+static void memory_buffer_test_fill(MemoryBuffer *buffer, const rcti *rect)
+{
+	for (int y = rect->ymin; y < rect->ymax; y++) {
+		for (int x = rect->xmin; x < rect->xmax; x++) {
+			const float color[4] = {(float)x, (float)y, 0.5f, 1.0f};
+			buffer->writePixel(x, y, color);
+		}
+	}
+}
+
+/* Rows of a buffer that doesn't start at the origin must be read from the rect,
+ * pixels outside of it are zero. */
+static void memory_buffer_test_read_row(int stride)
+{
+	rcti rect;
+	BLI_rcti_init(&rect, 10, 20, 5, 9);
+
+	MemoryBuffer *buffer = new MemoryBuffer(COM_DT_COLOR, &rect);
+	memory_buffer_test_fill(buffer, &rect);
+
+	const int x = 6, length = 20;
+	float *row = new float[length * stride];
+
+	for (int y = rect.ymin - 1; y <= rect.ymax; y++) {
+		buffer->readRow(row, x, y, length, stride);
+
+		for (int i = 0; i < length; i++) {
+			float expected[4];
+			if (y >= rect.ymin && y < rect.ymax && x + i >= rect.xmin && x + i < rect.xmax) {
+				expected[0] = (float)(x + i);
+				expected[1] = (float)y;
+				expected[2] = 0.5f;
+				expected[3] = 1.0f;
+			}
+			else {
+				zero_v4(expected);
+			}
+
+			EXPECT_EQ(expected[0], row[i * stride + 0]);
+			EXPECT_EQ(expected[1], row[i * stride + 1]);
+			EXPECT_EQ(expected[2], row[i * stride + 2]);
+			EXPECT_EQ(expected[3], row[i * stride + 3]);
+		}
+	}
+
+	delete[] row;
+	delete buffer;
+}
+
+TEST(MemoryBuffer, ReadRowOffsetRect)
+{
+	memory_buffer_test_read_row(COM_NUM_CHANNELS_COLOR);
+}
+
+TEST(MemoryBuffer, ReadRowOffsetRectStride)
+{
+	memory_buffer_test_read_row(COM_NUM_CHANNELS_COLOR + 2);
+}
@@ -0,0 +1,125 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+# Benchmark for loading and linking large .blend files.
+#
+# Writes a synthetic file with many data-blocks, each with many pointers to relink
+# (meshes with many vertex groups and materials, actions with many F-Curves),
+# then times opening it and linking half of its objects from another file.
+#
+# Usage:
+#   blender --background --factory-startup --python bl_blendfile_load_benchmark.py -- [--objects N] [--runs N]
+
+import bpy
+
+import os
+import sys
+import tempfile
+import time
+
+
+def parse_args():
+    import argparse
+
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+    parser = argparse.ArgumentParser(description="Time loading of a synthetic .blend file.")
+    parser.add_argument("--objects", type=int, default=2000, help="number of objects to create")
+    parser.add_argument("--runs", type=int, default=3, help="number of times every file is loaded")
+    return parser.parse_args(argv)
+
+
+def create_synthetic_scene(tot_objects):
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    scene = bpy.context.scene
+
+    materials = [bpy.data.materials.new("Material.%03d" % i) for i in range(16)]
+
+    for i in range(tot_objects):
+        mesh = bpy.data.meshes.new("Mesh.%05d" % i)
+        verts = [(x, y, 0.0) for x in range(8) for y in range(8)]
+        faces = [(x * 8 + y, (x + 1) * 8 + y, (x + 1) * 8 + y + 1, x * 8 + y + 1)
+                 for x in range(7) for y in range(7)]
+        mesh.from_pydata(verts, [], faces)
+        mesh.uv_textures.new()
+        for mat in materials:
+            mesh.materials.append(mat)
+
+        ob = bpy.data.objects.new("Object.%05d" % i, mesh)
+        ob.location = (i % 100, i // 100, 0.0)
+        for j in range(8):
+            ob.vertex_groups.new("Group.%d" % j)
+        scene.objects.link(ob)
+
+        action = bpy.data.actions.new("Action.%05d" % i)
+        for index in range(3):
+            fcurve = action.fcurves.new("location", index, "Object Transforms")
+            fcurve.keyframe_points.add(8)
+            for k, point in enumerate(fcurve.keyframe_points):
+                point.co = (k * 10.0, float(k))
+        ob.animation_data_create().action = action
+
+
+def time_runs(runs, fn):
+    times = []
+    for _ in range(runs):
+        start = time.time()
+        fn()
+        times.append(time.time() - start)
+    return min(times), sum(times) / len(times)
+
+
+def main():
+    args = parse_args()
+
+    with tempfile.TemporaryDirectory() as temp_dir:
+        filepath = os.path.join(temp_dir, "synthetic.blend")
+        filepath_compressed = os.path.join(temp_dir, "synthetic_compressed.blend")
+
+        start = time.time()
+        create_synthetic_scene(args.objects)
+        print("Created %d objects in %.3fs" % (args.objects, time.time() - start))
+
+        bpy.ops.wm.save_as_mainfile(filepath=filepath, compress=False)
+        bpy.ops.wm.save_as_mainfile(filepath=filepath_compressed, compress=True)
+        print("File size: %.1f MB, compressed %.1f MB" %
+              (os.path.getsize(filepath) / 1e6, os.path.getsize(filepath_compressed) / 1e6))
+
+        def open_file():
+            bpy.ops.wm.open_mainfile(filepath=filepath, load_ui=False)
+
+        def open_file_compressed():
+            bpy.ops.wm.open_mainfile(filepath=filepath_compressed, load_ui=False)
+
+        def link_objects():
+            bpy.ops.wm.read_factory_settings(use_empty=True)
+            with bpy.data.libraries.load(filepath, link=True) as (data_from, data_to):
+                data_to.objects = data_from.objects[::2]
+
+        for name, fn in (("open", open_file),
+                         ("open compressed", open_file_compressed),
+                         ("link half of the objects", link_objects)):
+            best, average = time_runs(args.runs, fn)
+            print("%-26s best %.3fs, average %.3fs" % (name + ":", best, average))
+
+        assert(len(bpy.data.objects) == (args.objects + 1) // 2)
+
+
+if __name__ == "__main__":
+    main()